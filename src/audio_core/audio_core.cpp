@@ -12,6 +12,9 @@
 #include "audio_core/sink.h"
 #include "audio_core/sink_details.h"
 #include "common/common_types.h"
+#include "common/microprofile.h"
+#include "common/perf_counters.h"
+#include "core/core.h"
 #include "core/core_timing.h"
 #include "core/hle/service/dsp_dsp.h"
 
@@ -21,7 +24,13 @@ namespace AudioCore {
 static int tick_event;                               ///< CoreTiming event
 static constexpr u64 audio_frame_ticks = 1310252ull; ///< Units: ARM11 cycles
 
+MICROPROFILE_DEFINE(DSP, "DSP", "Audio Tick", MP_RGB(255, 192, 64));
+
 static void AudioTickCallback(u64 /*userdata*/, int cycles_late) {
+    Core::FrameProfiler::Scope profile_scope(Core::System::GetInstance().frame_profiler,
+                                             Core::FrameProfiler::Component::DSP);
+    MICROPROFILE_SCOPE(DSP);
+    PERF_COUNTERS_SCOPE(DSP);
     if (DSP::HLE::Tick()) {
         // TODO(merry): Signal all the other interrupts as appropriate.
         Service::DSP_DSP::SignalPipeInterrupt(DSP::HLE::DspPipe::Audio);
@@ -58,4 +67,8 @@ void Shutdown() {
     DSP::HLE::Shutdown();
 }
 
+void DoState(PointerWrap& p) {
+    DSP::HLE::DoState(p);
+}
+
 } // namespace AudioCore
@@ -9,6 +9,8 @@
 #include "common/common_types.h"
 #include "core/memory.h"
 
+class PointerWrap;
+
 namespace AudioCore {
 
 constexpr int native_sample_rate = 32728; ///< 32kHz
@@ -28,4 +30,7 @@ void EnableStretching(bool enable);
 /// Shutdown Audio Core
 void Shutdown();
 
+/// Serializes the state of the DSP, for checkpoints
+void DoState(PointerWrap& p);
+
 } // namespace AudioCore
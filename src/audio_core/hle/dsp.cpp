@@ -10,6 +10,7 @@
 #include "audio_core/hle/source.h"
 #include "audio_core/sink.h"
 #include "audio_core/time_stretch.h"
+#include "common/chunk_file.h"
 
 namespace DSP {
 namespace HLE {
@@ -151,6 +152,18 @@ void Shutdown() {
     }
 }
 
+void DoState(PointerWrap& p) {
+    auto s = p.Section("DSP", 1);
+    if (!s)
+        return;
+
+    DoPipeState(p);
+    for (auto& source : sources) {
+        source.DoState(p);
+    }
+    mixers.DoState(p);
+}
+
 bool Tick() {
     StereoFrame16 current_frame = {};
 
@@ -14,6 +14,8 @@
 #include "common/common_types.h"
 #include "common/swap.h"
 
+class PointerWrap;
+
 namespace AudioCore {
 class Sink;
 }
@@ -570,6 +572,9 @@ void Init();
 /// Shutdown DSP hardware
 void Shutdown();
 
+/// Serializes the state of the audio processing, for checkpoints. DSP memory isn't included.
+void DoState(PointerWrap& p);
+
 /**
  * Perform processing and updates state of current shared memory buffer.
  * This function is called every audio tick before triggering the audio interrupt.
@@ -7,6 +7,7 @@
 #include "audio_core/hle/common.h"
 #include "audio_core/hle/dsp.h"
 #include "audio_core/hle/filter.h"
+#include "common/chunk_file.h"
 #include "common/common_types.h"
 #include "common/math_util.h"
 
@@ -35,6 +36,13 @@ void SourceFilters::Configure(SourceConfiguration::Configuration::BiquadFilter c
     biquad_filter.Configure(config);
 }
 
+void SourceFilters::DoState(PointerWrap& p) {
+    p.Do(simple_filter_enabled);
+    p.Do(biquad_filter_enabled);
+    p.DoVoid(&simple_filter, sizeof(simple_filter));
+    p.DoVoid(&biquad_filter, sizeof(biquad_filter));
+}
+
 void SourceFilters::ProcessFrame(StereoFrame16& frame) {
     if (!simple_filter_enabled && !biquad_filter_enabled)
         return;
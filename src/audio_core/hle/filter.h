@@ -49,6 +49,8 @@ public:
      */
     void ProcessFrame(StereoFrame16& frame);
 
+    void DoState(PointerWrap& p);
+
 private:
     bool simple_filter_enabled;
     bool biquad_filter_enabled;
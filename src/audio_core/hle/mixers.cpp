@@ -8,6 +8,7 @@
 #include "audio_core/hle/dsp.h"
 #include "audio_core/hle/mixers.h"
 #include "common/assert.h"
+#include "common/chunk_file.h"
 #include "common/logging/log.h"
 #include "common/math_util.h"
 
@@ -32,6 +33,11 @@ DspStatus Mixers::Tick(DspConfiguration& config, const IntermediateMixSamples& r
     return GetCurrentStatus();
 }
 
+void Mixers::DoState(PointerWrap& p) {
+    p.Do(current_frame);
+    p.DoVoid(&state, sizeof(state));
+}
+
 void Mixers::ParseConfig(DspConfiguration& config) {
     if (!config.dirty_raw) {
         return;
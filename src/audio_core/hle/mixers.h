@@ -26,6 +26,8 @@ public:
         return current_frame;
     }
 
+    void DoState(PointerWrap& p);
+
 private:
     StereoFrame16 current_frame = {};
 
@@ -59,5 +59,8 @@ enum class DspState {
 /// Get the state of the DSP
 DspState GetDspState();
 
+/// Serializes the pipes and the state of the DSP, for checkpoints
+void DoPipeState(PointerWrap& p);
+
 } // namespace HLE
 } // namespace DSP
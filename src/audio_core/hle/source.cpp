@@ -9,6 +9,7 @@
 #include "audio_core/hle/source.h"
 #include "audio_core/interpolate.h"
 #include "common/assert.h"
+#include "common/chunk_file.h"
 #include "common/logging/log.h"
 #include "core/memory.h"
 
@@ -40,6 +41,46 @@ void Source::MixInto(QuadFrame32& dest, size_t intermediate_mix_id) const {
     }
 }
 
+void Source::DoState(PointerWrap& p) {
+    p.Do(current_frame);
+    p.Do(state.enabled);
+    p.Do(state.sync);
+    p.Do(state.gain);
+
+    // std::priority_queue doesn't give access to its elements, so they are stored in order
+    std::vector<Buffer> buffers;
+    if (p.GetMode() != PointerWrap::MODE_READ) {
+        auto queue = state.input_queue;
+        for (; !queue.empty(); queue.pop()) {
+            buffers.push_back(queue.top());
+        }
+    }
+    u32 buffer_count = static_cast<u32>(buffers.size());
+    p.Do(buffer_count);
+    buffers.resize(buffer_count);
+    p.DoVoid(buffers.data(), static_cast<int>(buffer_count * sizeof(Buffer)));
+    if (p.GetMode() == PointerWrap::MODE_READ) {
+        state.input_queue = {};
+        for (const Buffer& buffer : buffers) {
+            state.input_queue.push(buffer);
+        }
+    }
+
+    p.Do(state.mono_or_stereo);
+    p.Do(state.format);
+    p.Do(state.current_sample_number);
+    p.Do(state.next_sample_number);
+    p.Do(state.current_buffer);
+    p.Do(state.buffer_update);
+    p.Do(state.current_buffer_id);
+    p.Do(state.adpcm_coeffs);
+    p.Do(state.adpcm_state);
+    p.Do(state.rate_multiplier);
+    p.Do(state.interpolation_mode);
+    p.DoVoid(&state.interp_state, sizeof(state.interp_state));
+    state.filters.DoState(p);
+}
+
 void Source::Reset() {
     current_frame.fill({});
     state = {};
@@ -54,6 +54,8 @@ public:
      */
     void MixInto(QuadFrame32& dest, size_t intermediate_mix_id) const;
 
+    void DoState(PointerWrap& p);
+
 private:
     const size_t source_id;
     StereoFrame16 current_frame;
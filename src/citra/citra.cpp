@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <chrono>
 #include <iostream>
 #include <memory>
 #include <string>
@@ -25,7 +26,9 @@
 #endif
 
 #include "citra/config.h"
+#include "citra/emu_window/emu_window_null.h"
 #include "citra/emu_window/emu_window_sdl2.h"
+#include "common/file_util.h"
 #include "common/logging/backend.h"
 #include "common/logging/filter.h"
 #include "common/logging/log.h"
@@ -40,9 +43,97 @@
 static void PrintHelp(const char* argv0) {
     std::cout << "Usage: " << argv0
               << " [options] <filename>\n"
-                 "-g, --gdbport=NUMBER  Enable gdb stub on port NUMBER\n"
-                 "-h, --help            Display this help and exit\n"
-                 "-v, --version         Output version information and exit\n";
+                 "-b, --boot-profile=FILE  Boot without a display, write the boot time breakdown\n"
+                 "                         to FILE (- for stdout) as JSON and exit\n"
+                 "-B, --benchmark=FILE     Run without a display, audio or input for a number of\n"
+                 "                         frames, write their times to FILE (- for stdout) as\n"
+                 "                         JSON and exit\n"
+                 "-n, --frames=NUMBER      Number of frames to run for --benchmark (default 1800)\n"
+                 "-c, --perf-counters      Also count hardware events (cycles, instructions, cache\n"
+                 "                         and branch misses) in the hot paths for --benchmark.\n"
+                 "                         Linux only, slows down emulation\n"
+                 "-g, --gdbport=NUMBER     Enable gdb stub on port NUMBER\n"
+                 "-h, --help               Display this help and exit\n"
+                 "-v, --version            Output version information and exit\n";
+}
+
+/// How long to wait for the first frame when profiling the boot, in case it never comes
+static constexpr std::chrono::seconds BOOT_PROFILE_TIMEOUT{60};
+
+/// Configures the emulator to run without a display, audio device or input, for profiling
+static void ConfigureHeadless() {
+    Settings::values.use_null_renderer = true;
+    Settings::values.sink_id = "null";
+
+    // With no input devices, runs are reproducible
+    for (std::string& button : Settings::values.buttons) {
+        button.clear();
+    }
+    for (std::string& analog : Settings::values.analogs) {
+        analog.clear();
+    }
+    Settings::values.motion_device.clear();
+    Settings::values.touch_device.clear();
+}
+
+/// Writes a profiling report to a file, or to stdout if the path is -
+static bool WriteReport(const std::string& report, const std::string& path) {
+    if (path == "-") {
+        std::cout << report;
+        return true;
+    }
+    if (FileUtil::WriteStringToFile(true, report, path.c_str()) != report.size()) {
+        LOG_CRITICAL(Frontend, "Failed to write the report to %s", path.c_str());
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Runs the application until it presents its first frame, and writes the boot profile.
+ * @returns The exit code of citra, 0 if the first frame was reached and the profile written
+ */
+static int ProfileBoot(Core::System& system, const std::string& path) {
+    const auto deadline = std::chrono::steady_clock::now() + BOOT_PROFILE_TIMEOUT;
+    while (!system.boot_profiler.IsFirstFrameReached() &&
+           std::chrono::steady_clock::now() < deadline) {
+        if (system.RunLoop() != Core::System::ResultStatus::Success) {
+            LOG_CRITICAL(Frontend, "Emulation failed: %s", system.GetStatusDetails().c_str());
+            return -1;
+        }
+    }
+
+    if (!WriteReport(system.boot_profiler.ToJSON(), path)) {
+        return -1;
+    }
+
+    if (!system.boot_profiler.IsFirstFrameReached()) {
+        LOG_CRITICAL(Frontend, "The application didn't present a frame within %lld seconds",
+                     static_cast<long long>(BOOT_PROFILE_TIMEOUT.count()));
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Runs the application for a number of system frames, and writes their times.
+ * @returns The exit code of citra, 0 if the frames were run and the report written
+ */
+static int RunBenchmark(Core::System& system, size_t frames, const std::string& path,
+                        bool count_hardware_events) {
+    // Make the performance statistics cover the same frames as the profiler
+    system.GetAndResetPerfStats();
+    system.frame_profiler.Start(count_hardware_events);
+    while (system.frame_profiler.GetFrames().size() < frames) {
+        if (system.RunLoop() != Core::System::ResultStatus::Success) {
+            LOG_CRITICAL(Frontend, "Emulation failed: %s", system.GetStatusDetails().c_str());
+            return -1;
+        }
+    }
+    system.frame_profiler.Stop();
+
+    const Core::PerfStats::Results perf_results = system.GetAndResetPerfStats();
+    return WriteReport(system.frame_profiler.ToJSON(perf_results), path) ? 0 : -1;
 }
 
 static void PrintVersion() {
@@ -66,8 +157,16 @@ int main(int argc, char** argv) {
     }
 #endif
     std::string filepath;
+    std::string boot_profile_path;
+    std::string benchmark_path;
+    size_t benchmark_frames = 1800;
+    bool count_hardware_events = false;
 
     static struct option long_options[] = {
+        {"boot-profile", required_argument, 0, 'b'},
+        {"benchmark", required_argument, 0, 'B'},
+        {"frames", required_argument, 0, 'n'},
+        {"perf-counters", no_argument, 0, 'c'},
         {"gdbport", required_argument, 0, 'g'},
         {"help", no_argument, 0, 'h'},
         {"version", no_argument, 0, 'v'},
@@ -75,9 +174,28 @@ int main(int argc, char** argv) {
     };
 
     while (optind < argc) {
-        char arg = getopt_long(argc, argv, "g:hv", long_options, &option_index);
+        char arg = getopt_long(argc, argv, "b:B:n:cg:hv", long_options, &option_index);
         if (arg != -1) {
             switch (arg) {
+            case 'b':
+                boot_profile_path = optarg;
+                break;
+            case 'B':
+                benchmark_path = optarg;
+                break;
+            case 'n':
+                errno = 0;
+                benchmark_frames = strtoul(optarg, &endarg, 0);
+                if (endarg == optarg || benchmark_frames == 0)
+                    errno = EINVAL;
+                if (errno != 0) {
+                    perror("--frames");
+                    exit(1);
+                }
+                break;
+            case 'c':
+                count_hardware_events = true;
+                break;
             case 'g':
                 errno = 0;
                 gdb_port = strtoul(optarg, &endarg, 0);
@@ -126,15 +244,28 @@ int main(int argc, char** argv) {
     // Apply the command line arguments
     Settings::values.gdbstub_port = gdb_port;
     Settings::values.use_gdbstub = use_gdbstub;
+    const bool headless = !boot_profile_path.empty() || !benchmark_path.empty();
+    if (headless) {
+        ConfigureHeadless();
+    }
     Settings::Apply();
 
-    std::unique_ptr<EmuWindow_SDL2> emu_window{std::make_unique<EmuWindow_SDL2>()};
+    std::unique_ptr<EmuWindow_SDL2> sdl_window;
+    std::unique_ptr<EmuWindow_Null> null_window;
+    EmuWindow* emu_window;
+    if (headless) {
+        null_window = std::make_unique<EmuWindow_Null>();
+        emu_window = null_window.get();
+    } else {
+        sdl_window = std::make_unique<EmuWindow_SDL2>();
+        emu_window = sdl_window.get();
+    }
 
     Core::System& system{Core::System::GetInstance()};
 
     SCOPE_EXIT({ system.Shutdown(); });
 
-    const Core::System::ResultStatus load_result{system.Load(emu_window.get(), filepath)};
+    const Core::System::ResultStatus load_result{system.Load(emu_window, filepath)};
 
     switch (load_result) {
     case Core::System::ResultStatus::ErrorGetLoader:
@@ -167,7 +298,14 @@ int main(int argc, char** argv) {
 
     Core::Telemetry().AddField(Telemetry::FieldType::App, "Frontend", "SDL");
 
-    while (emu_window->IsOpen()) {
+    if (!boot_profile_path.empty()) {
+        return ProfileBoot(system, boot_profile_path);
+    }
+    if (!benchmark_path.empty()) {
+        return RunBenchmark(system, benchmark_frames, benchmark_path, count_hardware_events);
+    }
+
+    while (sdl_window->IsOpen()) {
         system.RunLoop();
     }
 
@@ -83,15 +83,27 @@ void Config::ReadValues() {
 
     // Core
     Settings::values.use_cpu_jit = sdl2_config->GetBoolean("Core", "use_cpu_jit", true);
+    Settings::values.skip_idle_loops = sdl2_config->GetBoolean("Core", "skip_idle_loops", false);
+    Settings::values.snapshot_interval =
+        static_cast<u32>(sdl2_config->GetInteger("Core", "snapshot_interval", 0));
+    Settings::values.snapshot_budget =
+        static_cast<u32>(sdl2_config->GetInteger("Core", "snapshot_budget", 64));
 
     // Renderer
     Settings::values.use_hw_renderer = sdl2_config->GetBoolean("Renderer", "use_hw_renderer", true);
     Settings::values.use_shader_jit = sdl2_config->GetBoolean("Renderer", "use_shader_jit", true);
+    Settings::values.use_compiled_tev =
+        sdl2_config->GetBoolean("Renderer", "use_compiled_tev", true);
     Settings::values.resolution_factor =
         (float)sdl2_config->GetReal("Renderer", "resolution_factor", 1.0);
     Settings::values.use_vsync = sdl2_config->GetBoolean("Renderer", "use_vsync", false);
     Settings::values.toggle_framelimit =
         sdl2_config->GetBoolean("Renderer", "toggle_framelimit", true);
+    Settings::values.frame_pacing = static_cast<Settings::FramePacing>(
+        sdl2_config->GetInteger("Renderer", "frame_pacing", 1));
+    Settings::values.use_frame_skip = sdl2_config->GetBoolean("Renderer", "use_frame_skip", false);
+    Settings::values.frame_skip_threshold =
+        static_cast<u32>(sdl2_config->GetInteger("Renderer", "frame_skip_threshold", 95));
 
     Settings::values.bg_red = (float)sdl2_config->GetReal("Renderer", "bg_red", 0.0);
     Settings::values.bg_green = (float)sdl2_config->GetReal("Renderer", "bg_green", 0.0);
@@ -128,6 +140,14 @@ void Config::ReadValues() {
     // Data Storage
     Settings::values.use_virtual_sd =
         sdl2_config->GetBoolean("Data Storage", "use_virtual_sd", true);
+    Settings::values.code_cache_size =
+        static_cast<u32>(sdl2_config->GetInteger("Data Storage", "code_cache_size", 256));
+    Settings::values.file_cache_size =
+        static_cast<u32>(sdl2_config->GetInteger("Data Storage", "file_cache_size", 4));
+    Settings::values.file_cache_read_ahead =
+        static_cast<u32>(sdl2_config->GetInteger("Data Storage", "file_cache_read_ahead", 8));
+    Settings::values.file_cache_write_back =
+        sdl2_config->GetBoolean("Data Storage", "file_cache_write_back", false);
 
     // System
     Settings::values.is_new_3ds = sdl2_config->GetBoolean("System", "is_new_3ds", false);
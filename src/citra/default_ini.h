@@ -71,6 +71,18 @@ touch_device=
 # 0: Interpreter (slow), 1 (default): JIT (fast)
 use_cpu_jit =
 
+# Whether to skip ahead to the next event when the CPU spins in a loop that only reads memory
+# 0 (default): Run idle loops, 1: Skip idle loops
+skip_idle_loops =
+
+# Emulated milliseconds between two in-memory snapshots for rewinding
+# 0 (default): Disabled, 1000: One snapshot per emulated second
+snapshot_interval =
+
+# Memory used by the snapshots for rewinding, in MiB. The oldest snapshots are dropped beyond it.
+# Default: 64
+snapshot_budget =
+
 [Renderer]
 # Whether to use software or hardware rendering.
 # 0: Software, 1 (default): Hardware
@@ -80,6 +92,10 @@ use_hw_renderer =
 # 0: Interpreter (slow), 1 (default): JIT (fast)
 use_shader_jit =
 
+# Whether the software renderer translates the texture combiner configuration before drawing
+# 0: Evaluate the registers for every fragment (slow), 1 (default): Translate once per draw (fast)
+use_compiled_tev =
+
 # Resolution scale factor
 # 0: Auto (scales resolution to window size), 1: Native 3DS screen resolution, Otherwise a scale
 # factor for the 3DS resolution
@@ -119,6 +135,20 @@ custom_bottom_bottom =
 # 0: Off , 1  (default): On
 toggle_framelimit =
 
+# How the frame limiter waits until the next frame is due
+# 0: Sleep, 1 (default): Sleep, then spin for the last fraction of a millisecond (precise),
+# 2: Precise, and aligned to the refreshes of the display when V-Sync is enabled
+frame_pacing =
+
+# Whether to skip drawing some frames when the emulation can't run at full speed. Only the draws to
+# the buffers copied to the screen are skipped, the other render targets are always drawn.
+# 0 (default): Off, 1: On
+use_frame_skip =
+
+# Emulation speed, in percent, below which frames are skipped. Up to 3 frames out of 4 are skipped.
+# Default: 95
+frame_skip_threshold =
+
 # Swaps the prominent screen with the other screen.
 # For example, if Single Screen is chosen, setting this to 1 will display the bottom screen instead of the top screen.
 # 0 (default): Top Screen is prominent, 1: Bottom Screen is prominent
@@ -144,6 +174,23 @@ output_device =
 # 1 (default): Yes, 0: No
 use_virtual_sd =
 
+# Maximum size of the cache of decompressed executables, in MiB. The oldest entries are evicted
+# first. 0: Disable the cache, 256 (default)
+code_cache_size =
+
+# Size of the cache of each open save data or SD card file, in MiB.
+# 0: Disable the cache, 4 (default)
+file_cache_size =
+
+# Number of 16 KiB blocks fetched in the background ahead of sequential reads from cached files.
+# 0: Disable reading ahead, 8 (default)
+file_cache_read_ahead =
+
+# Whether data written to cached files is kept in the cache until the file is flushed or closed.
+# Keeping it is faster, but the data not written yet is lost if the emulator crashes.
+# 0 (default): Write it right away, 1: Keep it in the cache
+file_cache_write_back =
+
 [System]
 # The system model that Citra will try to emulate
 # 0: Old 3DS (default), 1: New 3DS
@@ -0,0 +1,12 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "citra/emu_window/emu_window_null.h"
+#include "core/3ds.h"
+
+EmuWindow_Null::EmuWindow_Null() {
+    // Lay the screens out as in the SDL window, though nothing is drawn
+    UpdateCurrentFramebufferLayout(Core::kScreenTopWidth,
+                                   Core::kScreenTopHeight + Core::kScreenBottomHeight);
+}
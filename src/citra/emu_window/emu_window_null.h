@@ -0,0 +1,25 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "core/frontend/emu_window.h"
+
+/// Window which doesn't exist, for running without a display along with the null renderer
+class EmuWindow_Null : public EmuWindow {
+public:
+    EmuWindow_Null();
+
+    /// Swap buffers to display the next frame
+    void SwapBuffers() override {}
+
+    /// Polls window events
+    void PollEvents() override {}
+
+    /// Makes the graphics context current for the caller thread
+    void MakeCurrent() override {}
+
+    /// Releases the GL context from the caller thread
+    void DoneCurrent() override {}
+};
@@ -68,14 +68,22 @@ void Config::ReadValues() {
 
     qt_config->beginGroup("Core");
     Settings::values.use_cpu_jit = qt_config->value("use_cpu_jit", true).toBool();
+    Settings::values.skip_idle_loops = qt_config->value("skip_idle_loops", false).toBool();
+    Settings::values.snapshot_interval = qt_config->value("snapshot_interval", 0).toUInt();
+    Settings::values.snapshot_budget = qt_config->value("snapshot_budget", 64).toUInt();
     qt_config->endGroup();
 
     qt_config->beginGroup("Renderer");
     Settings::values.use_hw_renderer = qt_config->value("use_hw_renderer", true).toBool();
     Settings::values.use_shader_jit = qt_config->value("use_shader_jit", true).toBool();
+    Settings::values.use_compiled_tev = qt_config->value("use_compiled_tev", true).toBool();
     Settings::values.resolution_factor = qt_config->value("resolution_factor", 1.0).toFloat();
     Settings::values.use_vsync = qt_config->value("use_vsync", false).toBool();
     Settings::values.toggle_framelimit = qt_config->value("toggle_framelimit", true).toBool();
+    Settings::values.frame_pacing =
+        static_cast<Settings::FramePacing>(qt_config->value("frame_pacing", 1).toInt());
+    Settings::values.use_frame_skip = qt_config->value("use_frame_skip", false).toBool();
+    Settings::values.frame_skip_threshold = qt_config->value("frame_skip_threshold", 95).toUInt();
 
     Settings::values.bg_red = qt_config->value("bg_red", 0.0).toFloat();
     Settings::values.bg_green = qt_config->value("bg_green", 0.0).toFloat();
@@ -123,6 +131,11 @@ void Config::ReadValues() {
 
     qt_config->beginGroup("Data Storage");
     Settings::values.use_virtual_sd = qt_config->value("use_virtual_sd", true).toBool();
+    Settings::values.code_cache_size = qt_config->value("code_cache_size", 256).toUInt();
+    Settings::values.file_cache_size = qt_config->value("file_cache_size", 4).toUInt();
+    Settings::values.file_cache_read_ahead = qt_config->value("file_cache_read_ahead", 8).toUInt();
+    Settings::values.file_cache_write_back =
+        qt_config->value("file_cache_write_back", false).toBool();
     qt_config->endGroup();
 
     qt_config->beginGroup("System");
@@ -231,14 +244,21 @@ void Config::SaveValues() {
 
     qt_config->beginGroup("Core");
     qt_config->setValue("use_cpu_jit", Settings::values.use_cpu_jit);
+    qt_config->setValue("skip_idle_loops", Settings::values.skip_idle_loops);
+    qt_config->setValue("snapshot_interval", Settings::values.snapshot_interval);
+    qt_config->setValue("snapshot_budget", Settings::values.snapshot_budget);
     qt_config->endGroup();
 
     qt_config->beginGroup("Renderer");
     qt_config->setValue("use_hw_renderer", Settings::values.use_hw_renderer);
     qt_config->setValue("use_shader_jit", Settings::values.use_shader_jit);
+    qt_config->setValue("use_compiled_tev", Settings::values.use_compiled_tev);
     qt_config->setValue("resolution_factor", (double)Settings::values.resolution_factor);
     qt_config->setValue("use_vsync", Settings::values.use_vsync);
     qt_config->setValue("toggle_framelimit", Settings::values.toggle_framelimit);
+    qt_config->setValue("frame_pacing", static_cast<int>(Settings::values.frame_pacing));
+    qt_config->setValue("use_frame_skip", Settings::values.use_frame_skip);
+    qt_config->setValue("frame_skip_threshold", Settings::values.frame_skip_threshold);
 
     // Cast to double because Qt's written float values are not human-readable
     qt_config->setValue("bg_red", (double)Settings::values.bg_red);
@@ -284,6 +304,10 @@ void Config::SaveValues() {
 
     qt_config->beginGroup("Data Storage");
     qt_config->setValue("use_virtual_sd", Settings::values.use_virtual_sd);
+    qt_config->setValue("code_cache_size", Settings::values.code_cache_size);
+    qt_config->setValue("file_cache_size", Settings::values.file_cache_size);
+    qt_config->setValue("file_cache_read_ahead", Settings::values.file_cache_read_ahead);
+    qt_config->setValue("file_cache_write_back", Settings::values.file_cache_write_back);
     qt_config->endGroup();
 
     qt_config->beginGroup("System");
@@ -397,6 +397,7 @@ WaitTreeWidget::WaitTreeWidget(QWidget* parent) : QDockWidget(tr("Wait Tree"), p
 void WaitTreeWidget::OnDebugModeEntered() {
     if (!Core::System::GetInstance().IsPoweredOn())
         return;
+    Kernel::SaveThreadContexts();
     model->InitItems();
     view->setModel(model);
     setEnabled(true);
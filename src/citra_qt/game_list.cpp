@@ -2,13 +2,21 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <cstring>
+#include <functional>
 #include <QApplication>
+#include <QDataStream>
+#include <QFile>
 #include <QFileInfo>
 #include <QHeaderView>
 #include <QKeyEvent>
 #include <QMenu>
+#include <QSaveFile>
+#include <QThread>
 #include <QThreadPool>
 #include "common/common_paths.h"
+#include "common/file_util.h"
 #include "common/logging/log.h"
 #include "common/string_util.h"
 #include "core/loader/loader.h"
@@ -253,6 +261,8 @@ void GameList::clearFilter() {
 }
 
 void GameList::AddEntry(const QList<QStandardItem*>& entry_items) {
+    if (first_entry_ms < 0)
+        first_entry_ms = populate_timer.elapsed();
     item_model->invisibleRootItem()->appendRow(entry_items);
 }
 
@@ -290,6 +300,9 @@ void GameList::DonePopulating(QStringList watch_list) {
     }
     tree_view->setEnabled(true);
     int rowCount = tree_view->model()->rowCount();
+    LOG_INFO(Frontend, "Game list populated with %d entries in %lld ms, the first after %lld ms",
+             rowCount, static_cast<long long>(populate_timer.elapsed()),
+             static_cast<long long>(first_entry_ms));
     search_field->setFilterResult(rowCount, rowCount);
     if (rowCount > 0) {
         search_field->setFocus();
@@ -327,6 +340,9 @@ void GameList::PopulateAsync(const QString& dir_path, bool deep_scan) {
 
     emit ShouldCancelWorker();
 
+    populate_timer.start();
+    first_entry_ms = -1;
+
     GameListWorker* worker = new GameListWorker(dir_path, deep_scan);
 
     connect(worker, &GameListWorker::EntryReady, this, &GameList::AddEntry, Qt::QueuedConnection);
@@ -372,6 +388,134 @@ void GameList::RefreshGameDirectory() {
     }
 }
 
+/// Version of the game list cache format, to be bumped whenever it changes
+constexpr quint32 GAME_LIST_CACHE_VERSION = 1;
+
+static QString GetGameListCachePath() {
+    return QString::fromStdString(FileUtil::GetUserPath(D_CACHE_IDX) + "game_list.bin");
+}
+
+static QDataStream& operator<<(QDataStream& stream, const GameListCacheEntry& entry) {
+    return stream << entry.size << entry.modification_time << entry.is_game << entry.program_id
+                  << entry.file_type << entry.title << entry.icon;
+}
+
+static QDataStream& operator>>(QDataStream& stream, GameListCacheEntry& entry) {
+    return stream >> entry.size >> entry.modification_time >> entry.is_game >> entry.program_id >>
+           entry.file_type >> entry.title >> entry.icon;
+}
+
+void GameListCache::Load() {
+    QFile file(GetGameListCachePath());
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+
+    QDataStream stream(&file);
+    quint32 version;
+    stream >> version;
+    if (version != GAME_LIST_CACHE_VERSION)
+        return;
+    stream >> saved_entries;
+    if (stream.status() != QDataStream::Ok) {
+        LOG_WARNING(Frontend, "The game list cache is damaged, all files will be read again");
+        saved_entries.clear();
+    }
+}
+
+void GameListCache::Save() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!changed && entries.size() == saved_entries.size())
+        return;
+
+    if (!FileUtil::CreateFullPath(FileUtil::GetUserPath(D_CACHE_IDX)))
+        return;
+    // Written to another file first, so that an interrupted write doesn't leave a truncated cache
+    QSaveFile file(GetGameListCachePath());
+    if (file.open(QIODevice::WriteOnly)) {
+        QDataStream stream(&file);
+        stream << GAME_LIST_CACHE_VERSION << entries;
+        if (stream.status() == QDataStream::Ok && file.commit())
+            return;
+    }
+    LOG_WARNING(Frontend, "Failed to save the game list cache");
+}
+
+bool GameListCache::Find(const QString& path, qint64 size, qint64 modification_time,
+                         GameListCacheEntry& entry) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = saved_entries.constFind(path);
+    if (it == saved_entries.constEnd() || it->size != size ||
+        it->modification_time != modification_time) {
+        return false;
+    }
+    entry = *it;
+    entries.insert(path, entry);
+    return true;
+}
+
+void GameListCache::Store(const QString& path, const GameListCacheEntry& entry) {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.insert(path, entry);
+    changed = true;
+}
+
+/// Work item of the loader pool, reading a single file
+class GameListEntryReader final : public QRunnable {
+public:
+    explicit GameListEntryReader(std::function<void()> read) : read(std::move(read)) {}
+
+    void run() override {
+        read();
+    }
+
+private:
+    std::function<void()> read;
+};
+
+void GameListWorker::ReadEntry(const std::string& physical_name, qint64 size,
+                               qint64 modification_time) {
+    GameListCacheEntry entry;
+    entry.size = size;
+    entry.modification_time = modification_time;
+
+    std::unique_ptr<Loader::AppLoader> loader = Loader::GetLoader(physical_name);
+    if (loader) {
+        entry.is_game = true;
+        entry.file_type = QString::fromStdString(Loader::GetFileTypeString(loader->GetFileType()));
+
+        u64 program_id = 0;
+        loader->ReadProgramId(program_id);
+        entry.program_id = program_id;
+
+        std::vector<u8> smdh_data;
+        loader->ReadIcon(smdh_data);
+        if (Loader::IsValidSMDH(smdh_data)) {
+            Loader::SMDH smdh;
+            std::memcpy(&smdh, smdh_data.data(), sizeof(Loader::SMDH));
+            std::vector<u16> icon = smdh.GetIcon(true);
+            entry.icon = QByteArray(reinterpret_cast<const char*>(icon.data()),
+                                    static_cast<int>(icon.size() * sizeof(u16)));
+            entry.title =
+                GetQStringShortTitleFromSMDH(smdh, Loader::SMDH::TitleLanguage::English);
+        }
+    }
+
+    const QString path = QString::fromStdString(physical_name);
+    cache.Store(path, entry);
+    ++num_read;
+    if (entry.is_game && !stop_processing)
+        EmitEntry(path, entry);
+}
+
+void GameListWorker::EmitEntry(const QString& path, const GameListCacheEntry& entry) {
+    emit EntryReady({
+        new GameListItemPath(path, GetQImageFromIconData(entry.icon), entry.title,
+                             entry.program_id),
+        new GameListItem(entry.file_type),
+        new GameListItemSize(entry.size),
+    });
+}
+
 void GameListWorker::AddFstEntriesToGameList(const std::string& dir_path, unsigned int recursion) {
     const auto callback = [this, recursion](unsigned* num_entries_out, const std::string& directory,
                                             const std::string& virtual_name) -> bool {
@@ -382,22 +526,26 @@ void GameListWorker::AddFstEntriesToGameList(const std::string& dir_path, unsign
 
         bool is_dir = FileUtil::IsDirectory(physical_name);
         if (!is_dir && HasSupportedFileExtension(physical_name)) {
-            std::unique_ptr<Loader::AppLoader> loader = Loader::GetLoader(physical_name);
-            if (!loader)
+            u64 size;
+            s64 modification_time;
+            if (!FileUtil::GetSizeAndModificationTime(physical_name, size, modification_time))
                 return true;
 
-            std::vector<u8> smdh;
-            loader->ReadIcon(smdh);
-
-            u64 program_id = 0;
-            loader->ReadProgramId(program_id);
-
-            emit EntryReady({
-                new GameListItemPath(QString::fromStdString(physical_name), smdh, program_id),
-                new GameListItem(
-                    QString::fromStdString(Loader::GetFileTypeString(loader->GetFileType()))),
-                new GameListItemSize(FileUtil::GetSize(physical_name)),
-            });
+            // Files unchanged since the previous scan are listed right away, the others are read
+            // by the loader pool while the directory is still being traversed
+            GameListCacheEntry entry;
+            const QString path = QString::fromStdString(physical_name);
+            if (cache.Find(path, size, modification_time, entry)) {
+                ++num_cached;
+                if (entry.is_game)
+                    EmitEntry(path, entry);
+                return true;
+            }
+            loader_pool.start(new GameListEntryReader([this, physical_name, size,
+                                                       modification_time] {
+                if (!stop_processing)
+                    ReadEntry(physical_name, size, modification_time);
+            }));
         } else if (is_dir && recursion > 0) {
             watch_list.append(QString::fromStdString(physical_name));
             AddFstEntriesToGameList(physical_name, recursion - 1);
@@ -411,8 +559,20 @@ void GameListWorker::AddFstEntriesToGameList(const std::string& dir_path, unsign
 
 void GameListWorker::run() {
     stop_processing = false;
+    // Reading files mostly waits on the storage, which may be over the network, so use more
+    // threads than cores
+    loader_pool.setMaxThreadCount(std::max(QThread::idealThreadCount(), 2) * 2);
+    cache.Load();
+
     watch_list.append(dir_path);
     AddFstEntriesToGameList(dir_path.toStdString(), deep_scan ? 256 : 0);
+    loader_pool.waitForDone();
+    if (stop_processing)
+        return;
+
+    LOG_INFO(Frontend, "Game list scan: %d files from the cache, %d read", num_cached.load(),
+             num_read.load());
+    cache.Save();
     emit Finished(watch_list);
 }
 
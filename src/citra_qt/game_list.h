@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <QElapsedTimer>
 #include <QFileSystemWatcher>
 #include <QHBoxLayout>
 #include <QLabel>
@@ -98,4 +99,9 @@ private:
     QStandardItemModel* item_model = nullptr;
     GameListWorker* current_worker = nullptr;
     QFileSystemWatcher* watcher = nullptr;
+
+    /// Time since the game list started being populated
+    QElapsedTimer populate_timer;
+    /// Time it took to add the first entry to the game list, in milliseconds, -1 if none was added
+    qint64 first_entry_ms = -1;
 };
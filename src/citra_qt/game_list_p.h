@@ -5,36 +5,41 @@
 #pragma once
 
 #include <atomic>
+#include <mutex>
+#include <QByteArray>
+#include <QHash>
 #include <QImage>
 #include <QRunnable>
 #include <QStandardItem>
 #include <QString>
+#include <QThreadPool>
 #include "citra_qt/util/util.h"
 #include "common/string_util.h"
 #include "core/loader/smdh.h"
 
+/// Size of the large icon of SMDH data, in RGB565 pixels
+constexpr int LARGE_ICON_SIZE = 48;
+
 /**
- * Gets the game icon from SMDH data.
- * @param smdh SMDH data
- * @param large If true, returns large icon (48x48), otherwise returns small icon (24x24)
- * @return QPixmap game icon
+ * Gets the large game icon from the pixels kept in the game list cache.
+ * @param icon_data Pixels of the icon, in RGB565
+ * @return QImage game icon, or a null image if there is no icon
  */
-static QPixmap GetQPixmapFromSMDH(const Loader::SMDH& smdh, bool large) {
-    std::vector<u16> icon_data = smdh.GetIcon(large);
-    const uchar* data = reinterpret_cast<const uchar*>(icon_data.data());
-    int size = large ? 48 : 24;
-    QImage icon(data, size, size, QImage::Format::Format_RGB16);
-    return QPixmap::fromImage(icon);
+static QImage GetQImageFromIconData(const QByteArray& icon_data) {
+    if (icon_data.size() != LARGE_ICON_SIZE * LARGE_ICON_SIZE * 2)
+        return QImage();
+    const uchar* data = reinterpret_cast<const uchar*>(icon_data.constData());
+    return QImage(data, LARGE_ICON_SIZE, LARGE_ICON_SIZE, QImage::Format::Format_RGB16).copy();
 }
 
 /**
  * Gets the default icon (for games without valid SMDH)
  * @param large If true, returns large icon (48x48), otherwise returns small icon (24x24)
- * @return QPixmap default icon
+ * @return QImage default icon
  */
-static QPixmap GetDefaultIcon(bool large) {
+static QImage GetDefaultIcon(bool large) {
     int size = large ? 48 : 24;
-    QPixmap icon(size, size);
+    QImage icon(size, size, QImage::Format::Format_ARGB32);
     icon.fill(Qt::transparent);
     return icon;
 }
@@ -72,26 +77,22 @@ public:
     static const int ProgramIdRole = Qt::UserRole + 3;
 
     GameListItemPath() : GameListItem() {}
-    GameListItemPath(const QString& game_path, const std::vector<u8>& smdh_data, u64 program_id)
+    /**
+     * @param icon Large icon of the game, or a null image for a game without valid SMDH
+     * @param title Short title of the game, or an empty string for a game without valid SMDH
+     */
+    GameListItemPath(const QString& game_path, const QImage& icon, const QString& title,
+                     u64 program_id)
         : GameListItem() {
         setData(game_path, FullPathRole);
         setData(qulonglong(program_id), ProgramIdRole);
 
-        if (!Loader::IsValidSMDH(smdh_data)) {
-            // SMDH is not valid, set a default icon
-            setData(GetDefaultIcon(true), Qt::DecorationRole);
-            return;
-        }
+        // Icons are set as QImages rather than QPixmaps, as the items are made outside of the GUI
+        // thread
+        setData(icon.isNull() ? GetDefaultIcon(true) : icon, Qt::DecorationRole);
 
-        Loader::SMDH smdh;
-        memcpy(&smdh, smdh_data.data(), sizeof(Loader::SMDH));
-
-        // Get icon from SMDH
-        setData(GetQPixmapFromSMDH(smdh, true), Qt::DecorationRole);
-
-        // Get title form SMDH
-        setData(GetQStringShortTitleFromSMDH(smdh, Loader::SMDH::TitleLanguage::English),
-                TitleRole);
+        if (!title.isEmpty())
+            setData(title, TitleRole);
     }
 
     QVariant data(int role) const override {
@@ -144,6 +145,51 @@ public:
     }
 };
 
+/// Metadata of a game file, as read by its loader
+struct GameListCacheEntry {
+    qint64 size = 0;
+    qint64 modification_time = 0;
+    /// Whether a loader recognized the file. Other files are kept so that they aren't read again.
+    bool is_game = false;
+    quint64 program_id = 0;
+    QString file_type;
+    /// Short title from the SMDH, empty if there is no valid SMDH
+    QString title;
+    /// Large icon from the SMDH in RGB565, empty if there is no valid SMDH
+    QByteArray icon;
+};
+
+/**
+ * Metadata of the game files found by the previous scans, saved in the cache folder and keyed by
+ * path, so that a rescan only opens the files whose size or modification time changed.
+ */
+class GameListCache {
+public:
+    /// Loads the entries saved by the previous scan, if any
+    void Load();
+
+    /// Saves the entries of the files found since Load, if they differ from the ones loaded
+    void Save();
+
+    /**
+     * Looks up a file unchanged since the previous scan. Thread-safe.
+     * @returns whether the file was found, in which case `entry` is set
+     */
+    bool Find(const QString& path, qint64 size, qint64 modification_time,
+              GameListCacheEntry& entry);
+
+    /// Stores the metadata of a file read during this scan. Thread-safe.
+    void Store(const QString& path, const GameListCacheEntry& entry);
+
+private:
+    std::mutex mutex;
+    /// Entries loaded from the previous scan
+    QHash<QString, GameListCacheEntry> saved_entries;
+    /// Entries of the files found during this scan
+    QHash<QString, GameListCacheEntry> entries;
+    bool changed = false;
+};
+
 /**
  * Asynchronous worker object for populating the game list.
  * Communicates with other threads through Qt's signal/slot system.
@@ -181,5 +227,17 @@ private:
     bool deep_scan;
     std::atomic_bool stop_processing;
 
+    GameListCache cache;
+    /// Threads reading the files that aren't in the cache, one work item per file
+    QThreadPool loader_pool;
+    std::atomic<int> num_cached{0};
+    std::atomic<int> num_read{0};
+
     void AddFstEntriesToGameList(const std::string& dir_path, unsigned int recursion = 0);
+
+    /// Reads the metadata of a game file with its loader, and adds it to the game list
+    void ReadEntry(const std::string& physical_name, qint64 size, qint64 modification_time);
+
+    /// Emits the items of a game file for the game list
+    void EmitEntry(const QString& path, const GameListCacheEntry& entry);
 };
@@ -258,6 +258,7 @@ void GMainWindow::InitializeHotkeys() {
     RegisterHotkey("Main Window", "Fullscreen", QKeySequence::FullScreen);
     RegisterHotkey("Main Window", "Exit Fullscreen", QKeySequence(Qt::Key_Escape),
                    Qt::ApplicationShortcut);
+    RegisterHotkey("Main Window", "Rewind", QKeySequence(Qt::Key_Backspace));
     LoadHotkeys();
 
     connect(GetHotkey("Main Window", "Load File", this), SIGNAL(activated()), this,
@@ -276,6 +277,12 @@ void GMainWindow::InitializeHotkeys() {
             ToggleFullscreen();
         }
     });
+    // The snapshot is restored by the emulation thread, once it runs
+    connect(GetHotkey("Main Window", "Rewind", render_window), &QShortcut::activated, this, [&] {
+        if (emulation_running) {
+            Core::System::GetInstance().RequestRewind();
+        }
+    });
 }
 
 void GMainWindow::ShowUpdaterWidgets() {
@@ -827,7 +834,15 @@ void GMainWindow::UpdateStatusBar() {
 
     auto results = Core::System::GetInstance().GetAndResetPerfStats();
 
-    emu_speed_label->setText(tr("Speed: %1%").arg(results.emulation_speed * 100.0, 0, 'f', 0));
+    if (results.skipped_frames == 0) {
+        emu_speed_label->setText(
+            tr("Speed: %1%").arg(results.emulation_speed * 100.0, 0, 'f', 0));
+    } else {
+        emu_speed_label->setText(tr("Speed: %1% (+%2% skipping %3 frames)")
+                                     .arg(results.emulation_speed * 100.0, 0, 'f', 0)
+                                     .arg(results.frame_skip_speed_gain * 100.0, 0, 'f', 0)
+                                     .arg(results.skipped_frames));
+    }
     game_fps_label->setText(tr("Game: %1 FPS").arg(results.game_fps, 0, 'f', 0));
     emu_frametime_label->setText(tr("Frame: %1 ms").arg(results.frametime * 1000.0, 0, 'f', 2));
 
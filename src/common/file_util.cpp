@@ -36,6 +36,7 @@
 #include <cstring>
 #include <dirent.h>
 #include <pwd.h>
+#include <sys/mman.h>
 #include <unistd.h>
 #endif
 
@@ -57,6 +58,7 @@
 #endif
 
 #include <algorithm>
+#include <limits>
 #include <sys/stat.h>
 
 #ifndef S_ISDIR
@@ -358,6 +360,23 @@ u64 GetSize(const std::string& filename) {
     return 0;
 }
 
+bool GetSizeAndModificationTime(const std::string& filename, u64& size, s64& modification_time) {
+    std::string copy(filename);
+    StripTailDirSlashes(copy);
+
+    struct stat buf;
+#ifdef _WIN32
+    if (_wstat64(Common::UTF8ToUTF16W(copy).c_str(), &buf) != 0)
+#else
+    if (stat(copy.c_str(), &buf) != 0)
+#endif
+        return false;
+
+    size = buf.st_size;
+    modification_time = buf.st_mtime;
+    return true;
+}
+
 // Overloaded GetSize, accepts file descriptor
 u64 GetSize(const int fd) {
     struct stat buf;
@@ -568,6 +587,26 @@ std::string GetCurrentDir() {
     return strDir;
 }
 
+std::string GetTempDir() {
+#ifdef _WIN32
+    wchar_t dir[MAX_PATH + 1];
+    DWORD length = GetTempPathW(MAX_PATH + 1, dir);
+    if (length == 0) {
+        LOG_ERROR(Common_Filesystem, "GetTempPath failed: %s", GetLastErrorMsg());
+        return GetCurrentDir();
+    }
+    // The path ends with a backslash
+    while (length > 1 && dir[length - 1] == L'\\')
+        --length;
+    return Common::UTF16ToUTF8(std::wstring(dir, length));
+#else
+    const char* tmpdir = getenv("TMPDIR");
+    std::string temp_dir = tmpdir != nullptr && tmpdir[0] != '\0' ? tmpdir : "/tmp";
+    StripTailDirSlashes(temp_dir);
+    return temp_dir;
+#endif
+}
+
 // Sets the current directory to the given directory
 bool SetCurrentDir(const std::string& directory) {
 #ifdef _WIN32
@@ -747,6 +786,28 @@ size_t WriteStringToFile(bool text_file, const std::string& str, const char* fil
     return FileUtil::IOFile(filename, text_file ? "w" : "wb").WriteBytes(str.data(), str.size());
 }
 
+bool WriteFileAtomically(const std::string& filename, const void* data, size_t size) {
+    const std::string temp_filename = filename + ".tmp";
+    if (!CreateFullPath(temp_filename))
+        return false;
+
+    bool written;
+    {
+        IOFile file(temp_filename, "wb");
+        written = file.WriteBytes(data, size) == size && file.Flush();
+    }
+#ifdef _WIN32
+    // rename doesn't replace an existing file on Windows
+    if (written && Exists(filename))
+        Delete(filename);
+#endif
+    if (!written || !Rename(temp_filename, filename)) {
+        Delete(temp_filename);
+        return false;
+    }
+    return true;
+}
+
 size_t ReadFileToString(bool text_file, const char* filename, std::string& str) {
     IOFile file(filename, text_file ? "r" : "rb");
 
@@ -889,4 +950,77 @@ bool IOFile::Resize(u64 size) {
     return m_good;
 }
 
+FileMapping::FileMapping(const IOFile& file, u64 offset, u64 size) {
+    if (!file.IsOpen() || size == 0 || offset + size > file.GetSize())
+        return;
+
+#ifdef _WIN32
+    SYSTEM_INFO system_info;
+    GetSystemInfo(&system_info);
+    const u64 view_offset = offset - offset % system_info.dwAllocationGranularity;
+#else
+    const u64 view_offset = offset - offset % static_cast<u64>(sysconf(_SC_PAGESIZE));
+#endif
+    const u64 total_size = offset - view_offset + size;
+    if (total_size > std::numeric_limits<size_t>::max())
+        return;
+
+#ifdef _WIN32
+    HANDLE file_handle = reinterpret_cast<HANDLE>(_get_osfhandle(_fileno(file.m_file)));
+    mapping_handle = CreateFileMappingW(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping_handle == nullptr) {
+        LOG_ERROR(Common_Filesystem, "CreateFileMapping failed: %s", GetLastErrorMsg());
+        return;
+    }
+
+    view = MapViewOfFile(mapping_handle, FILE_MAP_READ, static_cast<DWORD>(view_offset >> 32),
+                         static_cast<DWORD>(view_offset), static_cast<size_t>(total_size));
+    if (view == nullptr) {
+        LOG_ERROR(Common_Filesystem, "MapViewOfFile failed: %s", GetLastErrorMsg());
+        CloseHandle(mapping_handle);
+        mapping_handle = nullptr;
+        return;
+    }
+#else
+    view = mmap(nullptr, static_cast<size_t>(total_size), PROT_READ, MAP_PRIVATE,
+                fileno(file.m_file), static_cast<off_t>(view_offset));
+    if (view == MAP_FAILED) {
+        LOG_ERROR(Common_Filesystem, "mmap failed: %s", GetLastErrorMsg());
+        view = nullptr;
+        return;
+    }
+#endif
+
+    view_size = static_cast<size_t>(total_size);
+    data = static_cast<const u8*>(view) + (offset - view_offset);
+    this->size = size;
+}
+
+FileMapping::~FileMapping() {
+    if (view == nullptr)
+        return;
+
+#ifdef _WIN32
+    UnmapViewOfFile(view);
+    CloseHandle(mapping_handle);
+#else
+    munmap(view, view_size);
+#endif
+}
+
+void FileMapping::AdviseWillNeed(u64 offset, u64 length) const {
+#ifndef _WIN32
+    if (offset >= size)
+        return;
+    length = std::min(length, size - offset);
+
+    // madvise needs a page-aligned address
+    const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const uintptr_t start = reinterpret_cast<uintptr_t>(data + offset);
+    const uintptr_t aligned_start = start - start % page_size;
+    madvise(reinterpret_cast<void*>(aligned_start),
+            static_cast<size_t>(start - aligned_start + length), MADV_WILLNEED);
+#endif
+}
+
 } // namespace
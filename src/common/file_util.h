@@ -55,6 +55,10 @@ u64 GetSize(const int fd);
 // Overloaded GetSize, accepts FILE*
 u64 GetSize(FILE* f);
 
+// Gets the size and the last modification time (in seconds since the epoch) of a file or
+// directory with a single stat. Returns false, without logging an error, if it doesn't exist.
+bool GetSizeAndModificationTime(const std::string& filename, u64& size, s64& modification_time);
+
 // Returns true if successful, or path already exists.
 bool CreateDir(const std::string& filename);
 
@@ -115,6 +119,9 @@ bool DeleteDirRecursively(const std::string& directory, unsigned int recursion =
 // Returns the current directory
 std::string GetCurrentDir();
 
+// Returns the directory of the host for temporary files, without a trailing separator
+std::string GetTempDir();
+
 // Create directory and copy contents (does not overwrite existing files)
 void CopyDir(const std::string& source_path, const std::string& dest_path);
 
@@ -138,6 +145,13 @@ std::string AppDataRoamingDirectory();
 #endif
 
 size_t WriteStringToFile(bool text_file, const std::string& str, const char* filename);
+
+/**
+ * Writes a file under a temporary name, then renames it into place, so that an interrupted write
+ * never leaves a truncated file behind. Creates the parent directories if needed.
+ * @return True on success, false otherwise, in which case filename is left unchanged
+ */
+bool WriteFileAtomically(const std::string& filename, const void* data, size_t size);
 size_t ReadFileToString(bool text_file, const char* filename, std::string& str);
 
 /**
@@ -249,10 +263,58 @@ public:
     }
 
 private:
+    friend class FileMapping;
+
     std::FILE* m_file = nullptr;
     bool m_good = true;
 };
 
+/**
+ * Read-only memory mapping of a region of a file. Reading from the mapping is a memory copy instead
+ * of a seek and a read system call, and doesn't depend on the current position of the file, so
+ * several readers can share it.
+ */
+class FileMapping : public NonCopyable {
+public:
+    /**
+     * Maps a region of an open file. IsGood() returns false if the region couldn't be mapped, e.g.
+     * because it extends past the end of the file.
+     * @param file File to map, which can be closed afterwards
+     * @param offset Offset of the region in the file
+     * @param size Size of the region
+     */
+    FileMapping(const IOFile& file, u64 offset, u64 size);
+    ~FileMapping();
+
+    bool IsGood() const {
+        return data != nullptr;
+    }
+
+    /// Returns a pointer to the start of the mapped region
+    const u8* GetData() const {
+        return data;
+    }
+
+    u64 GetSize() const {
+        return size;
+    }
+
+    /**
+     * Hints that a range of the mapping is going to be read soon, so that it can be read from the
+     * disk ahead of time. Does nothing on platforms which don't support it.
+     */
+    void AdviseWillNeed(u64 offset, u64 length) const;
+
+private:
+    void* view = nullptr;
+    size_t view_size = 0;
+#ifdef _WIN32
+    void* mapping_handle = nullptr;
+#endif
+    const u8* data = nullptr;
+    u64 size = 0;
+};
+
 } // namespace
 
 // To deal with Windows being dumb at unicode:
@@ -4,13 +4,23 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 #include "common/assert.h"
 #include "common/common_funcs.h" // snprintf compatibility define
 #include "common/logging/backend.h"
 #include "common/logging/filter.h"
 #include "common/logging/log.h"
 #include "common/logging/text_formatter.h"
+#include "common/ring_buffer.h"
 
 namespace Log {
 
@@ -110,23 +120,32 @@ const char* GetLevelName(Level log_level) {
 #undef LVL
 }
 
-Entry CreateEntry(Class log_class, Level log_level, const char* filename, unsigned int line_nr,
-                  const char* function, const char* format, va_list args) {
+/// Returns the time elapsed since the first message was logged
+static std::chrono::microseconds GetTimestamp() {
     using std::chrono::steady_clock;
     using std::chrono::duration_cast;
 
     static steady_clock::time_point time_origin = steady_clock::now();
+    return duration_cast<std::chrono::microseconds>(steady_clock::now() - time_origin);
+}
+
+static std::string FormatLocation(const char* filename, unsigned int line_nr,
+                                  const char* function) {
+    std::array<char, 1024> formatting_buffer;
+    snprintf(formatting_buffer.data(), formatting_buffer.size(), "%s:%s:%u", filename, function,
+             line_nr);
+    return formatting_buffer.data();
+}
 
+Entry CreateEntry(Class log_class, Level log_level, const char* filename, unsigned int line_nr,
+                  const char* function, const char* format, va_list args) {
     std::array<char, 4 * 1024> formatting_buffer;
 
     Entry entry;
-    entry.timestamp = duration_cast<std::chrono::microseconds>(steady_clock::now() - time_origin);
+    entry.timestamp = GetTimestamp();
     entry.log_class = log_class;
     entry.log_level = log_level;
-
-    snprintf(formatting_buffer.data(), formatting_buffer.size(), "%s:%s:%u", filename, function,
-             line_nr);
-    entry.location = std::string(formatting_buffer.data());
+    entry.location = FormatLocation(filename, line_nr, function);
 
     vsnprintf(formatting_buffer.data(), formatting_buffer.size(), format, args);
     entry.message = std::string(formatting_buffer.data());
@@ -134,12 +153,242 @@ Entry CreateEntry(Class log_class, Level log_level, const char* filename, unsign
     return entry;
 }
 
+void ConsoleSink::Write(const Entry& entry) {
+    PrintColoredMessage(entry);
+}
+
+FileSink::FileSink(const std::string& filename) : file(filename, "w") {}
+
+void FileSink::Write(const Entry& entry) {
+    if (!file.IsOpen())
+        return;
+
+    std::array<char, 4 * 1024> format_buffer;
+    FormatLogMessage(entry, format_buffer.data(), format_buffer.size());
+    file.WriteBytes(format_buffer.data(), std::strlen(format_buffer.data()));
+    file.WriteBytes("\n", 1);
+    if (entry.log_level >= Level::Error) {
+        file.Flush();
+    }
+}
+
+/// Set once the backend has shut down, after which messages are printed right away
+static std::atomic<bool> backend_destroyed{false};
+
+namespace {
+
+/**
+ * A log message as queued by the emulation threads. Only the message text is formatted on the
+ * calling thread; file and function names are string literals and are kept as pointers.
+ */
+struct Record {
+    std::chrono::microseconds timestamp;
+    Class log_class;
+    Level log_level;
+    unsigned int line_nr;
+    const char* filename;
+    const char* function;
+    /// Longer messages are truncated. This size keeps records at 1 KiB.
+    std::array<char, 992> message;
+};
+
+/**
+ * Writes log messages to the sinks on a dedicated thread, so that logging only costs the threads
+ * that produce messages the formatting of the message itself. Messages are passed through a
+ * lock-free queue, which drops messages instead of blocking when it is full. Critical messages are
+ * never dropped: when the queue is full, they are written by the calling thread instead.
+ */
+class AsyncBackend {
+public:
+    AsyncBackend() {
+        sinks.push_back(std::make_unique<ConsoleSink>());
+        thread = std::thread([this] { Run(); });
+    }
+
+    ~AsyncBackend() {
+        backend_destroyed = true;
+        running = false;
+        wake_condition.notify_one();
+        thread.join();
+    }
+
+    void Push(Class log_class, Level log_level, const char* filename, unsigned int line_nr,
+              const char* function, const char* format, va_list args) {
+        const bool pushed = queue->TryPush([&](Record& record) {
+            record.timestamp = GetTimestamp();
+            record.log_class = log_class;
+            record.log_level = log_level;
+            record.line_nr = line_nr;
+            record.filename = filename;
+            record.function = function;
+            vsnprintf(record.message.data(), record.message.size(), format, args);
+        });
+
+        if (!pushed) {
+            if (log_level == Level::Critical) {
+                // fill wasn't called, so args is still unread
+                WriteSynchronously(
+                    CreateEntry(log_class, log_level, filename, line_nr, function, format, args));
+                return;
+            }
+            dropped_count.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        pushed_count.fetch_add(1, std::memory_order_release);
+        if (consumer_sleeping.load(std::memory_order_relaxed)) {
+            wake_condition.notify_one();
+        }
+    }
+
+    void AddSink(std::unique_ptr<Sink> sink) {
+        std::lock_guard<std::mutex> lock(sinks_mutex);
+        sinks.push_back(std::move(sink));
+    }
+
+    void Flush() {
+        // Messages logged by the sinks can't wait for the logging thread
+        if (std::this_thread::get_id() == thread.get_id())
+            return;
+
+        const u64 target = pushed_count.load(std::memory_order_acquire);
+        wake_condition.notify_one();
+
+        std::unique_lock<std::mutex> lock(flush_mutex);
+        flush_condition.wait(lock, [&] { return written_count >= target; });
+    }
+
+    u64 GetDroppedCount() const {
+        return dropped_count.load(std::memory_order_relaxed);
+    }
+
+private:
+    /**
+     * Writes a message that couldn't be queued straight to the sinks, once the messages queued
+     * before it have been written.
+     */
+    void WriteSynchronously(const Entry& entry) {
+        // The logging thread already holds sinks_mutex while it writes the queued messages
+        if (std::this_thread::get_id() == thread.get_id()) {
+            WriteToSinks(entry);
+            return;
+        }
+
+        Flush();
+        std::lock_guard<std::mutex> lock(sinks_mutex);
+        WriteToSinks(entry);
+    }
+
+    void Run() {
+        u64 reported_dropped_count = 0;
+        bool exiting = false;
+        while (!exiting) {
+            // Check before draining the queue, so that no message pushed before exiting is lost
+            exiting = !running;
+
+            u64 written = 0;
+            {
+                std::lock_guard<std::mutex> lock(sinks_mutex);
+                while (queue->TryPop([&](const Record& record) { Write(record); })) {
+                    ++written;
+                }
+
+                const u64 dropped = dropped_count.load(std::memory_order_relaxed);
+                if (dropped != reported_dropped_count) {
+                    Entry entry;
+                    entry.timestamp = GetTimestamp();
+                    entry.log_class = Class::Log;
+                    entry.log_level = Level::Warning;
+                    entry.location = FormatLocation(__FILE__, __LINE__, __func__);
+                    entry.message = std::to_string(dropped - reported_dropped_count) +
+                                    " log messages were dropped because the queue was full";
+                    WriteToSinks(entry);
+                    reported_dropped_count = dropped;
+                }
+            }
+
+            if (written != 0) {
+                std::lock_guard<std::mutex> lock(flush_mutex);
+                written_count += written;
+            }
+            flush_condition.notify_all();
+
+            if (exiting)
+                break;
+
+            // Producers only wake the thread up if it announced that it's going to sleep, so a
+            // message might be missed right before sleeping. The timeout bounds its latency.
+            std::unique_lock<std::mutex> lock(wake_mutex);
+            consumer_sleeping.store(true, std::memory_order_relaxed);
+            if (queue->IsEmpty() && running) {
+                wake_condition.wait_for(lock, std::chrono::milliseconds(10));
+            }
+            consumer_sleeping.store(false, std::memory_order_relaxed);
+        }
+    }
+
+    void Write(const Record& record) {
+        Entry entry;
+        entry.timestamp = record.timestamp;
+        entry.log_class = record.log_class;
+        entry.log_level = record.log_level;
+        entry.location = FormatLocation(record.filename, record.line_nr, record.function);
+        entry.message = record.message.data();
+        WriteToSinks(entry);
+    }
+
+    void WriteToSinks(const Entry& entry) {
+        for (const auto& sink : sinks) {
+            sink->Write(entry);
+        }
+    }
+
+    std::unique_ptr<Common::RingBuffer<Record, 2048>> queue =
+        std::make_unique<Common::RingBuffer<Record, 2048>>();
+    std::atomic<u64> pushed_count{0};
+    std::atomic<u64> dropped_count{0};
+
+    std::mutex sinks_mutex;
+    std::vector<std::unique_ptr<Sink>> sinks;
+
+    std::atomic<bool> running{true};
+    std::atomic<bool> consumer_sleeping{false};
+    std::mutex wake_mutex;
+    std::condition_variable wake_condition;
+
+    /// Number of messages written to the sinks, protected by flush_mutex
+    u64 written_count = 0;
+    std::mutex flush_mutex;
+    std::condition_variable flush_condition;
+
+    std::thread thread;
+};
+
+AsyncBackend& GetBackend() {
+    static AsyncBackend backend;
+    return backend;
+}
+
+} // Anonymous namespace
+
 static Filter* filter = nullptr;
 
 void SetFilter(Filter* new_filter) {
     filter = new_filter;
 }
 
+void AddSink(std::unique_ptr<Sink> sink) {
+    GetBackend().AddSink(std::move(sink));
+}
+
+void Flush() {
+    GetBackend().Flush();
+}
+
+u64 GetDroppedMessageCount() {
+    return GetBackend().GetDroppedCount();
+}
+
 void LogMessage(Class log_class, Level log_level, const char* filename, unsigned int line_nr,
                 const char* function, const char* format, ...) {
     if (filter != nullptr && !filter->CheckMessage(log_class, log_level))
@@ -147,9 +396,20 @@ void LogMessage(Class log_class, Level log_level, const char* filename, unsigned
 
     va_list args;
     va_start(args, format);
-    Entry entry = CreateEntry(log_class, log_level, filename, line_nr, function, format, args);
+    if (backend_destroyed) {
+        // Messages logged by static destructors that run after the logging thread has exited
+        Entry entry = CreateEntry(log_class, log_level, filename, line_nr, function, format, args);
+        va_end(args);
+        PrintColoredMessage(entry);
+        return;
+    }
+
+    AsyncBackend& backend = GetBackend();
+    backend.Push(log_class, log_level, filename, line_nr, function, format, args);
     va_end(args);
 
-    PrintColoredMessage(entry);
+    if (log_level == Level::Critical) {
+        backend.Flush();
+    }
 }
 }
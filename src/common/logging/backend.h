@@ -6,8 +6,11 @@
 
 #include <chrono>
 #include <cstdarg>
+#include <memory>
 #include <string>
 #include <utility>
+#include "common/common_types.h"
+#include "common/file_util.h"
 #include "common/logging/log.h"
 
 namespace Log {
@@ -47,4 +50,45 @@ Entry CreateEntry(Class log_class, Level log_level, const char* filename, unsign
                   const char* function, const char* format, va_list args);
 
 void SetFilter(Filter* filter);
+
+/**
+ * Interface for the destinations of log entries. Entries are written by the logging thread, so
+ * sinks don't need to be thread-safe, but must not log messages themselves.
+ */
+class Sink {
+public:
+    virtual ~Sink() = default;
+    virtual void Write(const Entry& entry) = 0;
+};
+
+/// Prints log entries to stderr, colored according to their severity level.
+class ConsoleSink : public Sink {
+public:
+    void Write(const Entry& entry) override;
+};
+
+/// Writes log entries to a text file.
+class FileSink : public Sink {
+public:
+    explicit FileSink(const std::string& filename);
+    void Write(const Entry& entry) override;
+
+private:
+    FileUtil::IOFile file;
+};
+
+/**
+ * Adds a destination for log messages. Messages are printed to the console by default, further
+ * sinks receive all messages logged after they were added.
+ */
+void AddSink(std::unique_ptr<Sink> sink);
+
+/**
+ * Blocks until all messages logged so far have been written to the sinks. Messages of the Critical
+ * level are flushed right away, as they usually precede a crash.
+ */
+void Flush();
+
+/// Returns the number of messages that were discarded because the message queue was full.
+u64 GetDroppedMessageCount();
 }
@@ -0,0 +1,260 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <atomic>
+#include <memory>
+#include "common/logging/log.h"
+#include "common/perf_counters.h"
+
+#ifdef __linux__
+#include <cerrno>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace Common {
+namespace PerfCounters {
+
+#ifdef __linux__
+
+#ifdef ARCHITECTURE_x86_64
+static u64 ReadPmc(u32 counter) {
+    u32 low, high;
+    __asm__ __volatile__("rdpmc" : "=a"(low), "=d"(high) : "c"(counter));
+    return (static_cast<u64>(high) << 32) | low;
+}
+#endif
+
+/// Counters opened by a thread, read all at once as a group
+struct ThreadCounters {
+    /// File descriptor of each event, -1 if it couldn't be opened
+    std::array<int, NumEvents> fds;
+    /// Page the kernel shares for each event, which lets it be read with rdpmc, or nullptr
+    std::array<const volatile perf_event_mmap_page*, NumEvents> pages{};
+    /// Position of each event in the values read from the group
+    std::array<size_t, NumEvents> positions{};
+    size_t num_counted = 0;
+
+    /// Number of nested entries in each scope
+    std::array<u32, NumScopes> depths{};
+    /// Values of the counters when each scope was entered
+    std::array<std::array<u64, NumEvents>, NumScopes> entry_values{};
+    /// Whether the counters could be read when each scope was entered
+    std::array<bool, NumScopes> entry_valid{};
+    Counts counts{};
+
+    ThreadCounters() {
+        fds.fill(-1);
+    }
+
+    ~ThreadCounters() {
+        for (size_t i = 0; i < NumEvents; ++i) {
+            if (pages[i] != nullptr)
+                munmap(const_cast<perf_event_mmap_page*>(pages[i]), sysconf(_SC_PAGESIZE));
+            if (fds[i] != -1)
+                close(fds[i]);
+        }
+    }
+
+    int GroupLeader() const {
+        for (int fd : fds) {
+            if (fd != -1)
+                return fd;
+        }
+        return -1;
+    }
+
+    /// Reads the current value of each counted event
+    bool Read(std::array<u64, NumEvents>& values) const {
+        return ReadUserSpace(values) || ReadGroup(values);
+    }
+
+    /**
+     * Reads the counters with rdpmc, without a system call. This fails if the CPU or the kernel
+     * don't allow it, or if an event isn't currently scheduled on the PMU.
+     */
+    bool ReadUserSpace(std::array<u64, NumEvents>& values) const {
+#ifdef ARCHITECTURE_x86_64
+        for (size_t i = 0; i < NumEvents; ++i) {
+            if (fds[i] == -1) {
+                values[i] = 0;
+                continue;
+            }
+            const volatile perf_event_mmap_page* page = pages[i];
+            if (page == nullptr)
+                return false;
+
+            // The kernel updates the page under a sequence lock, see linux/perf_event.h
+            u32 sequence;
+            do {
+                sequence = page->lock;
+                std::atomic_signal_fence(std::memory_order_seq_cst);
+                const u32 index = page->index;
+                if (!page->cap_user_rdpmc || index == 0)
+                    return false;
+                // The counter is pmc_width bits wide, and sign extended
+                const u32 shift = 64 - page->pmc_width;
+                const s64 pmc = static_cast<s64>(ReadPmc(index - 1) << shift) >> shift;
+                values[i] = page->offset + pmc;
+                std::atomic_signal_fence(std::memory_order_seq_cst);
+            } while (page->lock != sequence);
+        }
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    /// Reads the counters with a system call
+    bool ReadGroup(std::array<u64, NumEvents>& values) const {
+        struct {
+            u64 nr;
+            u64 values[NumEvents];
+        } group;
+        if (read(GroupLeader(), &group, sizeof(group)) < 0 || group.nr != num_counted)
+            return false;
+        for (size_t i = 0; i < NumEvents; ++i) {
+            values[i] = fds[i] != -1 ? group.values[positions[i]] : 0;
+        }
+        return true;
+    }
+};
+
+static thread_local std::unique_ptr<ThreadCounters> thread_counters;
+
+static int OpenCounter(u64 config, int group_fd) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.read_format = PERF_FORMAT_GROUP;
+    // The group starts disabled, and is enabled once complete
+    attr.disabled = group_fd == -1;
+    // Only the emulator's own code is counted, which is also allowed to unprivileged users
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, group_fd, 0));
+}
+
+bool Start() {
+    static constexpr std::array<u64, NumEvents> configs{{
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_MISSES,
+    }};
+
+    auto counters = std::make_unique<ThreadCounters>();
+    for (size_t i = 0; i < NumEvents; ++i) {
+        counters->fds[i] = OpenCounter(configs[i], counters->GroupLeader());
+        if (counters->fds[i] == -1) {
+            LOG_WARNING(Common, "Could not count %s: %s", GetEventName(static_cast<Event>(i)),
+                        std::strerror(errno));
+            continue;
+        }
+        counters->positions[i] = counters->num_counted++;
+
+        void* page = mmap(nullptr, sysconf(_SC_PAGESIZE), PROT_READ, MAP_SHARED,
+                          counters->fds[i], 0);
+        if (page != MAP_FAILED)
+            counters->pages[i] = static_cast<perf_event_mmap_page*>(page);
+    }
+    if (counters->num_counted == 0) {
+        thread_counters = nullptr;
+        return false;
+    }
+
+    ioctl(counters->GroupLeader(), PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(counters->GroupLeader(), PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    thread_counters = std::move(counters);
+    return true;
+}
+
+void Stop() {
+    thread_counters = nullptr;
+}
+
+bool IsEventCounted(Event event) {
+    return thread_counters && thread_counters->fds[static_cast<size_t>(event)] != -1;
+}
+
+Counts TakeCounts() {
+    if (!thread_counters)
+        return {};
+    Counts counts = thread_counters->counts;
+    thread_counters->counts = {};
+    return counts;
+}
+
+void Enter(Scope scope) {
+    if (!thread_counters)
+        return;
+    const size_t index = static_cast<size_t>(scope);
+    if (thread_counters->depths[index]++ != 0)
+        return;
+    thread_counters->entry_valid[index] =
+        thread_counters->Read(thread_counters->entry_values[index]);
+}
+
+void Leave(Scope scope) {
+    if (!thread_counters)
+        return;
+    const size_t index = static_cast<size_t>(scope);
+    // Scopes entered before the counters were started aren't counted
+    if (thread_counters->depths[index] == 0 || --thread_counters->depths[index] != 0)
+        return;
+    // Nothing can be counted if the counters couldn't be read on entry
+    if (!thread_counters->entry_valid[index])
+        return;
+
+    std::array<u64, NumEvents> values;
+    if (!thread_counters->Read(values))
+        return;
+    ScopeCounts& counts = thread_counters->counts[index];
+    counts.calls += 1;
+    for (size_t i = 0; i < NumEvents; ++i) {
+        counts.events[i] += values[i] - thread_counters->entry_values[index][i];
+    }
+}
+
+#else
+
+bool Start() {
+    LOG_WARNING(Common, "Hardware performance counters are only available on Linux");
+    return false;
+}
+
+void Stop() {}
+
+bool IsEventCounted(Event event) {
+    return false;
+}
+
+Counts TakeCounts() {
+    return {};
+}
+
+void Enter(Scope scope) {}
+
+void Leave(Scope scope) {}
+
+#endif
+
+const char* GetScopeName(Scope scope) {
+    static constexpr std::array<const char*, NumScopes> names{
+        {"arm_jit", "gpu_drawing", "gpu_shader", "gpu_rasterization", "dsp"}};
+    return names[static_cast<size_t>(scope)];
+}
+
+const char* GetEventName(Event event) {
+    static constexpr std::array<const char*, NumEvents> names{
+        {"cycles", "instructions", "cache_misses", "branch_misses"}};
+    return names[static_cast<size_t>(event)];
+}
+
+} // namespace PerfCounters
+} // namespace Common
@@ -0,0 +1,104 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include "common/common_types.h"
+
+namespace Common {
+
+/**
+ * Hardware performance counters attached to the hottest MicroProfile scopes. Where MicroProfile
+ * only measures the walltime of a scope, this counts the cycles, instructions, cache misses and
+ * branch misses of the CPU running it, which tells why a scope is slow (IPC, cache behavior...).
+ *
+ * The counters are opened with perf_event_open, for the thread calling Start only, and are only
+ * available on Linux. On x86-64 they are read from user space with rdpmc when the kernel allows
+ * it; otherwise reading them costs a system call on each entry and exit of a scope. Either way,
+ * nothing is counted unless started.
+ */
+namespace PerfCounters {
+
+/// Scopes the counters are attached to, named after their MicroProfile scope
+enum class Scope : u8 {
+    ARM_Jit,
+    GPU_Drawing,
+    GPU_Shader,
+    GPU_Rasterization,
+    DSP,
+};
+constexpr size_t NumScopes = 5;
+
+enum class Event : u8 {
+    Cycles,
+    Instructions,
+    CacheMisses,
+    BranchMisses,
+};
+constexpr size_t NumEvents = 4;
+
+/// Events counted in a scope. Scopes are inclusive: a scope nested in another counts for both.
+struct ScopeCounts {
+    /// Number of times the scope was entered, not counting recursive entries
+    u64 calls = 0;
+    /// Count of each event, indexed by Event
+    std::array<u64, NumEvents> events{};
+};
+
+/// Counts of all the scopes, indexed by Scope
+using Counts = std::array<ScopeCounts, NumScopes>;
+
+/**
+ * Opens the counters for the calling thread. Scopes entered on other threads aren't counted.
+ * @returns whether any counter could be opened
+ */
+bool Start();
+
+/// Closes the counters of the calling thread
+void Stop();
+
+/// Returns whether an event is counted, as the CPU or the kernel may not support all of them
+bool IsEventCounted(Event event);
+
+/// Returns the counts accumulated on the calling thread since the previous call, and resets them
+Counts TakeCounts();
+
+/// Starts counting events for a scope, if started on the calling thread
+void Enter(Scope scope);
+
+/// Stops counting events for a scope, if started on the calling thread
+void Leave(Scope scope);
+
+/// Returns the name of a scope, in snake_case
+const char* GetScopeName(Scope scope);
+
+/// Returns the name of an event, in snake_case
+const char* GetEventName(Event event);
+
+/// Counts events until the end of its scope
+class ScopeGuard {
+public:
+    explicit ScopeGuard(Scope scope) : scope(scope) {
+        Enter(scope);
+    }
+
+    ~ScopeGuard() {
+        Leave(scope);
+    }
+
+    ScopeGuard(const ScopeGuard&) = delete;
+    ScopeGuard& operator=(const ScopeGuard&) = delete;
+
+private:
+    Scope scope;
+};
+
+} // namespace PerfCounters
+} // namespace Common
+
+/// Counts events until the end of the enclosing block, in the scope of the given name
+#define PERF_COUNTERS_SCOPE(name)                                                                  \
+    ::Common::PerfCounters::ScopeGuard perf_counters_scope_##name(                                 \
+        ::Common::PerfCounters::Scope::name)
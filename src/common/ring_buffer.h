@@ -0,0 +1,110 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace Common {
+
+/**
+ * Bounded lock-free queue of fixed-size elements, for any number of producer threads and a single
+ * consumer thread. Each slot carries a sequence number which tells whether it is free to be written
+ * or ready to be read, so producers only contend on the write position and never wait for the
+ * consumer: when the queue is full, pushing fails instead.
+ *
+ * Elements are written and read in place, which avoids copying large elements around. The queue
+ * is large if the elements are, so it should be allocated on the heap.
+ *
+ * @tparam T Type of the elements, which must be default constructible
+ * @tparam capacity Number of slots of the queue, which must be a power of two
+ */
+template <typename T, size_t capacity>
+class RingBuffer {
+    static_assert(capacity != 0 && (capacity & (capacity - 1)) == 0,
+                  "capacity must be a power of two");
+
+public:
+    RingBuffer() {
+        for (size_t i = 0; i < capacity; ++i) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    RingBuffer(const RingBuffer&) = delete;
+    RingBuffer& operator=(const RingBuffer&) = delete;
+
+    /**
+     * Reserves a slot, lets the given function fill it in and publishes it to the consumer.
+     * May be called from any thread.
+     * @param fill Function called with a reference to the element to write
+     * @returns false if the queue was full, in which case fill isn't called
+     */
+    template <typename Func>
+    bool TryPush(Func&& fill) {
+        size_t position = write_position.load(std::memory_order_relaxed);
+        Slot* slot;
+        while (true) {
+            slot = &slots[position % capacity];
+            const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            const auto difference =
+                static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+            if (difference == 0) {
+                // The slot is free; try to claim it
+                if (write_position.compare_exchange_weak(position, position + 1,
+                                                         std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (difference < 0) {
+                // The slot still holds an element from the previous lap, so the queue is full
+                return false;
+            } else {
+                // Another producer claimed the slot first
+                position = write_position.load(std::memory_order_relaxed);
+            }
+        }
+
+        fill(slot->value);
+        slot->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Passes the oldest element to the given function and frees its slot. Must only be called
+     * from the consumer thread.
+     * @param consume Function called with a reference to the element to read
+     * @returns false if there was no element ready to be read
+     */
+    template <typename Func>
+    bool TryPop(Func&& consume) {
+        Slot& slot = slots[read_position % capacity];
+        if (slot.sequence.load(std::memory_order_acquire) != read_position + 1)
+            return false;
+
+        consume(slot.value);
+        slot.sequence.store(read_position + capacity, std::memory_order_release);
+        ++read_position;
+        return true;
+    }
+
+    /// Returns whether there is an element ready to be read. Must only be called by the consumer.
+    bool IsEmpty() const {
+        const Slot& slot = slots[read_position % capacity];
+        return slot.sequence.load(std::memory_order_acquire) != read_position + 1;
+    }
+
+private:
+    struct Slot {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    std::array<Slot, capacity> slots;
+    std::atomic<size_t> write_position{0};
+    size_t read_position = 0;
+};
+
+} // namespace Common
@@ -4,9 +4,13 @@
 
 #pragma once
 
+#include <algorithm>
 #include <array>
+#include <cstddef>
 #include <deque>
 #include <boost/range/algorithm_ext/erase.hpp>
+#include "common/bit_set.h"
+#include "common/common_types.h"
 
 namespace Common {
 
@@ -21,15 +25,11 @@ struct ThreadQueueList {
     // Number of priority levels. (Valid levels are [0..NUM_QUEUES).)
     static const Priority NUM_QUEUES = N;
 
-    ThreadQueueList() {
-        first = nullptr;
-    }
-
     // Only for debugging, returns priority level.
     Priority contains(const T& uid) {
         for (Priority i = 0; i < NUM_QUEUES; ++i) {
             Queue& cur = queues[i];
-            if (std::find(cur.data.cbegin(), cur.data.cend(), uid) != cur.data.cend()) {
+            if (std::find(cur.cbegin(), cur.cend(), uid) != cur.cend()) {
                 return i;
             }
         }
@@ -38,122 +38,108 @@ struct ThreadQueueList {
     }
 
     T get_first() {
-        Queue* cur = first;
-        while (cur != nullptr) {
-            if (!cur->data.empty()) {
-                return cur->data.front();
-            }
-            cur = cur->next_nonempty;
-        }
+        Priority priority = first_nonempty();
+        if (priority == NUM_QUEUES)
+            return T();
 
-        return T();
+        return queues[priority].front();
     }
 
     T pop_first() {
-        Queue* cur = first;
-        while (cur != nullptr) {
-            if (!cur->data.empty()) {
-                auto tmp = std::move(cur->data.front());
-                cur->data.pop_front();
-                return tmp;
-            }
-            cur = cur->next_nonempty;
-        }
+        Priority priority = first_nonempty();
+        if (priority == NUM_QUEUES)
+            return T();
 
-        return T();
+        return pop_front(priority);
     }
 
     T pop_first_better(Priority priority) {
-        Queue* cur = first;
-        Queue* stop = &queues[priority];
-        while (cur < stop) {
-            if (!cur->data.empty()) {
-                auto tmp = std::move(cur->data.front());
-                cur->data.pop_front();
-                return tmp;
-            }
-            cur = cur->next_nonempty;
-        }
+        Priority first = first_nonempty();
+        if (first >= priority)
+            return T();
 
-        return T();
+        return pop_front(first);
     }
 
     void push_front(Priority priority, const T& thread_id) {
-        Queue* cur = &queues[priority];
-        cur->data.push_front(thread_id);
+        queues[priority].push_front(thread_id);
+        mark_nonempty(priority);
     }
 
     void push_back(Priority priority, const T& thread_id) {
-        Queue* cur = &queues[priority];
-        cur->data.push_back(thread_id);
+        queues[priority].push_back(thread_id);
+        mark_nonempty(priority);
     }
 
     void move(const T& thread_id, Priority old_priority, Priority new_priority) {
         remove(old_priority, thread_id);
-        prepare(new_priority);
         push_back(new_priority, thread_id);
     }
 
     void remove(Priority priority, const T& thread_id) {
-        Queue* cur = &queues[priority];
-        boost::remove_erase(cur->data, thread_id);
+        Queue& cur = queues[priority];
+        boost::remove_erase(cur, thread_id);
+        if (cur.empty())
+            mark_empty(priority);
     }
 
     void rotate(Priority priority) {
-        Queue* cur = &queues[priority];
+        Queue& cur = queues[priority];
 
-        if (cur->data.size() > 1) {
-            cur->data.push_back(std::move(cur->data.front()));
-            cur->data.pop_front();
+        if (cur.size() > 1) {
+            cur.push_back(std::move(cur.front()));
+            cur.pop_front();
         }
     }
 
     void clear() {
         queues.fill(Queue());
-        first = nullptr;
+        nonempty_mask.fill(0);
     }
 
     bool empty(Priority priority) const {
-        const Queue* cur = &queues[priority];
-        return cur->data.empty();
-    }
-
-    void prepare(Priority priority) {
-        Queue* cur = &queues[priority];
-        if (cur->next_nonempty == UnlinkedTag())
-            link(priority);
+        return queues[priority].empty();
     }
 
 private:
-    struct Queue {
-        // Points to the next active priority, skipping over ones that have never been used.
-        Queue* next_nonempty = UnlinkedTag();
-        // Double-ended queue of threads in this priority level
-        std::deque<T> data;
-    };
-
-    /// Special tag used to mark priority levels that have never been used.
-    static Queue* UnlinkedTag() {
-        return reinterpret_cast<Queue*>(1);
+    // Double-ended queue of threads in a priority level
+    using Queue = std::deque<T>;
+
+    static constexpr size_t BITS_PER_WORD = 64;
+    static constexpr size_t NUM_WORDS = (NUM_QUEUES + BITS_PER_WORD - 1) / BITS_PER_WORD;
+
+    /// Returns the highest (numerically lowest) non-empty priority level, or NUM_QUEUES if none.
+    Priority first_nonempty() const {
+        for (size_t word = 0; word < NUM_WORDS; ++word) {
+            if (nonempty_mask[word] != 0) {
+                return static_cast<Priority>(word * BITS_PER_WORD +
+                                             LeastSignificantSetBit(nonempty_mask[word]));
+            }
+        }
+
+        return NUM_QUEUES;
     }
 
-    void link(Priority priority) {
-        Queue* cur = &queues[priority];
+    T pop_front(Priority priority) {
+        Queue& cur = queues[priority];
+        auto tmp = std::move(cur.front());
+        cur.pop_front();
+        if (cur.empty())
+            mark_empty(priority);
+        return tmp;
+    }
 
-        for (int i = priority - 1; i >= 0; --i) {
-            if (queues[i].next_nonempty != UnlinkedTag()) {
-                cur->next_nonempty = queues[i].next_nonempty;
-                queues[i].next_nonempty = cur;
-                return;
-            }
-        }
+    void mark_nonempty(Priority priority) {
+        nonempty_mask[priority / BITS_PER_WORD] |= u64(1) << (priority % BITS_PER_WORD);
+    }
 
-        cur->next_nonempty = first;
-        first = cur;
+    void mark_empty(Priority priority) {
+        nonempty_mask[priority / BITS_PER_WORD] &= ~(u64(1) << (priority % BITS_PER_WORD));
     }
 
-    // The first queue that's ever been used.
-    Queue* first;
+    // One bit per priority level, set when the level has threads in it. Finding the next thread to
+    // run is a bit scan instead of a walk over the levels.
+    std::array<u64, NUM_WORDS> nonempty_mask{};
     // The priority level queues of thread ids.
     std::array<Queue, NUM_QUEUES> queues;
 };
@@ -5,6 +5,7 @@
 #pragma once
 
 #include "common/common_types.h"
+#include "core/arm/idle_loop.h"
 #include "core/arm/skyeye_common/arm_regformat.h"
 #include "core/arm/skyeye_common/vfp/asm_vfp.h"
 
@@ -125,16 +126,28 @@ public:
     virtual void SetCP15Register(CP15Register reg, u32 value) = 0;
 
     /**
-     * Saves the current CPU context
+     * Saves the general purpose registers and the CPSR of the current CPU context
      * @param ctx Thread context to save
      */
-    virtual void SaveContext(ThreadContext& ctx) = 0;
+    virtual void SaveCoreContext(ThreadContext& ctx) = 0;
 
     /**
-     * Loads a CPU context
+     * Loads the general purpose registers and the CPSR of a CPU context
      * @param ctx Thread context to load
      */
-    virtual void LoadContext(const ThreadContext& ctx) = 0;
+    virtual void LoadCoreContext(const ThreadContext& ctx) = 0;
+
+    /**
+     * Saves the VFP registers, FPSCR and FPEXC of the current CPU context
+     * @param ctx Thread context to save
+     */
+    virtual void SaveVFPContext(ThreadContext& ctx) = 0;
+
+    /**
+     * Loads the VFP registers, FPSCR and FPEXC of a CPU context
+     * @param ctx Thread context to load
+     */
+    virtual void LoadVFPContext(const ThreadContext& ctx) = 0;
 
     /// Prepare core for thread reschedule (if needed to correctly handle state)
     virtual void PrepareReschedule() = 0;
@@ -144,6 +157,11 @@ public:
         return num_instructions;
     }
 
+    /// Returns the number of emulated cycles skipped in idle loops
+    u64 GetIdleLoopSkippedCycles() const {
+        return idle_loop_detector.GetSkippedCycles();
+    }
+
 protected:
     /**
      * Executes the given number of instructions
@@ -151,6 +169,9 @@ protected:
      */
     virtual void ExecuteInstructions(int num_instructions) = 0;
 
+    /// Checked by the implementations after each slice of execution
+    IdleLoop::Detector idle_loop_detector;
+
 private:
     u64 num_instructions = 0; ///< Number of instructions executed
 };
@@ -6,6 +6,7 @@
 #include <dynarmic/dynarmic.h>
 #include "common/assert.h"
 #include "common/microprofile.h"
+#include "common/perf_counters.h"
 #include "core/arm/dynarmic/arm_dynarmic.h"
 #include "core/arm/dynarmic/arm_dynarmic_cp15.h"
 #include "core/arm/dyncom/arm_dyncom_interpreter.h"
@@ -129,33 +130,46 @@ MICROPROFILE_DEFINE(ARM_Jit, "ARM JIT", "ARM JIT", MP_RGB(255, 64, 64));
 void ARM_Dynarmic::ExecuteInstructions(int num_instructions) {
     ASSERT(Memory::GetCurrentPageTable() == current_page_table);
     MICROPROFILE_SCOPE(ARM_Jit);
+    PERF_COUNTERS_SCOPE(ARM_Jit);
 
-    std::size_t ticks_executed = jit->Run(static_cast<unsigned>(num_instructions));
+    std::size_t ticks_executed;
+    {
+        Core::FrameProfiler::Scope profile_scope(Core::System::GetInstance().frame_profiler,
+                                                 Core::FrameProfiler::Component::CPU);
+        ticks_executed = jit->Run(static_cast<unsigned>(num_instructions));
+    }
 
     CoreTiming::AddTicks(ticks_executed);
+    idle_loop_detector.Check(*this);
 }
 
-void ARM_Dynarmic::SaveContext(ARM_Interface::ThreadContext& ctx) {
+void ARM_Dynarmic::SaveCoreContext(ARM_Interface::ThreadContext& ctx) {
     memcpy(ctx.cpu_registers, jit->Regs().data(), sizeof(ctx.cpu_registers));
-    memcpy(ctx.fpu_registers, jit->ExtRegs().data(), sizeof(ctx.fpu_registers));
 
     ctx.sp = jit->Regs()[13];
     ctx.lr = jit->Regs()[14];
     ctx.pc = jit->Regs()[15];
     ctx.cpsr = jit->Cpsr();
-
-    ctx.fpscr = jit->Fpscr();
-    ctx.fpexc = interpreter_state->VFP[VFP_FPEXC];
 }
 
-void ARM_Dynarmic::LoadContext(const ARM_Interface::ThreadContext& ctx) {
+void ARM_Dynarmic::LoadCoreContext(const ARM_Interface::ThreadContext& ctx) {
     memcpy(jit->Regs().data(), ctx.cpu_registers, sizeof(ctx.cpu_registers));
-    memcpy(jit->ExtRegs().data(), ctx.fpu_registers, sizeof(ctx.fpu_registers));
 
     jit->Regs()[13] = ctx.sp;
     jit->Regs()[14] = ctx.lr;
     jit->Regs()[15] = ctx.pc;
     jit->Cpsr() = ctx.cpsr;
+}
+
+void ARM_Dynarmic::SaveVFPContext(ARM_Interface::ThreadContext& ctx) {
+    memcpy(ctx.fpu_registers, jit->ExtRegs().data(), sizeof(ctx.fpu_registers));
+
+    ctx.fpscr = jit->Fpscr();
+    ctx.fpexc = interpreter_state->VFP[VFP_FPEXC];
+}
+
+void ARM_Dynarmic::LoadVFPContext(const ARM_Interface::ThreadContext& ctx) {
+    memcpy(jit->ExtRegs().data(), ctx.fpu_registers, sizeof(ctx.fpu_registers));
 
     jit->SetFpscr(ctx.fpscr);
     interpreter_state->VFP[VFP_FPEXC] = ctx.fpexc;
@@ -83,31 +83,43 @@ void ARM_DynCom::ExecuteInstructions(int num_instructions) {
     // Dyncom only breaks on instruction dispatch. This only happens on every instruction when
     // executing one instruction at a time. Otherwise, if a block is being executed, more
     // instructions may actually be executed than specified.
-    unsigned ticks_executed = InterpreterMainLoop(state.get());
+    unsigned ticks_executed;
+    {
+        Core::FrameProfiler::Scope profile_scope(Core::System::GetInstance().frame_profiler,
+                                                 Core::FrameProfiler::Component::CPU);
+        ticks_executed = InterpreterMainLoop(state.get());
+    }
     CoreTiming::AddTicks(ticks_executed);
+    idle_loop_detector.Check(*this);
 }
 
-void ARM_DynCom::SaveContext(ThreadContext& ctx) {
+void ARM_DynCom::SaveCoreContext(ThreadContext& ctx) {
     memcpy(ctx.cpu_registers, state->Reg.data(), sizeof(ctx.cpu_registers));
-    memcpy(ctx.fpu_registers, state->ExtReg.data(), sizeof(ctx.fpu_registers));
 
     ctx.sp = state->Reg[13];
     ctx.lr = state->Reg[14];
     ctx.pc = state->Reg[15];
     ctx.cpsr = state->Cpsr;
-
-    ctx.fpscr = state->VFP[VFP_FPSCR];
-    ctx.fpexc = state->VFP[VFP_FPEXC];
 }
 
-void ARM_DynCom::LoadContext(const ThreadContext& ctx) {
+void ARM_DynCom::LoadCoreContext(const ThreadContext& ctx) {
     memcpy(state->Reg.data(), ctx.cpu_registers, sizeof(ctx.cpu_registers));
-    memcpy(state->ExtReg.data(), ctx.fpu_registers, sizeof(ctx.fpu_registers));
 
     state->Reg[13] = ctx.sp;
     state->Reg[14] = ctx.lr;
     state->Reg[15] = ctx.pc;
     state->Cpsr = ctx.cpsr;
+}
+
+void ARM_DynCom::SaveVFPContext(ThreadContext& ctx) {
+    memcpy(ctx.fpu_registers, state->ExtReg.data(), sizeof(ctx.fpu_registers));
+
+    ctx.fpscr = state->VFP[VFP_FPSCR];
+    ctx.fpexc = state->VFP[VFP_FPEXC];
+}
+
+void ARM_DynCom::LoadVFPContext(const ThreadContext& ctx) {
+    memcpy(state->ExtReg.data(), ctx.fpu_registers, sizeof(ctx.fpu_registers));
 
     state->VFP[VFP_FPSCR] = ctx.fpscr;
     state->VFP[VFP_FPEXC] = ctx.fpexc;
@@ -31,8 +31,10 @@ public:
     u32 GetCP15Register(CP15Register reg) override;
     void SetCP15Register(CP15Register reg, u32 value) override;
 
-    void SaveContext(ThreadContext& ctx) override;
-    void LoadContext(const ThreadContext& ctx) override;
+    void SaveCoreContext(ThreadContext& ctx) override;
+    void LoadCoreContext(const ThreadContext& ctx) override;
+    void SaveVFPContext(ThreadContext& ctx) override;
+    void LoadVFPContext(const ThreadContext& ctx) override;
 
     void PrepareReschedule() override;
     void ExecuteInstructions(int num_instructions) override;
@@ -0,0 +1,186 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "core/arm/arm_interface.h"
+#include "core/arm/idle_loop.h"
+#include "core/core_timing.h"
+#include "core/memory.h"
+#include "core/settings.h"
+
+namespace IdleLoop {
+
+/// How an instruction may appear in a loop that only reads memory
+enum class InstructionKind {
+    Allowed, ///< Loads and data processing instructions not writing the PC
+    Branch,  ///< Branch to an immediate offset, possibly conditional
+    Other,   ///< Anything else, including stores, writebacks and SVCs
+};
+
+static InstructionKind DecodeArm(u32 inst, s32& branch_offset) {
+    if ((inst >> 28) == 0xF)
+        return InstructionKind::Other;
+
+    const u32 rd = (inst >> 12) & 0xF;
+    const bool load = (inst & (1 << 20)) != 0;
+    const bool pre_indexed = (inst & (1 << 24)) != 0;
+    const bool writeback = (inst & (1 << 21)) != 0;
+
+    if ((inst & 0x0C000000) == 0) {
+        const bool immediate = (inst & (1 << 25)) != 0;
+        if (!immediate && (inst & 0x90) == 0x90) {
+            // Multiplies and swaps, or halfword and doubleword loads and stores
+            if ((inst & 0x60) == 0)
+                return InstructionKind::Other;
+            return load && pre_indexed && !writeback && rd != 15 ? InstructionKind::Allowed
+                                                                 : InstructionKind::Other;
+        }
+        const u32 opcode = (inst >> 21) & 0xF;
+        const bool is_compare = opcode >= 8 && opcode <= 11;
+        if (is_compare && !load) {
+            // MRS, MSR, BX and the other miscellaneous instructions
+            return InstructionKind::Other;
+        }
+        return is_compare || rd != 15 ? InstructionKind::Allowed : InstructionKind::Other;
+    }
+
+    if ((inst & 0x0C000000) == 0x04000000) {
+        // Media instructions share the encoding of register offset loads and stores
+        if ((inst & 0x02000010) == 0x02000010)
+            return InstructionKind::Other;
+        return load && pre_indexed && !writeback && rd != 15 ? InstructionKind::Allowed
+                                                             : InstructionKind::Other;
+    }
+
+    if ((inst & 0x0F000000) == 0x0A000000) {
+        // Sign extension of the 24-bit word offset, relative to the instruction address + 8
+        branch_offset = (static_cast<s32>(inst << 8) >> 6) + 8;
+        return InstructionKind::Branch;
+    }
+
+    return InstructionKind::Other;
+}
+
+static InstructionKind DecodeThumb(u32 inst, s32& branch_offset) {
+    const bool load = (inst & (1 << 11)) != 0;
+
+    if (inst < 0x4400) {
+        // Shifts, additions, subtractions, moves and compares with immediates, and ALU operations
+        return InstructionKind::Allowed;
+    }
+    if (inst < 0x4800) {
+        // Operations on high registers, or BX/BLX
+        const u32 op = (inst >> 8) & 3;
+        const u32 rd = (inst & 7) | ((inst >> 4) & 8);
+        return op != 3 && (op == 1 || rd != 15) ? InstructionKind::Allowed
+                                                : InstructionKind::Other;
+    }
+    if (inst < 0x5000) {
+        // PC-relative load
+        return InstructionKind::Allowed;
+    }
+    if (inst < 0x6000) {
+        // Register offset loads and stores, the loads being the last five opcodes
+        return ((inst >> 9) & 7) >= 3 ? InstructionKind::Allowed : InstructionKind::Other;
+    }
+    if (inst < 0xA000) {
+        // Immediate offset and SP-relative loads and stores
+        return load ? InstructionKind::Allowed : InstructionKind::Other;
+    }
+    if (inst < 0xB000) {
+        // Additions to the PC or SP into a register
+        return InstructionKind::Allowed;
+    }
+    if ((inst & 0xFF00) == 0xB200 || (inst & 0xFF0F) == 0xBF00) {
+        // Sign and zero extensions, and hints (NOP, YIELD, WFE...)
+        return InstructionKind::Allowed;
+    }
+    if (inst >= 0xD000 && inst < 0xDE00) {
+        branch_offset = (static_cast<s32>(inst << 24) >> 23) + 4;
+        return InstructionKind::Branch;
+    }
+    if (inst >= 0xE000 && inst < 0xE800) {
+        branch_offset = (static_cast<s32>(inst << 21) >> 20) + 4;
+        return InstructionKind::Branch;
+    }
+    return InstructionKind::Other;
+}
+
+boost::optional<Loop> FindReadOnlyLoop(u32 pc, bool thumb,
+                                       const std::function<u32(u32)>& read_instruction) {
+    const u32 size = thumb ? 2 : 4;
+    auto decode = [&](u32 address, s32& branch_offset) {
+        const u32 inst = read_instruction(address);
+        return thumb ? DecodeThumb(inst, branch_offset) : DecodeArm(inst, branch_offset);
+    };
+
+    // Looks for the branch closing the loop after the PC, then checks the instructions before
+    s32 branch_offset = 0;
+    for (u32 i = 0; i < MAX_LOOP_INSTRUCTIONS; ++i) {
+        const u32 address = pc + i * size;
+        const InstructionKind kind = decode(address, branch_offset);
+        if (kind == InstructionKind::Other)
+            return boost::none;
+        if (kind == InstructionKind::Allowed)
+            continue;
+
+        const u32 loop_start = address + branch_offset;
+        if (branch_offset > 0 || loop_start > pc ||
+            (address - loop_start) / size >= MAX_LOOP_INSTRUCTIONS) {
+            return boost::none;
+        }
+        for (u32 before = loop_start; before < pc; before += size) {
+            if (decode(before, branch_offset) != InstructionKind::Allowed)
+                return boost::none;
+        }
+        return Loop{loop_start, address};
+    }
+    return boost::none;
+}
+
+void Detector::Check(ARM_Interface& cpu) {
+    if (!Settings::values.skip_idle_loops)
+        return;
+
+    std::array<u32, 15> new_registers;
+    for (int i = 0; i < 15; ++i) {
+        new_registers[i] = cpu.GetReg(i);
+    }
+    const u32 pc = cpu.GetPC();
+    const u32 new_cpsr = cpu.GetCPSR();
+    const u64 new_event_count = CoreTiming::GetExecutedEventCount();
+
+    if (new_registers != registers || new_cpsr != cpsr || new_event_count != event_count) {
+        registers = new_registers;
+        cpsr = new_cpsr;
+        event_count = new_event_count;
+        loop = boost::none;
+        repeats = 0;
+        return;
+    }
+
+    // Slices end after a number of instructions, which may not be a multiple of the loop length,
+    // so the PC only has to be in the same loop
+    if (!loop || pc < loop->start || pc > loop->end) {
+        const bool thumb = (cpsr & (1 << 5)) != 0;
+        auto read_instruction = [thumb](u32 address) -> u32 {
+            if (!Memory::IsValidVirtualAddress(address))
+                return 0xFFFFFFFF; // Neither an allowed instruction nor a branch in either mode
+            return thumb ? Memory::Read16(address) : Memory::Read32(address);
+        };
+        loop = FindReadOnlyLoop(pc, thumb, read_instruction);
+        repeats = 0;
+        if (!loop)
+            return;
+    }
+    if (++repeats < REPEATS_BEFORE_SKIPPING)
+        return;
+
+    // The loop can only exit once an event changes the memory it reads, so skip to the next one
+    const u64 idle_ticks = CoreTiming::GetIdleTicks();
+    CoreTiming::Idle();
+    CoreTiming::Advance();
+    skipped_cycles += CoreTiming::GetIdleTicks() - idle_ticks;
+}
+
+} // namespace IdleLoop
@@ -0,0 +1,68 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <functional>
+#include <boost/optional.hpp>
+#include "common/common_types.h"
+
+class ARM_Interface;
+
+namespace IdleLoop {
+
+/// Maximum number of instructions in a loop considered idle
+constexpr u32 MAX_LOOP_INSTRUCTIONS = 8;
+
+/// Addresses of the first instruction of a loop and of the branch closing it
+struct Loop {
+    u32 start;
+    u32 end;
+};
+
+/**
+ * Finds whether an instruction is part of a short loop that only reads memory: loads, data
+ * processing instructions and a single branch backwards, to the beginning of the loop.
+ * @param pc Address of the instruction
+ * @param thumb Whether the loop is made of Thumb instructions
+ * @param read_instruction Reads the instruction at an address (a halfword in Thumb)
+ * @returns the loop the instruction is part of, if it is such a loop
+ */
+boost::optional<Loop> FindReadOnlyLoop(u32 pc, bool thumb,
+                                       const std::function<u32(u32)>& read_instruction);
+
+/**
+ * Detects when the CPU spins in a loop that only reads memory, such as one polling a flag until
+ * the next VBlank, and skips the emulated time directly to the next scheduled event.
+ *
+ * The CPU state is compared between slices of execution: if the registers other than the PC are
+ * unchanged, no event ran in the meantime and the PC stayed in such a loop, then each iteration
+ * of the loop reads the same values and it can't exit before an event changes the memory.
+ */
+class Detector {
+public:
+    /// Checks the CPU state after a slice of execution, and skips to the next event when idle
+    void Check(ARM_Interface& cpu);
+
+    /// Returns the number of emulated cycles skipped so far
+    u64 GetSkippedCycles() const {
+        return skipped_cycles;
+    }
+
+private:
+    /// Number of consecutive slices ending in the same state before the loop is considered idle
+    static constexpr u32 REPEATS_BEFORE_SKIPPING = 2;
+
+    /// Registers at the end of the previous slice, without the PC
+    std::array<u32, 15> registers{};
+    u32 cpsr = 0;
+    u64 event_count = 0;
+    /// Read-only loop the PC was in at the end of the previous slices with the same state
+    boost::optional<Loop> loop;
+    u32 repeats = 0;
+    u64 skipped_cycles = 0;
+};
+
+} // namespace IdleLoop
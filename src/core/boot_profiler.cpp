@@ -0,0 +1,129 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include "common/logging/log.h"
+#include "common/string_util.h"
+#include "core/boot_profiler.h"
+
+namespace Core {
+
+static double ToMilliseconds(BootProfiler::Clock::duration duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+BootProfiler::Scope::Scope(BootProfiler& profiler, const char* name)
+    : profiler(profiler), boot(0), index(profiler.BeginPhase(name, boot)) {}
+
+BootProfiler::Scope::~Scope() {
+    if (index >= 0) {
+        profiler.EndPhase(boot, index);
+    }
+}
+
+void BootProfiler::Begin() {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    ++current_boot;
+    phases.clear();
+    depth = 0;
+    time_to_first_frame = Clock::duration::zero();
+    first_frame_reached = false;
+    origin = Clock::now();
+    recording = true;
+}
+
+void BootProfiler::MarkFirstFrame() {
+    if (!recording) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (!recording) {
+        return;
+    }
+    time_to_first_frame = Clock::now() - origin;
+    recording = false;
+    first_frame_reached = true;
+    LOG_INFO(Core, "First frame presented %.1f ms after the boot began",
+             ToMilliseconds(time_to_first_frame));
+}
+
+std::vector<BootProfiler::Phase> BootProfiler::GetPhases() const {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    return phases;
+}
+
+std::string BootProfiler::ToJSON() const {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::string json = "{\n";
+    if (first_frame_reached) {
+        json += Common::StringFromFormat("  \"time_to_first_frame_ms\": %.3f,\n",
+                                         ToMilliseconds(time_to_first_frame));
+    } else {
+        json += "  \"time_to_first_frame_ms\": null,\n";
+    }
+
+    json += "  \"phases\": [";
+    for (size_t i = 0; i < phases.size(); ++i) {
+        const Phase& phase = phases[i];
+        json += Common::StringFromFormat(
+            "%s\n    {\"name\": \"%s\", \"depth\": %d, \"start_ms\": %.3f, \"duration_ms\": %.3f}",
+            i == 0 ? "" : ",", phase.name, phase.depth, ToMilliseconds(phase.start),
+            ToMilliseconds(phase.duration));
+    }
+    json += phases.empty() ? "]\n}\n" : "\n  ]\n}\n";
+    return json;
+}
+
+int BootProfiler::BeginPhase(const char* name, u32& boot) {
+    if (!recording) {
+        return -1;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (!recording) {
+        return -1;
+    }
+    boot = current_boot;
+    phases.push_back({name, depth++, Clock::now() - origin, Clock::duration::zero()});
+    return static_cast<int>(phases.size() - 1);
+}
+
+void BootProfiler::EndPhase(u32 boot, int index) {
+    const Clock::time_point end = Clock::now();
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // The phase was dropped if a new boot began in the meantime
+    if (boot != current_boot) {
+        return;
+    }
+    Phase& phase = phases[index];
+    phase.duration = (end - origin) - phase.start;
+    --depth;
+
+    // Top-level phases are logged with the breakdown of the phases directly nested in them
+    if (phase.depth != 0) {
+        return;
+    }
+    std::string nested;
+    for (size_t i = index + 1; i < phases.size() && phases[i].depth != 0; ++i) {
+        if (phases[i].depth != 1) {
+            continue;
+        }
+        nested += Common::StringFromFormat("%s%s %.1f ms", nested.empty() ? " (" : ", ",
+                                           phases[i].name, ToMilliseconds(phases[i].duration));
+    }
+    LOG_INFO(Core, "%s took %.1f ms%s", phase.name, ToMilliseconds(phase.duration),
+             nested.empty() ? "" : (nested + ")").c_str());
+}
+
+} // namespace Core
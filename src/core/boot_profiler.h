@@ -0,0 +1,92 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "common/common_types.h"
+
+namespace Core {
+
+/**
+ * Records how long the phases of booting an application take, from the start of System::Load to
+ * the first frame the application presents. Phases are timed with Scope objects and may be nested.
+ * All public functions of this class are thread-safe.
+ */
+class BootProfiler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Phase {
+        /// Name of the phase, which must be a valid JSON string (e.g. a function name)
+        const char* name;
+        /// Number of phases this one is nested in
+        int depth;
+        /// Time from the start of the boot to the start of the phase
+        Clock::duration start;
+        /// Walltime the phase took
+        Clock::duration duration;
+    };
+
+    /// Times the phase lasting until the end of its scope, if the application is still booting
+    class Scope {
+    public:
+        Scope(BootProfiler& profiler, const char* name);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        BootProfiler& profiler;
+        /// Boot the phase belongs to
+        u32 boot;
+        /// Index of the recorded phase, or -1 if it isn't recorded
+        int index;
+    };
+
+    /// Starts recording a new boot, dropping the phases of the previous one
+    void Begin();
+
+    /// Stops recording when the application presents its first frame
+    void MarkFirstFrame();
+
+    /// Returns whether the first frame was presented since the boot began
+    bool IsFirstFrameReached() const {
+        return first_frame_reached;
+    }
+
+    /// Returns the recorded phases, in the order they started
+    std::vector<Phase> GetPhases() const;
+
+    /**
+     * Formats the recorded boot as a JSON object, with the time to the first frame (null if it
+     * wasn't reached) and the phases. Times are in milliseconds.
+     */
+    std::string ToJSON() const;
+
+private:
+    int BeginPhase(const char* name, u32& boot);
+    void EndPhase(u32 boot, int index);
+
+    mutable std::mutex mutex;
+    std::atomic<bool> recording{false};
+    std::atomic<bool> first_frame_reached{false};
+
+    /// Number of boots that began, to tell the phases of previous boots apart
+    u32 current_boot = 0;
+    /// Point when the boot began
+    Clock::time_point origin;
+    /// Time from the beginning of the boot to the first frame
+    Clock::duration time_to_first_frame = Clock::duration::zero();
+    /// Number of phases currently open
+    int depth = 0;
+    std::vector<Phase> phases;
+};
+
+} // namespace Core
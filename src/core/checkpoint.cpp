@@ -0,0 +1,435 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cinttypes>
+#include <cstring>
+#include <set>
+#include <cryptopp/zlib.h>
+#include "audio_core/audio_core.h"
+#include "common/chunk_file.h"
+#include "common/logging/log.h"
+#include "core/arm/arm_interface.h"
+#include "core/core.h"
+#include "core/core_timing.h"
+#include "core/hle/kernel/memory.h"
+#include "core/hle/kernel/process.h"
+#include "core/hle/kernel/thread.h"
+#include "core/hw/hw.h"
+#include "core/loader/loader.h"
+#include "core/memory.h"
+#include "core/checkpoint.h"
+#include "video_core/pica.h"
+
+namespace Core {
+namespace Checkpoint {
+
+constexpr u32 MAGIC = Loader::MakeMagic('C', 'S', 'T', 'A');
+
+/// Emulated memory is mostly made of zeroes and repeated data, which the fastest level compresses
+/// nearly as well as the default one
+constexpr unsigned DEFLATE_LEVEL = 1;
+/// Size of the data handed to and taken from zlib at once
+constexpr size_t CHUNK_SIZE = 0x100000;
+/// Upper bound of the sections serialized with PointerWrap, to reject damaged sizes early
+constexpr u64 MAX_SECTION_SIZE = 0x4000000;
+
+struct SectionHeader {
+    std::array<char, 16> name;
+    u32_le version;
+    INSERT_PADDING_BYTES(4);
+    u64_le size;
+};
+static_assert(sizeof(SectionHeader) == 32, "SectionHeader has incorrect size");
+
+StateWriter::StateWriter(const std::string& path, const Header& header)
+    : file(path, "wb"),
+      compressor(std::make_unique<CryptoPP::ZlibCompressor>(nullptr, DEFLATE_LEVEL)),
+      scratch(CHUNK_SIZE) {
+    file.WriteObject(header);
+}
+
+StateWriter::~StateWriter() = default;
+
+void StateWriter::BeginSection(const char* name, u32 version, u64 size) {
+    SectionHeader section{};
+    std::strncpy(section.name.data(), name, section.name.size() - 1);
+    section.version = version;
+    section.size = size;
+    Write(&section, sizeof(section));
+}
+
+void StateWriter::Write(const void* data, size_t size) {
+    const u8* bytes = static_cast<const u8*>(data);
+    // The compressed data is written out after each chunk, so that it is never all held in memory
+    while (size > 0) {
+        const size_t chunk_size = std::min(size, CHUNK_SIZE);
+        compressor->Put(bytes, chunk_size);
+        Drain();
+        bytes += chunk_size;
+        size -= chunk_size;
+    }
+}
+
+void StateWriter::WriteSection(const char* name, u32 version,
+                               const std::function<void(PointerWrap&)>& do_state) {
+    u8* ptr = nullptr;
+    PointerWrap measure(&ptr, PointerWrap::MODE_MEASURE);
+    do_state(measure);
+    std::vector<u8> buffer(reinterpret_cast<size_t>(ptr));
+
+    ptr = buffer.data();
+    PointerWrap p(&ptr, PointerWrap::MODE_WRITE);
+    do_state(p);
+
+    BeginSection(name, version, buffer.size());
+    Write(buffer.data(), buffer.size());
+}
+
+bool StateWriter::Finish() {
+    compressor->MessageEnd();
+    Drain();
+    return file.Close();
+}
+
+void StateWriter::Drain() {
+    while (const size_t size = compressor->Get(scratch.data(), scratch.size())) {
+        file.WriteBytes(scratch.data(), size);
+    }
+}
+
+StateReader::StateReader(const std::string& path)
+    : file(path, "rb"), decompressor(std::make_unique<CryptoPP::ZlibDecompressor>()),
+      scratch(CHUNK_SIZE) {
+    is_open = file.IsOpen() && file.ReadBytes(&header, sizeof(header)) == sizeof(header);
+}
+
+StateReader::~StateReader() = default;
+
+s64 StateReader::BeginSection(const char* name, u32 version) {
+    SectionHeader section;
+    if (!Read(&section, sizeof(section))) {
+        return -1;
+    }
+
+    section.name.back() = '\0';
+    if (std::strcmp(section.name.data(), name) != 0 || section.version != version) {
+        LOG_ERROR(Core, "Expected section %s version %u, found section %s version %u", name,
+                  version, section.name.data(), static_cast<u32>(section.version));
+        return -1;
+    }
+    return static_cast<s64>(section.size);
+}
+
+bool StateReader::Read(void* data, size_t size) {
+    u8* bytes = static_cast<u8*>(data);
+    while (size > 0) {
+        if (decompressor->MaxRetrievable() == 0 && !Fill()) {
+            return false;
+        }
+        const size_t read_size = decompressor->Get(bytes, size);
+        bytes += read_size;
+        size -= read_size;
+    }
+    return true;
+}
+
+bool StateReader::ReadSection(const char* name, u32 version, std::vector<u8>& buffer) {
+    const s64 size = BeginSection(name, version);
+    if (size < 0 || static_cast<u64>(size) > MAX_SECTION_SIZE) {
+        return false;
+    }
+    buffer.resize(static_cast<size_t>(size));
+    return Read(buffer.data(), buffer.size());
+}
+
+bool StateReader::Finish() {
+    while (Fill()) {
+    }
+    return !corrupted && decompressor->MaxRetrievable() == 0;
+}
+
+bool StateReader::Fill() {
+    if (input_ended) {
+        return false;
+    }
+
+    try {
+        const size_t size = file.ReadBytes(scratch.data(), scratch.size());
+        if (size > 0) {
+            decompressor->Put(scratch.data(), size);
+        } else {
+            // This flushes the data held back by the decompressor and checks the stream is complete
+            decompressor->MessageEnd();
+            input_ended = true;
+        }
+    } catch (const CryptoPP::Exception& e) {
+        LOG_ERROR(Core, "Checkpoint is corrupted: %s", e.what());
+        input_ended = corrupted = true;
+        return false;
+    }
+    return true;
+}
+
+std::vector<MemoryBlock> GetMemoryBlocks() {
+    std::vector<MemoryBlock> blocks;
+
+    static constexpr std::array<std::pair<PAddr, u32>, 3> physical_areas{{
+        {Memory::VRAM_PADDR, Memory::VRAM_SIZE},
+        {Memory::DSP_RAM_PADDR, Memory::DSP_RAM_SIZE},
+        {Memory::N3DS_EXTRA_RAM_PADDR, Memory::N3DS_EXTRA_RAM_SIZE},
+    }};
+    for (const auto& area : physical_areas) {
+        blocks.push_back({area.first, area.second, Memory::GetPhysicalPointer(area.first)});
+    }
+
+    // The linear heaps hold most of FCRAM, and may be mapped into the process several times
+    std::set<const std::vector<u8>*> stored_blocks;
+    for (const auto& region : Kernel::memory_regions) {
+        std::vector<u8>& memory = *region.linear_heap_memory;
+        blocks.push_back({Memory::FCRAM_PADDR + region.base, static_cast<u32>(memory.size()),
+                          memory.data()});
+        stored_blocks.insert(&memory);
+    }
+
+    // The rest of the memory of the process: code, heap, stack, TLS and shared memory blocks
+    for (const auto& entry : Kernel::g_current_process->vm_manager.vma_map) {
+        const Kernel::VirtualMemoryArea& vma = entry.second;
+        if (vma.type != Kernel::VMAType::AllocatedMemoryBlock ||
+            !stored_blocks.insert(vma.backing_block.get()).second) {
+            continue;
+        }
+        std::vector<u8>& memory = *vma.backing_block;
+        blocks.push_back({vma.base, static_cast<u32>(memory.size()), memory.data()});
+    }
+    return blocks;
+}
+
+static void DoMemoryLayout(PointerWrap& p, std::vector<MemoryBlock>& blocks) {
+    u32 count = static_cast<u32>(blocks.size());
+    p.Do(count);
+    blocks.resize(count);
+    for (MemoryBlock& block : blocks) {
+        p.Do(block.address);
+        p.Do(block.size);
+    }
+}
+
+struct Component {
+    const char* name;
+    void (*do_state)(PointerWrap& p);
+};
+
+/// Components serialized with PointerWrap, in the order they are stored and restored in. The
+/// threads come first, so that whether they can be restored is known before anything is changed.
+static constexpr std::array<Component, 5> components{{
+    {"Threads", Kernel::DoThreadState},
+    {"CoreTiming", CoreTiming::DoState},
+    {"Hardware", HW::DoState},
+    {"Pica", Pica::DoState},
+    {"DSP", AudioCore::DoState},
+}};
+
+void DoComponentState(PointerWrap& p) {
+    for (const Component& component : components) {
+        component.do_state(p);
+    }
+}
+
+bool IsComponentStateRestorable(const std::vector<u8>& buffer) {
+    u8* ptr = const_cast<u8*>(buffer.data());
+    PointerWrap p(&ptr, PointerWrap::MODE_READ);
+    return Kernel::IsThreadStateRestorable(p);
+}
+
+std::vector<u8> Compress(const void* data, size_t size) {
+    CryptoPP::ZlibCompressor compressor(nullptr, DEFLATE_LEVEL);
+    compressor.Put(static_cast<const u8*>(data), size);
+    compressor.MessageEnd();
+
+    std::vector<u8> compressed(static_cast<size_t>(compressor.MaxRetrievable()));
+    compressor.Get(compressed.data(), compressed.size());
+    return compressed;
+}
+
+bool Decompress(const std::vector<u8>& compressed, std::vector<u8>& data) {
+    try {
+        CryptoPP::ZlibDecompressor decompressor;
+        decompressor.Put(compressed.data(), compressed.size());
+        decompressor.MessageEnd();
+
+        data.resize(static_cast<size_t>(decompressor.MaxRetrievable()));
+        decompressor.Get(data.data(), data.size());
+    } catch (const CryptoPP::Exception& e) {
+        LOG_ERROR(Core, "Compressed state is corrupted: %s", e.what());
+        return false;
+    }
+    return true;
+}
+
+static double MillisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+        .count();
+}
+
+ResultStatus Save(const std::string& path) {
+    System& system = System::GetInstance();
+    if (!system.IsPoweredOn()) {
+        return ResultStatus::ErrorNotPoweredOn;
+    }
+    const auto start = std::chrono::steady_clock::now();
+
+    u64 program_id = 0;
+    system.GetAppLoader().ReadProgramId(program_id);
+    Header header{};
+    header.magic = MAGIC;
+    header.version = VERSION;
+    header.program_id = program_id;
+    header.ticks = CoreTiming::GetTicks();
+
+    FileUtil::CreateFullPath(path);
+    StateWriter writer(path, header);
+    if (!writer.IsOpen()) {
+        LOG_ERROR(Core, "Could not open %s to save the state", path.c_str());
+        return ResultStatus::ErrorFile;
+    }
+
+    // Surfaces cached by the rasterizer are written back, so that the memory is up to date
+    Memory::RasterizerFlushRegion(Memory::VRAM_PADDR, Memory::VRAM_SIZE);
+    Memory::RasterizerFlushRegion(Memory::FCRAM_PADDR, Memory::FCRAM_N3DS_SIZE);
+
+    for (const Component& component : components) {
+        writer.WriteSection(component.name, 1, component.do_state);
+    }
+
+    std::vector<MemoryBlock> blocks = GetMemoryBlocks();
+    writer.WriteSection("MemoryLayout", 1,
+                        [&blocks](PointerWrap& p) { DoMemoryLayout(p, blocks); });
+    u64 memory_size = 0;
+    for (const MemoryBlock& block : blocks) {
+        memory_size += block.size;
+    }
+    writer.BeginSection("Memory", 1, memory_size);
+    for (const MemoryBlock& block : blocks) {
+        writer.Write(block.data, block.size);
+    }
+
+    if (!writer.Finish()) {
+        LOG_ERROR(Core, "Could not write the state to %s", path.c_str());
+        return ResultStatus::ErrorFile;
+    }
+    LOG_INFO(Core, "Saved the state to %s in %.1f ms", path.c_str(), MillisecondsSince(start));
+    return ResultStatus::Success;
+}
+
+ResultStatus Load(const std::string& path) {
+    System& system = System::GetInstance();
+    if (!system.IsPoweredOn()) {
+        return ResultStatus::ErrorNotPoweredOn;
+    }
+    const auto start = std::chrono::steady_clock::now();
+
+    StateReader reader(path);
+    if (!reader.IsOpen()) {
+        LOG_ERROR(Core, "Could not open the state %s", path.c_str());
+        return ResultStatus::ErrorFile;
+    }
+    const Header& header = reader.GetHeader();
+    if (header.magic != MAGIC || header.version != VERSION) {
+        LOG_ERROR(Core, "%s isn't a checkpoint of version %u", path.c_str(), VERSION);
+        return ResultStatus::ErrorInvalidFormat;
+    }
+    u64 program_id = 0;
+    system.GetAppLoader().ReadProgramId(program_id);
+    if (header.program_id != program_id) {
+        LOG_ERROR(Core, "The state was saved from the application %016" PRIX64,
+                  static_cast<u64>(header.program_id));
+        return ResultStatus::ErrorWrongTitle;
+    }
+
+    // The whole state is read and verified before anything is changed
+    std::array<std::vector<u8>, components.size()> buffers;
+    for (size_t i = 0; i < components.size(); ++i) {
+        if (!reader.ReadSection(components[i].name, 1, buffers[i])) {
+            return ResultStatus::ErrorCorrupted;
+        }
+    }
+
+    if (!IsComponentStateRestorable(buffers[0])) {
+        LOG_ERROR(Core, "The threads of the application are in another state than in the state");
+        return ResultStatus::ErrorKernelState;
+    }
+
+    std::vector<u8> layout_buffer;
+    if (!reader.ReadSection("MemoryLayout", 1, layout_buffer)) {
+        return ResultStatus::ErrorCorrupted;
+    }
+    std::vector<MemoryBlock> saved_blocks;
+    u8* layout_ptr = layout_buffer.data();
+    PointerWrap layout(&layout_ptr, PointerWrap::MODE_READ);
+    DoMemoryLayout(layout, saved_blocks);
+    if (layout.error == PointerWrap::ERROR_FAILURE) {
+        return ResultStatus::ErrorCorrupted;
+    }
+
+    const std::vector<MemoryBlock> blocks = GetMemoryBlocks();
+    const bool same_layout =
+        std::equal(blocks.begin(), blocks.end(), saved_blocks.begin(), saved_blocks.end(),
+                   [](const MemoryBlock& a, const MemoryBlock& b) {
+                       return a.address == b.address && a.size == b.size;
+                   });
+    if (!same_layout) {
+        LOG_ERROR(Core, "The memory of the application was laid out differently in the state");
+        return ResultStatus::ErrorMemoryLayout;
+    }
+
+    u64 memory_size = 0;
+    for (const MemoryBlock& block : blocks) {
+        memory_size += block.size;
+    }
+    if (reader.BeginSection("Memory", 1) != static_cast<s64>(memory_size)) {
+        return ResultStatus::ErrorCorrupted;
+    }
+    std::vector<std::vector<u8>> memory(blocks.size());
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        memory[i].resize(blocks[i].size);
+        if (!reader.Read(memory[i].data(), memory[i].size())) {
+            return ResultStatus::ErrorCorrupted;
+        }
+    }
+    if (!reader.Finish()) {
+        return ResultStatus::ErrorCorrupted;
+    }
+
+    // The surfaces cached by the rasterizer are dropped, as they would be out of date
+    Memory::RasterizerFlushAndInvalidateRegion(Memory::VRAM_PADDR, Memory::VRAM_SIZE);
+    Memory::RasterizerFlushAndInvalidateRegion(Memory::FCRAM_PADDR, Memory::FCRAM_N3DS_SIZE);
+    // The snapshots for rewinding were taken from the state being replaced, whose memory is
+    // written below without the write tracking noticing
+    system.snapshot_ring.Clear();
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        std::memcpy(blocks[i].data, memory[i].data(), memory[i].size());
+    }
+
+    for (size_t i = 0; i < components.size(); ++i) {
+        u8* ptr = buffers[i].data();
+        PointerWrap p(&ptr, PointerWrap::MODE_READ);
+        components[i].do_state(p);
+        if (p.error == PointerWrap::ERROR_FAILURE || ptr != buffers[i].data() + buffers[i].size()) {
+            // The sections passed the checksum, so this is a bug in a DoState function
+            LOG_CRITICAL(Core, "Could not restore %s, the emulation is in an undefined state",
+                         components[i].name);
+            return ResultStatus::ErrorCorrupted;
+        }
+    }
+    CPU().ClearInstructionCache();
+
+    LOG_INFO(Core, "Loaded the state %s in %.1f ms", path.c_str(), MillisecondsSince(start));
+    return ResultStatus::Success;
+}
+
+} // namespace Checkpoint
+} // namespace Core
@@ -0,0 +1,192 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "common/common_funcs.h"
+#include "common/common_types.h"
+#include "common/file_util.h"
+#include "common/swap.h"
+
+class PointerWrap;
+
+namespace CryptoPP {
+class ZlibCompressor;
+class ZlibDecompressor;
+} // namespace CryptoPP
+
+/**
+ * Checkpoints: snapshots of the emulated system taken while the emulation is paused (between two
+ * calls to System::RunLoop), written to a file and restored later in the same session.
+ *
+ * A checkpoint file begins with an uncompressed Header, followed by a single zlib stream holding a
+ * sequence of sections. Each section has a name, a version and a size, and is either serialized
+ * with PointerWrap (the small components) or streamed as raw bytes (the emulated memory), so that
+ * saving never needs a second copy of the memory.
+ *
+ * The state covers the emulated memory, the CoreTiming queue, the registers of the threads, the
+ * GPU, LCD and PICA state and the HLE DSP. Kernel objects and the state of the HLE services are not
+ * serialized: they are kept as they are when a checkpoint is loaded. A checkpoint is therefore only
+ * loaded into the session it was saved from, while the memory layout of the application is
+ * unchanged and its threads are the same ones, in the same state (running, ready or waiting on the
+ * same objects). This suits rewinding and retrying from a point of the same run. These aren't save
+ * states: starting a new session from a checkpoint isn't supported, and is refused rather than
+ * resuming with mismatched kernel objects, so the frontends don't offer to load them from files.
+ */
+namespace Core {
+namespace Checkpoint {
+
+/// Version of the state format, to be bumped whenever the layout of any section changes
+constexpr u32 VERSION = 2;
+
+enum class ResultStatus {
+    Success,
+    ErrorNotPoweredOn,  ///< No application is running
+    ErrorFile,          ///< The file couldn't be opened, read or written
+    ErrorInvalidFormat, ///< The file isn't a checkpoint, or was made by another version
+    ErrorWrongTitle,    ///< The state was saved from another application
+    ErrorMemoryLayout,  ///< The memory of the running application doesn't match the state
+    ErrorCorrupted,     ///< The compressed stream or one of its sections is damaged
+    ErrorKernelState,   ///< The threads of the application aren't in the state that was saved
+};
+
+struct Header {
+    u32_le magic;
+    u32_le version;
+    u64_le program_id;
+    /// Emulated CPU ticks when the state was saved
+    u64_le ticks;
+    INSERT_PADDING_BYTES(8);
+};
+static_assert(sizeof(Header) == 32, "Header has incorrect size");
+
+/// Writes a checkpoint file section by section, compressing the sections on the fly
+class StateWriter {
+public:
+    StateWriter(const std::string& path, const Header& header);
+    ~StateWriter();
+
+    bool IsOpen() const {
+        return file.IsOpen();
+    }
+
+    /**
+     * Begins a section of the given size, whose contents are then written with Write.
+     * @param name Name of the section, of at most 15 characters
+     */
+    void BeginSection(const char* name, u32 version, u64 size);
+
+    /// Writes the contents of the current section
+    void Write(const void* data, size_t size);
+
+    /// Writes a whole section with a DoState function
+    void WriteSection(const char* name, u32 version,
+                      const std::function<void(PointerWrap&)>& do_state);
+
+    /// Ends the compressed stream. Returns whether the whole file was written successfully.
+    bool Finish();
+
+private:
+    /// Writes the compressed data available to the file
+    void Drain();
+
+    FileUtil::IOFile file;
+    std::unique_ptr<CryptoPP::ZlibCompressor> compressor;
+    std::vector<u8> scratch;
+};
+
+/// Reads a checkpoint file section by section, decompressing the sections on the fly
+class StateReader {
+public:
+    explicit StateReader(const std::string& path);
+    ~StateReader();
+
+    /// Returns whether the file was opened and has a complete header
+    bool IsOpen() const {
+        return is_open;
+    }
+
+    const Header& GetHeader() const {
+        return header;
+    }
+
+    /**
+     * Begins reading the next section, which must have the given name and version.
+     * @returns the size of the section, or -1 if the next section isn't the expected one
+     */
+    s64 BeginSection(const char* name, u32 version);
+
+    /// Reads contents of the current section. Returns false if the stream is truncated or damaged.
+    bool Read(void* data, size_t size);
+
+    /// Reads a whole section into a buffer, for a DoState function to read it afterwards
+    bool ReadSection(const char* name, u32 version, std::vector<u8>& buffer);
+
+    /**
+     * Checks that the compressed stream ends after the last section. This also verifies the
+     * checksum of the stream, so the contents read can only be trusted after this succeeded.
+     */
+    bool Finish();
+
+private:
+    /// Feeds the next part of the file to the decompressor. Returns false once all of it was fed.
+    bool Fill();
+
+    FileUtil::IOFile file;
+    std::unique_ptr<CryptoPP::ZlibDecompressor> decompressor;
+    std::vector<u8> scratch;
+    Header header{};
+    bool is_open = false;
+    /// Whether the whole file was fed to the decompressor
+    bool input_ended = false;
+    /// Whether the decompressor found the stream to be damaged
+    bool corrupted = false;
+};
+
+/// Block of emulated memory stored in a state
+struct MemoryBlock {
+    /// Physical address of the memory that isn't owned by the process, otherwise the first virtual
+    /// address the block is mapped at. This tells the blocks apart when a state is loaded.
+    u32 address;
+    u32 size;
+    u8* data;
+};
+
+/// Returns the emulated memory stored in states, in a deterministic order
+std::vector<MemoryBlock> GetMemoryBlocks();
+
+/// Serializes the state of everything but the emulated memory
+void DoComponentState(PointerWrap& p);
+
+/**
+ * Checks that state serialized by DoComponentState can be restored into the running application,
+ * whose kernel objects must be in the state they were saved in.
+ */
+bool IsComponentStateRestorable(const std::vector<u8>& buffer);
+
+/// Compresses data into a zlib stream
+std::vector<u8> Compress(const void* data, size_t size);
+
+/// Decompresses a zlib stream. Returns false if the stream is damaged.
+bool Decompress(const std::vector<u8>& compressed, std::vector<u8>& data);
+
+/**
+ * Saves the state of the running application.
+ * @note This must only be called from the emulation thread, while the emulation is paused.
+ */
+ResultStatus Save(const std::string& path);
+
+/**
+ * Loads a state saved from the running application. Nothing is changed unless the whole file
+ * could be read and verified.
+ * @note This must only be called from the emulation thread, while the emulation is paused.
+ */
+ResultStatus Load(const std::string& path);
+
+} // namespace Checkpoint
+} // namespace Core
@@ -2,6 +2,8 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <cinttypes>
 #include <memory>
 #include <utility>
 #include "audio_core/audio_core.h"
@@ -15,6 +17,7 @@
 #include "core/hle/kernel/kernel.h"
 #include "core/hle/kernel/process.h"
 #include "core/hle/kernel/thread.h"
+#include "core/hle/lock.h"
 #include "core/hle/service/service.h"
 #include "core/hw/hw.h"
 #include "core/loader/loader.h"
@@ -62,22 +65,78 @@ System::ResultStatus System::RunLoop(int tight_loop) {
     HW::Update();
     Reschedule();
 
+    if (state_request != StateRequest::None) {
+        HandleStateRequest();
+    }
+
+    // Snapshots are taken between two runs of the CPU, where the whole state is consistent
+    if (Settings::values.snapshot_interval != 0 && CoreTiming::GetTicks() >= next_snapshot_ticks) {
+        snapshot_ring.Take();
+        ScheduleNextSnapshot();
+    }
+
     return status;
 }
 
+void System::RequestRewind() {
+    state_request = StateRequest::Rewind;
+}
+
+void System::ScheduleNextSnapshot() {
+    const int interval = static_cast<int>(Settings::values.snapshot_interval);
+    next_snapshot_ticks = CoreTiming::GetTicks() + msToCycles(interval);
+}
+
+void System::Rewind() {
+    const size_t count = snapshot_ring.GetCount();
+    if (count == 0) {
+        LOG_WARNING(Core, "No snapshot to rewind to");
+        return;
+    }
+    // The newest snapshot may have been taken just now, so the one before it is restored
+    const size_t index = count >= 2 ? count - 2 : 0;
+    const u64 ticks = CoreTiming::GetTicks();
+    if (!snapshot_ring.Restore(index)) {
+        LOG_WARNING(Core, "Could not rewind to the snapshot");
+        return;
+    }
+    LOG_INFO(Core, "Rewound by %.2f s", static_cast<double>(ticks - CoreTiming::GetTicks()) /
+                                            BASE_CLOCK_RATE_ARM11);
+    // The snapshot restored stays the newest one until the next interval
+    ScheduleNextSnapshot();
+}
+
+void System::HandleStateRequest() {
+    switch (state_request.exchange(StateRequest::None)) {
+    case StateRequest::Rewind:
+        Rewind();
+        break;
+    case StateRequest::None:
+        break;
+    }
+}
+
 System::ResultStatus System::SingleStep() {
     return RunLoop(1);
 }
 
 System::ResultStatus System::Load(EmuWindow* emu_window, const std::string& filepath) {
-    app_loader = Loader::GetLoader(filepath);
+    boot_profiler.Begin();
+    BootProfiler::Scope load_scope(boot_profiler, "System::Load");
+
+    {
+        BootProfiler::Scope profile_scope(boot_profiler, "Loader::GetLoader");
+        app_loader = Loader::GetLoader(filepath);
+    }
 
     if (!app_loader) {
         LOG_CRITICAL(Core, "Failed to obtain loader for %s!", filepath.c_str());
         return ResultStatus::ErrorGetLoader;
     }
-    std::pair<boost::optional<u32>, Loader::ResultStatus> system_mode =
-        app_loader->LoadKernelSystemMode();
+    std::pair<boost::optional<u32>, Loader::ResultStatus> system_mode = [&] {
+        BootProfiler::Scope profile_scope(boot_profiler, "AppLoader::LoadKernelSystemMode");
+        return app_loader->LoadKernelSystemMode();
+    }();
 
     if (system_mode.second != Loader::ResultStatus::Success) {
         LOG_CRITICAL(Core, "Failed to determine system mode (Error %i)!",
@@ -101,7 +160,10 @@ System::ResultStatus System::Load(EmuWindow* emu_window, const std::string& file
         return init_result;
     }
 
-    const Loader::ResultStatus load_result{app_loader->Load(Kernel::g_current_process)};
+    const Loader::ResultStatus load_result = [&] {
+        BootProfiler::Scope profile_scope(boot_profiler, "AppLoader::Load");
+        return app_loader->Load(Kernel::g_current_process);
+    }();
     if (Loader::ResultStatus::Success != load_result) {
         LOG_CRITICAL(Core, "Failed to load ROM (Error %i)!", load_result);
         System::Shutdown();
@@ -116,6 +178,7 @@ System::ResultStatus System::Load(EmuWindow* emu_window, const std::string& file
         }
     }
     Memory::SetCurrentPageTable(&Kernel::g_current_process->vm_manager.page_table);
+
     status = ResultStatus::Success;
     return status;
 }
@@ -125,6 +188,10 @@ void System::PrepareReschedule() {
     reschedule_pending = true;
 }
 
+void System::SetCPU(std::unique_ptr<ARM_Interface> cpu) {
+    cpu_core = std::move(cpu);
+}
+
 PerfStats::Results System::GetAndResetPerfStats() {
     return perf_stats.GetAndResetStats(CoreTiming::GetGlobalTimeUs());
 }
@@ -139,6 +206,7 @@ void System::Reschedule() {
 }
 
 System::ResultStatus System::Init(EmuWindow* emu_window, u32 system_mode) {
+    BootProfiler::Scope init_scope(boot_profiler, "System::Init");
     LOG_DEBUG(HW_Memory, "initialized OK");
 
     if (Settings::values.use_cpu_jit) {
@@ -151,17 +219,33 @@ System::ResultStatus System::Init(EmuWindow* emu_window, u32 system_mode) {
 
     CoreTiming::Init();
     HW::Init();
-    Kernel::Init(system_mode);
-    Service::Init();
-    AudioCore::Init();
+    {
+        BootProfiler::Scope profile_scope(boot_profiler, "Kernel::Init");
+        Kernel::Init(system_mode);
+    }
+    {
+        BootProfiler::Scope profile_scope(boot_profiler, "Service::Init");
+        Service::Init();
+    }
+    {
+        BootProfiler::Scope profile_scope(boot_profiler, "AudioCore::Init");
+        AudioCore::Init();
+    }
     GDBStub::Init();
 
-    if (!VideoCore::Init(emu_window)) {
-        return ResultStatus::ErrorVideoCore;
+    {
+        BootProfiler::Scope profile_scope(boot_profiler, "VideoCore::Init");
+        if (!VideoCore::Init(emu_window)) {
+            return ResultStatus::ErrorVideoCore;
+        }
     }
 
     LOG_DEBUG(Core, "Initialized OK");
 
+    snapshot_ring.SetBudget(static_cast<size_t>(Settings::values.snapshot_budget) * 1024 * 1024);
+    next_snapshot_ticks = 0;
+    state_request = StateRequest::None;
+
     // Reset counters and set time origin to current frame
     GetAndResetPerfStats();
     perf_stats.BeginSystemFrame();
@@ -178,8 +262,28 @@ void System::Shutdown() {
                          perf_results.game_fps);
     Telemetry().AddField(Telemetry::FieldType::Performance, "Shutdown_Frametime",
                          perf_results.frametime * 1000.0);
+    Telemetry().AddField(Telemetry::FieldType::Performance, "Shutdown_ContextSwitchRate",
+                         perf_results.context_switch_rate);
+    Telemetry().AddField(Telemetry::FieldType::Performance, "Shutdown_ContextSwitchTime",
+                         perf_results.context_switch_time * 1000000.0);
+    Telemetry().AddField(Telemetry::FieldType::Performance, "Shutdown_SkippedFrames",
+                         perf_results.skipped_frames);
+    Telemetry().AddField(Telemetry::FieldType::Performance, "Shutdown_PacingErrorMax",
+                         perf_results.pacing_error_max * 1000.0);
+    if (cpu_core) {
+        const u64 skipped_cycles = cpu_core->GetIdleLoopSkippedCycles();
+        u64 program_id = 0;
+        app_loader->ReadProgramId(program_id);
+        LOG_INFO(Core, "Skipped %" PRIu64 " cycles in idle loops (%.1f%%) running %016" PRIX64,
+                 skipped_cycles, 100.0 * skipped_cycles / std::max<u64>(CoreTiming::GetTicks(), 1),
+                 program_id);
+        Telemetry().AddField(Telemetry::FieldType::Performance, "Shutdown_IdleLoopSkippedCycles",
+                             skipped_cycles);
+    }
+    HLE::LogLockStats();
 
     // Shutdown emulation session
+    snapshot_ring.Clear();
     GDBStub::Shutdown();
     AudioCore::Shutdown();
     VideoCore::Shutdown();
@@ -4,12 +4,16 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include "common/common_types.h"
+#include "core/boot_profiler.h"
+#include "core/frame_profiler.h"
 #include "core/loader/loader.h"
 #include "core/memory.h"
 #include "core/perf_stats.h"
+#include "core/snapshot_ring.h"
 #include "core/telemetry_session.h"
 
 class EmuWindow;
@@ -94,6 +98,14 @@ public:
 
     PerfStats::Results GetAndResetPerfStats();
 
+    /**
+     * Asks for the application to be rewound to the snapshot taken before the newest one (see
+     * SnapshotRing). This can be called from any thread: the snapshot is restored by the emulation
+     * thread between two runs of the CPU, and the outcome is logged. Asking again rewinds further
+     * back.
+     */
+    void RequestRewind();
+
     /**
      * Gets a reference to the emulated CPU.
      * @returns A reference to the emulated CPU.
@@ -102,8 +114,19 @@ public:
         return *cpu_core;
     }
 
+    /**
+     * Replaces the emulated CPU without initializing the rest of the system. This lets tests run
+     * the kernel, which saves and loads thread contexts, without loading an application.
+     * @param cpu The CPU to use, or nullptr to remove it
+     */
+    void SetCPU(std::unique_ptr<ARM_Interface> cpu);
+
     PerfStats perf_stats;
     FrameLimiter frame_limiter;
+    FrameSkipper frame_skipper;
+    BootProfiler boot_profiler;
+    FrameProfiler frame_profiler;
+    SnapshotRing snapshot_ring;
 
     void SetStatus(ResultStatus new_status, const char* details = nullptr) {
         status = new_status;
@@ -132,6 +155,17 @@ private:
     /// Reschedule the core emulation
     void Reschedule();
 
+    enum class StateRequest { None, Rewind };
+
+    /// Handles the state request made by the frontend, if any
+    void HandleStateRequest();
+
+    /// Restores the snapshot taken before the newest one
+    void Rewind();
+
+    /// Sets when the next snapshot for rewinding is due, from the snapshot interval setting
+    void ScheduleNextSnapshot();
+
     /// AppLoader used to load the current executing application
     std::unique_ptr<Loader::AppLoader> app_loader;
 
@@ -141,6 +175,12 @@ private:
     /// When true, signals that a reschedule should happen
     bool reschedule_pending{};
 
+    /// CPU ticks at which the next snapshot for rewinding is due
+    u64 next_snapshot_ticks = 0;
+
+    /// State request made by the frontend, handled by the emulation thread
+    std::atomic<StateRequest> state_request{StateRequest::None};
+
     /// Telemetry session for this emulation session
     std::unique_ptr<Core::TelemetrySession> telemetry_session;
 
@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <atomic>
 #include <cinttypes>
 #include <mutex>
@@ -54,6 +55,7 @@ int g_slice_length;
 
 static s64 global_timer;
 static s64 idled_cycles;
+static u64 executed_events;
 static s64 last_global_time_ticks;
 static s64 last_global_time_us;
 
@@ -153,6 +155,7 @@ void Init() {
     g_slice_length = INITIAL_SLICE_LENGTH;
     global_timer = 0;
     idled_cycles = 0;
+    executed_events = 0;
     last_global_time_ticks = 0;
     last_global_time_us = 0;
     has_ts_events = 0;
@@ -203,6 +206,10 @@ u64 GetIdleTicks() {
     return (u64)idled_cycles;
 }
 
+u64 GetExecutedEventCount() {
+    return executed_events;
+}
+
 // This is to be called when outside threads, such as the graphics thread, wants to
 // schedule things to be executed on the main thread.
 void ScheduleEvent_Threadsafe(s64 cycles_into_future, int event_type, u64 userdata) {
@@ -439,6 +446,7 @@ void ProcessFifoWaitEvents() {
         if (first->time <= (s64)GetTicks()) {
             Event* evt = first;
             first = first->next;
+            ++executed_events;
             event_types[evt->type].callback(evt->userdata, (int)(GetTicks() - evt->time));
             FreeEvent(evt);
         } else {
@@ -559,4 +567,47 @@ std::string GetScheduledEventsSummary() {
     return text;
 }
 
+static void Event_DoState(PointerWrap& p, BaseEvent* event) {
+    p.Do(event->time);
+    p.Do(event->userdata);
+
+    // Event type ids depend on the order the types were registered in, so the name is stored
+    std::string name;
+    if (p.GetMode() != PointerWrap::MODE_READ) {
+        name = event_types[event->type].name;
+    }
+    p.Do(name);
+    if (p.GetMode() != PointerWrap::MODE_READ) {
+        return;
+    }
+
+    auto type = std::find_if(event_types.begin(), event_types.end(),
+                             [&name](const EventType& type) { return name == type.name; });
+    if (type == event_types.end()) {
+        LOG_ERROR(Core_Timing, "Savestate broken: unknown event type %s", name.c_str());
+        p.SetError(PointerWrap::ERROR_FAILURE);
+        return;
+    }
+    event->type = static_cast<int>(type - event_types.begin());
+}
+
+void DoState(PointerWrap& p) {
+    std::lock_guard<std::recursive_mutex> lock(external_event_section);
+    auto s = p.Section("CoreTiming", 1);
+    if (!s)
+        return;
+
+    // Thread-safe events are merged into the queue first, so only one queue has to be stored
+    MoveEvents();
+    p.DoLinkedList<BaseEvent, GetNewEvent, FreeEvent, Event_DoState>(first);
+
+    p.Do(g_clock_rate_arm11);
+    p.Do(g_slice_length);
+    p.Do(global_timer);
+    p.Do(idled_cycles);
+    p.Do(last_global_time_ticks);
+    p.Do(last_global_time_us);
+    p.Do(down_count);
+}
+
 } // namespace
@@ -8,6 +8,8 @@
 #include <string>
 #include "common/common_types.h"
 
+class PointerWrap;
+
 // This is a system to schedule events into the emulated machine's future. Time is measured
 // in main CPU clock cycles.
 
@@ -77,6 +79,9 @@ u64 GetTicks();
 u64 GetIdleTicks();
 u64 GetGlobalTimeUs();
 
+/// Returns the number of events run so far, which tells whether any ran during a period
+u64 GetExecutedEventCount();
+
 /**
  * Registers an event type with the specified name and callback
  * @param name Name of the event type
@@ -131,6 +136,9 @@ void ClearPendingEvents();
 
 void LogPendingEvents();
 
+/// Serializes the clock and the scheduled events, for checkpoints. Events are matched by name.
+void DoState(PointerWrap& p);
+
 /// Warning: not included in save states.
 void RegisterAdvanceCallback(void (*callback)(int cycles_executed));
 void RegisterMHzChangeCallback(MHzChangeCallback callback);
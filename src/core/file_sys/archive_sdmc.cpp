@@ -17,6 +17,10 @@
 
 namespace FileSys {
 
+SDMCArchive::~SDMCArchive() {
+    LogFileCacheStats(GetName(), *cache_stats);
+}
+
 ResultVal<std::unique_ptr<FileBackend>> SDMCArchive::OpenFile(const Path& path,
                                                               const Mode& mode) const {
     Mode modified_mode;
@@ -82,8 +86,8 @@ ResultVal<std::unique_ptr<FileBackend>> SDMCArchive::OpenFileBase(const Path& pa
         return ERROR_NOT_FOUND;
     }
 
-    auto disk_file = std::make_unique<DiskFile>(std::move(file), mode);
-    return MakeResult<std::unique_ptr<FileBackend>>(std::move(disk_file));
+    return MakeResult<std::unique_ptr<FileBackend>>(
+        MakeCachedDiskFile(std::move(file), mode, full_path, cache_stats));
 }
 
 ResultCode SDMCArchive::DeleteFile(const Path& path) const {
@@ -7,6 +7,7 @@
 #include <memory>
 #include <string>
 #include "core/file_sys/archive_backend.h"
+#include "core/file_sys/cached_file.h"
 #include "core/hle/result.h"
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -18,6 +19,7 @@ namespace FileSys {
 class SDMCArchive : public ArchiveBackend {
 public:
     explicit SDMCArchive(const std::string& mount_point_) : mount_point(mount_point_) {}
+    ~SDMCArchive() override;
 
     std::string GetName() const override {
         return "SDMCArchive: " + mount_point;
@@ -38,6 +40,7 @@ public:
 protected:
     ResultVal<std::unique_ptr<FileBackend>> OpenFileBase(const Path& path, const Mode& mode) const;
     std::string mount_point;
+    std::shared_ptr<FileCacheStats> cache_stats = std::make_shared<FileCacheStats>();
 };
 
 /// File system interface to the SDMC archive
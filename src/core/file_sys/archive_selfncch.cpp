@@ -172,8 +172,9 @@ public:
 private:
     ResultVal<std::unique_ptr<FileBackend>> OpenRomFS() const {
         if (ncch_data.romfs_file) {
-            return MakeResult<std::unique_ptr<FileBackend>>(std::make_unique<IVFCFile>(
-                ncch_data.romfs_file, ncch_data.romfs_offset, ncch_data.romfs_size));
+            return MakeResult<std::unique_ptr<FileBackend>>(
+                std::make_unique<IVFCFile>(ncch_data.romfs_file, ncch_data.romfs_mapping,
+                                           ncch_data.romfs_offset, ncch_data.romfs_size));
         } else {
             LOG_INFO(Service_FS, "Unable to read RomFS");
             return ERROR_ROMFS_NOT_FOUND;
@@ -183,8 +184,8 @@ private:
     ResultVal<std::unique_ptr<FileBackend>> OpenUpdateRomFS() const {
         if (ncch_data.update_romfs_file) {
             return MakeResult<std::unique_ptr<FileBackend>>(std::make_unique<IVFCFile>(
-                ncch_data.update_romfs_file, ncch_data.update_romfs_offset,
-                ncch_data.update_romfs_size));
+                ncch_data.update_romfs_file, ncch_data.update_romfs_mapping,
+                ncch_data.update_romfs_offset, ncch_data.update_romfs_size));
         } else {
             LOG_INFO(Service_FS, "Unable to read update RomFS");
             return ERROR_ROMFS_NOT_FOUND;
@@ -252,6 +253,7 @@ void ArchiveFactory_SelfNCCH::Register(Loader::AppLoader& app_loader) {
     if (Loader::ResultStatus::Success ==
         app_loader.ReadRomFS(romfs_file_, data.romfs_offset, data.romfs_size)) {
 
+        data.romfs_mapping = MapRomFS(romfs_file_, data.romfs_offset, data.romfs_size);
         data.romfs_file = std::move(romfs_file_);
     }
 
@@ -260,6 +262,8 @@ void ArchiveFactory_SelfNCCH::Register(Loader::AppLoader& app_loader) {
         app_loader.ReadUpdateRomFS(update_romfs_file, data.update_romfs_offset,
                                    data.update_romfs_size)) {
 
+        data.update_romfs_mapping =
+            MapRomFS(update_romfs_file, data.update_romfs_offset, data.update_romfs_size);
         data.update_romfs_file = std::move(update_romfs_file);
     }
 
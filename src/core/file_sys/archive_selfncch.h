@@ -23,10 +23,12 @@ struct NCCHData {
     std::shared_ptr<std::vector<u8>> logo;
     std::shared_ptr<std::vector<u8>> banner;
     std::shared_ptr<FileUtil::IOFile> romfs_file;
+    std::shared_ptr<const FileUtil::FileMapping> romfs_mapping;
     u64 romfs_offset = 0;
     u64 romfs_size = 0;
 
     std::shared_ptr<FileUtil::IOFile> update_romfs_file;
+    std::shared_ptr<const FileUtil::FileMapping> update_romfs_mapping;
     u64 update_romfs_offset = 0;
     u64 update_romfs_size = 0;
 };
@@ -0,0 +1,659 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cinttypes>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <list>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "common/assert.h"
+#include "common/logging/log.h"
+#include "common/thread.h"
+#include "core/file_sys/cached_file.h"
+#include "core/file_sys/errors.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// FileSys namespace
+
+namespace FileSys {
+
+/// A block of the file, with the data past its valid size zeroed
+struct CachedBlock {
+    u64 index;
+    std::vector<u8> data;
+    size_t size;
+    bool dirty;
+};
+
+/**
+ * The state of the cached file, shared by its CachedFile handles and with the read-ahead thread.
+ * Blocks are loaded with backend_mutex held for the whole load, so a block can't be loaded twice
+ * and blocks which are being written back can't be read from the backend in the meantime.
+ */
+class BlockCache : public std::enable_shared_from_this<BlockCache> {
+public:
+    BlockCache(const FileCacheConfig& config_, std::shared_ptr<FileCacheStats> stats_)
+        : config(config_), stats(std::move(stats_)) {
+        ASSERT(config.block_size != 0 && config.capacity != 0);
+    }
+
+    /// Adds a handle to the file, whose backend may then be used to access it
+    void Attach(const FileBackend& handle_backend, bool writable);
+
+    /// Removes a handle, first writing the dirty blocks back if they would go through its backend.
+    /// Once all handles are removed, the cached blocks are dropped and reading ahead stops.
+    void Detach(const FileBackend& handle_backend);
+
+    ResultVal<size_t> Read(u64 offset, size_t length, u8* buffer);
+    ResultVal<size_t> Write(u64 offset, size_t length, bool flush, const u8* buffer);
+    u64 GetSize();
+    bool SetSize(u64 size);
+    void Flush();
+
+    /// Loads the blocks in [first_block, end_block) which aren't cached yet. Called by the
+    /// read-ahead thread.
+    void ReadAhead(u64 first_block, u64 end_block);
+
+private:
+    using BlockList = std::list<CachedBlock>;
+
+    struct Handle {
+        const FileBackend* backend;
+        bool writable;
+    };
+
+    /// Picks the backend the file is accessed through. Requires both mutexes to be held.
+    void ChooseBackend();
+
+    /**
+     * Calls a function on each part of [offset, offset + length) which falls in a single block.
+     * @param func Function taking the block index, the offset within the block, the offset within
+     *             the range and the size of the part, and returning a ResultCode
+     */
+    template <typename Func>
+    ResultCode ForEachBlock(u64 offset, size_t length, Func&& func);
+
+    /**
+     * Calls a function on a block with `mutex` held, loading the block first if needed
+     * @param overwritten_size Size of the data at the start of the block which the function
+     *                         overwrites. The block isn't read from the backend if it's all of it.
+     */
+    template <typename Func>
+    ResultCode AccessBlock(u64 index, size_t overwritten_size, Func&& func);
+
+    /**
+     * Reads blocks which aren't cached from the backend, with a single read, and adds them to the
+     * cache. Requires backend_mutex to be held and `lock` to hold `mutex`, which is released while
+     * the backend is read from.
+     */
+    ResultCode LoadBlocks(u64 first_block, size_t count, std::unique_lock<std::mutex>& lock);
+
+    /// Removes the least recently used block and returns its storage. Requires both mutexes.
+    std::vector<u8> EvictBlock();
+
+    /// Removes all the blocks, which must have been written back. Requires `mutex` to be held.
+    void DropBlocks();
+
+    /// Returns the size of the data of a block in the file. Requires `mutex` to be held.
+    size_t GetValidSize(u64 index) const;
+
+    /// Reads straight from the backend, with the data not written back yet put on top
+    ResultVal<size_t> ReadUncached(u64 offset, size_t length, u8* buffer);
+
+    /// Writes a dirty block to the backend. Requires both mutexes to be held.
+    void WriteBackBlock(CachedBlock& block);
+
+    /// Writes all the dirty blocks to the backend, in file order. Requires both mutexes to be held.
+    void WriteBackAllBlocks();
+
+    /// Queues the blocks following a sequential read to be fetched in the background
+    void RequestReadAhead(u64 offset, size_t length);
+
+    const FileCacheConfig config;
+    std::shared_ptr<FileCacheStats> stats;
+
+    /// Serializes the accesses to the backend. When both are needed, it's taken before `mutex`.
+    std::mutex backend_mutex;
+    /// Handles to the file, protected by backend_mutex
+    std::vector<Handle> handles;
+    /// Backend of the handle all the accesses go through, null without handles. It's a writable
+    /// one whenever there is one, as the dirty blocks are written back through it. Changed with
+    /// both mutexes held.
+    const FileBackend* backend = nullptr;
+
+    /// Protects the members below
+    std::mutex mutex;
+    BlockList lru_blocks; ///< Cached blocks, the most recently used first
+    std::unordered_map<u64, BlockList::iterator> blocks;
+    u64 file_size = 0;    ///< Size of the file, including the data which isn't written back yet
+    u64 next_sequential_offset = 0;
+    u64 read_ahead_end = 0; ///< Index of the first block which wasn't requested to be read ahead
+};
+
+namespace {
+
+/// Thread fetching blocks ahead of sequential reads, shared by all the cached files
+class ReadAheadWorker {
+public:
+    ReadAheadWorker() : thread(&ReadAheadWorker::Loop, this) {}
+
+    ~ReadAheadWorker() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+        }
+        condition.notify_one();
+        thread.join();
+    }
+
+    void Request(std::weak_ptr<BlockCache> cache, u64 first_block, u64 end_block) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            requests.push_back({std::move(cache), first_block, end_block});
+        }
+        condition.notify_one();
+    }
+
+private:
+    struct ReadAheadRequest {
+        std::weak_ptr<BlockCache> cache;
+        u64 first_block;
+        u64 end_block;
+    };
+
+    void Loop() {
+        Common::SetCurrentThreadName("FileCacheReadAhead");
+
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            condition.wait(lock, [this] { return stop || !requests.empty(); });
+            if (stop)
+                return;
+
+            ReadAheadRequest request = std::move(requests.front());
+            requests.pop_front();
+
+            lock.unlock();
+            // Files closed in the meantime are skipped
+            if (auto cache = request.cache.lock()) {
+                cache->ReadAhead(request.first_block, request.end_block);
+            }
+            lock.lock();
+        }
+    }
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<ReadAheadRequest> requests;
+    bool stop = false;
+    std::thread thread;
+};
+
+ReadAheadWorker& GetReadAheadWorker() {
+    static ReadAheadWorker worker;
+    return worker;
+}
+
+/// Returns the cache shared by the handles opened with a key, creating it if there is none
+std::shared_ptr<BlockCache> GetSharedBlockCache(const std::string& key,
+                                                const FileCacheConfig& config,
+                                                std::shared_ptr<FileCacheStats> stats) {
+    static std::mutex mutex;
+    static std::unordered_map<std::string, std::weak_ptr<BlockCache>> caches;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::shared_ptr<BlockCache> cache = caches[key].lock();
+    if (cache == nullptr) {
+        // Forget the files which were closed since the last time a file was opened
+        for (auto it = caches.begin(); it != caches.end();) {
+            it = it->second.expired() ? caches.erase(it) : std::next(it);
+        }
+        cache = std::make_shared<BlockCache>(config, std::move(stats));
+        caches[key] = cache;
+    }
+    return cache;
+}
+
+} // Anonymous namespace
+
+void BlockCache::Attach(const FileBackend& handle_backend, bool writable) {
+    std::lock_guard<std::mutex> backend_lock(backend_mutex);
+    std::lock_guard<std::mutex> lock(mutex);
+    if (handles.empty()) {
+        // The file may have been changed since the last handle was removed
+        file_size = handle_backend.GetSize();
+        next_sequential_offset = 0;
+        read_ahead_end = 0;
+    }
+    handles.push_back({&handle_backend, writable});
+    ChooseBackend();
+}
+
+void BlockCache::Detach(const FileBackend& handle_backend) {
+    std::lock_guard<std::mutex> backend_lock(backend_mutex);
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = std::find_if(handles.begin(), handles.end(), [&](const Handle& handle) {
+        return handle.backend == &handle_backend;
+    });
+    if (it == handles.end())
+        return;
+
+    if (backend == &handle_backend) {
+        WriteBackAllBlocks();
+        backend->Flush();
+        backend = nullptr;
+    }
+    handles.erase(it);
+    if (handles.empty()) {
+        DropBlocks();
+        return;
+    }
+    ChooseBackend();
+}
+
+void BlockCache::ChooseBackend() {
+    auto it = std::find_if(handles.begin(), handles.end(),
+                           [](const Handle& handle) { return handle.writable; });
+    const FileBackend* chosen = it != handles.end() ? it->backend : handles.front().backend;
+    if (chosen == backend)
+        return;
+
+    // Data still buffered by the previous backend has to reach the file before it's read through
+    // another one
+    if (backend != nullptr) {
+        backend->Flush();
+    }
+    backend = chosen;
+}
+
+template <typename Func>
+ResultCode BlockCache::ForEachBlock(u64 offset, size_t length, Func&& func) {
+    size_t done = 0;
+    while (done < length) {
+        const u64 position = offset + done;
+        const u64 index = position / config.block_size;
+        const size_t block_offset = static_cast<size_t>(position % config.block_size);
+        const size_t size = std::min(length - done, config.block_size - block_offset);
+
+        ResultCode result = func(index, block_offset, done, size);
+        if (result.IsError())
+            return result;
+
+        done += size;
+    }
+    return RESULT_SUCCESS;
+}
+
+template <typename Func>
+ResultCode BlockCache::AccessBlock(u64 index, size_t overwritten_size, Func&& func) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = blocks.find(index);
+        if (it != blocks.end()) {
+            ++stats->hits;
+            lru_blocks.splice(lru_blocks.begin(), lru_blocks, it->second);
+            func(*it->second);
+            return RESULT_SUCCESS;
+        }
+    }
+
+    std::lock_guard<std::mutex> backend_lock(backend_mutex);
+    std::unique_lock<std::mutex> lock(mutex);
+    auto it = blocks.find(index);
+    if (it != blocks.end()) {
+        // The read-ahead thread fetched it in the meantime
+        ++stats->hits;
+        lru_blocks.splice(lru_blocks.begin(), lru_blocks, it->second);
+        func(*it->second);
+        return RESULT_SUCCESS;
+    }
+
+    if (overwritten_size >= GetValidSize(index)) {
+        // None of the data of the block is kept, so there's nothing to read
+        std::vector<u8> storage = lru_blocks.size() < config.capacity ? std::vector<u8>()
+                                                                      : EvictBlock();
+        storage.assign(config.block_size, 0);
+        lru_blocks.push_front({index, std::move(storage), GetValidSize(index), false});
+        blocks[index] = lru_blocks.begin();
+        func(lru_blocks.front());
+        return RESULT_SUCCESS;
+    }
+
+    ++stats->misses;
+    ResultCode result = LoadBlocks(index, 1, lock);
+    if (result.IsError())
+        return result;
+
+    func(*blocks[index]);
+    return RESULT_SUCCESS;
+}
+
+size_t BlockCache::GetValidSize(u64 index) const {
+    const u64 block_offset = index * config.block_size;
+    return block_offset < file_size
+               ? static_cast<size_t>(std::min<u64>(config.block_size, file_size - block_offset))
+               : 0;
+}
+
+ResultCode BlockCache::LoadBlocks(u64 first_block, size_t count,
+                                  std::unique_lock<std::mutex>& lock) {
+    ASSERT(count <= config.capacity);
+
+    // Make room first, reusing the storage of the evicted blocks
+    std::vector<std::vector<u8>> buffers;
+    buffers.reserve(count);
+    while (lru_blocks.size() + count > config.capacity) {
+        buffers.push_back(EvictBlock());
+    }
+    buffers.resize(count);
+
+    std::vector<Memory::HostSpan> spans;
+    spans.reserve(count);
+    for (auto& buffer : buffers) {
+        buffer.resize(config.block_size);
+        spans.push_back({buffer.data(), buffer.size()});
+    }
+
+    const u64 offset = first_block * config.block_size;
+    const bool past_end = offset >= file_size;
+    lock.unlock();
+    ResultVal<size_t> read =
+        past_end ? MakeResult<size_t>(0) : backend->ReadScatter(offset, spans);
+    lock.lock();
+    if (read.Failed())
+        return read.Code();
+
+    for (size_t i = 0; i < count; ++i) {
+        // Data which isn't in the backend yet, because it's past the end of blocks which weren't
+        // written back, reads as zeros
+        const size_t read_in_block = static_cast<size_t>(
+            std::min<u64>(config.block_size, *read - std::min<u64>(*read, i * config.block_size)));
+        std::fill(buffers[i].begin() + read_in_block, buffers[i].end(), 0);
+
+        // The file may have grown while the lock was released, so the size is only checked now
+        const u64 index = first_block + i;
+        lru_blocks.push_front({index, std::move(buffers[i]), GetValidSize(index), false});
+        blocks[index] = lru_blocks.begin();
+    }
+    return RESULT_SUCCESS;
+}
+
+void BlockCache::DropBlocks() {
+    blocks.clear();
+    lru_blocks.clear();
+}
+
+std::vector<u8> BlockCache::EvictBlock() {
+    CachedBlock& block = lru_blocks.back();
+    if (block.dirty) {
+        WriteBackBlock(block);
+    }
+    std::vector<u8> storage = std::move(block.data);
+    blocks.erase(block.index);
+    lru_blocks.pop_back();
+    return storage;
+}
+
+void BlockCache::WriteBackBlock(CachedBlock& block) {
+    ResultVal<size_t> written =
+        backend->Write(block.index * config.block_size, block.size, false, block.data.data());
+    if (written.Failed() || *written != block.size) {
+        LOG_ERROR(Service_FS, "Failed to write back block %" PRIu64, block.index);
+    }
+    block.dirty = false;
+    ++stats->written_back_blocks;
+}
+
+void BlockCache::WriteBackAllBlocks() {
+    std::vector<CachedBlock*> dirty_blocks;
+    for (auto& block : lru_blocks) {
+        if (block.dirty) {
+            dirty_blocks.push_back(&block);
+        }
+    }
+
+    std::sort(dirty_blocks.begin(), dirty_blocks.end(),
+              [](const CachedBlock* a, const CachedBlock* b) { return a->index < b->index; });
+    for (CachedBlock* block : dirty_blocks) {
+        WriteBackBlock(*block);
+    }
+}
+
+void BlockCache::RequestReadAhead(u64 offset, size_t length) {
+    if (config.read_ahead_blocks == 0 || length == 0)
+        return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    const u64 end = offset + length;
+    const bool sequential = offset == next_sequential_offset;
+    next_sequential_offset = end;
+    if (!sequential) {
+        // A new stream starts, the blocks fetched for the previous one don't count
+        read_ahead_end = 0;
+        return;
+    }
+
+    // Fetch more blocks once half of those fetched ahead were consumed, so that the requests are
+    // batched instead of asking for a single block on each read
+    const u64 next_block = (end + config.block_size - 1) / config.block_size;
+    if (read_ahead_end >= next_block + config.read_ahead_blocks / 2 + 1)
+        return;
+
+    const u64 first_block = std::max(read_ahead_end, next_block);
+    read_ahead_end = next_block + config.read_ahead_blocks;
+    GetReadAheadWorker().Request(shared_from_this(), first_block, read_ahead_end);
+}
+
+void BlockCache::ReadAhead(u64 first_block, u64 end_block) {
+    std::lock_guard<std::mutex> backend_lock(backend_mutex);
+    std::unique_lock<std::mutex> lock(mutex);
+    if (handles.empty())
+        return;
+
+    // Load each run of blocks which aren't cached yet with a single read
+    end_block = std::min(end_block, (file_size + config.block_size - 1) / config.block_size);
+    u64 index = first_block;
+    while (index < end_block) {
+        if (blocks.count(index) != 0) {
+            ++index;
+            continue;
+        }
+
+        u64 run_end = index + 1;
+        while (run_end < end_block && run_end - index < config.capacity &&
+               blocks.count(run_end) == 0) {
+            ++run_end;
+        }
+
+        const size_t count = static_cast<size_t>(run_end - index);
+        if (LoadBlocks(index, count, lock).IsError())
+            return;
+        stats->read_ahead_blocks += count;
+        index = run_end;
+    }
+}
+
+ResultVal<size_t> BlockCache::ReadUncached(u64 offset, size_t length, u8* buffer) {
+    std::lock_guard<std::mutex> backend_lock(backend_mutex);
+    ResultVal<size_t> read = backend->Read(offset, length, buffer);
+    if (read.Failed())
+        return read;
+    std::fill(buffer + *read, buffer + length, 0);
+
+    if (!config.write_back)
+        return MakeResult<size_t>(length);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto copy_dirty_data = [&](u64 index, size_t block_offset, size_t done, size_t part_size) {
+        auto it = blocks.find(index);
+        if (it != blocks.end() && it->second->dirty) {
+            std::memcpy(buffer + done, it->second->data.data() + block_offset, part_size);
+        }
+        return RESULT_SUCCESS;
+    };
+    ForEachBlock(offset, length, copy_dirty_data);
+    return MakeResult<size_t>(length);
+}
+
+ResultVal<size_t> BlockCache::Read(u64 offset, size_t length, u8* buffer) {
+    const u64 size = GetSize();
+    if (offset >= size)
+        return MakeResult<size_t>(0);
+    length = static_cast<size_t>(std::min<u64>(length, size - offset));
+    if (length >= config.uncached_read_size)
+        return ReadUncached(offset, length, buffer);
+
+    ResultCode result = ForEachBlock(
+        offset, length, [&](u64 index, size_t block_offset, size_t done, size_t part_size) {
+            return AccessBlock(index, 0, [&](const CachedBlock& block) {
+                std::memcpy(buffer + done, block.data.data() + block_offset, part_size);
+            });
+        });
+    if (result.IsError())
+        return result;
+
+    RequestReadAhead(offset, length);
+    return MakeResult<size_t>(length);
+}
+
+ResultVal<size_t> BlockCache::Write(u64 offset, size_t length, bool flush, const u8* buffer) {
+    if (!config.write_back) {
+        std::lock_guard<std::mutex> backend_lock(backend_mutex);
+        ResultVal<size_t> written = backend->Write(offset, length, flush, buffer);
+        if (written.Failed() || *written == 0)
+            return written;
+
+        // Drop the cached copies of the blocks which were written to
+        std::lock_guard<std::mutex> lock(mutex);
+        const u64 last_block = (offset + *written - 1) / config.block_size;
+        for (u64 index = offset / config.block_size; index <= last_block; ++index) {
+            auto it = blocks.find(index);
+            if (it != blocks.end()) {
+                lru_blocks.erase(it->second);
+                blocks.erase(it);
+            }
+        }
+        file_size = std::max(file_size, offset + *written);
+        return written;
+    }
+
+    ResultCode result = ForEachBlock(
+        offset, length, [&](u64 index, size_t block_offset, size_t done, size_t part_size) {
+            const size_t overwritten_size = block_offset == 0 ? part_size : 0;
+            return AccessBlock(index, overwritten_size, [&](CachedBlock& block) {
+                std::memcpy(block.data.data() + block_offset, buffer + done, part_size);
+                block.size = std::max(block.size, block_offset + part_size);
+                block.dirty = true;
+                file_size = std::max(file_size, index * config.block_size + block.size);
+            });
+        });
+    if (result.IsError())
+        return result;
+
+    if (flush) {
+        Flush();
+    }
+    return MakeResult<size_t>(length);
+}
+
+u64 BlockCache::GetSize() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return file_size;
+}
+
+bool BlockCache::SetSize(u64 size) {
+    std::lock_guard<std::mutex> backend_lock(backend_mutex);
+    std::lock_guard<std::mutex> lock(mutex);
+    WriteBackAllBlocks();
+    DropBlocks();
+
+    const bool success = backend->SetSize(size);
+    file_size = backend->GetSize();
+    return success;
+}
+
+void BlockCache::Flush() {
+    std::lock_guard<std::mutex> backend_lock(backend_mutex);
+    std::lock_guard<std::mutex> lock(mutex);
+    WriteBackAllBlocks();
+    backend->Flush();
+}
+
+CachedFile::CachedFile(std::unique_ptr<FileBackend> backend, const FileCacheConfig& config,
+                       std::shared_ptr<FileCacheStats> stats)
+    : backend(std::move(backend)), writable(true),
+      cache(std::make_shared<BlockCache>(config, std::move(stats))) {
+    cache->Attach(*this->backend, writable);
+}
+
+CachedFile::CachedFile(std::unique_ptr<FileBackend> backend, bool writable,
+                       const std::string& key, const FileCacheConfig& config,
+                       std::shared_ptr<FileCacheStats> stats)
+    : backend(std::move(backend)), writable(writable),
+      cache(GetSharedBlockCache(key, config, std::move(stats))) {
+    cache->Attach(*this->backend, writable);
+}
+
+CachedFile::~CachedFile() {
+    // The read-ahead thread may still hold the cache for a moment, so it's told to stop using the
+    // backend before it's destroyed
+    cache->Detach(*backend);
+}
+
+ResultVal<size_t> CachedFile::Read(u64 offset, size_t length, u8* buffer) const {
+    // Like a closed DiskFile, a closed handle doesn't read or write anything
+    if (closed)
+        return MakeResult<size_t>(0);
+    return cache->Read(offset, length, buffer);
+}
+
+ResultVal<size_t> CachedFile::Write(u64 offset, size_t length, bool flush,
+                                    const u8* buffer) const {
+    if (!writable)
+        return ERROR_INVALID_OPEN_FLAGS;
+    if (closed)
+        return MakeResult<size_t>(0);
+    return cache->Write(offset, length, flush, buffer);
+}
+
+u64 CachedFile::GetSize() const {
+    return cache->GetSize();
+}
+
+bool CachedFile::SetSize(u64 size) const {
+    return !closed && cache->SetSize(size);
+}
+
+bool CachedFile::Close() const {
+    cache->Detach(*backend);
+    closed = true;
+    return backend->Close();
+}
+
+void CachedFile::Flush() const {
+    if (!closed) {
+        cache->Flush();
+    }
+}
+
+void LogFileCacheStats(const std::string& name, const FileCacheStats& stats) {
+    const u64 accesses = stats.hits + stats.misses;
+    if (accesses == 0)
+        return;
+
+    LOG_DEBUG(Service_FS,
+              "%s: file cache hit rate %.1f%% over %" PRIu64 " block accesses, %" PRIu64
+              " blocks read ahead, %" PRIu64 " blocks written back",
+              name.c_str(), stats.GetHitRate() * 100.0, accesses, stats.read_ahead_blocks.load(),
+              stats.written_back_blocks.load());
+}
+
+} // namespace FileSys
@@ -0,0 +1,96 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include "common/common_types.h"
+#include "core/file_sys/file_backend.h"
+#include "core/hle/result.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// FileSys namespace
+
+namespace FileSys {
+
+/// Parameters of the block cache of a CachedFile
+struct FileCacheConfig {
+    /// Size in bytes of the blocks the file is read and written in
+    size_t block_size = 0x4000;
+    /// Maximum number of blocks kept in memory, the least recently used being evicted first
+    size_t capacity = 256;
+    /// Number of blocks fetched in the background ahead of sequential reads (0 disables it)
+    size_t read_ahead_blocks = 8;
+    /// Reads of at least this size go straight to the backend: they're rarely repeated, and
+    /// caching them would only add a copy and evict everything else
+    size_t uncached_read_size = 0x10000;
+    /// Keep written data in the cache until it's flushed or evicted instead of writing it through
+    bool write_back = false;
+};
+
+/// Cache statistics, shared by all the files opened from an archive
+struct FileCacheStats {
+    std::atomic<u64> hits{0};
+    std::atomic<u64> misses{0};
+    std::atomic<u64> read_ahead_blocks{0};
+    std::atomic<u64> written_back_blocks{0};
+
+    /// Returns the fraction of block accesses which were served from the cache
+    double GetHitRate() const {
+        const u64 total = hits + misses;
+        return total == 0 ? 0.0 : static_cast<double>(hits) / total;
+    }
+};
+
+class BlockCache;
+
+/**
+ * Decorator which caches the data of another FileBackend in fixed-size blocks, so that the many
+ * small reads games issue don't each go to the host file. Sequential reads are detected and the
+ * blocks following them are fetched on a background thread.
+ *
+ * With write-back enabled, writes only touch the cached blocks, which are written to the backend
+ * when the file is flushed, resized, closed or when they're evicted.
+ *
+ * Handles opened on the same file with the same key share a single cache, so that they all see each
+ * other's writes right away. All the accesses to the file go through one of their backends, a
+ * writable one if any, so that the stdio buffering of a DiskFile can't hide data from the others.
+ */
+class CachedFile final : public FileBackend {
+public:
+    /// Caches a file on its own
+    CachedFile(std::unique_ptr<FileBackend> backend, const FileCacheConfig& config,
+               std::shared_ptr<FileCacheStats> stats);
+
+    /**
+     * Caches a file with the cache shared by the handles opened with the same key. The
+     * configuration and statistics are those of the handle which created the cache.
+     * @param writable Whether the file may be written to through this handle
+     * @param key Identifies the file, e.g. its host path
+     */
+    CachedFile(std::unique_ptr<FileBackend> backend, bool writable, const std::string& key,
+               const FileCacheConfig& config, std::shared_ptr<FileCacheStats> stats);
+    ~CachedFile() override;
+
+    ResultVal<size_t> Read(u64 offset, size_t length, u8* buffer) const override;
+    ResultVal<size_t> Write(u64 offset, size_t length, bool flush, const u8* buffer) const override;
+    u64 GetSize() const override;
+    bool SetSize(u64 size) const override;
+    bool Close() const override;
+    void Flush() const override;
+
+private:
+    std::unique_ptr<FileBackend> backend;
+    bool writable;
+    mutable bool closed = false; ///< Whether the handle was closed and removed from the cache
+    std::shared_ptr<BlockCache> cache;
+};
+
+/// Logs the cache statistics of an archive, if any of its files was cached
+void LogFileCacheStats(const std::string& name, const FileCacheStats& stats);
+
+} // namespace FileSys
@@ -10,6 +10,7 @@
 #include "common/logging/log.h"
 #include "core/file_sys/disk_archive.h"
 #include "core/file_sys/errors.h"
+#include "core/settings.h"
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // FileSys namespace
@@ -24,6 +25,22 @@ ResultVal<size_t> DiskFile::Read(const u64 offset, const size_t length, u8* buff
     return MakeResult<size_t>(file->ReadBytes(buffer, length));
 }
 
+ResultVal<size_t> DiskFile::ReadScatter(const u64 offset,
+                                         const std::vector<Memory::HostSpan>& spans) const {
+    if (!mode.read_flag)
+        return ERROR_INVALID_OPEN_FLAGS;
+
+    file->Seek(offset, SEEK_SET);
+    size_t total_read = 0;
+    for (const auto& span : spans) {
+        size_t read = file->ReadBytes(span.pointer, span.size);
+        total_read += read;
+        if (read < span.size)
+            break;
+    }
+    return MakeResult<size_t>(total_read);
+}
+
 ResultVal<size_t> DiskFile::Write(const u64 offset, const size_t length, const bool flush,
                                   const u8* buffer) const {
     if (!mode.write_flag)
@@ -36,6 +53,25 @@ ResultVal<size_t> DiskFile::Write(const u64 offset, const size_t length, const b
     return MakeResult<size_t>(written);
 }
 
+ResultVal<size_t> DiskFile::WriteGather(const u64 offset,
+                                        const std::vector<Memory::HostSpan>& spans,
+                                        const bool flush) const {
+    if (!mode.write_flag)
+        return ERROR_INVALID_OPEN_FLAGS;
+
+    file->Seek(offset, SEEK_SET);
+    size_t total_written = 0;
+    for (const auto& span : spans) {
+        size_t written = file->WriteBytes(span.pointer, span.size);
+        total_written += written;
+        if (written < span.size)
+            break;
+    }
+    if (flush)
+        file->Flush();
+    return MakeResult<size_t>(total_written);
+}
+
 u64 DiskFile::GetSize() const {
     return file->GetSize();
 }
@@ -50,6 +86,25 @@ bool DiskFile::Close() const {
     return file->Close();
 }
 
+std::unique_ptr<FileBackend> MakeCachedDiskFile(FileUtil::IOFile&& file, const Mode& mode,
+                                                const std::string& path,
+                                                std::shared_ptr<FileCacheStats> stats) {
+    auto disk_file = std::make_unique<DiskFile>(std::move(file), mode);
+    // Blocks can't be completed from the file if it can't be read, so writes to write-only
+    // files go straight to it
+    if (!mode.read_flag || Settings::values.file_cache_size == 0)
+        return std::move(disk_file);
+
+    FileCacheConfig config;
+    config.capacity = std::max<size_t>(
+        1, static_cast<size_t>(Settings::values.file_cache_size) * 1024 * 1024 / config.block_size);
+    config.read_ahead_blocks = std::min<size_t>(Settings::values.file_cache_read_ahead,
+                                                config.capacity / 2);
+    config.write_back = Settings::values.file_cache_write_back;
+    return std::make_unique<CachedFile>(std::move(disk_file), mode.write_flag != 0, path, config,
+                                        std::move(stats));
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 DiskDirectory::DiskDirectory(const std::string& path) : directory() {
@@ -11,6 +11,7 @@
 #include "common/common_types.h"
 #include "common/file_util.h"
 #include "core/file_sys/archive_backend.h"
+#include "core/file_sys/cached_file.h"
 #include "core/file_sys/directory_backend.h"
 #include "core/file_sys/file_backend.h"
 #include "core/hle/result.h"
@@ -28,7 +29,11 @@ public:
     }
 
     ResultVal<size_t> Read(u64 offset, size_t length, u8* buffer) const override;
+    ResultVal<size_t> ReadScatter(u64 offset,
+                                  const std::vector<Memory::HostSpan>& spans) const override;
     ResultVal<size_t> Write(u64 offset, size_t length, bool flush, const u8* buffer) const override;
+    ResultVal<size_t> WriteGather(u64 offset, const std::vector<Memory::HostSpan>& spans,
+                                  bool flush) const override;
     u64 GetSize() const override;
     bool SetSize(u64 size) const override;
     bool Close() const override;
@@ -42,6 +47,16 @@ protected:
     std::unique_ptr<FileUtil::IOFile> file;
 };
 
+/**
+ * Creates a DiskFile behind a block cache if the file is readable and the cache is enabled. The
+ * cache is configured by the file cache settings, and shared by the handles to the same file.
+ * @param path Host path of the file
+ * @param stats Cache statistics of the archive the file is opened from
+ */
+std::unique_ptr<FileBackend> MakeCachedDiskFile(FileUtil::IOFile&& file, const Mode& mode,
+                                                const std::string& path,
+                                                std::shared_ptr<FileCacheStats> stats);
+
 class DiskDirectory : public DirectoryBackend {
 public:
     DiskDirectory(const std::string& path);
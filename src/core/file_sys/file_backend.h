@@ -5,8 +5,10 @@
 #pragma once
 
 #include <cstddef>
+#include <vector>
 #include "common/common_types.h"
 #include "core/hle/result.h"
+#include "core/memory.h"
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // FileSys namespace
@@ -27,6 +29,29 @@ public:
      */
     virtual ResultVal<size_t> Read(u64 offset, size_t length, u8* buffer) const = 0;
 
+    /**
+     * Read data from the file into a list of buffers, which are filled in order as if they were a
+     * single buffer. This allows reading straight into guest memory that isn't contiguous in host
+     * memory.
+     * @param offset Offset in bytes to start reading data from
+     * @param spans Buffers to read data into
+     * @return Number of bytes read, or error code
+     */
+    virtual ResultVal<size_t> ReadScatter(u64 offset,
+                                          const std::vector<Memory::HostSpan>& spans) const {
+        size_t total_read = 0;
+        for (const auto& span : spans) {
+            ResultVal<size_t> read = Read(offset + total_read, span.size, span.pointer);
+            if (read.Failed())
+                return read.Code();
+
+            total_read += *read;
+            if (*read < span.size)
+                break;
+        }
+        return MakeResult<size_t>(total_read);
+    }
+
     /**
      * Write data to the file
      * @param offset Offset in bytes to start writing data to
@@ -38,6 +63,33 @@ public:
     virtual ResultVal<size_t> Write(u64 offset, size_t length, bool flush,
                                     const u8* buffer) const = 0;
 
+    /**
+     * Write data to the file from a list of buffers, which are written in order as if they were a
+     * single buffer. This allows writing straight from guest memory that isn't contiguous in host
+     * memory.
+     * @param offset Offset in bytes to start writing data to
+     * @param spans Buffers to read data from
+     * @param flush The flush parameters (0 == do not flush)
+     * @return Number of bytes written, or error code
+     */
+    virtual ResultVal<size_t> WriteGather(u64 offset, const std::vector<Memory::HostSpan>& spans,
+                                          bool flush) const {
+        size_t total_written = 0;
+        for (const auto& span : spans) {
+            ResultVal<size_t> written =
+                Write(offset + total_written, span.size, false, span.pointer);
+            if (written.Failed())
+                return written.Code();
+
+            total_written += *written;
+            if (*written < span.size)
+                break;
+        }
+        if (flush)
+            Flush();
+        return MakeResult<size_t>(total_written);
+    }
+
     /**
      * Get the size of the file in bytes
      * @return Size of the file in bytes
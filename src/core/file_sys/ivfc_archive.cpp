@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <cstring>
 #include <memory>
 #include "common/common_types.h"
@@ -13,6 +14,19 @@
 
 namespace FileSys {
 
+std::shared_ptr<const FileUtil::FileMapping> MapRomFS(
+    const std::shared_ptr<FileUtil::IOFile>& file, u64 offset, u64 size) {
+    if (file == nullptr)
+        return nullptr;
+
+    auto mapping = std::make_shared<FileUtil::FileMapping>(*file, offset, size);
+    if (!mapping->IsGood()) {
+        LOG_WARNING(Service_FS, "Unable to map the RomFS, reading it from the file instead");
+        return nullptr;
+    }
+    return mapping;
+}
+
 std::string IVFCArchive::GetName() const {
     return "IVFC";
 }
@@ -20,7 +34,7 @@ std::string IVFCArchive::GetName() const {
 ResultVal<std::unique_ptr<FileBackend>> IVFCArchive::OpenFile(const Path& path,
                                                               const Mode& mode) const {
     return MakeResult<std::unique_ptr<FileBackend>>(
-        std::make_unique<IVFCFile>(romfs_file, data_offset, data_size));
+        std::make_unique<IVFCFile>(romfs_file, romfs_mapping, data_offset, data_size));
 }
 
 ResultCode IVFCArchive::DeleteFile(const Path& path) const {
@@ -85,14 +99,79 @@ u64 IVFCArchive::GetFreeBytes() const {
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+void IVFCFile::AdviseReadAhead(u64 offset, size_t length) const {
+    // Games stream assets with reads that continue where the previous one ended. Ask for the data
+    // following them ahead of time so that it's hopefully in memory by the time it's read. The
+    // hint is only renewed once half of the previous window is consumed, to keep small streaming
+    // reads from making a system call each.
+    constexpr u64 read_ahead_window = 0x100000;
+
+    const u64 end = offset + length;
+    if (offset == next_sequential_offset && end + read_ahead_window / 2 > read_ahead_end) {
+        const u64 window = std::max<u64>(length, read_ahead_window);
+        romfs_mapping->AdviseWillNeed(end, window);
+        read_ahead_end = end + window;
+    }
+    next_sequential_offset = end;
+}
+
 ResultVal<size_t> IVFCFile::Read(const u64 offset, const size_t length, u8* buffer) const {
     LOG_TRACE(Service_FS, "called offset=%llu, length=%zu", offset, length);
+    // The pointer to the data can't even be computed past the end of the mapping
+    if (offset >= data_size)
+        return MakeResult<size_t>(0);
+
+    if (romfs_mapping) {
+        size_t read_length = static_cast<size_t>(std::min<u64>(length, data_size - offset));
+        AdviseReadAhead(offset, read_length);
+        std::memcpy(buffer, romfs_mapping->GetData() + offset, read_length);
+        return MakeResult<size_t>(read_length);
+    }
+
     romfs_file->Seek(data_offset + offset, SEEK_SET);
     size_t read_length = (size_t)std::min((u64)length, data_size - offset);
 
     return MakeResult<size_t>(romfs_file->ReadBytes(buffer, read_length));
 }
 
+ResultVal<size_t> IVFCFile::ReadScatter(const u64 offset,
+                                         const std::vector<Memory::HostSpan>& spans) const {
+    LOG_TRACE(Service_FS, "called offset=%llu, spans=%zu", offset, spans.size());
+    if (offset >= data_size)
+        return MakeResult<size_t>(0);
+    u64 remaining = data_size - offset;
+
+    size_t total_read = 0;
+    if (romfs_mapping) {
+        size_t length = 0;
+        for (const auto& span : spans) {
+            length += span.size;
+        }
+        AdviseReadAhead(offset, static_cast<size_t>(std::min<u64>(length, remaining)));
+
+        for (const auto& span : spans) {
+            if (remaining == 0)
+                break;
+            size_t read_length = static_cast<size_t>(std::min<u64>(span.size, remaining));
+            std::memcpy(span.pointer, romfs_mapping->GetData() + offset + total_read, read_length);
+            total_read += read_length;
+            remaining -= read_length;
+        }
+        return MakeResult<size_t>(total_read);
+    }
+
+    romfs_file->Seek(data_offset + offset, SEEK_SET);
+    for (const auto& span : spans) {
+        size_t read_length = static_cast<size_t>(std::min<u64>(span.size, remaining));
+        size_t read = romfs_file->ReadBytes(span.pointer, read_length);
+        total_read += read;
+        remaining -= read;
+        if (read < span.size)
+            break;
+    }
+    return MakeResult<size_t>(total_read);
+}
+
 ResultVal<size_t> IVFCFile::Write(const u64 offset, const size_t length, const bool flush,
                                   const u8* buffer) const {
     LOG_ERROR(Service_FS, "Attempted to write to IVFC file");
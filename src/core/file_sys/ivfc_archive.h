@@ -20,6 +20,13 @@
 
 namespace FileSys {
 
+/**
+ * Maps the data of a RomFS into memory, so that it can be read without going through the file.
+ * @returns the mapping, or nullptr if the data couldn't be mapped
+ */
+std::shared_ptr<const FileUtil::FileMapping> MapRomFS(
+    const std::shared_ptr<FileUtil::IOFile>& file, u64 offset, u64 size);
+
 /**
  * Helper which implements an interface to deal with IVFC images used in some archives
  * This should be subclassed by concrete archive types, which will provide the
@@ -28,7 +35,8 @@ namespace FileSys {
 class IVFCArchive : public ArchiveBackend {
 public:
     IVFCArchive(std::shared_ptr<FileUtil::IOFile> file, u64 offset, u64 size)
-        : romfs_file(file), data_offset(offset), data_size(size) {}
+        : romfs_file(file), romfs_mapping(MapRomFS(file, offset, size)), data_offset(offset),
+          data_size(size) {}
 
     std::string GetName() const override;
 
@@ -46,6 +54,7 @@ public:
 
 protected:
     std::shared_ptr<FileUtil::IOFile> romfs_file;
+    std::shared_ptr<const FileUtil::FileMapping> romfs_mapping;
     u64 data_offset;
     u64 data_size;
 };
@@ -53,9 +62,19 @@ protected:
 class IVFCFile : public FileBackend {
 public:
     IVFCFile(std::shared_ptr<FileUtil::IOFile> file, u64 offset, u64 size)
-        : romfs_file(file), data_offset(offset), data_size(size) {}
+        : IVFCFile(file, MapRomFS(file, offset, size), offset, size) {}
+
+    /**
+     * Creates a file which reads from an existing mapping of the RomFS data. The file is only read
+     * from if the mapping is nullptr.
+     */
+    IVFCFile(std::shared_ptr<FileUtil::IOFile> file,
+             std::shared_ptr<const FileUtil::FileMapping> mapping, u64 offset, u64 size)
+        : romfs_file(file), romfs_mapping(mapping), data_offset(offset), data_size(size) {}
 
     ResultVal<size_t> Read(u64 offset, size_t length, u8* buffer) const override;
+    ResultVal<size_t> ReadScatter(u64 offset,
+                                  const std::vector<Memory::HostSpan>& spans) const override;
     ResultVal<size_t> Write(u64 offset, size_t length, bool flush, const u8* buffer) const override;
     u64 GetSize() const override;
     bool SetSize(u64 size) const override;
@@ -65,9 +84,16 @@ public:
     void Flush() const override {}
 
 private:
+    /// Hints the OS to fetch the data following a read from the mapping if reads are sequential
+    void AdviseReadAhead(u64 offset, size_t length) const;
+
     std::shared_ptr<FileUtil::IOFile> romfs_file;
+    std::shared_ptr<const FileUtil::FileMapping> romfs_mapping;
     u64 data_offset;
     u64 data_size;
+    /// Offset right after the previous read, at which a sequential read would continue
+    mutable u64 next_sequential_offset = 0;
+    mutable u64 read_ahead_end = 0;
 };
 
 class IVFCDirectory : public DirectoryBackend {
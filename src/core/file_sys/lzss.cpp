@@ -0,0 +1,132 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include "core/file_sys/lzss.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// FileSys namespace
+
+namespace FileSys {
+
+/// Number of literals (clear bits) at the top of each control byte
+static const std::array<u8, 256> literal_run_lengths = [] {
+    std::array<u8, 256> lengths{};
+    for (unsigned control = 0; control < 256; ++control) {
+        u8 length = 0;
+        while (length < 8 && !(control & (0x80 >> length)))
+            ++length;
+        lengths[control] = length;
+    }
+    return lengths;
+}();
+
+/**
+ * Copies a back-reference of at least chunk_size bytes, chunk_size bytes at a time, going down
+ * from its end as the data is decompressed backwards. The last chunk overlaps the previous one
+ * rather than being split up, which is fine since the overlapping bytes get the same values again.
+ * @param dest_end End of the destination
+ * @param size Size of the back-reference, at least chunk_size
+ * @param distance Distance from each byte to its source, at least chunk_size
+ */
+template <size_t chunk_size>
+static void CopyBackReference(u8* dest_end, u32 size, u32 distance) {
+    u8* dest = dest_end;
+    u32 remaining = size;
+    while (remaining >= chunk_size) {
+        dest -= chunk_size;
+        std::memcpy(dest, dest + distance, chunk_size);
+        remaining -= chunk_size;
+    }
+    if (remaining != 0) {
+        dest = dest_end - size;
+        std::memcpy(dest, dest + distance, chunk_size);
+    }
+}
+
+u32 LZSS_GetDecompressedSize(const u8* buffer, u32 size) {
+    u32 offset_size;
+    std::memcpy(&offset_size, buffer + size - 4, sizeof(u32));
+    return offset_size + size;
+}
+
+bool LZSS_Decompress(const u8* compressed, u32 compressed_size, u8* decompressed,
+                     u32 decompressed_size) {
+    if (compressed_size < 8 || decompressed_size < compressed_size)
+        return false;
+
+    u32 buffer_top_and_bottom;
+    std::memcpy(&buffer_top_and_bottom, compressed + compressed_size - 8, sizeof(u32));
+    u32 out = decompressed_size;
+    u32 index = compressed_size - ((buffer_top_and_bottom >> 24) & 0xFF);
+    u32 stop_index = compressed_size - (buffer_top_and_bottom & 0xFFFFFF);
+    if (index > compressed_size || stop_index > compressed_size)
+        return false;
+
+    std::memcpy(decompressed, compressed, compressed_size);
+    std::memset(decompressed + compressed_size, 0, decompressed_size - compressed_size);
+
+    // The data is decompressed backwards, from the end of the buffers to their beginning
+    while (index > stop_index) {
+        u8 control = compressed[--index];
+
+        for (unsigned i = 0; i < 8; i++) {
+            if (index <= stop_index)
+                break;
+            if (out == 0)
+                break;
+
+            if (control & 0x80) {
+                // Check if compression is out of bounds
+                if (index < 2)
+                    return false;
+                index -= 2;
+
+                u32 segment_offset = compressed[index] | (compressed[index + 1] << 8);
+                u32 segment_size = ((segment_offset >> 12) & 15) + 3;
+                segment_offset &= 0x0FFF;
+                segment_offset += 2;
+
+                // Check if compression is out of bounds. The segment is copied downwards, so its
+                // first byte is the highest one read.
+                if (out < segment_size || out + segment_offset >= decompressed_size)
+                    return false;
+
+                // Each byte is copied from segment_offset + 1 bytes above it, which is already
+                // decompressed, so whole runs can be copied as long as they aren't longer than
+                // that distance
+                const u32 distance = segment_offset + 1;
+                u8* dest = decompressed + out;
+                if (distance >= 8 && segment_size >= 8) {
+                    CopyBackReference<8>(dest, segment_size, distance);
+                } else if (distance >= 4 && segment_size >= 4) {
+                    CopyBackReference<4>(dest, segment_size, distance);
+                } else {
+                    for (u8* end = dest - segment_size; dest != end;) {
+                        --dest;
+                        *dest = dest[distance];
+                    }
+                }
+                out -= segment_size;
+            } else {
+                // Literals in a row are contiguous in both buffers, so the whole run of them in
+                // this group is copied at once
+                const u32 run = std::min({static_cast<u32>(literal_run_lengths[control]), 8 - i,
+                                          index - stop_index, out});
+                index -= run;
+                out -= run;
+                std::memcpy(decompressed + out, compressed + index, run);
+                control <<= run - 1;
+                i += run - 1;
+            }
+            control <<= 1;
+        }
+    }
+    return true;
+}
+
+} // namespace FileSys
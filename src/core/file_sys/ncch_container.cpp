@@ -2,14 +2,21 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <chrono>
 #include <cinttypes>
 #include <cstring>
 #include <memory>
+#include "common/common_paths.h"
 #include "common/common_types.h"
+#include "common/hash.h"
 #include "common/logging/log.h"
+#include "common/string_util.h"
 #include "core/core.h"
+#include "core/file_sys/lzss.h"
 #include "core/file_sys/ncch_container.h"
 #include "core/loader/loader.h"
+#include "core/settings.h"
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // FileSys namespace
@@ -19,79 +26,115 @@ namespace FileSys {
 static const int kMaxSections = 8;   ///< Maximum number of sections (files) in an ExeFs
 static const int kBlockSize = 0x200; ///< Size of ExeFS blocks (in bytes)
 
+/// Returns the directory in which the decompressed .code of all programs are cached
+static std::string GetCodeCacheDirectory() {
+    return FileUtil::GetUserPath(D_CACHE_IDX) + "code";
+}
+
+/// Returns the path at which the decompressed .code of a program is cached
+static std::string GetCodeCachePath(u64 program_id, u64 compressed_hash) {
+    return GetCodeCacheDirectory() + DIR_SEP +
+           Common::StringFromFormat("%016" PRIX64 "_%016" PRIX64 ".bin", program_id,
+                                    compressed_hash);
+}
+
 /**
- * Get the decompressed size of an LZSS compressed ExeFS file
- * @param buffer Buffer of compressed file
- * @param size Size of compressed buffer
- * @return Size of decompressed buffer
+ * Loads a previously decompressed .code from the cache
+ * @param path Path of the cached .code
+ * @param buffer Buffer to load it into, already resized to the expected size
+ * @return True if it was cached, otherwise false
  */
-static u32 LZSS_GetDecompressedSize(const u8* buffer, u32 size) {
-    u32 offset_size = *(u32*)(buffer + size - 4);
-    return offset_size + size;
+static bool LoadCachedCode(const std::string& path, std::vector<u8>& buffer) {
+    FileUtil::IOFile file(path, "rb");
+    return file.IsOpen() && file.GetSize() == buffer.size() &&
+           file.ReadBytes(buffer.data(), buffer.size()) == buffer.size();
 }
 
 /**
- * Decompress ExeFS file (compressed with LZSS)
- * @param compressed Compressed buffer
- * @param compressed_size Size of compressed buffer
- * @param decompressed Decompressed buffer
- * @param decompressed_size Size of decompressed buffer
- * @return True on success, otherwise false
+ * Deletes the oldest cached .code until the cache, and a new entry of the given size, fit in the
+ * size limit set by the user
  */
-static bool LZSS_Decompress(const u8* compressed, u32 compressed_size, u8* decompressed,
-                            u32 decompressed_size) {
-    const u8* footer = compressed + compressed_size - 8;
-    u32 buffer_top_and_bottom = *reinterpret_cast<const u32*>(footer);
-    u32 out = decompressed_size;
-    u32 index = compressed_size - ((buffer_top_and_bottom >> 24) & 0xFF);
-    u32 stop_index = compressed_size - (buffer_top_and_bottom & 0xFFFFFF);
-
-    memset(decompressed, 0, decompressed_size);
-    memcpy(decompressed, compressed, compressed_size);
-
-    while (index > stop_index) {
-        u8 control = compressed[--index];
-
-        for (unsigned i = 0; i < 8; i++) {
-            if (index <= stop_index)
-                break;
-            if (index <= 0)
-                break;
-            if (out <= 0)
-                break;
-
-            if (control & 0x80) {
-                // Check if compression is out of bounds
-                if (index < 2)
-                    return false;
-                index -= 2;
-
-                u32 segment_offset = compressed[index] | (compressed[index + 1] << 8);
-                u32 segment_size = ((segment_offset >> 12) & 15) + 3;
-                segment_offset &= 0x0FFF;
-                segment_offset += 2;
-
-                // Check if compression is out of bounds
-                if (out < segment_size)
-                    return false;
-
-                for (unsigned j = 0; j < segment_size; j++) {
-                    // Check if compression is out of bounds
-                    if (out + segment_offset >= decompressed_size)
-                        return false;
-
-                    u8 data = decompressed[out + segment_offset];
-                    decompressed[--out] = data;
-                }
-            } else {
-                // Check if compression is out of bounds
-                if (out < 1)
-                    return false;
-                decompressed[--out] = compressed[--index];
+static void TrimCodeCache(u64 new_entry_size, u64 max_size) {
+    struct CachedCode {
+        std::string path;
+        u64 size;
+        s64 modification_time;
+    };
+    std::vector<CachedCode> cached_codes;
+    u64 total_size = new_entry_size;
+    FileUtil::ForeachDirectoryEntry(
+        nullptr, GetCodeCacheDirectory(),
+        [&](unsigned* num_entries_out, const std::string& directory, const std::string& name) {
+            CachedCode cached_code{directory + DIR_SEP + name, 0, 0};
+            if (!FileUtil::IsDirectory(cached_code.path) &&
+                FileUtil::GetSizeAndModificationTime(cached_code.path, cached_code.size,
+                                                     cached_code.modification_time)) {
+                total_size += cached_code.size;
+                cached_codes.push_back(std::move(cached_code));
             }
-            control <<= 1;
-        }
+            return true;
+        });
+    if (total_size <= max_size)
+        return;
+
+    std::sort(cached_codes.begin(), cached_codes.end(),
+              [](const CachedCode& a, const CachedCode& b) {
+                  return a.modification_time < b.modification_time;
+              });
+    for (const CachedCode& cached_code : cached_codes) {
+        if (total_size <= max_size)
+            break;
+        if (FileUtil::Delete(cached_code.path))
+            total_size -= cached_code.size;
     }
+}
+
+/// Stores a decompressed .code in the cache, so that the next boots don't decompress it again
+static void StoreCachedCode(const std::string& path, const std::vector<u8>& buffer) {
+    const u64 max_size = static_cast<u64>(Settings::values.code_cache_size) * 1024 * 1024;
+    if (buffer.size() > max_size)
+        return;
+
+    TrimCodeCache(buffer.size(), max_size);
+    if (!FileUtil::WriteFileAtomically(path, buffer.data(), buffer.size()))
+        LOG_WARNING(Service_FS, "Failed to cache the decompressed .code at %s", path.c_str());
+}
+
+/**
+ * Decompresses a .code section, or loads it from the cache if it was already decompressed. The
+ * cache is keyed by the hash of the compressed data, so that updated titles aren't confused with
+ * their previous version.
+ * @return True on success, false if the compressed data is invalid
+ */
+static bool DecompressCode(u64 program_id, const u8* compressed, u32 compressed_size,
+                           std::vector<u8>& buffer) {
+    using Clock = std::chrono::steady_clock;
+    const auto start = Clock::now();
+    auto elapsed_ms = [&start] {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    };
+
+    if (compressed_size < 8)
+        return false;
+
+    const bool use_cache = Settings::values.code_cache_size != 0;
+    const std::string cache_path =
+        use_cache ? GetCodeCachePath(program_id, Common::ComputeHash64(compressed, compressed_size))
+                  : "";
+    const u32 decompressed_size = LZSS_GetDecompressedSize(compressed, compressed_size);
+    buffer.resize(decompressed_size);
+
+    if (use_cache && LoadCachedCode(cache_path, buffer)) {
+        LOG_INFO(Loader, "Loaded the decompressed .code from the cache in %.2f ms", elapsed_ms());
+        return true;
+    }
+
+    if (!LZSS_Decompress(compressed, compressed_size, buffer.data(), decompressed_size))
+        return false;
+    LOG_INFO(Loader, "Decompressed .code (%u bytes) in %.2f ms", decompressed_size, elapsed_ms());
+
+    if (use_cache)
+        StoreCachedCode(cache_path, buffer);
     return true;
 }
 
@@ -281,9 +324,7 @@ Loader::ResultStatus NCCHContainer::LoadSectionExeFS(const char* name, std::vect
                     return Loader::ResultStatus::Error;
 
                 // Decompress .code section...
-                u32 decompressed_size = LZSS_GetDecompressedSize(&temp_buffer[0], section.size);
-                buffer.resize(decompressed_size);
-                if (!LZSS_Decompress(&temp_buffer[0], section.size, &buffer[0], decompressed_size))
+                if (!DecompressCode(ncch_header.program_id, &temp_buffer[0], section.size, buffer))
                     return Loader::ResultStatus::ErrorInvalidFormat;
             } else {
                 // Section is uncompressed...
@@ -13,6 +13,10 @@
 
 namespace FileSys {
 
+SaveDataArchive::~SaveDataArchive() {
+    LogFileCacheStats(GetName(), *cache_stats);
+}
+
 ResultVal<std::unique_ptr<FileBackend>> SaveDataArchive::OpenFile(const Path& path,
                                                                   const Mode& mode) const {
     LOG_DEBUG(Service_FS, "called path=%s mode=%01X", path.DebugStr().c_str(), mode.hex);
@@ -67,8 +71,8 @@ ResultVal<std::unique_ptr<FileBackend>> SaveDataArchive::OpenFile(const Path& pa
         return ERROR_FILE_NOT_FOUND;
     }
 
-    auto disk_file = std::make_unique<DiskFile>(std::move(file), mode);
-    return MakeResult<std::unique_ptr<FileBackend>>(std::move(disk_file));
+    return MakeResult<std::unique_ptr<FileBackend>>(
+        MakeCachedDiskFile(std::move(file), mode, full_path, cache_stats));
 }
 
 ResultCode SaveDataArchive::DeleteFile(const Path& path) const {
@@ -4,8 +4,10 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
 #include "core/file_sys/archive_backend.h"
+#include "core/file_sys/cached_file.h"
 #include "core/file_sys/directory_backend.h"
 #include "core/file_sys/file_backend.h"
 #include "core/hle/result.h"
@@ -19,6 +21,7 @@ namespace FileSys {
 class SaveDataArchive : public ArchiveBackend {
 public:
     explicit SaveDataArchive(const std::string& mount_point_) : mount_point(mount_point_) {}
+    ~SaveDataArchive() override;
 
     std::string GetName() const override {
         return "SaveDataArchive: " + mount_point;
@@ -38,6 +41,7 @@ public:
 
 protected:
     std::string mount_point;
+    std::shared_ptr<FileCacheStats> cache_stats = std::make_shared<FileCacheStats>();
 };
 
 } // namespace FileSys
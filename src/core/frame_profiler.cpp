@@ -0,0 +1,219 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <numeric>
+#include <string>
+#include "common/string_util.h"
+#include "core/frame_profiler.h"
+
+namespace Core {
+
+/// Upper bounds of the histogram buckets in milliseconds, followed by an unbounded bucket
+static constexpr std::array<double, 9> HISTOGRAM_BOUNDS_MS{
+    {0.25, 0.5, 1.0, 2.0, 4.0, 8.0, 16.0, 32.0, 64.0}};
+
+static double ToMilliseconds(FrameProfiler::Clock::duration duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+/// Formats the distribution of a set of per-frame times as a JSON object
+static std::string FormatDistribution(std::vector<double> times_ms) {
+    std::sort(times_ms.begin(), times_ms.end());
+    auto percentile = [&times_ms](double fraction) {
+        const size_t index = static_cast<size_t>(fraction * (times_ms.size() - 1) + 0.5);
+        return times_ms[index];
+    };
+    const double mean = std::accumulate(times_ms.begin(), times_ms.end(), 0.0) / times_ms.size();
+
+    std::string json = Common::StringFromFormat(
+        "{\"mean_ms\": %.4f, \"p50_ms\": %.4f, \"p90_ms\": %.4f, \"p99_ms\": %.4f, "
+        "\"max_ms\": %.4f, \"histogram\": [",
+        mean, percentile(0.5), percentile(0.9), percentile(0.99), times_ms.back());
+
+    auto bucket_begin = times_ms.begin();
+    for (double bound : HISTOGRAM_BOUNDS_MS) {
+        const auto bucket_end = std::upper_bound(bucket_begin, times_ms.end(), bound);
+        json += Common::StringFromFormat("{\"le_ms\": %g, \"count\": %zu}, ", bound,
+                                         static_cast<size_t>(bucket_end - bucket_begin));
+        bucket_begin = bucket_end;
+    }
+    json += Common::StringFromFormat("{\"le_ms\": null, \"count\": %zu}]}",
+                                     static_cast<size_t>(times_ms.end() - bucket_begin));
+    return json;
+}
+
+void FrameProfiler::Start(bool count_hardware_events) {
+    if (counting_hardware_events) {
+        Common::PerfCounters::Stop();
+    }
+    counting_hardware_events = count_hardware_events && Common::PerfCounters::Start();
+    for (size_t i = 0; i < counted_events.size(); ++i) {
+        counted_events[i] = counting_hardware_events &&
+                            Common::PerfCounters::IsEventCounted(
+                                static_cast<Common::PerfCounters::Event>(i));
+    }
+    recording = true;
+    stack.clear();
+    frames.clear();
+    current_frame = {};
+    frame_begin = last_switch = Clock::now();
+}
+
+void FrameProfiler::Stop() {
+    if (counting_hardware_events) {
+        Common::PerfCounters::Stop();
+        counting_hardware_events = false;
+    }
+    recording = false;
+    stack.clear();
+}
+
+void FrameProfiler::EndFrame() {
+    if (!recording) {
+        return;
+    }
+
+    const Clock::time_point now = Clock::now();
+    CountElapsedTime(now);
+    current_frame.total = now - frame_begin;
+    if (counting_hardware_events) {
+        current_frame.counters = Common::PerfCounters::TakeCounts();
+    }
+    frames.push_back(current_frame);
+
+    current_frame = {};
+    frame_begin = now;
+}
+
+std::string FrameProfiler::ToJSON(const PerfStats::Results& perf_results) const {
+    std::string json = Common::StringFromFormat(
+        "{\n  \"frames\": %zu,\n"
+        "  \"perf_stats\": {\"system_fps\": %.3f, \"game_fps\": %.3f, \"frametime_ms\": %.4f, "
+        "\"emulation_speed\": %.4f, \"context_switch_rate\": %.1f, \"ipc_request_rate\": %.1f, "
+        "\"ipc_bytes_per_request\": %.1f, \"surface_downloads\": %u, "
+        "\"early_surface_downloads\": %u, \"surface_download_stall_ms\": %.4f, "
+        "\"skipped_frames\": %u, \"frame_skip_speed_gain\": %.4f, \"pacing_error_max_ms\": %.4f, "
+        "\"pacing_error_histogram\": [",
+        frames.size(), perf_results.system_fps, perf_results.game_fps,
+        perf_results.frametime * 1000.0, perf_results.emulation_speed,
+        perf_results.context_switch_rate, perf_results.ipc_request_rate,
+        perf_results.ipc_bytes_per_request, perf_results.surface_downloads,
+        perf_results.early_surface_downloads, perf_results.surface_download_stall_time * 1000.0,
+        perf_results.skipped_frames, perf_results.frame_skip_speed_gain,
+        perf_results.pacing_error_max * 1000.0);
+    for (size_t i = 0; i < PerfStats::PACING_ERROR_BUCKETS_US.size(); ++i) {
+        json += Common::StringFromFormat("{\"le_us\": %u, \"count\": %u}, ",
+                                         PerfStats::PACING_ERROR_BUCKETS_US[i],
+                                         perf_results.pacing_error_histogram[i]);
+    }
+    json += Common::StringFromFormat("{\"le_us\": null, \"count\": %u}",
+                                     perf_results.pacing_error_histogram.back());
+    json += "]},\n";
+
+    if (frames.empty()) {
+        return json + "  \"components\": {}\n}\n";
+    }
+
+    static constexpr std::array<const char*, NumComponents> component_names{
+        {"cpu", "gpu", "dsp", "hle"}};
+
+    auto distribution = [this](auto&& get_time) {
+        std::vector<double> times_ms(frames.size());
+        std::transform(frames.begin(), frames.end(), times_ms.begin(),
+                       [&](const Frame& frame) { return ToMilliseconds(get_time(frame)); });
+        return FormatDistribution(std::move(times_ms));
+    };
+
+    json += "  \"components\": {\n    \"total\": ";
+    json += distribution([](const Frame& frame) { return frame.total; });
+    for (size_t i = 0; i < NumComponents; ++i) {
+        json += Common::StringFromFormat(",\n    \"%s\": ", component_names[i]);
+        json += distribution([i](const Frame& frame) { return frame.components[i]; });
+    }
+    json += ",\n    \"other\": ";
+    json += distribution([](const Frame& frame) {
+        Clock::duration left = frame.total;
+        for (Clock::duration component : frame.components) {
+            left -= component;
+        }
+        return left;
+    });
+    json += "\n  }";
+
+    if (std::find(counted_events.begin(), counted_events.end(), true) != counted_events.end()) {
+        json += ",\n  \"hardware_counters\": {";
+        json += FormatHardwareCounters();
+        json += "\n  }";
+    }
+    json += "\n}\n";
+    return json;
+}
+
+std::string FrameProfiler::FormatHardwareCounters() const {
+    namespace PerfCounters = Common::PerfCounters;
+    constexpr size_t CYCLES = static_cast<size_t>(PerfCounters::Event::Cycles);
+    constexpr size_t INSTRUCTIONS = static_cast<size_t>(PerfCounters::Event::Instructions);
+
+    std::string json;
+    for (size_t scope = 0; scope < PerfCounters::NumScopes; ++scope) {
+        PerfCounters::ScopeCounts total;
+        for (const Frame& frame : frames) {
+            total.calls += frame.counters[scope].calls;
+            for (size_t event = 0; event < PerfCounters::NumEvents; ++event) {
+                total.events[event] += frame.counters[scope].events[event];
+            }
+        }
+
+        json += Common::StringFromFormat(
+            "%s\n    \"%s\": {\"calls\": %.1f", scope == 0 ? "" : ",",
+            PerfCounters::GetScopeName(static_cast<PerfCounters::Scope>(scope)),
+            static_cast<double>(total.calls) / frames.size());
+        for (size_t event = 0; event < PerfCounters::NumEvents; ++event) {
+            const char* name = PerfCounters::GetEventName(static_cast<PerfCounters::Event>(event));
+            if (counted_events[event]) {
+                json += Common::StringFromFormat(", \"%s\": %.1f", name,
+                                                 static_cast<double>(total.events[event]) /
+                                                     frames.size());
+            } else {
+                json += Common::StringFromFormat(", \"%s\": null", name);
+            }
+        }
+
+        // Instructions per cycle, over all the frames
+        if (counted_events[CYCLES] && counted_events[INSTRUCTIONS] && total.events[CYCLES] != 0) {
+            json += Common::StringFromFormat(
+                ", \"ipc\": %.3f}",
+                static_cast<double>(total.events[INSTRUCTIONS]) / total.events[CYCLES]);
+        } else {
+            json += ", \"ipc\": null}";
+        }
+    }
+    return json;
+}
+
+void FrameProfiler::Enter(Component component) {
+    CountElapsedTime(Clock::now());
+    stack.push_back(component);
+}
+
+void FrameProfiler::Leave() {
+    // The profiler may have been stopped and restarted since the component was entered
+    if (stack.empty()) {
+        return;
+    }
+    CountElapsedTime(Clock::now());
+    stack.pop_back();
+}
+
+void FrameProfiler::CountElapsedTime(Clock::time_point now) {
+    if (!stack.empty()) {
+        current_frame.components[static_cast<size_t>(stack.back())] += now - last_switch;
+    }
+    last_switch = now;
+}
+
+} // namespace Core
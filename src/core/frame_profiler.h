@@ -0,0 +1,127 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "common/common_types.h"
+#include "common/perf_counters.h"
+#include "core/perf_stats.h"
+
+namespace Core {
+
+/**
+ * Breaks the walltime of each system frame (LCD VBlank) down into the time spent in the components
+ * of the emulator, for benchmarking. Components are timed with Scope objects, and time is counted
+ * towards the innermost one: an HLE service call made while the CPU runs counts as HLE time, not
+ * CPU time. Time outside of any component (scheduling, timing events, the frontend) is left over.
+ *
+ * Nothing is recorded unless the profiler was started. Unlike PerfStats, this class isn't
+ * thread-safe: it must only be used from the emulation thread.
+ */
+class FrameProfiler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    enum class Component : u8 {
+        CPU, ///< Emulated ARM11 code
+        GPU, ///< PICA command lists, display transfers and memory fills, presenting frames
+        DSP, ///< HLE audio processing
+        HLE, ///< Supervisor calls, including the HLE services handling IPC requests
+    };
+    static constexpr size_t NumComponents = 4;
+
+    struct Frame {
+        /// Walltime of the whole frame
+        Clock::duration total = Clock::duration::zero();
+        /// Walltime spent in each component, indexed by Component
+        std::array<Clock::duration, NumComponents> components{};
+        /// Hardware events counted in the hot scopes, if counting them
+        Common::PerfCounters::Counts counters{};
+    };
+
+    /// Counts the time until the end of its scope towards a component, if the profiler is started
+    class Scope {
+    public:
+        Scope(FrameProfiler& profiler, Component component) : profiler(profiler) {
+            active = profiler.recording;
+            if (active) {
+                profiler.Enter(component);
+            }
+        }
+
+        ~Scope() {
+            if (active) {
+                profiler.Leave();
+            }
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        FrameProfiler& profiler;
+        bool active;
+    };
+
+    /**
+     * Starts recording, dropping the frames previously recorded. The first frame starts now.
+     * @param count_hardware_events Whether to also count hardware events in the hot scopes, on the
+     *                              calling thread. This slows down emulation.
+     */
+    void Start(bool count_hardware_events = false);
+
+    /// Stops recording. The current frame, which isn't complete, is dropped.
+    void Stop();
+
+    bool IsRecording() const {
+        return recording;
+    }
+
+    /// Ends the current frame and starts the next one. Called at each VBlank.
+    void EndFrame();
+
+    /// Returns the frames recorded, in order
+    const std::vector<Frame>& GetFrames() const {
+        return frames;
+    }
+
+    /**
+     * Formats the recorded frames as a JSON object. For the whole frames, each component and the
+     * time left over, it has the mean, percentiles and a histogram of the per-frame times, in
+     * milliseconds. If hardware events were counted, it also has their mean per frame in each
+     * scope.
+     * @param perf_results Performance statistics of the same period, to include in the report
+     */
+    std::string ToJSON(const PerfStats::Results& perf_results) const;
+
+private:
+    void Enter(Component component);
+    void Leave();
+
+    /// Formats the mean per frame of the hardware events counted in each scope, as JSON members
+    std::string FormatHardwareCounters() const;
+
+    /// Counts the time since the last switch towards the component currently running, if any
+    void CountElapsedTime(Clock::time_point now);
+
+    bool recording = false;
+    bool counting_hardware_events = false;
+    /// Hardware events counted in the recorded frames, indexed by Common::PerfCounters::Event
+    std::array<bool, Common::PerfCounters::NumEvents> counted_events{};
+
+    /// Components currently timed, the innermost last
+    std::vector<Component> stack;
+    /// Point when the current frame began
+    Clock::time_point frame_begin;
+    /// Point when the running component last changed
+    Clock::time_point last_switch;
+    Frame current_frame;
+    std::vector<Frame> frames;
+};
+
+} // namespace Core
@@ -35,6 +35,7 @@
 #include "core/arm/arm_interface.h"
 #include "core/core.h"
 #include "core/gdbstub/gdbstub.h"
+#include "core/hle/kernel/thread.h"
 #include "core/loader/loader.h"
 #include "core/memory.h"
 
@@ -450,6 +451,9 @@ static void SendSignal(u32 signal) {
 
     latest_signal = signal;
 
+    // The emulation is halted, the contexts of all threads may be inspected
+    Kernel::SaveThreadContexts();
+
     std::string buffer =
         Common::StringFromFormat("T%02x%02x:%08x;%02x:%08x;", latest_signal, 15,
                                  htonl(Core::CPU().GetPC()), 13, htonl(Core::CPU().GetReg(13)));
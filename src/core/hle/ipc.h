@@ -24,8 +24,11 @@ static const int kCommandHeaderOffset = 0x80;
  * @return Pointer to command buffer
  */
 inline u32* GetCommandBuffer(const int offset = 0) {
-    return (u32*)Memory::GetPointer(GetCurrentThread()->GetTLSAddress() + kCommandHeaderOffset +
-                                    offset);
+    u8* pointer = Memory::GetPointer(GetCurrentThread()->GetTLSAddress() + kCommandHeaderOffset +
+                                     offset);
+    // The services write their replies there, up to the end of the TLS of the thread
+    Memory::NotifyHostWrite(pointer, Memory::TLS_ENTRY_SIZE - kCommandHeaderOffset - offset);
+    return reinterpret_cast<u32*>(pointer);
 }
 
 /// Offset into static buffers, relative to command buffer header
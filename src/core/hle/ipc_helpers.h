@@ -318,6 +318,13 @@ public:
     VAddr PopMappedBuffer(size_t* data_size = nullptr,
                           MappedBufferPermissions* buffer_perms = nullptr);
 
+    /**
+     * Pops a static or mapped buffer descriptor and returns a view of the guest memory it
+     * describes, which can be read and written without an intermediate copy. Only available when
+     * parsing a request through an HLERequestContext.
+     */
+    const Kernel::MappedBuffer& PopMappedBufferView();
+
     /**
      * @brief Reads the next normal parameters as a struct, by copying it
      * @note: The output class must be correctly packed/padded to fit hardware layout.
@@ -468,6 +475,13 @@ inline VAddr RequestParser::PopStaticBuffer(size_t* data_size, bool useStaticBuf
     }
 }
 
+inline const Kernel::MappedBuffer& RequestParser::PopMappedBufferView() {
+    ASSERT_MSG(context != nullptr, "Buffer views are only available with an HLERequestContext");
+    const Kernel::MappedBuffer& buffer = context->GetMappedBuffer(index);
+    Skip(2, false);
+    return buffer;
+}
+
 inline VAddr RequestParser::PopMappedBuffer(size_t* data_size,
                                             MappedBufferPermissions* buffer_perms) {
     const u32 sbuffer_descriptor = Pop<u32>();
@@ -2,14 +2,17 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <boost/range/algorithm_ext/erase.hpp>
 #include "common/assert.h"
 #include "common/common_types.h"
+#include "common/logging/log.h"
 #include "core/hle/kernel/handle_table.h"
 #include "core/hle/kernel/hle_ipc.h"
 #include "core/hle/kernel/kernel.h"
 #include "core/hle/kernel/process.h"
 #include "core/hle/kernel/server_session.h"
+#include "core/memory.h"
 
 namespace Kernel {
 
@@ -23,6 +26,53 @@ void SessionRequestHandler::ClientDisconnected(SharedPtr<ServerSession> server_s
     boost::range::remove_erase(connected_sessions, server_session);
 }
 
+MappedBuffer::MappedBuffer(const Process& process, u32 descriptor, VAddr address)
+    : process(&process), address(address) {
+    if (IPC::GetDescriptorType(descriptor) == IPC::DescriptorType::StaticBuffer) {
+        // Static buffers are only ever read by the receiver
+        size = IPC::StaticBufferDescInfo{descriptor}.size;
+        perms = IPC::MappedBufferPermissions::R;
+    } else {
+        IPC::MappedBufferDescInfo info{descriptor};
+        size = info.size;
+        perms = info.perms;
+    }
+}
+
+size_t MappedBuffer::ClampRange(size_t offset, size_t size) const {
+    if (offset > this->size) {
+        LOG_ERROR(Kernel, "Offset 0x%zX is past the end of the buffer of size 0x%zX", offset,
+                  this->size);
+        return 0;
+    }
+    if (size > this->size - offset) {
+        LOG_ERROR(Kernel, "Range of size 0x%zX at 0x%zX runs past the buffer of size 0x%zX", size,
+                  offset, this->size);
+        return this->size - offset;
+    }
+    return size;
+}
+
+size_t MappedBuffer::Read(void* dest_buffer, size_t offset, size_t size) const {
+    if (!(perms & IPC::MappedBufferPermissions::R)) {
+        LOG_ERROR(Kernel, "Reading from a buffer at 0x%08X that isn't readable", address);
+        return 0;
+    }
+    size = ClampRange(offset, size);
+    Memory::ReadBlock(*process, static_cast<VAddr>(address + offset), dest_buffer, size);
+    return size;
+}
+
+size_t MappedBuffer::Write(const void* src_buffer, size_t offset, size_t size) const {
+    if (!(perms & IPC::MappedBufferPermissions::W)) {
+        LOG_ERROR(Kernel, "Writing to a buffer at 0x%08X that isn't writable", address);
+        return 0;
+    }
+    size = ClampRange(offset, size);
+    Memory::WriteBlock(*process, static_cast<VAddr>(address + offset), src_buffer, size);
+    return size;
+}
+
 HLERequestContext::HLERequestContext(SharedPtr<ServerSession> session)
     : session(std::move(session)) {
     cmd_buf[0] = 0;
@@ -44,6 +94,15 @@ void HLERequestContext::ClearIncomingObjects() {
     request_handles.clear();
 }
 
+const MappedBuffer& HLERequestContext::GetMappedBuffer(size_t descriptor_index) const {
+    auto itr = std::find_if(mapped_buffers.begin(), mapped_buffers.end(),
+                            [descriptor_index](const std::pair<size_t, MappedBuffer>& buffer) {
+                                return buffer.first == descriptor_index;
+                            });
+    ASSERT_MSG(itr != mapped_buffers.end(), "No buffer descriptor at offset %zu", descriptor_index);
+    return itr->second;
+}
+
 ResultCode HLERequestContext::PopulateFromIncomingCommandBuffer(const u32_le* src_cmdbuf,
                                                                 Process& src_process,
                                                                 HandleTable& src_table) {
@@ -54,6 +113,7 @@ ResultCode HLERequestContext::PopulateFromIncomingCommandBuffer(const u32_le* sr
     ASSERT(command_size <= IPC::COMMAND_BUFFER_LENGTH); // TODO(yuriks): Return error
 
     std::copy_n(src_cmdbuf, untranslated_size, cmd_buf.begin());
+    bytes_copied += command_size * sizeof(u32);
 
     size_t i = untranslated_size;
     while (i < command_size) {
@@ -84,6 +144,16 @@ ResultCode HLERequestContext::PopulateFromIncomingCommandBuffer(const u32_le* sr
             cmd_buf[i++] = src_process.process_id;
             break;
         }
+        case IPC::DescriptorType::StaticBuffer:
+        case IPC::DescriptorType::MappedBuffer: {
+            // The service shares the address space of the requesting process, so the buffer is
+            // accessed in place instead of being copied or mapped.
+            ASSERT(i < command_size); // TODO(yuriks): Return error
+            VAddr address = cmd_buf[i] = src_cmdbuf[i];
+            mapped_buffers.emplace_back(i - 1, MappedBuffer(src_process, descriptor, address));
+            i += 1;
+            break;
+        }
         default:
             UNIMPLEMENTED_MSG("Unsupported handle translation: 0x%08X", descriptor);
         }
@@ -101,6 +171,7 @@ ResultCode HLERequestContext::WriteToOutgoingCommandBuffer(u32_le* dst_cmdbuf, P
     ASSERT(command_size <= IPC::COMMAND_BUFFER_LENGTH);
 
     std::copy_n(cmd_buf.begin(), untranslated_size, dst_cmdbuf);
+    bytes_copied += command_size * sizeof(u32);
 
     size_t i = untranslated_size;
     while (i < command_size) {
@@ -124,6 +195,14 @@ ResultCode HLERequestContext::WriteToOutgoingCommandBuffer(u32_le* dst_cmdbuf, P
             }
             break;
         }
+        case IPC::DescriptorType::StaticBuffer:
+        case IPC::DescriptorType::MappedBuffer: {
+            // Buffers are written to in place by the service, only the address is passed back
+            ASSERT(i < command_size);
+            dst_cmdbuf[i] = cmd_buf[i];
+            i += 1;
+            break;
+        }
         default:
             UNIMPLEMENTED_MSG("Unsupported handle translation: 0x%08X", descriptor);
         }
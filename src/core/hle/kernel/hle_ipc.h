@@ -6,6 +6,7 @@
 
 #include <array>
 #include <memory>
+#include <utility>
 #include <vector>
 #include <boost/container/small_vector.hpp>
 #include "common/common_types.h"
@@ -63,6 +64,52 @@ protected:
     std::vector<SharedPtr<ServerSession>> connected_sessions;
 };
 
+/**
+ * View of a guest memory buffer passed to an HLE service through a static or mapped buffer
+ * descriptor. HLE services run in the address space of the requesting process, so instead of
+ * being copied into an intermediate buffer, the data is transferred straight between the guest
+ * memory and the service's own storage.
+ */
+class MappedBuffer {
+public:
+    MappedBuffer(const Process& process, u32 descriptor, VAddr address);
+
+    /**
+     * Copies size bytes starting at offset in the buffer to dest_buffer. The sizes come from the
+     * guest, so a range running past the end of the buffer is clamped to it.
+     * @returns the number of bytes copied
+     */
+    size_t Read(void* dest_buffer, size_t offset, size_t size) const;
+
+    /**
+     * Copies size bytes from src_buffer to the buffer, starting at offset. A range running past
+     * the end of the buffer is clamped to it.
+     * @returns the number of bytes copied
+     */
+    size_t Write(const void* src_buffer, size_t offset, size_t size) const;
+
+    VAddr GetAddress() const {
+        return address;
+    }
+
+    size_t GetSize() const {
+        return size;
+    }
+
+    IPC::MappedBufferPermissions GetPermissions() const {
+        return perms;
+    }
+
+private:
+    /// Returns the size of a range of the buffer, clamped to the end of the buffer
+    size_t ClampRange(size_t offset, size_t size) const;
+
+    const Process* process;
+    VAddr address;
+    size_t size;
+    IPC::MappedBufferPermissions perms;
+};
+
 /**
  * Class containing information about an in-flight IPC request being handled by an HLE service
  * implementation. Services should avoid using old global APIs (e.g. Kernel::GetCommandBuffer()) and
@@ -119,6 +166,17 @@ public:
      */
     void ClearIncomingObjects();
 
+    /**
+     * Returns the buffer described by the static or mapped buffer descriptor at the given offset
+     * in the command buffer.
+     */
+    const MappedBuffer& GetMappedBuffer(size_t descriptor_index) const;
+
+    /// Returns the number of bytes copied between the guest and this context to serve the request.
+    size_t GetBytesCopied() const {
+        return bytes_copied;
+    }
+
     /// Populates this context with data from the requesting process/thread.
     ResultCode PopulateFromIncomingCommandBuffer(const u32_le* src_cmdbuf, Process& src_process,
                                                  HandleTable& src_table);
@@ -131,6 +189,9 @@ private:
     SharedPtr<ServerSession> session;
     // TODO(yuriks): Check common usage of this and optimize size accordingly
     boost::container::small_vector<SharedPtr<Object>, 8> request_handles;
+    /// Buffers of the request, with the offset of their descriptor in the command buffer
+    boost::container::small_vector<std::pair<size_t, MappedBuffer>, 4> mapped_buffers;
+    mutable size_t bytes_copied = 0;
 };
 
 } // namespace Kernel
@@ -4,6 +4,7 @@
 
 #include <tuple>
 
+#include "core/core.h"
 #include "core/hle/kernel/client_port.h"
 #include "core/hle/kernel/client_session.h"
 #include "core/hle/kernel/hle_ipc.h"
@@ -65,6 +66,7 @@ ResultCode ServerSession::HandleSyncRequest(SharedPtr<Thread> thread) {
         ResultCode result = TranslateHLERequest(this);
         if (result.IsError())
             return result;
+        Core::System::GetInstance().perf_stats.AddIPCRequest();
         hle_handler->HandleSyncRequest(SharedPtr<ServerSession>(this));
         // TODO(Subv): Translate the response command buffer.
     } else {
@@ -178,7 +178,10 @@ VMAPermission SharedMemory::ConvertPermissions(MemoryPermission permission) {
 };
 
 u8* SharedMemory::GetPointer(u32 offset) {
-    return backing_block->data() + backing_block_offset + offset;
+    u8* pointer = backing_block->data() + backing_block_offset + offset;
+    // The HLE services write to the shared memory through this pointer
+    Memory::NotifyHostWrite(pointer, size - offset);
+    return pointer;
 }
 
 } // namespace Kernel
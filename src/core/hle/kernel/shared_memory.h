@@ -98,7 +98,8 @@ public:
     ResultCode Unmap(Process* target_process, VAddr address);
 
     /**
-    * Gets a pointer to the shared memory block
+    * Gets a pointer to the shared memory block, reporting the rest of the block as written to
+    * (see Memory::NotifyHostWrite)
     * @param offset Offset from the start of the shared memory block to get pointer
     * @return Pointer to the shared memory block from the specified offset
     */
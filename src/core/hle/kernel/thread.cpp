@@ -4,8 +4,11 @@
 
 #include <algorithm>
 #include <list>
+#include <tuple>
+#include <unordered_map>
 #include <vector>
 #include "common/assert.h"
+#include "common/chunk_file.h"
 #include "common/common_types.h"
 #include "common/logging/log.h"
 #include "common/math_util.h"
@@ -47,8 +50,17 @@ static std::vector<SharedPtr<Thread>> thread_list;
 // Lists only ready thread ids.
 static Common::ThreadQueueList<Thread*, THREADPRIO_LOWEST + 1> ready_queue;
 
+// Threads waiting to be arbitrated, by arbitration address. Each queue is sorted by ascending
+// precedence, so that the thread to be arbitrated next is at the back.
+static std::unordered_map<VAddr, std::vector<Thread*>> arbiter_wait_queues;
+
 static SharedPtr<Thread> current_thread;
 
+// Thread whose VFP registers are currently loaded in the CPU. They are only saved to its context
+// when another thread is switched in, so that switching to the idle state and back to the same
+// thread leaves them in place.
+static Thread* vfp_context_owner = nullptr;
+
 // The first available thread id at startup
 static u32 next_thread_id;
 
@@ -67,14 +79,165 @@ Thread* GetCurrentThread() {
     return current_thread.get();
 }
 
+void SaveThreadContexts() {
+    if (current_thread) {
+        Core::CPU().SaveCoreContext(current_thread->context);
+    }
+    if (vfp_context_owner) {
+        Core::CPU().SaveVFPContext(vfp_context_owner->context);
+    }
+}
+
+/// Thread stored by DoThreadState. Only the registers and the running ticks are restored, the rest
+/// tells whether the thread is still in the state it was saved in.
+struct SavedThread {
+    u32 thread_id;
+    u32 status;
+    u32 current_priority;
+    VAddr wait_address;
+    Handle callback_handle;
+    std::vector<u32> wait_object_ids;
+    u64 last_running_ticks;
+    ARM_Interface::ThreadContext context;
+};
+
+struct SavedThreads {
+    /// Ids of the running thread and of the owner of the VFP registers, 0 if there is none
+    u32 current_thread_id = 0;
+    u32 vfp_context_owner_id = 0;
+    std::vector<SavedThread> threads;
+};
+
+static u32 GetIdOfThread(const Thread* thread) {
+    return thread != nullptr ? thread->thread_id : 0;
+}
+
+static SavedThreads GetSavedThreads() {
+    SaveThreadContexts();
+
+    SavedThreads saved;
+    saved.current_thread_id = GetIdOfThread(current_thread.get());
+    saved.vfp_context_owner_id = GetIdOfThread(vfp_context_owner);
+    saved.threads.reserve(thread_list.size());
+    for (const auto& thread : thread_list) {
+        SavedThread saved_thread;
+        saved_thread.thread_id = thread->thread_id;
+        saved_thread.status = thread->status;
+        saved_thread.current_priority = thread->current_priority;
+        saved_thread.wait_address = thread->wait_address;
+        saved_thread.callback_handle = thread->callback_handle;
+        saved_thread.last_running_ticks = thread->last_running_ticks;
+        saved_thread.context = thread->context;
+        for (const auto& object : thread->wait_objects) {
+            saved_thread.wait_object_ids.push_back(object->GetObjectId());
+        }
+        saved.threads.push_back(std::move(saved_thread));
+    }
+    return saved;
+}
+
+static void DoSavedThreads(PointerWrap& p, SavedThreads& saved) {
+    auto s = p.Section("Threads", 1);
+    if (!s)
+        return;
+
+    p.Do(saved.current_thread_id);
+    p.Do(saved.vfp_context_owner_id);
+    u32 count = static_cast<u32>(saved.threads.size());
+    p.Do(count);
+    saved.threads.resize(count);
+    for (SavedThread& thread : saved.threads) {
+        p.Do(thread.thread_id);
+        p.Do(thread.status);
+        p.Do(thread.current_priority);
+        p.Do(thread.wait_address);
+        p.Do(thread.callback_handle);
+        p.Do(thread.wait_object_ids);
+        p.Do(thread.last_running_ticks);
+        p.Do(thread.context);
+    }
+}
+
+/// Checks that the saved threads are the existing ones, in the same state. The wakeup events in the
+/// CoreTiming queue refer to the threads by callback_handle, so these must match as well.
+static bool IsSavedStateOfThreads(const SavedThreads& saved) {
+    const SavedThreads running = GetSavedThreads();
+    const auto key = [](const SavedThread& thread) {
+        return std::tie(thread.thread_id, thread.status, thread.current_priority,
+                        thread.wait_address, thread.callback_handle, thread.wait_object_ids);
+    };
+    return saved.current_thread_id == running.current_thread_id &&
+           saved.vfp_context_owner_id == running.vfp_context_owner_id &&
+           std::equal(saved.threads.begin(), saved.threads.end(), running.threads.begin(),
+                      running.threads.end(), [&key](const SavedThread& a, const SavedThread& b) {
+                          return key(a) == key(b);
+                      });
+}
+
+void DoThreadState(PointerWrap& p) {
+    SavedThreads saved;
+    if (p.GetMode() != PointerWrap::MODE_READ) {
+        saved = GetSavedThreads();
+    }
+    DoSavedThreads(p, saved);
+    if (p.GetMode() != PointerWrap::MODE_READ || p.error == PointerWrap::ERROR_FAILURE) {
+        return;
+    }
+
+    if (!IsSavedStateOfThreads(saved)) {
+        LOG_ERROR(Kernel, "The saved threads don't match the running ones");
+        p.SetError(PointerWrap::ERROR_FAILURE);
+        return;
+    }
+    for (size_t i = 0; i < thread_list.size(); ++i) {
+        thread_list[i]->context = saved.threads[i].context;
+        thread_list[i]->last_running_ticks = saved.threads[i].last_running_ticks;
+    }
+    if (current_thread) {
+        Core::CPU().LoadCoreContext(current_thread->context);
+    }
+    if (vfp_context_owner) {
+        Core::CPU().LoadVFPContext(vfp_context_owner->context);
+    }
+}
+
+bool IsThreadStateRestorable(PointerWrap& p) {
+    SavedThreads saved;
+    DoSavedThreads(p, saved);
+    return p.error != PointerWrap::ERROR_FAILURE && IsSavedStateOfThreads(saved);
+}
+
 /**
- * Check if the specified thread is waiting on the specified address to be arbitrated
- * @param thread The thread to test
- * @param wait_address The address to test against
- * @return True if the thread is waiting, false otherwise
+ * Checks whether a thread waiting on an address arbiter is resumed before another one
+ * @return True if thread a has precedence over thread b
  */
-static bool CheckWait_AddressArbiter(const Thread* thread, VAddr wait_address) {
-    return thread->status == THREADSTATUS_WAIT_ARB && wait_address == thread->wait_address;
+static bool HasArbitrationPrecedence(const Thread* a, const Thread* b) {
+    // Among threads of the same priority, the most recently created one is resumed first
+    if (a->current_priority != b->current_priority)
+        return a->current_priority < b->current_priority;
+    return a->thread_id > b->thread_id;
+}
+
+/// Adds a thread to the wait queue of the address it's waiting to be arbitrated on
+static void AddArbiterWaiter(Thread* thread) {
+    auto& queue = arbiter_wait_queues[thread->wait_address];
+    auto position = std::upper_bound(
+        queue.begin(), queue.end(), thread,
+        [](const Thread* a, const Thread* b) { return HasArbitrationPrecedence(b, a); });
+    queue.insert(position, thread);
+}
+
+/// Removes a thread from the wait queue of the address it's waiting to be arbitrated on
+static void RemoveArbiterWaiter(Thread* thread) {
+    auto queue = arbiter_wait_queues.find(thread->wait_address);
+    if (queue == arbiter_wait_queues.end())
+        return;
+
+    auto& threads = queue->second;
+    threads.erase(std::remove(threads.begin(), threads.end(), thread), threads.end());
+    if (threads.empty()) {
+        arbiter_wait_queues.erase(queue);
+    }
 }
 
 void Thread::Stop() {
@@ -87,10 +250,17 @@ void Thread::Stop() {
     // This is only needed when the thread is termintated forcefully (SVC TerminateProcess)
     if (status == THREADSTATUS_READY) {
         ready_queue.remove(current_priority, this);
+    } else if (status == THREADSTATUS_WAIT_ARB) {
+        RemoveArbiterWaiter(this);
     }
 
     status = THREADSTATUS_DEAD;
 
+    // The VFP registers of a dead thread don't need to be saved anymore
+    if (vfp_context_owner == this) {
+        vfp_context_owner = nullptr;
+    }
+
     WakeupAllWaitingThreads();
 
     // Clean up any dangling references in objects that this thread was waiting for
@@ -110,36 +280,27 @@ void Thread::Stop() {
 }
 
 Thread* ArbitrateHighestPriorityThread(u32 address) {
-    Thread* highest_priority_thread = nullptr;
-    u32 priority = THREADPRIO_LOWEST;
-
-    // Iterate through threads, find highest priority thread that is waiting to be arbitrated...
-    for (auto& thread : thread_list) {
-        if (!CheckWait_AddressArbiter(thread.get(), address))
-            continue;
+    auto queue = arbiter_wait_queues.find(address);
+    if (queue == arbiter_wait_queues.end())
+        return nullptr;
 
-        if (thread == nullptr)
-            continue;
-
-        if (thread->current_priority <= priority) {
-            highest_priority_thread = thread.get();
-            priority = thread->current_priority;
-        }
-    }
-
-    // If a thread was arbitrated, resume it
-    if (nullptr != highest_priority_thread) {
-        highest_priority_thread->ResumeFromWait();
-    }
+    // Resuming the thread removes it from the wait queue
+    Thread* highest_priority_thread = queue->second.back();
+    highest_priority_thread->ResumeFromWait();
 
     return highest_priority_thread;
 }
 
 void ArbitrateAllThreads(u32 address) {
-    // Resume all threads found to be waiting on the address
-    for (auto& thread : thread_list) {
-        if (CheckWait_AddressArbiter(thread.get(), address))
-            thread->ResumeFromWait();
+    auto queue = arbiter_wait_queues.find(address);
+    if (queue == arbiter_wait_queues.end())
+        return;
+
+    // Threads of the same priority are resumed in the order they were created
+    std::vector<Thread*> threads = std::move(queue->second);
+    arbiter_wait_queues.erase(queue);
+    for (Thread* thread : threads) {
+        thread->ResumeFromWait();
     }
 }
 
@@ -153,7 +314,7 @@ static void SwitchContext(Thread* new_thread) {
     // Save context for previous thread
     if (previous_thread) {
         previous_thread->last_running_ticks = CoreTiming::GetTicks();
-        Core::CPU().SaveContext(previous_thread->context);
+        Core::CPU().SaveCoreContext(previous_thread->context);
 
         if (previous_thread->status == THREADSTATUS_RUNNING) {
             // This is only the case when a reschedule is triggered without the current thread
@@ -183,7 +344,14 @@ static void SwitchContext(Thread* new_thread) {
             SetCurrentPageTable(&Kernel::g_current_process->vm_manager.page_table);
         }
 
-        Core::CPU().LoadContext(new_thread->context);
+        Core::CPU().LoadCoreContext(new_thread->context);
+        if (vfp_context_owner != new_thread) {
+            if (vfp_context_owner) {
+                Core::CPU().SaveVFPContext(vfp_context_owner->context);
+            }
+            Core::CPU().LoadVFPContext(new_thread->context);
+            vfp_context_owner = new_thread;
+        }
         Core::CPU().SetCP15Register(CP15_THREAD_URO, new_thread->GetTLSAddress());
     } else {
         current_thread = nullptr;
@@ -224,6 +392,7 @@ void WaitCurrentThread_ArbitrateAddress(VAddr wait_address) {
     Thread* thread = GetCurrentThread();
     thread->wait_address = wait_address;
     thread->status = THREADSTATUS_WAIT_ARB;
+    AddArbiterWaiter(thread);
 }
 
 void ExitCurrentThread() {
@@ -276,10 +445,13 @@ void Thread::ResumeFromWait() {
     switch (status) {
     case THREADSTATUS_WAIT_SYNCH_ALL:
     case THREADSTATUS_WAIT_SYNCH_ANY:
-    case THREADSTATUS_WAIT_ARB:
     case THREADSTATUS_WAIT_SLEEP:
         break;
 
+    case THREADSTATUS_WAIT_ARB:
+        RemoveArbiterWaiter(this);
+        break;
+
     case THREADSTATUS_READY:
         // The thread's wakeup callback must have already been cleared when the thread was first
         // awoken.
@@ -394,7 +566,6 @@ ResultVal<SharedPtr<Thread>> Thread::Create(std::string name, VAddr entry_point,
     SharedPtr<Thread> thread(new Thread);
 
     thread_list.push_back(thread);
-    ready_queue.prepare(priority);
 
     thread->thread_id = NewThreadId();
     thread->status = THREADSTATUS_DORMANT;
@@ -404,6 +575,7 @@ ResultVal<SharedPtr<Thread>> Thread::Create(std::string name, VAddr entry_point,
     thread->last_running_ticks = CoreTiming::GetTicks();
     thread->processor_id = processor_id;
     thread->wait_objects.clear();
+    thread->wait_all_blocker = 0;
     thread->wait_address = 0;
     thread->name = std::move(name);
     thread->callback_handle = wakeup_callback_handle_table.Create(thread).Unwrap();
@@ -470,10 +642,15 @@ void Thread::SetPriority(u32 priority) {
     // If thread was ready, adjust queues
     if (status == THREADSTATUS_READY)
         ready_queue.move(this, current_priority, priority);
-    else
-        ready_queue.prepare(priority);
+
+    // Threads waiting to be arbitrated are ordered by priority
+    if (status == THREADSTATUS_WAIT_ARB)
+        RemoveArbiterWaiter(this);
 
     nominal_priority = current_priority = priority;
+
+    if (status == THREADSTATUS_WAIT_ARB)
+        AddArbiterWaiter(this);
 }
 
 void Thread::UpdatePriority() {
@@ -489,9 +666,15 @@ void Thread::BoostPriority(u32 priority) {
     // If thread was ready, adjust queues
     if (status == THREADSTATUS_READY)
         ready_queue.move(this, current_priority, priority);
-    else
-        ready_queue.prepare(priority);
+
+    // Threads waiting to be arbitrated are ordered by priority
+    if (status == THREADSTATUS_WAIT_ARB)
+        RemoveArbiterWaiter(this);
+
     current_priority = priority;
+
+    if (status == THREADSTATUS_WAIT_ARB)
+        AddArbiterWaiter(this);
 }
 
 SharedPtr<Thread> SetupMainThread(u32 entry_point, u32 priority, SharedPtr<Process> owner_process) {
@@ -516,6 +699,10 @@ void Reschedule() {
     Thread* cur = GetCurrentThread();
     Thread* next = PopNextReadyThread();
 
+    // Nothing to do if the running thread keeps running
+    if (next == cur && cur && cur->status == THREADSTATUS_RUNNING)
+        return;
+
     if (cur && next) {
         LOG_TRACE(Kernel, "context switch %u -> %u", cur->GetObjectId(), next->GetObjectId());
     } else if (cur) {
@@ -524,7 +711,10 @@ void Reschedule() {
         LOG_TRACE(Kernel, "context switch idle -> %u", next->GetObjectId());
     }
 
+    auto& perf_stats = Core::System::GetInstance().perf_stats;
+    auto switch_begin = Core::PerfStats::Clock::now();
     SwitchContext(next);
+    perf_stats.AddContextSwitch(Core::PerfStats::Clock::now() - switch_begin);
 }
 
 void Thread::SetWaitSynchronizationResult(ResultCode result) {
@@ -553,17 +743,20 @@ void ThreadingInit() {
     ThreadWakeupEventType = CoreTiming::RegisterEvent("ThreadWakeupCallback", ThreadWakeupCallback);
 
     current_thread = nullptr;
+    vfp_context_owner = nullptr;
     next_thread_id = 1;
 }
 
 void ThreadingShutdown() {
     current_thread = nullptr;
+    vfp_context_owner = nullptr;
 
     for (auto& t : thread_list) {
         t->Stop();
     }
     thread_list.clear();
     ready_queue.clear();
+    arbiter_wait_queues.clear();
 }
 
 const std::vector<SharedPtr<Thread>>& GetThreadList() {
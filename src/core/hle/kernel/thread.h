@@ -15,6 +15,8 @@
 #include "core/hle/kernel/wait_object.h"
 #include "core/hle/result.h"
 
+class PointerWrap;
+
 enum ThreadPriority : u32 {
     THREADPRIO_HIGHEST = 0,       ///< Highest thread priority
     THREADPRIO_USERLAND_MAX = 24, ///< Highest thread priority for userland apps
@@ -208,6 +210,10 @@ public:
     // passed to WaitSynchronization1/N.
     std::vector<SharedPtr<WaitObject>> wait_objects;
 
+    /// Index in wait_objects of the object that last kept the thread from waking up when waiting
+    /// for all of its objects. It is the first one checked when another object is signalled.
+    size_t wait_all_blocker;
+
     VAddr wait_address; ///< If waiting on an AddressArbiter, this is the arbitration address
 
     std::string name;
@@ -263,6 +269,29 @@ void ArbitrateAllThreads(u32 address);
  */
 Thread* GetCurrentThread();
 
+/**
+ * Saves the registers of the current thread, and the VFP registers the scheduler keeps loaded in
+ * the CPU, to the contexts of their threads. Must be called before reading thread contexts from
+ * outside the scheduler (debuggers, checkpoints), as they are otherwise only saved when switching
+ * to another thread.
+ */
+void SaveThreadContexts();
+
+/**
+ * Serializes the registers of the threads, along with what tells the threads apart and what they
+ * are waiting on. The other kernel objects aren't serialized, so the registers are only restored
+ * into the threads they were saved from, while these threads are in the same state. Restoring
+ * into other threads fails with ERROR_FAILURE and changes nothing.
+ */
+void DoThreadState(PointerWrap& p);
+
+/**
+ * Reads threads serialized by DoThreadState, without restoring them.
+ * @returns whether DoThreadState can restore them: the same threads exist, with the same status,
+ * priority and wait objects, and the same thread is running
+ */
+bool IsThreadStateRestorable(PointerWrap& p);
+
 /**
  * Waits the current thread on a sleep
  */
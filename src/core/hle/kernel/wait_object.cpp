@@ -32,6 +32,28 @@ void WaitObject::RemoveWaitingThread(Thread* thread) {
         waiting_threads.erase(itr);
 }
 
+/**
+ * Checks whether none of the objects a thread in THREADSTATUS_WAIT_SYNCH_ALL is waiting on would
+ * make it wait. The object that made it wait last time is checked first, as it usually still
+ * does, which avoids going through all the objects on every signal.
+ */
+static bool IsReadyToWakeUpFromWaitAll(Thread* thread) {
+    const auto& objects = thread->wait_objects;
+    if (thread->wait_all_blocker < objects.size() &&
+        objects[thread->wait_all_blocker]->ShouldWait(thread)) {
+        return false;
+    }
+
+    for (size_t i = 0; i < objects.size(); ++i) {
+        if (objects[i]->ShouldWait(thread)) {
+            thread->wait_all_blocker = i;
+            return false;
+        }
+    }
+
+    return true;
+}
+
 SharedPtr<Thread> WaitObject::GetHighestPriorityReadyThread() {
     Thread* candidate = nullptr;
     u32 candidate_priority = THREADPRIO_LOWEST + 1;
@@ -52,10 +74,7 @@ SharedPtr<Thread> WaitObject::GetHighestPriorityReadyThread() {
         // in THREADSTATUS_WAIT_SYNCH_ALL and the rest of the objects it is waiting on are ready.
         bool ready_to_run = true;
         if (thread->status == THREADSTATUS_WAIT_SYNCH_ALL) {
-            ready_to_run = std::none_of(thread->wait_objects.begin(), thread->wait_objects.end(),
-                                        [&thread](const SharedPtr<WaitObject>& object) {
-                                            return object->ShouldWait(thread.get());
-                                        });
+            ready_to_run = IsReadyToWakeUpFromWaitAll(thread.get());
         }
 
         if (ready_to_run) {
@@ -2,8 +2,37 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <cinttypes>
+#include <vector>
 #include <core/hle/lock.h>
+#include "common/logging/log.h"
 
 namespace HLE {
 std::recursive_mutex g_hle_lock;
+
+/// Sites registered so far. A function-local static, as sites are registered by static objects.
+static std::vector<LockSite*>& GetSites() {
+    static std::vector<LockSite*> sites;
+    return sites;
+}
+
+LockSite::LockSite(const char* name) : name(name) {
+    GetSites().push_back(this);
+}
+
+void LogLockStats() {
+    for (LockSite* site : GetSites()) {
+        const u64 acquisitions = site->acquisitions.exchange(0);
+        const u64 contentions = site->contentions.exchange(0);
+        const u64 wait_ns = site->wait_ns.exchange(0);
+        const u64 hold_ns = site->hold_ns.exchange(0);
+        if (acquisitions == 0)
+            continue;
+        LOG_INFO(Kernel,
+                 "HLE lock at %s: %" PRIu64 " acquisitions, %" PRIu64
+                 " contended, %.3f ms waited, %.3f ms held",
+                 site->name, acquisitions, contentions, wait_ns / 1e6, hold_ns / 1e6);
+    }
+}
+
 } // namespace HLE
@@ -4,7 +4,10 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <mutex>
+#include "common/common_types.h"
 
 namespace HLE {
 /*
@@ -15,4 +18,55 @@ namespace HLE {
  * than the CPU thread.
  */
 extern std::recursive_mutex g_hle_lock;
+
+/**
+ * Place in the code acquiring g_hle_lock, accumulating how often and how long it waited for the
+ * lock and held it. Sites are meant to be static objects, which register themselves.
+ */
+struct LockSite : NonCopyable {
+    explicit LockSite(const char* name);
+
+    const char* name;
+    std::atomic<u64> acquisitions{0};
+    /// Acquisitions that had to wait for another thread to release the lock
+    std::atomic<u64> contentions{0};
+    std::atomic<u64> wait_ns{0};
+    std::atomic<u64> hold_ns{0};
+};
+
+/// Holds g_hle_lock for a scope, accounting the time waited and held to a site
+class LockGuard : NonCopyable {
+public:
+    explicit LockGuard(LockSite& site) : site(site) {
+        if (!g_hle_lock.try_lock()) {
+            const auto wait_start = Clock::now();
+            g_hle_lock.lock();
+            acquired = Clock::now();
+            site.contentions.fetch_add(1, std::memory_order_relaxed);
+            site.wait_ns.fetch_add(Nanoseconds(acquired - wait_start), std::memory_order_relaxed);
+        } else {
+            acquired = Clock::now();
+        }
+        site.acquisitions.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    ~LockGuard() {
+        site.hold_ns.fetch_add(Nanoseconds(Clock::now() - acquired), std::memory_order_relaxed);
+        g_hle_lock.unlock();
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    static u64 Nanoseconds(Clock::duration duration) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+    }
+
+    LockSite& site;
+    Clock::time_point acquired;
+};
+
+/// Logs the contention statistics of the sites that acquired g_hle_lock, and resets them
+void LogLockStats();
+
 } // namespace HLE
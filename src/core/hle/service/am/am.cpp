@@ -2,11 +2,14 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <array>
 #include <cinttypes>
+#include <thread>
 #include "common/file_util.h"
 #include "common/logging/log.h"
 #include "common/string_util.h"
+#include "core/core.h"
 #include "core/file_sys/ncch_container.h"
 #include "core/file_sys/title_metadata.h"
 #include "core/hle/ipc.h"
@@ -17,6 +20,7 @@
 #include "core/hle/service/am/am_net.h"
 #include "core/hle/service/am/am_sys.h"
 #include "core/hle/service/am/am_u.h"
+#include "core/hle/service/am/title_index.h"
 #include "core/hle/service/fs/archive.h"
 #include "core/hle/service/service.h"
 #include "core/loader/loader.h"
@@ -152,25 +156,26 @@ std::string GetMediaTitlePath(Service::FS::MediaType media_type) {
 }
 
 void ScanForTitles(Service::FS::MediaType media_type) {
-    am_title_list[static_cast<u32>(media_type)].clear();
-
-    std::string title_path = GetMediaTitlePath(media_type);
-
-    FileUtil::FSTEntry entries;
-    FileUtil::ScanDirectoryTree(title_path, entries, 1);
-    for (const FileUtil::FSTEntry& tid_high : entries.children) {
-        for (const FileUtil::FSTEntry& tid_low : tid_high.children) {
-            std::string tid_string = tid_high.virtualName + tid_low.virtualName;
-            u64 tid = std::stoull(tid_string.c_str(), nullptr, 16);
-
-            FileSys::NCCHContainer container(GetTitleContentPath(media_type, tid));
-            if (container.Load() == Loader::ResultStatus::Success)
-                am_title_list[static_cast<u32>(media_type)].push_back(tid);
-        }
-    }
+    const std::string cache_path =
+        FileUtil::GetUserPath(D_CACHE_IDX) +
+        (media_type == Service::FS::MediaType::NAND ? "title_index_nand.bin"
+                                                    : "title_index_sdmc.bin");
+    TitleIndex index(GetMediaTitlePath(media_type), cache_path);
+
+    // Titles are checked by opening their main content, which the index avoids on most boots
+    auto check_title = [media_type](u64 tid, std::string& content_path) {
+        content_path = GetTitleContentPath(media_type, tid);
+        FileSys::NCCHContainer container(content_path);
+        return container.Load() == Loader::ResultStatus::Success;
+    };
+    const unsigned num_workers = std::min(std::max(std::thread::hardware_concurrency(), 1u), 8u);
+    const std::vector<u64> title_ids = index.Scan(check_title, num_workers);
+    am_title_list[static_cast<u32>(media_type)].assign(title_ids.begin(), title_ids.end());
 }
 
 void ScanForAllTitles() {
+    Core::BootProfiler::Scope profile_scope(Core::System::GetInstance().boot_profiler,
+                                            "AM::ScanForAllTitles");
     ScanForTitles(Service::FS::MediaType::NAND);
     ScanForTitles(Service::FS::MediaType::SDMC);
 }
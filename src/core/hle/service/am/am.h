@@ -58,7 +58,8 @@ std::string GetTitlePath(Service::FS::MediaType media_type, u64 tid);
 std::string GetMediaTitlePath(Service::FS::MediaType media_type);
 
 /**
- * Scans the for titles in a storage medium for listing.
+ * Scans the for titles in a storage medium for listing. Only the titles changed since the last
+ * scan are opened, as the results are kept in an index in the cache folder.
  * @param media_type the storage medium to scan
  */
 void ScanForTitles(Service::FS::MediaType media_type);
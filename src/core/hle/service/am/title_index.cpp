@@ -0,0 +1,249 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <utility>
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "common/string_util.h"
+#include "core/hle/service/am/title_index.h"
+#include "core/loader/loader.h"
+
+namespace Service {
+namespace AM {
+
+constexpr u32 INDEX_MAGIC = Loader::MakeMagic('T', 'I', 'D', 'X');
+/// Version of the index format, to be bumped whenever it changes
+constexpr u32 INDEX_VERSION = 1;
+
+/// Parses the name of a folder holding the high or the low half of title IDs
+static bool ParseTitleIdHalf(const std::string& name, u32& value) {
+    auto is_hex_digit = [](char c) { return std::isxdigit(static_cast<unsigned char>(c)) != 0; };
+    if (name.size() != 8 || !std::all_of(name.begin(), name.end(), is_hex_digit))
+        return false;
+    value = static_cast<u32>(std::stoul(name, nullptr, 16));
+    return true;
+}
+
+/// Reads values from the saved index, failing once the end is reached
+class IndexReader {
+public:
+    explicit IndexReader(const std::vector<u8>& data) : data(data) {}
+
+    template <typename T>
+    bool Read(T& value) {
+        if (data.size() - offset < sizeof(T))
+            return false;
+        std::memcpy(&value, data.data() + offset, sizeof(T));
+        offset += sizeof(T);
+        return true;
+    }
+
+    bool Read(std::string& value) {
+        u32 size;
+        if (!Read(size) || data.size() - offset < size)
+            return false;
+        value.assign(reinterpret_cast<const char*>(data.data() + offset), size);
+        offset += size;
+        return true;
+    }
+
+    bool AtEnd() const {
+        return offset == data.size();
+    }
+
+private:
+    const std::vector<u8>& data;
+    size_t offset = 0;
+};
+
+/// Appends values to the index to save
+class IndexWriter {
+public:
+    template <typename T>
+    void Write(const T& value) {
+        const u8* bytes = reinterpret_cast<const u8*>(&value);
+        data.insert(data.end(), bytes, bytes + sizeof(T));
+    }
+
+    void Write(const std::string& value) {
+        Write(static_cast<u32>(value.size()));
+        data.insert(data.end(), value.begin(), value.end());
+    }
+
+    std::vector<u8> data;
+};
+
+TitleIndex::TitleIndex(std::string title_path, std::string cache_path)
+    : title_path(std::move(title_path)), cache_path(std::move(cache_path)) {}
+
+std::vector<u64> TitleIndex::Scan(const TitleChecker& check, unsigned num_workers) {
+    using Clock = std::chrono::steady_clock;
+    const auto start = Clock::now();
+
+    std::vector<Entry> cached_entries;
+    if (!Load(cached_entries))
+        cached_entries.clear();
+    auto find_cached = [&cached_entries](u64 title_id) -> const Entry* {
+        auto it = std::lower_bound(
+            cached_entries.begin(), cached_entries.end(), title_id,
+            [](const Entry& entry, u64 title_id) { return entry.title_id < title_id; });
+        return it != cached_entries.end() && it->title_id == title_id ? &*it : nullptr;
+    };
+
+    // Titles are kept from the index when unchanged, the others are checked afterwards
+    std::vector<Entry> entries;
+    std::vector<size_t> changed_entries;
+    FileUtil::FSTEntry tree;
+    FileUtil::ScanDirectoryTree(title_path, tree, 1);
+    for (const FileUtil::FSTEntry& tid_high : tree.children) {
+        u32 high;
+        if (!tid_high.isDirectory || !ParseTitleIdHalf(tid_high.virtualName, high))
+            continue;
+        for (const FileUtil::FSTEntry& tid_low : tid_high.children) {
+            u32 low;
+            if (!tid_low.isDirectory || !ParseTitleIdHalf(tid_low.virtualName, low))
+                continue;
+            const u64 title_id = (static_cast<u64>(high) << 32) | low;
+            const Entry* cached = find_cached(title_id);
+            if (cached != nullptr && IsUpToDate(*cached)) {
+                entries.push_back(*cached);
+            } else {
+                changed_entries.push_back(entries.size());
+                entries.push_back({title_id, 0, 0, 0, false, ""});
+            }
+        }
+    }
+
+    // Checking a title is mostly waiting on the disk, so several are checked at once
+    std::atomic<size_t> next_entry{0};
+    auto check_titles = [&] {
+        for (size_t i; (i = next_entry++) < changed_entries.size();) {
+            Entry& entry = entries[changed_entries[i]];
+            u64 folder_size;
+            // Stat before checking, so that a title modified during the check is checked again
+            if (!FileUtil::GetSizeAndModificationTime(GetContentFolder(entry.title_id),
+                                                      folder_size, entry.folder_time)) {
+                entry.folder_time = 0;
+            }
+            entry.valid = check(entry.title_id, entry.content_path);
+            if (!FileUtil::GetSizeAndModificationTime(entry.content_path, entry.content_size,
+                                                      entry.content_time)) {
+                entry.content_size = 0;
+                entry.content_time = 0;
+            }
+        }
+    };
+    const size_t num_threads =
+        std::min<size_t>(std::max(num_workers, 1u), changed_entries.size());
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < num_threads; ++i) {
+        workers.emplace_back(check_titles);
+    }
+    check_titles();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    std::sort(entries.begin(), entries.end(),
+              [](const Entry& a, const Entry& b) { return a.title_id < b.title_id; });
+    if (!changed_entries.empty() || entries.size() != cached_entries.size())
+        Save(entries);
+
+    std::vector<u64> title_ids;
+    for (const Entry& entry : entries) {
+        if (entry.valid)
+            title_ids.push_back(entry.title_id);
+    }
+
+    last_stats.cached = entries.size() - changed_entries.size();
+    last_stats.checked = changed_entries.size();
+    last_stats.duration_ms =
+        std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    LOG_INFO(Service_AM, "Found %zu titles in %s in %.1f ms (%zu from the index, %zu checked)",
+             title_ids.size(), title_path.c_str(), last_stats.duration_ms, last_stats.cached,
+             last_stats.checked);
+    return title_ids;
+}
+
+bool TitleIndex::Load(std::vector<Entry>& entries) const {
+    FileUtil::IOFile file(cache_path, "rb");
+    if (!file.IsOpen())
+        return false;
+    std::vector<u8> data(file.GetSize());
+    if (file.ReadBytes(data.data(), data.size()) != data.size())
+        return false;
+
+    IndexReader reader(data);
+    u32 magic, version, count;
+    std::string indexed_path;
+    if (!reader.Read(magic) || !reader.Read(version) || !reader.Read(indexed_path) ||
+        !reader.Read(count) || magic != INDEX_MAGIC || version != INDEX_VERSION ||
+        indexed_path != title_path) {
+        return false;
+    }
+
+    entries.resize(std::min<size_t>(count, data.size()));
+    for (Entry& entry : entries) {
+        u8 valid;
+        if (!reader.Read(entry.title_id) || !reader.Read(entry.folder_time) ||
+            !reader.Read(entry.content_size) || !reader.Read(entry.content_time) ||
+            !reader.Read(valid) || !reader.Read(entry.content_path)) {
+            LOG_WARNING(Service_AM, "The title index %s is truncated", cache_path.c_str());
+            return false;
+        }
+        entry.valid = valid != 0;
+    }
+    return reader.AtEnd() && std::is_sorted(entries.begin(), entries.end(),
+                                            [](const Entry& a, const Entry& b) {
+                                                return a.title_id < b.title_id;
+                                            });
+}
+
+void TitleIndex::Save(const std::vector<Entry>& entries) const {
+    IndexWriter writer;
+    writer.Write(INDEX_MAGIC);
+    writer.Write(INDEX_VERSION);
+    writer.Write(title_path);
+    writer.Write(static_cast<u32>(entries.size()));
+    for (const Entry& entry : entries) {
+        writer.Write(entry.title_id);
+        writer.Write(entry.folder_time);
+        writer.Write(entry.content_size);
+        writer.Write(entry.content_time);
+        writer.Write(static_cast<u8>(entry.valid));
+        writer.Write(entry.content_path);
+    }
+
+    if (!FileUtil::WriteFileAtomically(cache_path, writer.data.data(), writer.data.size()))
+        LOG_WARNING(Service_AM, "Failed to save the title index to %s", cache_path.c_str());
+}
+
+bool TitleIndex::IsUpToDate(const Entry& entry) const {
+    u64 size = 0;
+    s64 time = 0;
+    FileUtil::GetSizeAndModificationTime(GetContentFolder(entry.title_id), size, time);
+    if (time != entry.folder_time)
+        return false;
+
+    size = 0;
+    time = 0;
+    if (!entry.content_path.empty())
+        FileUtil::GetSizeAndModificationTime(entry.content_path, size, time);
+    return size == entry.content_size && time == entry.content_time;
+}
+
+std::string TitleIndex::GetContentFolder(u64 title_id) const {
+    return Common::StringFromFormat("%s%08x/%08x/content/", title_path.c_str(),
+                                    static_cast<u32>(title_id >> 32),
+                                    static_cast<u32>(title_id & 0xFFFFFFFF));
+}
+
+} // namespace AM
+} // namespace Service
@@ -0,0 +1,89 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+#include "common/common_types.h"
+
+namespace Service {
+namespace AM {
+
+/**
+ * Index of the titles installed in a title/ folder, cached on disk so that booting doesn't have to
+ * open the content of every title again.
+ *
+ * For each title, the index remembers whether its main content was valid, along with the
+ * modification time of its content/ folder and the size and modification time of the content
+ * itself. A title is only checked again when one of these changed: adding, removing or renaming
+ * a file of the title changes the time of the folder, and rewriting the content changes its own.
+ */
+class TitleIndex {
+public:
+    /**
+     * Checks an installed title
+     * @param title_id ID of the title
+     * @param content_path Set to the path of the main content of the title
+     * @returns whether the title is valid, and listed
+     * @note This is called from several threads at once.
+     */
+    using TitleChecker = std::function<bool(u64 title_id, std::string& content_path)>;
+
+    /// Results of the last scan
+    struct Stats {
+        size_t cached = 0;  ///< Titles whose state was taken from the index
+        size_t checked = 0; ///< Titles new or changed since the index was saved
+        double duration_ms = 0;
+    };
+
+    /**
+     * @param title_path Path of the title/ folder to scan
+     * @param cache_path Path of the file the index is saved to
+     */
+    TitleIndex(std::string title_path, std::string cache_path);
+
+    /**
+     * Scans the title/ folder, checking the titles that aren't up to date in the index with
+     * several threads, and saves the index if it changed.
+     * @param check Function checking a title
+     * @param num_workers Maximum number of threads checking titles
+     * @returns the IDs of the valid titles, sorted
+     */
+    std::vector<u64> Scan(const TitleChecker& check, unsigned num_workers);
+
+    const Stats& GetLastStats() const {
+        return last_stats;
+    }
+
+private:
+    struct Entry {
+        u64 title_id;
+        s64 folder_time;
+        u64 content_size;
+        s64 content_time;
+        bool valid;
+        std::string content_path;
+    };
+
+    /// Loads the saved index. Returns false if it's missing, damaged or from another folder.
+    bool Load(std::vector<Entry>& entries) const;
+
+    /// Saves the index, replacing the previous one at once
+    void Save(const std::vector<Entry>& entries) const;
+
+    /// Returns whether a title is unchanged since its entry was made
+    bool IsUpToDate(const Entry& entry) const;
+
+    /// Returns the path of the content/ folder of a title
+    std::string GetContentFolder(u64 title_id) const;
+
+    std::string title_path;
+    std::string cache_path;
+    Stats last_stats;
+};
+
+} // namespace AM
+} // namespace Service
@@ -369,6 +369,8 @@ void GetSharedFont(Service::Interface* self) {
     if (!shared_font_loaded) {
         // On real 3DS, font loading happens on booting. However, we load it on demand to coordinate
         // with CFG region auto configuration, which happens later than APT initialization.
+        Core::BootProfiler::Scope profile_scope(Core::System::GetInstance().boot_profiler,
+                                                "APT::LoadSharedFont");
         if (LoadSharedFont()) {
             shared_font_loaded = true;
         } else if (LoadLegacySharedFont()) {
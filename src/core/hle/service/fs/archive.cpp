@@ -13,6 +13,7 @@
 #include "common/common_types.h"
 #include "common/file_util.h"
 #include "common/logging/log.h"
+#include "core/core.h"
 #include "core/file_sys/archive_backend.h"
 #include "core/file_sys/archive_extsavedata.h"
 #include "core/file_sys/archive_ncch.h"
@@ -26,9 +27,11 @@
 #include "core/file_sys/errors.h"
 #include "core/file_sys/file_backend.h"
 #include "core/hle/ipc.h"
+#include "core/hle/ipc_helpers.h"
 #include "core/hle/kernel/client_port.h"
 #include "core/hle/kernel/client_session.h"
 #include "core/hle/kernel/handle_table.h"
+#include "core/hle/kernel/process.h"
 #include "core/hle/kernel/server_session.h"
 #include "core/hle/result.h"
 #include "core/hle/service/fs/archive.h"
@@ -87,6 +90,106 @@ File::File(std::unique_ptr<FileSys::FileBackend>&& backend, const FileSys::Path&
 
 File::~File() {}
 
+/**
+ * Reads data from a file into a buffer passed by the current process. The data is read straight
+ * into the guest memory when it's backed by host memory, and through an intermediate buffer
+ * otherwise.
+ * @param spans Storage for the guest memory spans, reused between reads
+ */
+static ResultVal<size_t> ReadToGuestMemory(const FileSys::FileBackend& backend, u64 offset,
+                                           size_t length, const Kernel::MappedBuffer& buffer,
+                                           std::vector<Memory::HostSpan>& spans) {
+    if (Memory::GetWritableHostSpans(buffer.GetAddress(), length, spans))
+        return backend.ReadScatter(offset, spans);
+
+    std::vector<u8> data(length);
+    ResultVal<size_t> read = backend.Read(offset, data.size(), data.data());
+    if (read.Succeeded())
+        buffer.Write(data.data(), 0, *read);
+    return read;
+}
+
+/**
+ * Writes data to a file from a buffer passed by the current process, straight from the guest memory
+ * when it's backed by host memory, and through an intermediate buffer otherwise.
+ * @param spans Storage for the guest memory spans, reused between writes
+ */
+static ResultVal<size_t> WriteFromGuestMemory(const FileSys::FileBackend& backend, u64 offset,
+                                              size_t length, bool flush,
+                                              const Kernel::MappedBuffer& buffer,
+                                              std::vector<Memory::HostSpan>& spans) {
+    if (Memory::GetReadableHostSpans(buffer.GetAddress(), length, spans))
+        return backend.WriteGather(offset, spans, flush);
+
+    std::vector<u8> data(length);
+    buffer.Read(data.data(), 0, data.size());
+    return backend.Write(offset, data.size(), flush, data.data());
+}
+
+/// Clamps the length of a transfer to the size of the buffer passed by the guest
+static u32 ClampToBuffer(u32 length, const Kernel::MappedBuffer& buffer) {
+    if (length > buffer.GetSize()) {
+        LOG_ERROR(Service_FS, "Length 0x%08X is larger than the buffer of size 0x%zX", length,
+                  buffer.GetSize());
+        return static_cast<u32>(buffer.GetSize());
+    }
+    return length;
+}
+
+void File::Read(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp(ctx, 0x0802, 3, 2);
+    u64 offset = rp.Pop<u64>();
+    u32 length = rp.Pop<u32>();
+    const Kernel::MappedBuffer& buffer = rp.PopMappedBufferView();
+    LOG_TRACE(Service_FS, "Read %s: offset=0x%llx length=%d address=0x%x", GetName().c_str(),
+              offset, length, buffer.GetAddress());
+    length = ClampToBuffer(length, buffer);
+
+    if (offset + length > backend->GetSize()) {
+        LOG_ERROR(Service_FS,
+                  "Reading from out of bounds offset=0x%llX length=0x%08X file_size=0x%llX",
+                  offset, length, backend->GetSize());
+    }
+
+    ResultVal<size_t> read = ReadToGuestMemory(*backend, offset, length, buffer, spans);
+    IPC::RequestBuilder rb = rp.MakeBuilder(2, 2);
+    rb.Push(read.Code());
+    rb.Push<u32>(read.Succeeded() ? static_cast<u32>(*read) : 0);
+    rb.PushMappedBuffer(buffer.GetAddress(), buffer.GetSize(), buffer.GetPermissions());
+}
+
+void File::Write(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp(ctx, 0x0803, 4, 2);
+    u64 offset = rp.Pop<u64>();
+    u32 length = rp.Pop<u32>();
+    u32 flush = rp.Pop<u32>();
+    const Kernel::MappedBuffer& buffer = rp.PopMappedBufferView();
+    LOG_TRACE(Service_FS, "Write %s: offset=0x%llx length=%d address=0x%x, flush=0x%x",
+              GetName().c_str(), offset, length, buffer.GetAddress(), flush);
+    length = ClampToBuffer(length, buffer);
+
+    ResultVal<size_t> written =
+        WriteFromGuestMemory(*backend, offset, length, flush != 0, buffer, spans);
+    IPC::RequestBuilder rb = rp.MakeBuilder(2, 2);
+    rb.Push(written.Code());
+    rb.Push<u32>(written.Succeeded() ? static_cast<u32>(*written) : 0);
+    rb.PushMappedBuffer(buffer.GetAddress(), buffer.GetSize(), buffer.GetPermissions());
+}
+
+void File::HandleRequest(Kernel::SharedPtr<Kernel::ServerSession> server_session,
+                         void (File::*handler)(Kernel::HLERequestContext& ctx)) {
+    // TODO(yuriks): The kernel should be the one handling this as part of translation after
+    // everything else is migrated
+    u32* cmd_buff = Kernel::GetCommandBuffer();
+    Kernel::HLERequestContext context(std::move(server_session));
+    context.PopulateFromIncomingCommandBuffer(cmd_buff, *Kernel::g_current_process,
+                                              Kernel::g_handle_table);
+    (this->*handler)(context);
+    context.WriteToOutgoingCommandBuffer(cmd_buff, *Kernel::g_current_process,
+                                         Kernel::g_handle_table);
+    Core::System::GetInstance().perf_stats.AddIPCBytesCopied(context.GetBytesCopied());
+}
+
 void File::HandleSyncRequest(Kernel::SharedPtr<Kernel::ServerSession> server_session) {
     using Kernel::ClientSession;
     using Kernel::ServerSession;
@@ -97,49 +200,12 @@ void File::HandleSyncRequest(Kernel::SharedPtr<Kernel::ServerSession> server_ses
     switch (cmd) {
 
     // Read from file...
-    case FileCommand::Read: {
-        u64 offset = cmd_buff[1] | ((u64)cmd_buff[2]) << 32;
-        u32 length = cmd_buff[3];
-        u32 address = cmd_buff[5];
-        LOG_TRACE(Service_FS, "Read %s: offset=0x%llx length=%d address=0x%x", GetName().c_str(),
-                  offset, length, address);
-
-        if (offset + length > backend->GetSize()) {
-            LOG_ERROR(Service_FS,
-                      "Reading from out of bounds offset=0x%llX length=0x%08X file_size=0x%llX",
-                      offset, length, backend->GetSize());
-        }
-
-        std::vector<u8> data(length);
-        ResultVal<size_t> read = backend->Read(offset, data.size(), data.data());
-        if (read.Failed()) {
-            cmd_buff[1] = read.Code().raw;
-            return;
-        }
-        Memory::WriteBlock(address, data.data(), *read);
-        cmd_buff[2] = static_cast<u32>(*read);
-        break;
-    }
+    case FileCommand::Read:
+        return HandleRequest(std::move(server_session), &File::Read);
 
     // Write to file...
-    case FileCommand::Write: {
-        u64 offset = cmd_buff[1] | ((u64)cmd_buff[2]) << 32;
-        u32 length = cmd_buff[3];
-        u32 flush = cmd_buff[4];
-        u32 address = cmd_buff[6];
-        LOG_TRACE(Service_FS, "Write %s: offset=0x%llx length=%d address=0x%x, flush=0x%x",
-                  GetName().c_str(), offset, length, address, flush);
-
-        std::vector<u8> data(length);
-        Memory::ReadBlock(address, data.data(), data.size());
-        ResultVal<size_t> written = backend->Write(offset, data.size(), flush != 0, data.data());
-        if (written.Failed()) {
-            cmd_buff[1] = written.Code().raw;
-            return;
-        }
-        cmd_buff[2] = static_cast<u32>(*written);
-        break;
-    }
+    case FileCommand::Write:
+        return HandleRequest(std::move(server_session), &File::Write);
 
     case FileCommand::GetSize: {
         LOG_TRACE(Service_FS, "GetSize %s", GetName().c_str());
@@ -6,10 +6,12 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 #include "common/common_types.h"
 #include "core/file_sys/archive_backend.h"
 #include "core/hle/kernel/hle_ipc.h"
 #include "core/hle/result.h"
+#include "core/memory.h"
 
 namespace FileSys {
 class DirectoryBackend;
@@ -62,6 +64,17 @@ public:
 
 protected:
     void HandleSyncRequest(Kernel::SharedPtr<Kernel::ServerSession> server_session) override;
+
+private:
+    void Read(Kernel::HLERequestContext& ctx);
+    void Write(Kernel::HLERequestContext& ctx);
+
+    /// Handles a request of the current thread with one of the handlers using an HLERequestContext
+    void HandleRequest(Kernel::SharedPtr<Kernel::ServerSession> server_session,
+                       void (File::*handler)(Kernel::HLERequestContext& ctx));
+
+    /// Guest memory spans of the current read or write, kept to reuse their storage between them
+    std::vector<Memory::HostSpan> spans;
 };
 
 class Directory final : public Kernel::SessionRequestHandler {
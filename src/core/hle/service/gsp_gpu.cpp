@@ -295,6 +295,7 @@ ResultCode SetBufferSwap(u32 screen_id, const FrameBufferInfo& info) {
     if (screen_id == 0) {
         MicroProfileFlip();
         Core::System::GetInstance().perf_stats.EndGameFrame();
+        Core::System::GetInstance().boot_profiler.MarkFirstFrame();
     }
 
     return RESULT_SUCCESS;
@@ -6,6 +6,7 @@
 #include <array>
 #include <atomic>
 #include <cstring>
+#include <deque>
 #include <list>
 #include <mutex>
 #include <unordered_map>
@@ -16,7 +17,6 @@
 #include "core/hle/ipc_helpers.h"
 #include "core/hle/kernel/event.h"
 #include "core/hle/kernel/shared_memory.h"
-#include "core/hle/lock.h"
 #include "core/hle/result.h"
 #include "core/hle/service/nwm/nwm_uds.h"
 #include "core/hle/service/nwm/uds_beacon.h"
@@ -93,6 +93,11 @@ constexpr size_t MaxBeaconFrames = 15;
 // List of the last <MaxBeaconFrames> beacons received from the network.
 static std::list<Network::WifiPacket> received_beacons;
 
+// Non-beacon packets received by the network thread, waiting to be handled on the emulation thread
+static std::mutex received_packets_mutex;
+static std::deque<Network::WifiPacket> received_packets;
+static int received_packets_event;
+
 // Network node id used when a SecureData packet is addressed to every connected node.
 constexpr u16 BroadcastNetworkNodeId = 0xFFFF;
 
@@ -180,9 +185,7 @@ void HandleAssociationResponseFrame(const Network::WifiPacket& packet) {
 }
 
 static void HandleEAPoLPacket(const Network::WifiPacket& packet) {
-    std::unique_lock<std::recursive_mutex> hle_lock(HLE::g_hle_lock, std::defer_lock);
-    std::unique_lock<std::mutex> lock(connection_status_mutex, std::defer_lock);
-    std::lock(hle_lock, lock);
+    std::lock_guard<std::mutex> lock(connection_status_mutex);
 
     if (GetEAPoLFrameType(packet.data) == EAPoLStartMagic) {
         if (connection_status.status != static_cast<u32>(NetworkStatus::ConnectedAsHost)) {
@@ -265,9 +268,7 @@ static void HandleEAPoLPacket(const Network::WifiPacket& packet) {
 
 static void HandleSecureDataPacket(const Network::WifiPacket& packet) {
     auto secure_data = ParseSecureDataHeader(packet.data);
-    std::unique_lock<std::recursive_mutex> hle_lock(HLE::g_hle_lock, std::defer_lock);
-    std::unique_lock<std::mutex> lock(connection_status_mutex, std::defer_lock);
-    std::lock(hle_lock, lock);
+    std::lock_guard<std::mutex> lock(connection_status_mutex);
 
     if (secure_data.src_node_id == connection_status.network_node_id) {
         // Ignore packets that came from ourselves.
@@ -312,7 +313,7 @@ static void HandleSecureDataPacket(const Network::WifiPacket& packet) {
     // Add the received packet to the data queue.
     channel_info->second.received_packets.emplace_back(packet.data);
 
-    // Signal the data event. We can do this directly because we locked g_hle_lock
+    // Signal the data event. We can do this directly because we're on the emulation thread
     channel_info->second.event->Signal();
 }
 
@@ -408,22 +409,50 @@ static void HandleDataFrame(const Network::WifiPacket& packet) {
     }
 }
 
+/// Handles the packets received by the network thread, on the emulation thread
+static void HandleReceivedPackets(u64 userdata, int cycles_late) {
+    std::deque<Network::WifiPacket> packets;
+    {
+        std::lock_guard<std::mutex> lock(received_packets_mutex);
+        packets.swap(received_packets);
+    }
+
+    for (const Network::WifiPacket& packet : packets) {
+        switch (packet.type) {
+        case Network::WifiPacket::PacketType::Authentication:
+            HandleAuthenticationFrame(packet);
+            break;
+        case Network::WifiPacket::PacketType::AssociationResponse:
+            HandleAssociationResponseFrame(packet);
+            break;
+        case Network::WifiPacket::PacketType::Data:
+            HandleDataFrame(packet);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
 /// Callback to parse and handle a received wifi packet.
 void OnWifiPacketReceived(const Network::WifiPacket& packet) {
-    switch (packet.type) {
-    case Network::WifiPacket::PacketType::Beacon:
+    if (packet.type == Network::WifiPacket::PacketType::Beacon) {
+        // Beacons only go to their own list, so they don't need the emulation thread
         HandleBeaconFrame(packet);
-        break;
-    case Network::WifiPacket::PacketType::Authentication:
-        HandleAuthenticationFrame(packet);
-        break;
-    case Network::WifiPacket::PacketType::AssociationResponse:
-        HandleAssociationResponseFrame(packet);
-        break;
-    case Network::WifiPacket::PacketType::Data:
-        HandleDataFrame(packet);
-        break;
+        return;
     }
+
+    // The other packets change the HLE kernel state, for instance by signaling events. Rather
+    // than having the network thread wait for g_hle_lock, and delay every SVC in the meantime,
+    // they are handed over to the emulation thread.
+    bool handler_scheduled;
+    {
+        std::lock_guard<std::mutex> lock(received_packets_mutex);
+        handler_scheduled = !received_packets.empty();
+        received_packets.push_back(packet);
+    }
+    if (!handler_scheduled)
+        CoreTiming::ScheduleEvent_Threadsafe_Immediate(received_packets_event);
 }
 
 /**
@@ -1290,6 +1319,8 @@ NWM_UDS::NWM_UDS() {
 
     beacon_broadcast_event =
         CoreTiming::RegisterEvent("UDS::BeaconBroadcastCallback", BeaconBroadcastCallback);
+    received_packets_event =
+        CoreTiming::RegisterEvent("UDS::HandleReceivedPackets", HandleReceivedPackets);
 }
 
 NWM_UDS::~NWM_UDS() {
@@ -1306,6 +1337,12 @@ NWM_UDS::~NWM_UDS() {
     }
 
     CoreTiming::UnscheduleEvent(beacon_broadcast_event, 0);
+    CoreTiming::RemoveThreadsafeEvent(received_packets_event);
+    CoreTiming::UnscheduleEvent(received_packets_event, 0);
+    {
+        std::lock_guard<std::mutex> lock(received_packets_mutex);
+        received_packets.clear();
+    }
 }
 
 } // namespace NWM
@@ -7,6 +7,7 @@
 #include "common/assert.h"
 #include "common/logging/log.h"
 #include "common/string_util.h"
+#include "core/core.h"
 #include "core/hle/ipc.h"
 #include "core/hle/kernel/client_port.h"
 #include "core/hle/kernel/process.h"
@@ -76,6 +77,12 @@ static std::string MakeFunctionString(const char* name, const char* port_name,
     return function_string;
 }
 
+/// Returns the size in bytes of the request or reply in a command buffer, read from its header
+static size_t GetCommandSize(const u32* cmd_buff) {
+    IPC::Header header{cmd_buff[0]};
+    return (1 + header.normal_params_size + header.translate_params_size) * sizeof(u32);
+}
+
 Interface::Interface(u32 max_sessions) : max_sessions(max_sessions) {}
 Interface::~Interface() = default;
 
@@ -101,7 +108,12 @@ void Interface::HandleSyncRequest(SharedPtr<ServerSession> server_session) {
     LOG_TRACE(Service, "%s",
               MakeFunctionString(itr->second.name, GetPortName().c_str(), cmd_buff).c_str());
 
+    // Legacy handlers work on the command buffer in place. Its request and reply are counted like
+    // the ones HLERequestContext copies, so that both kinds of services can be compared.
+    const size_t request_size = GetCommandSize(cmd_buff);
     itr->second.func(this);
+    Core::System::GetInstance().perf_stats.AddIPCBytesCopied(request_size +
+                                                             GetCommandSize(cmd_buff));
 }
 
 void Interface::Register(const FunctionInfo* functions, size_t n) {
@@ -182,6 +194,7 @@ void ServiceFrameworkBase::HandleSyncRequest(SharedPtr<ServerSession> server_ses
     handler_invoker(this, info->handler_callback, context);
     context.WriteToOutgoingCommandBuffer(cmd_buf, *Kernel::g_current_process,
                                          Kernel::g_handle_table);
+    Core::System::GetInstance().perf_stats.AddIPCBytesCopied(context.GetBytesCopied());
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -220,10 +233,20 @@ void Init() {
 
     AddNamedPort(new ERR::ERR_F);
 
-    FS::ArchiveInit();
+    auto& boot_profiler = Core::System::GetInstance().boot_profiler;
+    {
+        Core::BootProfiler::Scope profile_scope(boot_profiler, "FS::ArchiveInit");
+        FS::ArchiveInit();
+    }
     ACT::Init();
-    AM::Init();
-    APT::Init();
+    {
+        Core::BootProfiler::Scope profile_scope(boot_profiler, "AM::Init");
+        AM::Init();
+    }
+    {
+        Core::BootProfiler::Scope profile_scope(boot_profiler, "APT::Init");
+        APT::Init();
+    }
     BOSS::Init();
     CAM::Init();
     CECD::Init();
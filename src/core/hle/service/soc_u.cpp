@@ -815,6 +815,7 @@ static void GetSockOpt(Interface* self) {
         // + 0x4 = 2nd pointer (u32) position
         // >> 2  = convert to u32 offset instead of byte offset (cmd_buffer = u32*)
         char* optval = reinterpret_cast<char*>(Memory::GetPointer(cmd_buffer[0x104 >> 2]));
+        Memory::NotifyHostWrite(reinterpret_cast<u8*>(optval), optlen);
 
         err = ::getsockopt(socket_handle, level, optname, optval, &optlen);
         if (err == SOCKET_ERROR_VALUE) {
@@ -268,7 +268,9 @@ static ResultCode WaitSynchronization1(Kernel::Handle handle, s64 nano_seconds)
         if (nano_seconds == 0)
             return Kernel::RESULT_TIMEOUT;
 
-        thread->wait_objects = {object};
+        // The wait list keeps its storage between waits, so this doesn't allocate
+        ASSERT_MSG(thread->wait_objects.empty(), "Running thread is waiting for objects");
+        thread->wait_objects.push_back(object);
         object->AddWaitingThread(thread);
         thread->status = THREADSTATUS_WAIT_SYNCH_ANY;
 
@@ -323,24 +325,32 @@ static ResultCode WaitSynchronizationN(s32* out, VAddr handles_address, s32 hand
         return Kernel::ERR_OUT_OF_RANGE;
 
     using ObjectPtr = Kernel::SharedPtr<Kernel::WaitObject>;
-    std::vector<ObjectPtr> objects(handle_count);
+
+    // The objects are gathered straight into the thread's wait list, which keeps its storage
+    // between waits. It must be emptied again if the thread doesn't end up waiting.
+    auto& objects = thread->wait_objects;
+    ASSERT_MSG(objects.empty(), "Running thread is waiting for objects");
+    objects.reserve(handle_count);
 
     for (int i = 0; i < handle_count; ++i) {
         Kernel::Handle handle = Memory::Read32(handles_address + i * sizeof(Kernel::Handle));
         auto object = Kernel::g_handle_table.Get<Kernel::WaitObject>(handle);
-        if (object == nullptr)
+        if (object == nullptr) {
+            objects.clear();
             return ERR_INVALID_HANDLE;
-        objects[i] = object;
+        }
+        objects.push_back(std::move(object));
     }
 
     if (wait_all) {
-        bool all_available =
-            std::all_of(objects.begin(), objects.end(),
-                        [thread](const ObjectPtr& object) { return !object->ShouldWait(thread); });
-        if (all_available) {
+        auto blocker =
+            std::find_if(objects.begin(), objects.end(),
+                         [thread](const ObjectPtr& object) { return object->ShouldWait(thread); });
+        if (blocker == objects.end()) {
             // We can acquire all objects right now, do so.
             for (auto& object : objects)
                 object->Acquire(thread);
+            objects.clear();
             // Note: In this case, the `out` parameter is not set,
             // and retains whatever value it had before.
             return RESULT_SUCCESS;
@@ -350,19 +360,20 @@ static ResultCode WaitSynchronizationN(s32* out, VAddr handles_address, s32 hand
 
         // If a timeout value of 0 was provided, just return the Timeout error code instead of
         // suspending the thread.
-        if (nano_seconds == 0)
+        if (nano_seconds == 0) {
+            objects.clear();
             return Kernel::RESULT_TIMEOUT;
+        }
 
         // Put the thread to sleep
         thread->status = THREADSTATUS_WAIT_SYNCH_ALL;
+        thread->wait_all_blocker = static_cast<size_t>(std::distance(objects.begin(), blocker));
 
         // Add the thread to each of the objects' waiting threads.
         for (auto& object : objects) {
             object->AddWaitingThread(thread);
         }
 
-        thread->wait_objects = std::move(objects);
-
         // Create an event to wake the thread up after the specified nanosecond delay has passed
         thread->WakeAfterDelay(nano_seconds);
 
@@ -401,6 +412,7 @@ static ResultCode WaitSynchronizationN(s32* out, VAddr handles_address, s32 hand
             Kernel::WaitObject* object = itr->get();
             object->Acquire(thread);
             *out = static_cast<s32>(std::distance(objects.begin(), itr));
+            objects.clear();
             return RESULT_SUCCESS;
         }
 
@@ -408,8 +420,10 @@ static ResultCode WaitSynchronizationN(s32* out, VAddr handles_address, s32 hand
 
         // If a timeout value of 0 was provided, just return the Timeout error code instead of
         // suspending the thread.
-        if (nano_seconds == 0)
+        if (nano_seconds == 0) {
+            objects.clear();
             return Kernel::RESULT_TIMEOUT;
+        }
 
         // Put the thread to sleep
         thread->status = THREADSTATUS_WAIT_SYNCH_ANY;
@@ -420,8 +434,6 @@ static ResultCode WaitSynchronizationN(s32* out, VAddr handles_address, s32 hand
             object->AddWaitingThread(thread);
         }
 
-        thread->wait_objects = std::move(objects);
-
         // Note: If no handles and no timeout were given, then the thread will deadlock, this is
         // consistent with hardware behavior.
 
@@ -466,14 +478,22 @@ static ResultCode ReplyAndReceive(s32* index, VAddr handles_address, s32 handle_
         return Kernel::ERR_OUT_OF_RANGE;
 
     using ObjectPtr = SharedPtr<Kernel::WaitObject>;
-    std::vector<ObjectPtr> objects(handle_count);
+    Kernel::Thread* thread = Kernel::GetCurrentThread();
+
+    // As in WaitSynchronizationN, the objects are gathered straight into the thread's wait list,
+    // which must be emptied again if the thread doesn't end up waiting.
+    auto& objects = thread->wait_objects;
+    ASSERT_MSG(objects.empty(), "Running thread is waiting for objects");
+    objects.reserve(handle_count);
 
     for (int i = 0; i < handle_count; ++i) {
         Kernel::Handle handle = Memory::Read32(handles_address + i * sizeof(Kernel::Handle));
         auto object = Kernel::g_handle_table.Get<Kernel::WaitObject>(handle);
-        if (object == nullptr)
+        if (object == nullptr) {
+            objects.clear();
             return ERR_INVALID_HANDLE;
-        objects[i] = object;
+        }
+        objects.push_back(std::move(object));
     }
 
     // We are also sending a command reply.
@@ -482,8 +502,10 @@ static ResultCode ReplyAndReceive(s32* index, VAddr handles_address, s32 handle_
     IPC::Header header{cmd_buff[0]};
     if (reply_target != 0 && header.command_id != 0xFFFF) {
         auto session = Kernel::g_handle_table.Get<Kernel::ServerSession>(reply_target);
-        if (session == nullptr)
+        if (session == nullptr) {
+            objects.clear();
             return ERR_INVALID_HANDLE;
+        }
 
         auto request_thread = std::move(session->currently_handling);
 
@@ -494,6 +516,7 @@ static ResultCode ReplyAndReceive(s32* index, VAddr handles_address, s32 handle_
         // TODO(Subv): Is the same error code (ClosedByRemote) returned for both of these cases?
         if (request_thread == nullptr || session->parent->client == nullptr) {
             *index = -1;
+            objects.clear();
             return Kernel::ERR_SESSION_CLOSED_BY_REMOTE;
         }
 
@@ -513,8 +536,6 @@ static ResultCode ReplyAndReceive(s32* index, VAddr handles_address, s32 handle_
         return RESULT_SUCCESS;
     }
 
-    auto thread = Kernel::GetCurrentThread();
-
     // Find the first object that is acquirable in the provided list of objects
     auto itr = std::find_if(objects.begin(), objects.end(), [thread](const ObjectPtr& object) {
         return !object->ShouldWait(thread);
@@ -522,12 +543,13 @@ static ResultCode ReplyAndReceive(s32* index, VAddr handles_address, s32 handle_
 
     if (itr != objects.end()) {
         // We found a ready object, acquire it and set the result value
-        Kernel::WaitObject* object = itr->get();
+        ObjectPtr object = *itr;
         object->Acquire(thread);
         *index = static_cast<s32>(std::distance(objects.begin(), itr));
+        objects.clear();
 
         if (object->GetHandleType() == Kernel::HandleType::ServerSession) {
-            auto server_session = static_cast<Kernel::ServerSession*>(object);
+            auto server_session = static_cast<Kernel::ServerSession*>(object.get());
             if (server_session->parent->client == nullptr)
                 return Kernel::ERR_SESSION_CLOSED_BY_REMOTE;
 
@@ -547,8 +569,6 @@ static ResultCode ReplyAndReceive(s32* index, VAddr handles_address, s32 handle_
         object->AddWaitingThread(thread);
     }
 
-    thread->wait_objects = std::move(objects);
-
     thread->wakeup_callback = [](ThreadWakeupReason reason,
                                  Kernel::SharedPtr<Kernel::Thread> thread,
                                  Kernel::SharedPtr<Kernel::WaitObject> object) {
@@ -1401,12 +1421,15 @@ static const FunctionDef* GetSVCInfo(u32 func_num) {
 }
 
 MICROPROFILE_DEFINE(Kernel_SVC, "Kernel", "SVC", MP_RGB(70, 200, 70));
+static HLE::LockSite svc_lock_site("SVC::CallSVC");
 
 void CallSVC(u32 immediate) {
     MICROPROFILE_SCOPE(Kernel_SVC);
+    Core::FrameProfiler::Scope profile_scope(Core::System::GetInstance().frame_profiler,
+                                             Core::FrameProfiler::Component::HLE);
 
     // Lock the global kernel mutex when we enter the kernel HLE.
-    std::lock_guard<std::recursive_mutex> lock(HLE::g_hle_lock);
+    HLE::LockGuard lock(svc_lock_site);
 
     const FunctionDef* info = GetSVCInfo(immediate);
     if (info) {
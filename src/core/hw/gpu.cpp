@@ -6,11 +6,13 @@
 #include <numeric>
 #include <type_traits>
 #include "common/alignment.h"
+#include "common/chunk_file.h"
 #include "common/color.h"
 #include "common/common_types.h"
 #include "common/logging/log.h"
 #include "common/microprofile.h"
 #include "common/vector_math.h"
+#include "core/core.h"
 #include "core/core_timing.h"
 #include "core/hle/service/gsp_gpu.h"
 #include "core/hw/gpu.h"
@@ -110,6 +112,7 @@ static void MemoryFill(const Regs::MemoryFillConfig& config) {
 
     Memory::RasterizerFlushAndInvalidateRegion(config.GetStartAddress(),
                                                config.GetEndAddress() - config.GetStartAddress());
+    Memory::NotifyHostWrite(start, end - start);
 
     if (config.fill_24bit) {
         // fill with 24-bit values
@@ -169,6 +172,15 @@ static void DisplayTransfer(const Regs::DisplayTransferConfig& config) {
         return;
     }
 
+    // Drawing to the color buffers copied to the screen can be skipped when frames are skipped
+    for (const auto& framebuffer : g_regs.framebuffer_config) {
+        if (dst_addr == framebuffer.address_left1 || dst_addr == framebuffer.address_left2 ||
+            dst_addr == framebuffer.address_right1 || dst_addr == framebuffer.address_right2) {
+            Core::System::GetInstance().frame_skipper.AddPresentedColorBuffer(src_addr);
+            break;
+        }
+    }
+
     if (VideoCore::g_renderer->Rasterizer()->AccelerateDisplayTransfer(config))
         return;
 
@@ -200,6 +212,7 @@ static void DisplayTransfer(const Regs::DisplayTransferConfig& config) {
 
     Memory::RasterizerFlushRegion(config.GetPhysicalInputAddress(), input_size);
     Memory::RasterizerFlushAndInvalidateRegion(config.GetPhysicalOutputAddress(), output_size);
+    Memory::NotifyHostWrite(dst_pointer, output_size);
 
     for (u32 y = 0; y < output_height; ++y) {
         for (u32 x = 0; x < output_width; ++x) {
@@ -365,6 +378,7 @@ static void TextureCopy(const Regs::DisplayTransferConfig& config) {
         config.texture_copy.size / output_width * (output_width + output_gap);
     Memory::RasterizerFlushAndInvalidateRegion(config.GetPhysicalOutputAddress(),
                                                static_cast<u32>(contiguous_output_size));
+    Memory::NotifyHostWrite(dst_pointer, contiguous_output_size);
 
     u32 remaining_input = input_width;
     u32 remaining_output = output_width;
@@ -412,7 +426,11 @@ inline void Write(u32 addr, const T data) {
         auto& config = g_regs.memory_fill_config[is_second_filler];
 
         if (config.trigger) {
-            MemoryFill(config);
+            {
+                Core::FrameProfiler::Scope profile_scope(Core::System::GetInstance().frame_profiler,
+                                                         Core::FrameProfiler::Component::GPU);
+                MemoryFill(config);
+            }
             LOG_TRACE(HW_GPU, "MemoryFill from 0x%08x to 0x%08x", config.GetStartAddress(),
                       config.GetEndAddress());
 
@@ -436,6 +454,8 @@ inline void Write(u32 addr, const T data) {
 
     case GPU_REG_INDEX(display_transfer_config.trigger): {
         MICROPROFILE_SCOPE(GPU_DisplayTransfer);
+        Core::FrameProfiler::Scope profile_scope(Core::System::GetInstance().frame_profiler,
+                                                 Core::FrameProfiler::Component::GPU);
 
         const auto& config = g_regs.display_transfer_config;
         if (config.trigger & 1) {
@@ -473,6 +493,8 @@ inline void Write(u32 addr, const T data) {
         const auto& config = g_regs.command_processor_config;
         if (config.trigger & 1) {
             MICROPROFILE_SCOPE(GPU_CmdlistProcessing);
+            Core::FrameProfiler::Scope profile_scope(Core::System::GetInstance().frame_profiler,
+                                                     Core::FrameProfiler::Component::GPU);
 
             u32* buffer = (u32*)Memory::GetPhysicalPointer(config.GetPhysicalAddress());
 
@@ -515,7 +537,13 @@ template void Write<u8>(u32 addr, const u8 data);
 
 /// Update hardware
 static void VBlankCallback(u64 userdata, int cycles_late) {
-    VideoCore::g_renderer->SwapBuffers();
+    auto& frame_profiler = Core::System::GetInstance().frame_profiler;
+    {
+        Core::FrameProfiler::Scope profile_scope(frame_profiler,
+                                                 Core::FrameProfiler::Component::GPU);
+        VideoCore::g_renderer->SwapBuffers();
+    }
+    frame_profiler.EndFrame();
 
     // Signal to GSP that GPU interrupt has occurred
     // TODO(yuriks): hwtest to determine if PDC0 is for the Top screen and PDC1 for the Sub
@@ -570,4 +598,12 @@ void Shutdown() {
     LOG_DEBUG(HW_GPU, "shutdown OK");
 }
 
+void DoState(PointerWrap& p) {
+    auto s = p.Section("GPU", 1);
+    if (!s)
+        return;
+
+    p.DoVoid(&g_regs, sizeof(g_regs));
+}
+
 } // namespace
@@ -11,6 +11,8 @@
 #include "common/common_funcs.h"
 #include "common/common_types.h"
 
+class PointerWrap;
+
 namespace GPU {
 
 constexpr float SCREEN_REFRESH_RATE = 60;
@@ -331,4 +333,7 @@ void Init();
 /// Shutdown hardware
 void Shutdown();
 
+/// Serializes the hardware state, for checkpoints
+void DoState(PointerWrap& p);
+
 } // namespace
@@ -98,4 +98,9 @@ void Shutdown() {
     LCD::Shutdown();
     LOG_DEBUG(HW, "shutdown OK");
 }
+
+void DoState(PointerWrap& p) {
+    GPU::DoState(p);
+    LCD::DoState(p);
+}
 }
@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <cstring>
+#include "common/chunk_file.h"
 #include "common/common_types.h"
 #include "common/logging/log.h"
 #include "core/hw/hw.h"
@@ -73,4 +74,12 @@ void Shutdown() {
     LOG_DEBUG(HW_LCD, "shutdown OK");
 }
 
+void DoState(PointerWrap& p) {
+    auto s = p.Section("LCD", 1);
+    if (!s)
+        return;
+
+    p.DoVoid(&g_regs, sizeof(g_regs));
+}
+
 } // namespace
@@ -109,6 +109,7 @@ static void SendData(const u32* input, ConversionBuffer& buf, int amount_of_data
     u8* output = Memory::GetPointer(buf.address);
 
     while (amount_of_data > 0) {
+        Memory::NotifyHostWrite(output, buf.transfer_unit);
         u8* unit_end = output + buf.transfer_unit;
         while (output < unit_end) {
             u32 color = *input++;
@@ -149,7 +149,12 @@ ResultStatus AppLoader_NCCH::Load(Kernel::SharedPtr<Kernel::Process>& process) {
     if (is_loaded)
         return ResultStatus::ErrorAlreadyLoaded;
 
-    ResultStatus result = base_ncch.Load();
+    auto& boot_profiler = Core::System::GetInstance().boot_profiler;
+    ResultStatus result;
+    {
+        Core::BootProfiler::Scope profile_scope(boot_profiler, "NCCHContainer::Load");
+        result = base_ncch.Load();
+    }
     if (result != ResultStatus::Success)
         return result;
 
@@ -158,9 +163,12 @@ ResultStatus AppLoader_NCCH::Load(Kernel::SharedPtr<Kernel::Process>& process) {
 
     LOG_INFO(Loader, "Program ID: %s", program_id.c_str());
 
-    update_ncch.OpenFile(Service::AM::GetTitleContentPath(Service::FS::MediaType::SDMC,
-                                                          ncch_program_id | UPDATE_MASK));
-    result = update_ncch.Load();
+    {
+        Core::BootProfiler::Scope profile_scope(boot_profiler, "NCCHContainer::Load (update)");
+        update_ncch.OpenFile(Service::AM::GetTitleContentPath(Service::FS::MediaType::SDMC,
+                                                              ncch_program_id | UPDATE_MASK));
+        result = update_ncch.Load();
+    }
     if (result == ResultStatus::Success) {
         overlay_ncch = &update_ncch;
     }
@@ -176,11 +184,17 @@ ResultStatus AppLoader_NCCH::Load(Kernel::SharedPtr<Kernel::Process>& process) {
 
     is_loaded = true; // Set state to loaded
 
-    result = LoadExec(process); // Load the executable into memory for booting
+    {
+        Core::BootProfiler::Scope profile_scope(boot_profiler, "AppLoader_NCCH::LoadExec");
+        result = LoadExec(process); // Load the executable into memory for booting
+    }
     if (ResultStatus::Success != result)
         return result;
 
-    Service::FS::RegisterSelfNCCH(*this);
+    {
+        Core::BootProfiler::Scope profile_scope(boot_profiler, "FS::RegisterSelfNCCH");
+        Service::FS::RegisterSelfNCCH(*this);
+    }
 
     ParseRegionLockoutInfo();
 
@@ -4,6 +4,8 @@
 
 #include <array>
 #include <cstring>
+#include <utility>
+#include <vector>
 #include "audio_core/audio_core.h"
 #include "common/assert.h"
 #include "common/common_types.h"
@@ -26,6 +28,13 @@ static std::array<u8, Memory::N3DS_EXTRA_RAM_SIZE> n3ds_extra_ram;
 
 static PageTable* current_page_table = nullptr;
 
+/// Function reporting the writes to memory, null while writes aren't tracked
+static WriteTracker write_tracker;
+/// Page table whose writes are tracked
+static PageTable* tracked_page_table = nullptr;
+/// Pages that got their pointer back since the tracking was last armed
+static std::vector<size_t> written_pages;
+
 void SetCurrentPageTable(PageTable* page_table) {
     current_page_table = page_table;
     if (Core::System::GetInstance().IsPoweredOn()) {
@@ -48,8 +57,14 @@ static void MapPages(PageTable& page_table, u32 base, u32 size, u8* memory, Page
     while (base != end) {
         ASSERT_MSG(base < PAGE_TABLE_NUM_ENTRIES, "out of range mapping at %08X", base);
 
-        page_table.attributes[base] = type;
-        page_table.pointers[base] = memory;
+        if (type == PageType::Memory && write_tracker && &page_table == tracked_page_table) {
+            page_table.attributes[base] = PageType::WriteTrackedMemory;
+            page_table.pointers[base] = nullptr;
+            page_table.tracked_pointers[base] = memory;
+        } else {
+            page_table.attributes[base] = type;
+            page_table.pointers[base] = memory;
+        }
         page_table.cached_res_count[base] = 0;
 
         base += 1;
@@ -133,6 +148,23 @@ static MMIORegionPointer GetMMIOHandler(VAddr vaddr) {
     return GetMMIOHandler(page_table, vaddr);
 }
 
+/**
+ * Reports the first write to a page of the tracked page table, and gives the page its pointer back
+ * so that the next writes take the fast path.
+ * @returns the pointer to the page
+ */
+static u8* UntrackPage(size_t page_index) {
+    u8* pointer = tracked_page_table->tracked_pointers[page_index];
+    write_tracker(pointer, PAGE_SIZE);
+    tracked_page_table->attributes[page_index] = PageType::Memory;
+    tracked_page_table->pointers[page_index] = pointer;
+    written_pages.push_back(page_index);
+    return pointer;
+}
+
+static HLE::LockSite read_lock_site("Memory::Read");
+static HLE::LockSite write_lock_site("Memory::Write");
+
 template <typename T>
 T ReadMMIO(MMIORegionPointer mmio_handler, VAddr addr);
 
@@ -146,8 +178,18 @@ T Read(const VAddr vaddr) {
         return value;
     }
 
+    // Pages tracked for writes keep no pointer until written to, so the pages only read from,
+    // like code and read-only data, are read from here without locking
+    if (current_page_table->attributes[vaddr >> PAGE_BITS] == PageType::WriteTrackedMemory) {
+        T value;
+        std::memcpy(&value,
+                    &current_page_table->tracked_pointers[vaddr >> PAGE_BITS][vaddr & PAGE_MASK],
+                    sizeof(T));
+        return value;
+    }
+
     // The memory access might do an MMIO or cached access, so we have to lock the HLE kernel state
-    std::lock_guard<std::recursive_mutex> lock(HLE::g_hle_lock);
+    HLE::LockGuard lock(read_lock_site);
 
     PageType type = current_page_table->attributes[vaddr >> PAGE_BITS];
     switch (type) {
@@ -188,7 +230,7 @@ void Write(const VAddr vaddr, const T data) {
     }
 
     // The memory access might do an MMIO or cached access, so we have to lock the HLE kernel state
-    std::lock_guard<std::recursive_mutex> lock(HLE::g_hle_lock);
+    HLE::LockGuard lock(write_lock_site);
 
     PageType type = current_page_table->attributes[vaddr >> PAGE_BITS];
     switch (type) {
@@ -201,7 +243,14 @@ void Write(const VAddr vaddr, const T data) {
         break;
     case PageType::RasterizerCachedMemory: {
         RasterizerFlushVirtualRegion(vaddr, sizeof(T), FlushMode::FlushAndInvalidate);
-        std::memcpy(GetPointerFromVMA(vaddr), &data, sizeof(T));
+        u8* pointer = GetPointerFromVMA(vaddr);
+        NotifyHostWrite(pointer, sizeof(T));
+        std::memcpy(pointer, &data, sizeof(T));
+        break;
+    }
+    case PageType::WriteTrackedMemory: {
+        u8* page_pointer = UntrackPage(vaddr >> PAGE_BITS);
+        std::memcpy(&page_pointer[vaddr & PAGE_MASK], &data, sizeof(T));
         break;
     }
     case PageType::Special:
@@ -224,7 +273,8 @@ bool IsValidVirtualAddress(const Kernel::Process& process, const VAddr vaddr) {
     if (page_pointer)
         return true;
 
-    if (page_table.attributes[vaddr >> PAGE_BITS] == PageType::RasterizerCachedMemory)
+    if (page_table.attributes[vaddr >> PAGE_BITS] == PageType::RasterizerCachedMemory ||
+        page_table.attributes[vaddr >> PAGE_BITS] == PageType::WriteTrackedMemory)
         return true;
 
     if (page_table.attributes[vaddr >> PAGE_BITS] != PageType::Special)
@@ -256,6 +306,10 @@ u8* GetPointer(const VAddr vaddr) {
         return GetPointerFromVMA(vaddr);
     }
 
+    if (current_page_table->attributes[vaddr >> PAGE_BITS] == PageType::WriteTrackedMemory) {
+        return current_page_table->tracked_pointers[vaddr >> PAGE_BITS] + (vaddr & PAGE_MASK);
+    }
+
     LOG_ERROR(HW_Memory, "unknown GetPointer @ 0x%08x", vaddr);
     return nullptr;
 }
@@ -369,6 +423,7 @@ void RasterizerMarkRegionCached(PAddr start, u32 size, int count_delta) {
                 // space, for example, a system module need not have a VRAM mapping.
                 break;
             case PageType::Memory:
+            case PageType::WriteTrackedMemory:
                 page_type = PageType::RasterizerCachedMemory;
                 current_page_table->pointers[vaddr >> PAGE_BITS] = nullptr;
                 break;
@@ -397,6 +452,10 @@ void RasterizerMarkRegionCached(PAddr start, u32 size, int count_delta) {
                     // after unmapping a VMA. In that case the underlying VMA will no longer exist,
                     // and we should just leave the pagetable entry blank.
                     page_type = PageType::Unmapped;
+                } else if (write_tracker && current_page_table == tracked_page_table) {
+                    // The page may have been written to already, which the tracker ignores
+                    page_type = PageType::WriteTrackedMemory;
+                    current_page_table->tracked_pointers[vaddr >> PAGE_BITS] = pointer;
                 } else {
                     page_type = PageType::Memory;
                     current_page_table->pointers[vaddr >> PAGE_BITS] = pointer;
@@ -462,6 +521,55 @@ void RasterizerFlushVirtualRegion(VAddr start, u32 size, FlushMode mode) {
     }
 }
 
+void StartWriteTracking(WriteTracker tracker) {
+    StopWriteTracking();
+    write_tracker = std::move(tracker);
+    tracked_page_table = current_page_table;
+    for (size_t page_index = 0; page_index < PAGE_TABLE_NUM_ENTRIES; ++page_index) {
+        if (tracked_page_table->attributes[page_index] == PageType::Memory) {
+            tracked_page_table->attributes[page_index] = PageType::WriteTrackedMemory;
+            tracked_page_table->tracked_pointers[page_index] =
+                tracked_page_table->pointers[page_index];
+            tracked_page_table->pointers[page_index] = nullptr;
+        }
+    }
+}
+
+void RearmWriteTracking() {
+    for (size_t page_index : written_pages) {
+        // The page may have been remapped or cached by the rasterizer since
+        if (tracked_page_table->attributes[page_index] == PageType::Memory) {
+            tracked_page_table->attributes[page_index] = PageType::WriteTrackedMemory;
+            tracked_page_table->tracked_pointers[page_index] =
+                tracked_page_table->pointers[page_index];
+            tracked_page_table->pointers[page_index] = nullptr;
+        }
+    }
+    written_pages.clear();
+}
+
+void StopWriteTracking() {
+    if (!write_tracker) {
+        return;
+    }
+    for (size_t page_index = 0; page_index < PAGE_TABLE_NUM_ENTRIES; ++page_index) {
+        if (tracked_page_table->attributes[page_index] == PageType::WriteTrackedMemory) {
+            tracked_page_table->attributes[page_index] = PageType::Memory;
+            tracked_page_table->pointers[page_index] =
+                tracked_page_table->tracked_pointers[page_index];
+        }
+    }
+    write_tracker = nullptr;
+    tracked_page_table = nullptr;
+    written_pages.clear();
+}
+
+void NotifyHostWrite(u8* pointer, size_t size) {
+    if (write_tracker) {
+        write_tracker(pointer, size);
+    }
+}
+
 u8 Read8(const VAddr addr) {
     return Read<u8>(addr);
 }
@@ -516,6 +624,11 @@ void ReadBlock(const Kernel::Process& process, const VAddr src_addr, void* dest_
             std::memcpy(dest_buffer, GetPointerFromVMA(process, current_vaddr), copy_amount);
             break;
         }
+        case PageType::WriteTrackedMemory: {
+            const u8* src_ptr = page_table.tracked_pointers[page_index] + page_offset;
+            std::memcpy(dest_buffer, src_ptr, copy_amount);
+            break;
+        }
         case PageType::RasterizerCachedSpecial: {
             MMIORegionPointer handler = GetMMIOHandler(page_table, current_vaddr);
             DEBUG_ASSERT(handler);
@@ -589,7 +702,14 @@ void WriteBlock(const Kernel::Process& process, const VAddr dest_addr, const voi
         case PageType::RasterizerCachedMemory: {
             RasterizerFlushVirtualRegion(current_vaddr, static_cast<u32>(copy_amount),
                                          FlushMode::FlushAndInvalidate);
-            std::memcpy(GetPointerFromVMA(process, current_vaddr), src_buffer, copy_amount);
+            u8* dest_ptr = GetPointerFromVMA(process, current_vaddr);
+            NotifyHostWrite(dest_ptr, copy_amount);
+            std::memcpy(dest_ptr, src_buffer, copy_amount);
+            break;
+        }
+        case PageType::WriteTrackedMemory: {
+            u8* dest_ptr = UntrackPage(page_index) + page_offset;
+            std::memcpy(dest_ptr, src_buffer, copy_amount);
             break;
         }
         case PageType::RasterizerCachedSpecial: {
@@ -615,6 +735,65 @@ void WriteBlock(const VAddr dest_addr, const void* src_buffer, const size_t size
     WriteBlock(*Kernel::g_current_process, dest_addr, src_buffer, size);
 }
 
+/// Gets the host memory backing a range of the current process' memory, for reading or writing
+static bool GetHostSpans(const VAddr vaddr, const size_t size, std::vector<HostSpan>& spans,
+                         bool writable) {
+    const auto& process = *Kernel::g_current_process;
+    auto& page_table = process.vm_manager.page_table;
+    size_t remaining_size = size;
+    size_t page_index = vaddr >> PAGE_BITS;
+    size_t page_offset = vaddr & PAGE_MASK;
+
+    spans.clear();
+    while (remaining_size > 0) {
+        const size_t span_amount = std::min(PAGE_SIZE - page_offset, remaining_size);
+        const VAddr current_vaddr = static_cast<VAddr>((page_index << PAGE_BITS) + page_offset);
+
+        u8* pointer;
+        switch (page_table.attributes[page_index]) {
+        case PageType::Memory:
+            DEBUG_ASSERT(page_table.pointers[page_index]);
+            pointer = page_table.pointers[page_index] + page_offset;
+            break;
+        case PageType::RasterizerCachedMemory:
+            RasterizerFlushVirtualRegion(current_vaddr, static_cast<u32>(span_amount),
+                                         writable ? FlushMode::FlushAndInvalidate
+                                                  : FlushMode::Flush);
+            pointer = GetPointerFromVMA(process, current_vaddr);
+            if (writable) {
+                NotifyHostWrite(pointer, span_amount);
+            }
+            break;
+        case PageType::WriteTrackedMemory:
+            pointer = writable ? UntrackPage(page_index) + page_offset
+                               : page_table.tracked_pointers[page_index] + page_offset;
+            break;
+        default:
+            return false;
+        }
+
+        if (!spans.empty() && spans.back().pointer + spans.back().size == pointer) {
+            spans.back().size += span_amount;
+        } else {
+            spans.push_back({pointer, span_amount});
+        }
+
+        page_index++;
+        page_offset = 0;
+        remaining_size -= span_amount;
+    }
+
+    return true;
+}
+
+bool GetWritableHostSpans(const VAddr vaddr, const size_t size, std::vector<HostSpan>& spans) {
+    return GetHostSpans(vaddr, size, spans, true);
+}
+
+bool GetReadableHostSpans(const VAddr vaddr, const size_t size, std::vector<HostSpan>& spans) {
+    return GetHostSpans(vaddr, size, spans, false);
+}
+
 void ZeroBlock(const VAddr dest_addr, const size_t size) {
     size_t remaining_size = size;
     size_t page_index = dest_addr >> PAGE_BITS;
@@ -648,7 +827,14 @@ void ZeroBlock(const VAddr dest_addr, const size_t size) {
         case PageType::RasterizerCachedMemory: {
             RasterizerFlushVirtualRegion(current_vaddr, static_cast<u32>(copy_amount),
                                          FlushMode::FlushAndInvalidate);
-            std::memset(GetPointerFromVMA(current_vaddr), 0, copy_amount);
+            u8* dest_ptr = GetPointerFromVMA(current_vaddr);
+            NotifyHostWrite(dest_ptr, copy_amount);
+            std::memset(dest_ptr, 0, copy_amount);
+            break;
+        }
+        case PageType::WriteTrackedMemory: {
+            u8* dest_ptr = UntrackPage(page_index) + page_offset;
+            std::memset(dest_ptr, 0, copy_amount);
             break;
         }
         case PageType::RasterizerCachedSpecial: {
@@ -704,6 +890,11 @@ void CopyBlock(VAddr dest_addr, VAddr src_addr, const size_t size) {
             WriteBlock(dest_addr, GetPointerFromVMA(current_vaddr), copy_amount);
             break;
         }
+        case PageType::WriteTrackedMemory: {
+            const u8* src_ptr = current_page_table->tracked_pointers[page_index] + page_offset;
+            WriteBlock(dest_addr, src_ptr, copy_amount);
+            break;
+        }
         case PageType::RasterizerCachedSpecial: {
             DEBUG_ASSERT(GetMMIOHandler(current_vaddr));
             RasterizerFlushVirtualRegion(current_vaddr, static_cast<u32>(copy_amount),
@@ -6,6 +6,7 @@
 
 #include <array>
 #include <cstddef>
+#include <functional>
 #include <string>
 #include <vector>
 #include <boost/optional.hpp>
@@ -40,6 +41,9 @@ enum class PageType {
     /// Page is mapped to a I/O region, but also needs to check for rasterizer cache flushing and
     /// invalidation
     RasterizerCachedSpecial,
+    /// Page is mapped to regular memory, but the first write to it must be reported to the write
+    /// tracker (see StartWriteTracking) before the page gets its pointer back
+    WriteTrackedMemory,
 };
 
 struct SpecialRegion {
@@ -78,6 +82,12 @@ struct PageTable {
      * flushed before the memory is accessed
      */
     std::array<u8, PAGE_TABLE_NUM_ENTRIES> cached_res_count;
+
+    /**
+     * Array of memory pointers backing the pages whose entries in the `attributes` array are of
+     * type `WriteTrackedMemory`, which are only accessed through the slow path.
+     */
+    std::array<u8*, PAGE_TABLE_NUM_ENTRIES> tracked_pointers;
 };
 
 /// Physical memory regions as seen from the ARM11
@@ -214,8 +224,38 @@ void WriteBlock(const VAddr dest_addr, const void* src_buffer, size_t size);
 void ZeroBlock(const VAddr dest_addr, const size_t size);
 void CopyBlock(VAddr dest_addr, VAddr src_addr, size_t size);
 
+/**
+ * Gets a pointer to the memory at a virtual address of the current process. Writes through this
+ * pointer bypass the write tracking, so they must be reported with NotifyHostWrite first.
+ */
 u8* GetPointer(VAddr virtual_address);
 
+/// A run of guest memory that is contiguous in host memory
+struct HostSpan {
+    u8* pointer;
+    size_t size;
+};
+
+/**
+ * Gets the host memory backing a range of the current process' memory, so that it can be written
+ * to directly instead of going through WriteBlock. Adjacent pages that are also adjacent in host
+ * memory are merged into a single span. Any copy of the range cached by the rasterizer is flushed
+ * and invalidated, as WriteBlock would do.
+ * @param vaddr Start of the range
+ * @param size Size of the range in bytes
+ * @param spans Filled with the spans backing the range, in order
+ * @returns false if part of the range isn't backed by memory (e.g. unmapped or MMIO), in which case
+ *          the range has to be written with WriteBlock
+ */
+bool GetWritableHostSpans(VAddr vaddr, size_t size, std::vector<HostSpan>& spans);
+
+/**
+ * Gets the host memory backing a range of the current process' memory, so that it can be read
+ * directly instead of going through ReadBlock. This works like GetWritableHostSpans, except that
+ * the copies cached by the rasterizer are only flushed, and the spans must not be written to.
+ */
+bool GetReadableHostSpans(VAddr vaddr, size_t size, std::vector<HostSpan>& spans);
+
 std::string ReadCString(VAddr virtual_address, std::size_t max_length);
 
 /**
@@ -271,4 +311,29 @@ enum class FlushMode {
  */
 void RasterizerFlushVirtualRegion(VAddr start, u32 size, FlushMode mode);
 
+/**
+ * Function called before emulated memory is written to, with the host memory about to be written.
+ * It is called at least once for each page written to since the tracking was last armed.
+ */
+using WriteTracker = std::function<void(u8* pointer, size_t size)>;
+
+/**
+ * Starts tracking the writes to the memory of the current process, in the same way as the
+ * rasterizer cache tracks its pages: the pages of memory are given the `WriteTrackedMemory` type
+ * and no pointer, so that the first write to each page, by the CPU or by the Memory functions, goes
+ * through the slow path and reaches the tracker. The page then gets its pointer back until the
+ * tracking is re-armed. Memory written through host pointers (the GPU, and the HLE services using
+ * GetPointer or shared memory) isn't seen this way, and must be reported with NotifyHostWrite.
+ */
+void StartWriteTracking(WriteTracker tracker);
+
+/// Tracks the writes to the pages written to since the tracking was started or last re-armed again
+void RearmWriteTracking();
+
+/// Stops tracking writes, giving all the pages their pointers back
+void StopWriteTracking();
+
+/// Reports host memory about to be written to directly, if writes are being tracked
+void NotifyHostWrite(u8* pointer, size_t size);
+
 } // namespace Memory
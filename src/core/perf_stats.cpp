@@ -2,9 +2,14 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <chrono>
 #include <mutex>
 #include <thread>
+#ifdef __linux__
+#include <cerrno>
+#include <time.h>
+#endif
 #include "common/math_util.h"
 #include "core/hw/gpu.h"
 #include "core/perf_stats.h"
@@ -17,6 +22,8 @@ using std::chrono::microseconds;
 
 namespace Core {
 
+constexpr std::array<u32, 7> PerfStats::PACING_ERROR_BUCKETS_US;
+
 void PerfStats::BeginSystemFrame() {
     std::lock_guard<std::mutex> lock(object_mutex);
 
@@ -30,6 +37,7 @@ void PerfStats::EndSystemFrame() {
     accumulated_frametime += frame_end - frame_begin;
     system_frames += 1;
 
+    previous_frametime = frame_end - frame_begin;
     previous_frame_length = frame_end - previous_frame_end;
     previous_frame_end = frame_end;
 }
@@ -40,6 +48,44 @@ void PerfStats::EndGameFrame() {
     game_frames += 1;
 }
 
+void PerfStats::AddContextSwitch(Clock::duration duration) {
+    context_switches.fetch_add(1, std::memory_order_relaxed);
+    accumulated_context_switch_ticks.fetch_add(duration.count(), std::memory_order_relaxed);
+}
+
+void PerfStats::AddIPCRequest() {
+    ipc_requests.fetch_add(1, std::memory_order_relaxed);
+}
+
+void PerfStats::AddIPCBytesCopied(size_t bytes) {
+    ipc_bytes_copied.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void PerfStats::AddSurfaceDownload(bool started_early, Clock::duration stall_time) {
+    std::lock_guard<std::mutex> lock(object_mutex);
+
+    surface_downloads += 1;
+    early_surface_downloads += started_early ? 1 : 0;
+    accumulated_surface_download_stall += stall_time;
+}
+
+void PerfStats::AddSkippedFrame(Clock::duration time_saved) {
+    std::lock_guard<std::mutex> lock(object_mutex);
+
+    skipped_frames += 1;
+    accumulated_skip_time_saved += time_saved;
+}
+
+void PerfStats::AddFramePacingError(std::chrono::nanoseconds error) {
+    std::lock_guard<std::mutex> lock(object_mutex);
+
+    const auto error_us = static_cast<u64>(duration_cast<microseconds>(error).count());
+    const auto bucket = std::lower_bound(PACING_ERROR_BUCKETS_US.begin(),
+                                         PACING_ERROR_BUCKETS_US.end(), error_us);
+    pacing_errors[bucket - PACING_ERROR_BUCKETS_US.begin()] += 1;
+    max_pacing_error = std::max(max_pacing_error, error);
+}
+
 PerfStats::Results PerfStats::GetAndResetStats(u64 current_system_time_us) {
     std::lock_guard<std::mutex> lock(object_mutex);
 
@@ -56,6 +102,32 @@ PerfStats::Results PerfStats::GetAndResetStats(u64 current_system_time_us) {
     results.frametime = duration_cast<DoubleSecs>(accumulated_frametime).count() /
                         static_cast<double>(system_frames);
     results.emulation_speed = system_us_per_second / 1'000'000.0;
+    const u32 switches = context_switches.exchange(0, std::memory_order_relaxed);
+    const Clock::duration switch_time{
+        accumulated_context_switch_ticks.exchange(0, std::memory_order_relaxed)};
+    results.context_switch_rate = static_cast<double>(switches) / interval;
+    results.context_switch_time =
+        switches == 0 ? 0.0
+                      : duration_cast<DoubleSecs>(switch_time).count() /
+                            static_cast<double>(switches);
+    const u64 requests = ipc_requests.exchange(0, std::memory_order_relaxed);
+    const u64 bytes_copied = ipc_bytes_copied.exchange(0, std::memory_order_relaxed);
+    results.ipc_request_rate = static_cast<double>(requests) / interval;
+    results.ipc_bytes_per_request =
+        requests == 0 ? 0.0 : static_cast<double>(bytes_copied) / static_cast<double>(requests);
+    results.surface_downloads = surface_downloads;
+    results.early_surface_downloads = early_surface_downloads;
+    results.surface_download_stall_time =
+        duration_cast<DoubleSecs>(accumulated_surface_download_stall).count();
+    results.skipped_frames = skipped_frames;
+    // Without skipping frames, the same emulated time would have taken the saved time longer
+    const double interval_without_skipping =
+        interval + duration_cast<DoubleSecs>(accumulated_skip_time_saved).count();
+    results.frame_skip_speed_gain =
+        results.emulation_speed - system_us_per_second * interval / interval_without_skipping /
+                                      1'000'000.0;
+    results.pacing_error_histogram = pacing_errors;
+    results.pacing_error_max = duration_cast<DoubleSecs>(max_pacing_error).count();
 
     // Reset counters
     reset_point = now;
@@ -63,6 +135,13 @@ PerfStats::Results PerfStats::GetAndResetStats(u64 current_system_time_us) {
     accumulated_frametime = Clock::duration::zero();
     system_frames = 0;
     game_frames = 0;
+    surface_downloads = 0;
+    early_surface_downloads = 0;
+    accumulated_surface_download_stall = Clock::duration::zero();
+    skipped_frames = 0;
+    accumulated_skip_time_saved = Clock::duration::zero();
+    pacing_errors = {};
+    max_pacing_error = std::chrono::nanoseconds::zero();
 
     return results;
 }
@@ -74,7 +153,13 @@ double PerfStats::GetLastFrameTimeScale() {
     return duration_cast<DoubleSecs>(previous_frame_length).count() / FRAME_LENGTH;
 }
 
-void FrameLimiter::DoFrameLimiting(u64 current_system_time_us) {
+PerfStats::Clock::duration PerfStats::GetLastFrametime() {
+    std::lock_guard<std::mutex> lock(object_mutex);
+
+    return previous_frametime;
+}
+
+void FrameLimiter::DoFrameLimiting(u64 current_system_time_us, PerfStats& perf_stats) {
     // Max lag caused by slow frames. Can be adjusted to compensate for too many slow frames. Higher
     // values increase the time needed to recover and limit framerate again after spikes.
     constexpr microseconds MAX_LAG_TIME_US = 25ms;
@@ -91,9 +176,16 @@ void FrameLimiter::DoFrameLimiting(u64 current_system_time_us) {
         MathUtil::Clamp(frame_limiting_delta_err, -MAX_LAG_TIME_US, MAX_LAG_TIME_US);
 
     if (frame_limiting_delta_err > microseconds::zero()) {
-        std::this_thread::sleep_for(frame_limiting_delta_err);
+        Clock::time_point deadline = now + frame_limiting_delta_err;
+        if (Settings::values.frame_pacing == Settings::FramePacing::VSync &&
+            Settings::values.use_vsync) {
+            // Waking up at a refresh that already passed just doesn't wait
+            deadline = std::max(AlignToVSync(deadline), now);
+        }
+        WaitUntil(deadline);
 
         auto now_after_sleep = Clock::now();
+        perf_stats.AddFramePacingError(std::max(now_after_sleep - deadline, Clock::duration{}));
         frame_limiting_delta_err -= duration_cast<microseconds>(now_after_sleep - now);
         now = now_after_sleep;
     }
@@ -102,4 +194,107 @@ void FrameLimiter::DoFrameLimiting(u64 current_system_time_us) {
     previous_walltime = now;
 }
 
+void FrameLimiter::AddVSyncTimestamp(Clock::time_point time) {
+    // Swaps taking longer than this missed a refresh, and don't tell its period
+    constexpr double MAX_PERIOD_RATIO = 1.5;
+    // Weight of the last swap in the estimated period
+    constexpr double AVERAGE_WEIGHT = 0.125;
+
+    const Clock::duration interval = time - last_vsync;
+    last_vsync = time;
+    if (vsync_period == Clock::duration::zero()) {
+        // The first intervals may be long, only those shorter than a 30 Hz refresh are trusted
+        if (interval < 33ms)
+            vsync_period = interval;
+    } else if (interval < vsync_period * MAX_PERIOD_RATIO) {
+        vsync_period += duration_cast<Clock::duration>((interval - vsync_period) * AVERAGE_WEIGHT);
+    }
+}
+
+void FrameLimiter::WaitUntil(Clock::time_point deadline) {
+    if (Settings::values.frame_pacing == Settings::FramePacing::Sleep) {
+        std::this_thread::sleep_until(deadline);
+        return;
+    }
+
+    // Sleeps end late by up to the timer slack (50 us by default) on Linux, and by up to the
+    // scheduler period elsewhere, so the end of the wait is spun instead
+#ifdef __linux__
+    constexpr Clock::duration SPIN_TIME = 200us;
+    const auto sleep_end = (deadline - SPIN_TIME).time_since_epoch();
+    // steady_clock is CLOCK_MONOTONIC, and an absolute sleep doesn't drift when interrupted
+    timespec wake_time;
+    wake_time.tv_sec = static_cast<time_t>(duration_cast<std::chrono::seconds>(sleep_end).count());
+    wake_time.tv_nsec = static_cast<long>(
+        duration_cast<std::chrono::nanoseconds>(sleep_end % std::chrono::seconds(1)).count());
+    if (sleep_end.count() > 0) {
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake_time, nullptr) == EINTR) {
+        }
+    }
+#else
+    constexpr Clock::duration SPIN_TIME = 2ms;
+    std::this_thread::sleep_until(deadline - SPIN_TIME);
+#endif
+    while (Clock::now() < deadline) {
+        std::this_thread::yield();
+    }
+}
+
+FrameLimiter::Clock::time_point FrameLimiter::AlignToVSync(Clock::time_point deadline) const {
+    if (vsync_period == Clock::duration::zero() || deadline < last_vsync)
+        return deadline;
+    const auto refreshes = (deadline - last_vsync + vsync_period / 2) / vsync_period;
+    return last_vsync + refreshes * vsync_period;
+}
+
+bool FrameSkipper::IsSkippingDraw(PAddr color_buffer) const {
+    return skipping_frame &&
+           std::find(presented_color_buffers.begin(), presented_color_buffers.end(),
+                     color_buffer) != presented_color_buffers.end();
+}
+
+void FrameSkipper::AddPresentedColorBuffer(PAddr color_buffer) {
+    if (std::find(presented_color_buffers.begin(), presented_color_buffers.end(),
+                  color_buffer) != presented_color_buffers.end()) {
+        return;
+    }
+    presented_color_buffers[next_presented_color_buffer] = color_buffer;
+    next_presented_color_buffer = (next_presented_color_buffer + 1) % MAX_PRESENTED_COLOR_BUFFERS;
+}
+
+void FrameSkipper::EndFrame(PerfStats& perf_stats) {
+    // Weight of the last frame in the average walltimes
+    constexpr double AVERAGE_WEIGHT = 0.125;
+    constexpr double FRAME_LENGTH = 1.0 / GPU::SCREEN_REFRESH_RATE;
+
+    if (!Settings::values.use_frame_skip) {
+        skipping_frame = false;
+        frames_skipped_in_row = 0;
+        return;
+    }
+
+    const double frametime = duration_cast<DoubleSecs>(perf_stats.GetLastFrametime()).count();
+    double& average = skipping_frame ? skipped_frametime : rendered_frametime;
+    average = average == 0.0 ? frametime : average + (frametime - average) * AVERAGE_WEIGHT;
+    if (skipping_frame) {
+        const double time_saved = std::max(rendered_frametime - frametime, 0.0);
+        perf_stats.AddSkippedFrame(duration_cast<Clock::duration>(DoubleSecs(time_saved)));
+        frames_skipped_in_row += 1;
+    } else {
+        frames_skipped_in_row = 0;
+    }
+
+    // Until a frame was skipped, skipping is assumed to save the whole rendering time
+    const double threshold = Settings::values.frame_skip_threshold / 100.0;
+    u32 frames_per_render = 1;
+    while (frames_per_render < MAX_FRAMES_PER_RENDER) {
+        const double walltime =
+            rendered_frametime + (frames_per_render - 1) * skipped_frametime;
+        if (frames_per_render * FRAME_LENGTH >= walltime * threshold)
+            break;
+        frames_per_render += 1;
+    }
+    skipping_frame = frames_skipped_in_row + 1 < frames_per_render;
+}
+
 } // namespace Core
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <chrono>
 #include <mutex>
 #include "common/common_types.h"
@@ -18,6 +20,12 @@ class PerfStats {
 public:
     using Clock = std::chrono::high_resolution_clock;
 
+    /// Inclusive upper bounds, in microseconds, of the buckets of the frame pacing error histogram.
+    /// The last bucket holds the larger errors.
+    static constexpr std::array<u32, 7> PACING_ERROR_BUCKETS_US{
+        {50, 100, 250, 500, 1000, 2000, 5000}};
+    static constexpr size_t NumPacingErrorBuckets = PACING_ERROR_BUCKETS_US.size() + 1;
+
     struct Results {
         /// System FPS (LCD VBlanks) in Hz
         double system_fps;
@@ -27,12 +35,68 @@ public:
         double frametime;
         /// Ratio of walltime / emulated time elapsed
         double emulation_speed;
+        /// Guest thread context switches in Hz
+        double context_switch_rate;
+        /// Average walltime per guest thread context switch, in seconds
+        double context_switch_time;
+        /// IPC requests handled by HLE services in Hz
+        double ipc_request_rate;
+        /// Average number of bytes the HLE IPC layer copied per request
+        double ipc_bytes_per_request;
+        /// Number of system frames whose rasterization was skipped
+        u32 skipped_frames;
+        /// Estimated increase of emulation_speed due to the skipped frames
+        double frame_skip_speed_gain;
+        /// Number of rasterizer surfaces read back from the host GPU to emulated memory
+        u32 surface_downloads;
+        /// Number of those surface readbacks that had been started ahead of time
+        u32 early_surface_downloads;
+        /// Total walltime spent waiting for surface readbacks to complete, in seconds
+        double surface_download_stall_time;
+        /// Number of frames the frame limiter waited for, by how late it woke up
+        std::array<u32, NumPacingErrorBuckets> pacing_error_histogram;
+        /// Largest lateness of the frame limiter, in seconds
+        double pacing_error_max;
     };
 
     void BeginSystemFrame();
     void EndSystemFrame();
     void EndGameFrame();
 
+    /**
+     * Records a guest thread context switch. Lock-free, as it is called on every switch.
+     * @param duration Walltime the switch took
+     */
+    void AddContextSwitch(Clock::duration duration);
+
+    /// Records an IPC request handled by an HLE service. Lock-free, as it is called on every one.
+    void AddIPCRequest();
+
+    /**
+     * Records data copied by the HLE IPC layer while handling a request. Lock-free.
+     * @param bytes Number of bytes copied between guest memory and the request context
+     */
+    void AddIPCBytesCopied(size_t bytes);
+
+    /**
+     * Records a rasterizer surface read back from the host GPU to emulated memory.
+     * @param started_early Whether the readback was started before the data was needed
+     * @param stall_time Walltime spent waiting for the readback to complete
+     */
+    void AddSurfaceDownload(bool started_early, Clock::duration stall_time);
+
+    /**
+     * Records a system frame whose rasterization was skipped.
+     * @param time_saved Estimated walltime that rasterizing the frame would have taken
+     */
+    void AddSkippedFrame(Clock::duration time_saved);
+
+    /**
+     * Records how precisely the frame limiter woke up for a frame
+     * @param error Time between the deadline of the frame and the end of the wait
+     */
+    void AddFramePacingError(std::chrono::nanoseconds error);
+
     Results GetAndResetStats(u64 current_system_time_us);
 
     /**
@@ -41,6 +105,9 @@ public:
      */
     double GetLastFrameTimeScale();
 
+    /// Gets the walltime of the previous system frame, excluding any waits
+    Clock::duration GetLastFrametime();
+
 private:
     std::mutex object_mutex;
 
@@ -55,6 +122,28 @@ private:
     u32 system_frames = 0;
     /// Cumulative number of game frames (GSP frame submissions) since last reset
     u32 game_frames = 0;
+    /// Cumulative number of guest thread context switches since last reset
+    std::atomic<u32> context_switches{0};
+    /// Cumulative duration of guest thread context switches since last reset, in clock ticks
+    std::atomic<Clock::rep> accumulated_context_switch_ticks{0};
+    /// Cumulative number of IPC requests handled by HLE services since last reset
+    std::atomic<u64> ipc_requests{0};
+    /// Cumulative number of bytes copied by the HLE IPC layer since last reset
+    std::atomic<u64> ipc_bytes_copied{0};
+    /// Cumulative number of surfaces read back since last reset
+    u32 surface_downloads = 0;
+    /// Cumulative number of surfaces read back since last reset whose readback started early
+    u32 early_surface_downloads = 0;
+    /// Cumulative walltime spent waiting for surface readbacks since last reset
+    Clock::duration accumulated_surface_download_stall = Clock::duration::zero();
+    /// Cumulative number of system frames skipped since last reset
+    u32 skipped_frames = 0;
+    /// Cumulative walltime saved by skipping frames since last reset
+    Clock::duration accumulated_skip_time_saved = Clock::duration::zero();
+    /// Histogram of the frame pacing errors since last reset
+    std::array<u32, NumPacingErrorBuckets> pacing_errors{};
+    /// Largest frame pacing error since last reset
+    std::chrono::nanoseconds max_pacing_error = std::chrono::nanoseconds::zero();
 
     /// Point when the previous system frame ended
     Clock::time_point previous_frame_end = reset_point;
@@ -62,15 +151,35 @@ private:
     Clock::time_point frame_begin = reset_point;
     /// Total visible duration (including frame-limiting, etc.) of the previous system frame
     Clock::duration previous_frame_length = Clock::duration::zero();
+    /// Duration (excluding v-sync/frame-limiting) of the previous system frame
+    Clock::duration previous_frametime = Clock::duration::zero();
 };
 
 class FrameLimiter {
 public:
-    using Clock = std::chrono::high_resolution_clock;
+    /// Monotonic, so that waits aren't affected by changes of the system time
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * Waits until the walltime catches up with the emulated time, if frame limiting is enabled
+     * @param current_system_time_us Emulated system time, in microseconds
+     * @param perf_stats Statistics recording how precisely the waits end
+     */
+    void DoFrameLimiting(u64 current_system_time_us, PerfStats& perf_stats);
 
-    void DoFrameLimiting(u64 current_system_time_us);
+    /**
+     * Records when a frame was presented with V-Sync, which tells when the display refreshes
+     * @param time Point when the swap of buffers ended
+     */
+    void AddVSyncTimestamp(Clock::time_point time);
 
 private:
+    /// Waits until a point in time, as precisely as the frame pacing setting asks for
+    static void WaitUntil(Clock::time_point deadline);
+
+    /// Moves a deadline to the nearest refresh of the display, if known
+    Clock::time_point AlignToVSync(Clock::time_point deadline) const;
+
     /// Emulated system time (in microseconds) at the last limiter invocation
     u64 previous_system_time_us = 0;
     /// Walltime at the last limiter invocation
@@ -78,6 +187,67 @@ private:
 
     /// Accumulated difference between walltime and emulated time
     std::chrono::microseconds frame_limiting_delta_err{0};
+
+    /// Last time a frame was presented with V-Sync
+    Clock::time_point last_vsync{};
+    /// Estimated refresh period of the display, zero until known
+    Clock::duration vsync_period = Clock::duration::zero();
+};
+
+/**
+ * Skips the rasterization of some system frames when the host can't emulate at full speed. The
+ * GPU commands and vertex shaders still run, only the drawing of triangles is dropped, so that the
+ * emulated state stays the same.
+ *
+ * The walltime of rendered and skipped frames is averaged separately, which predicts the speed of
+ * rendering one frame out of N. The smallest N reaching the speed threshold is chosen, up to one
+ * frame out of MAX_FRAMES_PER_RENDER. Must only be used from the emulation thread.
+ */
+class FrameSkipper {
+public:
+    using Clock = PerfStats::Clock;
+
+    /// Returns whether the rasterization of the current system frame is skipped
+    bool IsSkippingFrame() const {
+        return skipping_frame;
+    }
+
+    /**
+     * Returns whether draws to a color buffer are dropped in the current system frame. Only the
+     * color buffers copied to the screen are skipped: the other render targets may be textures or
+     * buffers the game reads back, whose contents in emulated memory must stay up to date.
+     * @param color_buffer Physical address of the color buffer drawn to
+     */
+    bool IsSkippingDraw(PAddr color_buffer) const;
+
+    /**
+     * Records a color buffer copied to the screen by a display transfer
+     * @param color_buffer Physical address of the color buffer copied
+     */
+    void AddPresentedColorBuffer(PAddr color_buffer);
+
+    /**
+     * Ends the current system frame and chooses whether the next one is skipped
+     * @param perf_stats Statistics giving the walltime of the frame, and recording skipped frames
+     */
+    void EndFrame(PerfStats& perf_stats);
+
+private:
+    /// Maximum number of system frames for each rendered one
+    static constexpr u32 MAX_FRAMES_PER_RENDER = 4;
+    /// Number of presented color buffers remembered, enough for double buffering on both screens
+    static constexpr size_t MAX_PRESENTED_COLOR_BUFFERS = 4;
+
+    bool skipping_frame = false;
+    /// Number of frames skipped since the last rendered one
+    u32 frames_skipped_in_row = 0;
+    /// Average walltime of the rendered frames and of the skipped frames, in seconds
+    double rendered_frametime = 0.0;
+    double skipped_frametime = 0.0;
+
+    /// Color buffers most recently copied to the screen, 0 when unused
+    std::array<PAddr, MAX_PRESENTED_COLOR_BUFFERS> presented_color_buffers{};
+    size_t next_presented_color_buffer = 0;
 };
 
 } // namespace Core
@@ -20,8 +20,10 @@ void Apply() {
     GDBStub::SetServerPort(values.gdbstub_port);
     GDBStub::ToggleServer(values.use_gdbstub);
 
-    VideoCore::g_hw_renderer_enabled = values.use_hw_renderer;
+    VideoCore::g_null_renderer_enabled = values.use_null_renderer;
+    VideoCore::g_hw_renderer_enabled = values.use_hw_renderer && !values.use_null_renderer;
     VideoCore::g_shader_jit_enabled = values.use_shader_jit;
+    VideoCore::g_compiled_tev_enabled = values.use_compiled_tev;
     VideoCore::g_toggle_framelimit_enabled = values.toggle_framelimit;
 
     if (VideoCore::g_emu_window) {
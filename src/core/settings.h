@@ -18,6 +18,12 @@ enum class LayoutOption {
     SideScreen,
 };
 
+enum class FramePacing {
+    Sleep,   ///< Sleeps for the time left, waking up when the OS schedules the thread
+    Precise, ///< Sleeps until shortly before the deadline, then spins until it
+    VSync,   ///< Like Precise, with deadlines moved to the nearest refresh when using V-Sync
+};
+
 namespace NativeButton {
 enum Values {
     A,
@@ -85,19 +91,40 @@ struct Values {
 
     // Core
     bool use_cpu_jit;
+    /// Whether to skip the emulated time spent in loops waiting for the next event
+    bool skip_idle_loops;
+    /// Emulated milliseconds between two snapshots for rewinding, 0 to disable them
+    u32 snapshot_interval;
+    /// Memory budget of the snapshots for rewinding, in MiB
+    u32 snapshot_budget;
 
     // Data Storage
     bool use_virtual_sd;
+    /// Maximum size of the cache of decompressed .code sections, in MiB, 0 to disable it
+    u32 code_cache_size;
+    /// Size of the block cache of each save data and SD card file, in MiB, 0 to disable it
+    u32 file_cache_size;
+    /// Number of 16 KiB blocks read ahead of sequential reads from cached files
+    u32 file_cache_read_ahead;
+    /// Whether data written to cached files stays in the cache until flushed
+    bool file_cache_write_back;
 
     // System Region
     int region_value;
 
     // Renderer
+    bool use_null_renderer;
     bool use_hw_renderer;
     bool use_shader_jit;
+    bool use_compiled_tev;
     float resolution_factor;
     bool use_vsync;
     bool toggle_framelimit;
+    FramePacing frame_pacing;
+    /// Whether to skip the rasterization of frames when emulation runs below full speed
+    bool use_frame_skip;
+    /// Emulation speed, in percent, that skipping frames aims to reach
+    u32 frame_skip_threshold;
 
     LayoutOption layout_option;
     bool swap_screen;
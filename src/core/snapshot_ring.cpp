@@ -0,0 +1,256 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include "common/assert.h"
+#include "common/chunk_file.h"
+#include "common/logging/log.h"
+#include "core/arm/arm_interface.h"
+#include "core/core.h"
+#include "core/core_timing.h"
+#include "core/memory.h"
+#include "core/snapshot_ring.h"
+
+namespace Core {
+
+/// Serializes the state of everything but the emulated memory into a buffer
+static std::vector<u8> SaveComponents() {
+    u8* ptr = nullptr;
+    PointerWrap measure(&ptr, PointerWrap::MODE_MEASURE);
+    Checkpoint::DoComponentState(measure);
+    std::vector<u8> buffer(reinterpret_cast<size_t>(ptr));
+
+    ptr = buffer.data();
+    PointerWrap p(&ptr, PointerWrap::MODE_WRITE);
+    Checkpoint::DoComponentState(p);
+    return buffer;
+}
+
+void SnapshotRing::SetBudget(size_t bytes) {
+    budget = bytes;
+    Evict();
+}
+
+void SnapshotRing::Take() {
+    const auto start = std::chrono::steady_clock::now();
+
+    // Surfaces cached by the rasterizer are written back, so that the memory is up to date
+    Memory::RasterizerFlushRegion(Memory::VRAM_PADDR, Memory::VRAM_SIZE);
+    Memory::RasterizerFlushRegion(Memory::FCRAM_PADDR, Memory::FCRAM_N3DS_SIZE);
+
+    Snapshot snapshot;
+    snapshot.ticks = CoreTiming::GetTicks();
+    const std::vector<u8> components = SaveComponents();
+    snapshot.components = Checkpoint::Compress(components.data(), components.size());
+
+    const std::vector<Checkpoint::MemoryBlock> blocks = Checkpoint::GetMemoryBlocks();
+    if (!HasSameLayout(blocks)) {
+        // The first snapshot, or one after a change of layout, only starts tracking the writes
+        if (!snapshots.empty()) {
+            LOG_INFO(Core, "The memory layout changed, dropping %zu snapshots", snapshots.size());
+        }
+        StartTracking(blocks);
+    } else {
+        CompareDspMemory();
+        snapshot.pages = pending_pages;
+        snapshot.previous_contents =
+            Checkpoint::Compress(pending_contents.data(), pending_contents.size());
+        ResetPendingPages();
+    }
+
+    last_stats.dirty_pages = snapshot.pages.size();
+    last_stats.size = snapshot.GetSize();
+    total_size += last_stats.size;
+    snapshots.push_back(std::move(snapshot));
+    Evict();
+
+    last_stats.duration_ms = std::chrono::duration<double, std::milli>(
+                                 std::chrono::steady_clock::now() - start)
+                                 .count();
+    LOG_DEBUG(Core, "Snapshot took %.2f ms, %zu dirty pages, %zu bytes (%zu snapshots, %zu bytes)",
+              last_stats.duration_ms, last_stats.dirty_pages, last_stats.size, snapshots.size(),
+              GetTotalSize());
+}
+
+bool SnapshotRing::Restore(size_t index) {
+    if (index >= snapshots.size()) {
+        return false;
+    }
+    if (!HasSameLayout(Checkpoint::GetMemoryBlocks())) {
+        LOG_ERROR(Core, "The memory layout changed since the snapshot was taken");
+        return false;
+    }
+
+    std::vector<u8> components;
+    if (!Checkpoint::Decompress(snapshots[index].components, components)) {
+        return false;
+    }
+    if (!Checkpoint::IsComponentStateRestorable(components)) {
+        LOG_ERROR(Core, "The threads of the application changed since the snapshot was taken");
+        return false;
+    }
+
+    // Everything is decompressed first, so that a failure leaves the running application alone
+    std::vector<std::vector<u8>> previous_contents(snapshots.size() - index - 1);
+    for (size_t i = 0; i < previous_contents.size(); ++i) {
+        if (!Checkpoint::Decompress(snapshots[index + 1 + i].previous_contents,
+                                   previous_contents[i])) {
+            return false;
+        }
+    }
+
+    // The surfaces cached by the rasterizer are dropped, as they would be out of date. They are
+    // written back first, which saves the pages they cover.
+    Memory::RasterizerFlushAndInvalidateRegion(Memory::VRAM_PADDR, Memory::VRAM_SIZE);
+    Memory::RasterizerFlushAndInvalidateRegion(Memory::FCRAM_PADDR, Memory::FCRAM_N3DS_SIZE);
+
+    // The memory is brought back to the newest snapshot, then the newer snapshots are undone
+    WritePages(pending_pages, pending_contents.data());
+    const Checkpoint::MemoryBlock& dsp = layout[dsp_block];
+    std::memcpy(dsp.data, dsp_copy.data(), dsp.size);
+    while (snapshots.size() > index + 1) {
+        WritePages(snapshots.back().pages, previous_contents.back().data());
+        previous_contents.pop_back();
+        total_size -= snapshots.back().GetSize();
+        snapshots.pop_back();
+    }
+    std::memcpy(dsp_copy.data(), dsp.data, dsp.size);
+    ResetPendingPages();
+
+    u8* ptr = components.data();
+    PointerWrap p(&ptr, PointerWrap::MODE_READ);
+    Checkpoint::DoComponentState(p);
+    ASSERT_MSG(p.error != PointerWrap::ERROR_FAILURE, "Could not restore a snapshot");
+    CPU().ClearInstructionCache();
+    return true;
+}
+
+void SnapshotRing::Clear() {
+    Memory::StopWriteTracking();
+    snapshots.clear();
+    total_size = 0;
+    layout.clear();
+    blocks_by_pointer.clear();
+    saved_pages.clear();
+    pending_pages.clear();
+    pending_pages.shrink_to_fit();
+    pending_contents.clear();
+    pending_contents.shrink_to_fit();
+    dsp_copy.clear();
+    dsp_copy.shrink_to_fit();
+}
+
+size_t SnapshotRing::GetTotalSize() const {
+    return total_size + pending_pages.capacity() * sizeof(PageRef) + pending_contents.capacity() +
+           dsp_copy.size();
+}
+
+void SnapshotRing::Evict() {
+    while (snapshots.size() > 1 && GetTotalSize() > budget) {
+        total_size -= snapshots.front().GetSize();
+        snapshots.pop_front();
+
+        // The oldest snapshot is never undone, so its previous contents aren't needed anymore
+        Snapshot& oldest = snapshots.front();
+        total_size -= oldest.GetSize();
+        oldest.pages.clear();
+        oldest.pages.shrink_to_fit();
+        oldest.previous_contents.clear();
+        oldest.previous_contents.shrink_to_fit();
+        total_size += oldest.GetSize();
+    }
+}
+
+bool SnapshotRing::HasSameLayout(const std::vector<Checkpoint::MemoryBlock>& blocks) const {
+    return std::equal(blocks.begin(), blocks.end(), layout.begin(), layout.end(),
+                      [](const Checkpoint::MemoryBlock& a, const Checkpoint::MemoryBlock& b) {
+                          return a.address == b.address && a.size == b.size && a.data == b.data;
+                      });
+}
+
+void SnapshotRing::StartTracking(const std::vector<Checkpoint::MemoryBlock>& blocks) {
+    Clear();
+    layout = blocks;
+
+    blocks_by_pointer.resize(blocks.size());
+    saved_pages.resize(blocks.size());
+    for (u32 i = 0; i < blocks.size(); ++i) {
+        blocks_by_pointer[i] = i;
+        saved_pages[i].assign((blocks[i].size + Memory::PAGE_MASK) / Memory::PAGE_SIZE, false);
+        if (blocks[i].address == Memory::DSP_RAM_PADDR) {
+            dsp_block = i;
+        }
+    }
+    std::sort(blocks_by_pointer.begin(), blocks_by_pointer.end(),
+              [&blocks](u32 a, u32 b) { return blocks[a].data < blocks[b].data; });
+
+    const Checkpoint::MemoryBlock& dsp = layout[dsp_block];
+    dsp_copy.assign(dsp.data, dsp.data + dsp.size);
+    Memory::StartWriteTracking([this](u8* pointer, size_t size) { OnWrite(pointer, size); });
+}
+
+void SnapshotRing::OnWrite(const u8* pointer, size_t size) {
+    // Finds the last block starting at or before the pointer
+    auto it = std::upper_bound(blocks_by_pointer.begin(), blocks_by_pointer.end(), pointer,
+                               [this](const u8* p, u32 block) { return p < layout[block].data; });
+    if (it == blocks_by_pointer.begin()) {
+        return;
+    }
+    const u32 block = *(it - 1);
+    const Checkpoint::MemoryBlock& memory = layout[block];
+    // The DSP memory is compared with its copy instead, as the HLE DSP bypasses the tracking
+    if (block == dsp_block || pointer >= memory.data + memory.size) {
+        return;
+    }
+
+    const size_t begin = static_cast<size_t>(pointer - memory.data) / Memory::PAGE_SIZE;
+    const size_t end = std::min<size_t>(pointer - memory.data + size, memory.size);
+    for (size_t offset = begin * Memory::PAGE_SIZE; offset < end; offset += Memory::PAGE_SIZE) {
+        SavePage(block, static_cast<u32>(offset), memory.data + offset);
+    }
+}
+
+void SnapshotRing::SavePage(u32 block, u32 offset, const u8* contents) {
+    std::vector<bool>::reference saved = saved_pages[block][offset / Memory::PAGE_SIZE];
+    if (saved) {
+        return;
+    }
+    saved = true;
+    const u32 size = std::min<u32>(Memory::PAGE_SIZE, layout[block].size - offset);
+    pending_pages.push_back({block, offset});
+    pending_contents.insert(pending_contents.end(), contents, contents + size);
+}
+
+void SnapshotRing::CompareDspMemory() {
+    const Checkpoint::MemoryBlock& dsp = layout[dsp_block];
+    u8* copy = dsp_copy.data();
+    for (u32 offset = 0; offset < dsp.size; offset += Memory::PAGE_SIZE) {
+        const u32 size = std::min<u32>(Memory::PAGE_SIZE, dsp.size - offset);
+        if (std::memcmp(dsp.data + offset, copy + offset, size) != 0) {
+            SavePage(dsp_block, offset, copy + offset);
+            std::memcpy(copy + offset, dsp.data + offset, size);
+        }
+    }
+}
+
+void SnapshotRing::ResetPendingPages() {
+    for (const PageRef& page : pending_pages) {
+        saved_pages[page.block][page.offset / Memory::PAGE_SIZE] = false;
+    }
+    pending_pages.clear();
+    pending_contents.clear();
+    Memory::RearmWriteTracking();
+}
+
+void SnapshotRing::WritePages(const std::vector<PageRef>& pages, const u8* contents) {
+    for (const PageRef& page : pages) {
+        const u32 size = std::min<u32>(Memory::PAGE_SIZE, layout[page.block].size - page.offset);
+        std::memcpy(layout[page.block].data + page.offset, contents, size);
+        contents += size;
+    }
+}
+
+} // namespace Core
@@ -0,0 +1,148 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <deque>
+#include <vector>
+#include "common/common_types.h"
+#include "core/checkpoint.h"
+
+namespace Core {
+
+/**
+ * Frequent in-memory snapshots of the emulated state, for rewinding, kept in a ring bounded by a
+ * budget of bytes: the oldest snapshots are dropped to make room for new ones.
+ *
+ * Each snapshot only stores the memory pages modified since the previous snapshot, along with their
+ * previous contents, compressed. The writes to memory are tracked through the page table (see
+ * Memory::StartWriteTracking), and the contents of a page are saved just before its first write
+ * since the previous snapshot. Restoring a snapshot undoes the newer snapshots one by one, starting
+ * from the live memory. The HLE DSP writes to its memory without going through the page table, so
+ * the DSP memory is instead compared with a copy of it, which is small.
+ *
+ * Like checkpoints, snapshots don't include kernel objects and HLE services yet (see checkpoint.h),
+ * so they can only be restored while the threads of the application are the same. When the memory
+ * layout of the application changes, the snapshots taken before are dropped.
+ */
+class SnapshotRing {
+public:
+    /// Cost of taking a snapshot
+    struct Stats {
+        /// Walltime taken, in milliseconds
+        double duration_ms = 0;
+        /// Number of pages modified since the previous snapshot
+        size_t dirty_pages = 0;
+        /// Size of the snapshot once compressed, in bytes
+        size_t size = 0;
+    };
+
+    /// Sets the budget of bytes for the snapshots, dropping the oldest ones if needed
+    void SetBudget(size_t bytes);
+
+    /**
+     * Takes a snapshot of the running application.
+     * @note This must only be called from the emulation thread, while the emulation is paused.
+     */
+    void Take();
+
+    /**
+     * Restores a snapshot, dropping the newer ones.
+     * @param index Index of the snapshot, the oldest being 0
+     * @returns whether the snapshot was restored
+     * @note This must only be called from the emulation thread, while the emulation is paused.
+     */
+    bool Restore(size_t index);
+
+    /// Drops all the snapshots
+    void Clear();
+
+    /// Returns the number of snapshots held
+    size_t GetCount() const {
+        return snapshots.size();
+    }
+
+    /// Returns the emulated time of a snapshot, in CPU ticks
+    u64 GetTicks(size_t index) const {
+        return snapshots[index].ticks;
+    }
+
+    /**
+     * Returns the size of all the snapshots held, in bytes, along with the buffers used to find the
+     * modified pages: the previous contents of the pages modified since the newest snapshot, and
+     * the copy of the DSP memory.
+     */
+    size_t GetTotalSize() const;
+
+    /// Returns the cost of the last snapshot taken
+    const Stats& GetLastStats() const {
+        return last_stats;
+    }
+
+private:
+    /// Memory page modified since the previous snapshot
+    struct PageRef {
+        u32 block;
+        u32 offset;
+    };
+
+    struct Snapshot {
+        u64 ticks;
+        /// Compressed state of everything but memory
+        std::vector<u8> components;
+        /// Pages modified since the previous snapshot
+        std::vector<PageRef> pages;
+        /// Compressed contents of these pages as of the previous snapshot
+        std::vector<u8> previous_contents;
+
+        size_t GetSize() const {
+            return components.size() + pages.size() * sizeof(PageRef) + previous_contents.size();
+        }
+    };
+
+    /// Drops the oldest snapshots until the snapshots fit in the budget. The newest one is kept.
+    void Evict();
+
+    /// Returns whether the memory is laid out the same as when the snapshots were taken
+    bool HasSameLayout(const std::vector<Checkpoint::MemoryBlock>& blocks) const;
+
+    /// Starts tracking the writes to a new memory layout, dropping the snapshots
+    void StartTracking(const std::vector<Checkpoint::MemoryBlock>& blocks);
+
+    /// Saves the contents of the pages about to be written to, unless saved since the last snapshot
+    void OnWrite(const u8* pointer, size_t size);
+
+    /// Saves the previous contents of a page, unless saved since the last snapshot
+    void SavePage(u32 block, u32 offset, const u8* contents);
+
+    /// Saves the pages of the DSP memory modified since the last snapshot, and updates its copy
+    void CompareDspMemory();
+
+    /// Forgets the pages saved since the last snapshot, and tracks their writes again
+    void ResetPendingPages();
+
+    /// Writes back the previous contents of pages
+    void WritePages(const std::vector<PageRef>& pages, const u8* contents);
+
+    std::deque<Snapshot> snapshots;
+    size_t budget = 64 * 1024 * 1024;
+    /// Size of the snapshots held, in bytes
+    size_t total_size = 0;
+    Stats last_stats;
+
+    /// Memory blocks as laid out when the snapshots were taken
+    std::vector<Checkpoint::MemoryBlock> layout;
+    /// Indices of the memory blocks, sorted by the address of their host memory
+    std::vector<u32> blocks_by_pointer;
+    /// For each memory block, whether each of its pages was saved since the newest snapshot
+    std::vector<std::vector<bool>> saved_pages;
+    /// Pages saved since the newest snapshot, and their contents as of that snapshot
+    std::vector<PageRef> pending_pages;
+    std::vector<u8> pending_contents;
+    /// Index of the DSP memory block, and a copy of it as of the newest snapshot
+    u32 dsp_block = 0;
+    std::vector<u8> dsp_copy;
+};
+
+} // namespace Core
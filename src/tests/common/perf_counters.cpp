@@ -0,0 +1,62 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <catch.hpp>
+#include "common/perf_counters.h"
+
+namespace Common {
+namespace PerfCounters {
+
+/// Runs some instructions that the compiler can't remove
+static u64 Work(u64 iterations) {
+    volatile u64 sum = 0;
+    for (u64 i = 0; i < iterations; ++i) {
+        sum = sum + i;
+    }
+    return sum;
+}
+
+TEST_CASE("PerfCounters count events in scopes", "[common]") {
+    {
+        // Nothing is counted before starting
+        PERF_COUNTERS_SCOPE(GPU_Shader);
+        Work(1000);
+    }
+    REQUIRE(TakeCounts()[static_cast<size_t>(Scope::GPU_Shader)].calls == 0);
+
+    if (!Start()) {
+        // Counters may be unavailable on this host or to this user
+        WARN("Hardware performance counters are unavailable, skipping");
+        return;
+    }
+
+    {
+        PERF_COUNTERS_SCOPE(GPU_Drawing);
+        for (int i = 0; i < 2; ++i) {
+            PERF_COUNTERS_SCOPE(GPU_Shader);
+            // Recursive entries count once
+            ScopeGuard nested_scope(Scope::GPU_Shader);
+            Work(100000);
+        }
+    }
+    const Counts counts = TakeCounts();
+    const ScopeCounts& drawing = counts[static_cast<size_t>(Scope::GPU_Drawing)];
+    const ScopeCounts& shader = counts[static_cast<size_t>(Scope::GPU_Shader)];
+    REQUIRE(drawing.calls == 1);
+    REQUIRE(shader.calls == 2);
+    REQUIRE(counts[static_cast<size_t>(Scope::DSP)].calls == 0);
+    if (IsEventCounted(Event::Instructions)) {
+        const size_t instructions = static_cast<size_t>(Event::Instructions);
+        REQUIRE(shader.events[instructions] >= 200000);
+        // Scopes are inclusive
+        REQUIRE(drawing.events[instructions] >= shader.events[instructions]);
+    }
+
+    // The counts are reset once taken
+    REQUIRE(TakeCounts()[static_cast<size_t>(Scope::GPU_Drawing)].calls == 0);
+    Stop();
+}
+
+} // namespace PerfCounters
+} // namespace Common
@@ -0,0 +1,86 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <catch.hpp>
+#include "common/common_types.h"
+#include "common/ring_buffer.h"
+
+namespace Common {
+
+TEST_CASE("RingBuffer: Elements are read in order and pushing fails when full", "[common]") {
+    RingBuffer<u32, 4> queue;
+    REQUIRE(queue.IsEmpty());
+
+    for (u32 i = 0; i < 4; ++i) {
+        REQUIRE(queue.TryPush([i](u32& value) { value = i; }));
+    }
+    REQUIRE_FALSE(queue.TryPush([](u32& value) { value = 4; }));
+
+    // Free slots can be reused once an element is read
+    for (u32 lap = 0; lap < 3; ++lap) {
+        u32 result = 0;
+        REQUIRE(queue.TryPop([&](u32 value) { result = value; }));
+        REQUIRE(result == lap);
+        REQUIRE(queue.TryPush([lap](u32& value) { value = lap + 4; }));
+    }
+
+    for (u32 i = 3; i < 7; ++i) {
+        u32 result = 0;
+        REQUIRE(queue.TryPop([&](u32 value) { result = value; }));
+        REQUIRE(result == i);
+    }
+    REQUIRE(queue.IsEmpty());
+    REQUIRE_FALSE(queue.TryPop([](u32) {}));
+}
+
+TEST_CASE("RingBuffer: Concurrent producers neither lose nor duplicate elements", "[common]") {
+    constexpr u32 num_producers = 4;
+    constexpr u32 elements_per_producer = 100000;
+
+    auto queue = std::make_unique<RingBuffer<u32, 256>>();
+    std::vector<std::thread> producers;
+    for (u32 producer = 0; producer < num_producers; ++producer) {
+        producers.emplace_back([&queue, producer] {
+            for (u32 i = 0; i < elements_per_producer; ++i) {
+                const u32 element = producer * elements_per_producer + i;
+                while (!queue->TryPush([element](u32& value) { value = element; })) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    // Elements of each producer must arrive in the order they were pushed
+    std::array<u32, num_producers> next_expected{};
+    u32 received = 0;
+    bool in_order = true;
+    while (received < num_producers * elements_per_producer) {
+        const bool popped = queue->TryPop([&](u32 value) {
+            const u32 producer = value / elements_per_producer;
+            in_order &= value % elements_per_producer == next_expected[producer];
+            ++next_expected[producer];
+        });
+        if (popped) {
+            ++received;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+    for (auto& producer : producers) {
+        producer.join();
+    }
+
+    REQUIRE(in_order);
+    REQUIRE(queue->IsEmpty());
+    for (u32 count : next_expected) {
+        REQUIRE(count == elements_per_producer);
+    }
+}
+
+} // namespace Common
@@ -0,0 +1,54 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <catch.hpp>
+#include "common/thread_queue_list.h"
+
+namespace Common {
+
+TEST_CASE("ThreadQueueList: Threads are popped by priority, then in order", "[common]") {
+    ThreadQueueList<int, 128> queue;
+    REQUIRE(queue.pop_first() == 0);
+
+    queue.push_back(100, 1);
+    queue.push_back(70, 2);
+    queue.push_back(100, 3);
+    queue.push_front(70, 4);
+    queue.push_back(5, 5);
+
+    REQUIRE(queue.get_first() == 5);
+    REQUIRE(queue.pop_first_better(5) == 0);
+    REQUIRE(queue.pop_first_better(6) == 5);
+    REQUIRE(queue.empty(5));
+
+    REQUIRE(queue.pop_first() == 4);
+    REQUIRE(queue.pop_first() == 2);
+    REQUIRE(queue.pop_first_better(100) == 0);
+    REQUIRE(queue.pop_first() == 1);
+    REQUIRE(queue.pop_first() == 3);
+    REQUIRE(queue.pop_first() == 0);
+}
+
+TEST_CASE("ThreadQueueList: Removing and moving threads updates the levels", "[common]") {
+    ThreadQueueList<int, 64> queue;
+    queue.push_back(63, 1);
+    queue.push_back(20, 2);
+    queue.push_back(20, 3);
+
+    queue.remove(20, 2);
+    REQUIRE(queue.get_first() == 3);
+    queue.move(3, 20, 63);
+    REQUIRE(queue.empty(20));
+    REQUIRE(queue.contains(3) == 63);
+
+    queue.rotate(63);
+    REQUIRE(queue.pop_first() == 3);
+    REQUIRE(queue.pop_first() == 1);
+
+    queue.push_back(0, 4);
+    queue.clear();
+    REQUIRE(queue.get_first() == 0);
+}
+
+} // namespace Common
@@ -0,0 +1,156 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <unordered_map>
+#include <vector>
+#include <catch.hpp>
+#include "core/arm/dyncom/arm_dyncom.h"
+#include "core/arm/idle_loop.h"
+#include "core/core_timing.h"
+#include "core/settings.h"
+#include "tests/core/arm/arm_test_common.h"
+
+namespace IdleLoop {
+
+/// Returns a function reading the given instructions, placed one after the other from an address
+static std::function<u32(u32)> MakeReader(u32 address, const std::vector<u32>& instructions,
+                                          u32 size) {
+    std::unordered_map<u32, u32> code;
+    for (u32 instruction : instructions) {
+        code[address] = instruction;
+        address += size;
+    }
+    return [code](u32 address) {
+        auto it = code.find(address);
+        return it != code.end() ? it->second : 0xFFFFFFFF;
+    };
+}
+
+TEST_CASE("IdleLoop::FindReadOnlyLoop detects ARM loops", "[core][arm]") {
+    SECTION("polling loop") {
+        // ldr r0, [r1]; cmp r0, #0; beq 0x100
+        const auto read = MakeReader(0x100, {0xE5910000, 0xE3500000, 0x0AFFFFFC}, 4);
+        REQUIRE(FindReadOnlyLoop(0x100, false, read));
+        REQUIRE(FindReadOnlyLoop(0x108, false, read));
+        const auto loop = FindReadOnlyLoop(0x104, false, read);
+        REQUIRE(loop);
+        REQUIRE(loop->start == 0x100);
+        REQUIRE(loop->end == 0x108);
+    }
+
+    SECTION("branch to itself") {
+        // b 0x400
+        REQUIRE(FindReadOnlyLoop(0x400, false, MakeReader(0x400, {0xEAFFFFFE}, 4)));
+    }
+
+    SECTION("loop writing memory") {
+        // str r0, [r1]; cmp r0, #0; beq 0x100
+        const auto read = MakeReader(0x100, {0xE5810000, 0xE3500000, 0x0AFFFFFC}, 4);
+        REQUIRE(!FindReadOnlyLoop(0x104, false, read));
+    }
+
+    SECTION("loop with writeback") {
+        // ldr r0, [r1, #4]!; cmp r0, #0; beq 0x100
+        const auto read = MakeReader(0x100, {0xE5B10004, 0xE3500000, 0x0AFFFFFC}, 4);
+        REQUIRE(!FindReadOnlyLoop(0x100, false, read));
+    }
+
+    SECTION("supervisor call") {
+        // svc #0; b 0x100
+        REQUIRE(!FindReadOnlyLoop(0x100, false, MakeReader(0x100, {0xEF000000, 0xEAFFFFFD}, 4)));
+    }
+
+    SECTION("loop too long") {
+        // Nine times mov r0, r0; b 0x300
+        std::vector<u32> code(9, 0xE1A00000);
+        code.push_back(0xEAFFFFF5);
+        const auto read = MakeReader(0x300, code, 4);
+        REQUIRE(!FindReadOnlyLoop(0x300, false, read));
+        REQUIRE(!FindReadOnlyLoop(0x320, false, read));
+    }
+}
+
+TEST_CASE("IdleLoop::FindReadOnlyLoop detects Thumb loops", "[core][arm]") {
+    SECTION("polling loop") {
+        // ldr r0, [r1]; cmp r0, #0; beq 0x200
+        const auto read = MakeReader(0x200, {0x6808, 0x2800, 0xD0FC}, 2);
+        REQUIRE(FindReadOnlyLoop(0x200, true, read));
+        REQUIRE(FindReadOnlyLoop(0x202, true, read));
+    }
+
+    SECTION("loop writing memory") {
+        // str r0, [r1]; cmp r0, #0; beq 0x200
+        const auto read = MakeReader(0x200, {0x6008, 0x2800, 0xD0FC}, 2);
+        REQUIRE(!FindReadOnlyLoop(0x202, true, read));
+    }
+
+    SECTION("branch forward") {
+        // ldr r0, [r1]; cmp r0, #0; beq 0x20A
+        REQUIRE(!FindReadOnlyLoop(0x200, true, MakeReader(0x200, {0x6808, 0x2800, 0xD001}, 2)));
+    }
+}
+
+/// Runs a loop on dyncom until an event scheduled far in the future runs, or a few slices passed
+static bool RunUntilEvent(ARM_Interface& cpu, bool& event_ran) {
+    // Slices whose number of instructions isn't a multiple of the loop length, so that they don't
+    // all end at the same PC
+    for (int slice = 0; slice < 20 && !event_ran; ++slice) {
+        cpu.Run(100);
+    }
+    return event_ran;
+}
+
+TEST_CASE("IdleLoop::Detector skips a polling loop on dyncom", "[core][arm]") {
+    ArmTests::TestEnvironment test_env(true);
+    // ldr r0, [r1]; cmp r0, #0; beq 0x100
+    test_env.SetMemory32(0x100, 0xE5910000);
+    test_env.SetMemory32(0x104, 0xE3500000);
+    test_env.SetMemory32(0x108, 0x0AFFFFFC);
+    test_env.SetMemory32(0x2000, 0);
+
+    CoreTiming::Init();
+    Settings::values.skip_idle_loops = true;
+    bool event_ran = false;
+    const int event =
+        CoreTiming::RegisterEvent("IdleLoopTest", [&](u64, int) { event_ran = true; });
+    CoreTiming::ScheduleEvent(10'000'000, event);
+
+    ARM_DynCom dyncom(USER32MODE);
+    dyncom.SetPC(0x100);
+    dyncom.SetReg(1, 0x2000);
+    REQUIRE(RunUntilEvent(dyncom, event_ran));
+    REQUIRE(dyncom.GetIdleLoopSkippedCycles() > 0);
+    REQUIRE(dyncom.GetPC() >= 0x100);
+    REQUIRE(dyncom.GetPC() <= 0x108);
+
+    Settings::values.skip_idle_loops = false;
+    CoreTiming::Shutdown();
+}
+
+TEST_CASE("IdleLoop::Detector runs loops writing memory on dyncom", "[core][arm]") {
+    ArmTests::TestEnvironment test_env(true);
+    // str r0, [r1]; cmp r0, #0; beq 0x100
+    test_env.SetMemory32(0x100, 0xE5810000);
+    test_env.SetMemory32(0x104, 0xE3500000);
+    test_env.SetMemory32(0x108, 0x0AFFFFFC);
+
+    CoreTiming::Init();
+    Settings::values.skip_idle_loops = true;
+    bool event_ran = false;
+    const int event =
+        CoreTiming::RegisterEvent("IdleLoopTest", [&](u64, int) { event_ran = true; });
+    CoreTiming::ScheduleEvent(10'000'000, event);
+
+    ARM_DynCom dyncom(USER32MODE);
+    dyncom.SetPC(0x100);
+    dyncom.SetReg(0, 0);
+    dyncom.SetReg(1, 0x2000);
+    REQUIRE(!RunUntilEvent(dyncom, event_ran));
+    REQUIRE(dyncom.GetIdleLoopSkippedCycles() == 0);
+
+    Settings::values.skip_idle_loops = false;
+    CoreTiming::Shutdown();
+}
+
+} // namespace IdleLoop
@@ -0,0 +1,48 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <string>
+#include <catch.hpp>
+#include "core/boot_profiler.h"
+
+namespace Core {
+
+TEST_CASE("BootProfiler records nested phases until the first frame", "[core]") {
+    BootProfiler profiler;
+    profiler.Begin();
+    {
+        BootProfiler::Scope outer(profiler, "System::Load");
+        BootProfiler::Scope inner(profiler, "System::Init");
+    }
+    {
+        BootProfiler::Scope scope(profiler, "APT::LoadSharedFont");
+        profiler.MarkFirstFrame();
+    }
+    BootProfiler::Scope after_first_frame(profiler, "GSP::SetBufferSwap");
+
+    const auto phases = profiler.GetPhases();
+    REQUIRE(phases.size() == 3);
+    REQUIRE(std::string(phases[0].name) == "System::Load");
+    REQUIRE(phases[0].depth == 0);
+    REQUIRE(std::string(phases[1].name) == "System::Init");
+    REQUIRE(phases[1].depth == 1);
+    REQUIRE(phases[1].start >= phases[0].start);
+    REQUIRE(phases[1].start + phases[1].duration <= phases[0].start + phases[0].duration);
+    REQUIRE(std::string(phases[2].name) == "APT::LoadSharedFont");
+    REQUIRE(phases[2].depth == 0);
+    REQUIRE(profiler.IsFirstFrameReached());
+
+    const std::string json = profiler.ToJSON();
+    REQUIRE(json.find("\"time_to_first_frame_ms\": null") == std::string::npos);
+    REQUIRE(json.find("\"name\": \"System::Init\", \"depth\": 1") != std::string::npos);
+
+    // A new boot drops the phases of the previous one
+    profiler.Begin();
+    REQUIRE(profiler.GetPhases().empty());
+    REQUIRE_FALSE(profiler.IsFirstFrameReached());
+    REQUIRE(profiler.ToJSON() ==
+            "{\n  \"time_to_first_frame_ms\": null,\n  \"phases\": []\n}\n");
+}
+
+} // namespace Core
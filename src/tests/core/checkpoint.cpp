@@ -0,0 +1,194 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <catch.hpp>
+#include "common/chunk_file.h"
+#include "common/file_util.h"
+#include "core/core_timing.h"
+#include "core/checkpoint.h"
+
+namespace Core {
+namespace Checkpoint {
+
+/// Memory contents resembling an application's: mostly zeroes, with some varied data
+static std::vector<u8> MakeMemory(size_t size) {
+    std::vector<u8> memory(size);
+    u32 seed = 1;
+    for (size_t i = 0; i < size / 4; i += 0x1000) {
+        for (size_t j = i; j < i + 0x400; ++j) {
+            seed = seed * 1103515245 + 12345;
+            memory[j] = static_cast<u8>(seed >> 24);
+        }
+    }
+    return memory;
+}
+
+static void DoTestState(PointerWrap& p, std::vector<u32>& values, std::string& name) {
+    auto s = p.Section("Test", 1);
+    if (!s)
+        return;
+
+    p.Do(values);
+    p.Do(name);
+}
+
+TEST_CASE("StateWriter and StateReader round-trip sections", "[core]") {
+    const std::string path = FileUtil::GetTempDir() + "/checkpoint_test.bin";
+    const std::vector<u8> memory = MakeMemory(3 * 1024 * 1024 + 123);
+    std::vector<u32> values{1, 2, 3, 0xDEADBEEF};
+    std::string name = "citra";
+
+    Header header{};
+    header.version = VERSION;
+    header.program_id = 0x0004000000123400;
+    {
+        StateWriter writer(path, header);
+        REQUIRE(writer.IsOpen());
+        writer.WriteSection("Test", 1, [&](PointerWrap& p) { DoTestState(p, values, name); });
+        writer.BeginSection("Memory", 2, memory.size());
+        writer.Write(memory.data(), memory.size());
+        REQUIRE(writer.Finish());
+    }
+    REQUIRE(FileUtil::GetSize(path) < memory.size() / 2);
+
+    {
+        StateReader reader(path);
+        REQUIRE(reader.IsOpen());
+        REQUIRE(reader.GetHeader().program_id == header.program_id);
+
+        std::vector<u8> buffer;
+        REQUIRE(reader.ReadSection("Test", 1, buffer));
+        std::vector<u32> read_values;
+        std::string read_name;
+        u8* ptr = buffer.data();
+        PointerWrap p(&ptr, PointerWrap::MODE_READ);
+        DoTestState(p, read_values, read_name);
+        REQUIRE(p.error == PointerWrap::ERROR_NONE);
+        REQUIRE(read_values == values);
+        REQUIRE(read_name == name);
+
+        REQUIRE(reader.BeginSection("Memory", 2) == static_cast<s64>(memory.size()));
+        std::vector<u8> read_memory(memory.size());
+        REQUIRE(reader.Read(read_memory.data(), read_memory.size()));
+        REQUIRE(read_memory == memory);
+        REQUIRE(reader.Finish());
+    }
+
+    {
+        // Sections must be read in the order, and with the version, they were written in
+        StateReader reader(path);
+        REQUIRE(reader.BeginSection("Memory", 2) == -1);
+    }
+
+    {
+        // A damaged stream is detected, at the latest by the checksum at its end
+        std::vector<u8> contents(FileUtil::GetSize(path));
+        FileUtil::IOFile(path, "rb").ReadBytes(contents.data(), contents.size());
+        contents[contents.size() / 2] ^= 0x10;
+        FileUtil::IOFile(path, "wb").WriteBytes(contents.data(), contents.size());
+
+        StateReader reader(path);
+        std::vector<u8> buffer;
+        bool intact = reader.ReadSection("Test", 1, buffer);
+        std::vector<u8> read_memory(memory.size());
+        intact = intact && reader.BeginSection("Memory", 2) == static_cast<s64>(memory.size());
+        intact = intact && reader.Read(read_memory.data(), read_memory.size());
+        intact = intact && reader.Finish();
+        REQUIRE(!intact);
+    }
+
+    FileUtil::Delete(path);
+}
+
+TEST_CASE("Compress and Decompress round-trip buffers", "[core]") {
+    const std::vector<u8> data = MakeMemory(256 * 1024);
+    std::vector<u8> compressed = Compress(data.data(), data.size());
+    REQUIRE(compressed.size() < data.size() / 2);
+
+    std::vector<u8> decompressed;
+    REQUIRE(Decompress(compressed, decompressed));
+    REQUIRE(decompressed == data);
+
+    REQUIRE(Decompress(Compress(nullptr, 0), decompressed));
+    REQUIRE(decompressed.empty());
+
+    compressed[compressed.size() / 2] ^= 0x10;
+    REQUIRE(!Decompress(compressed, decompressed));
+}
+
+TEST_CASE("CoreTiming::DoState restores the scheduled events", "[core]") {
+    CoreTiming::Init();
+    CoreTiming::RegisterEvent("first", [](u64, int) {});
+    int second_event = CoreTiming::RegisterEvent("second", [](u64, int) {});
+    CoreTiming::ScheduleEvent(1000, second_event, 42);
+    CoreTiming::ScheduleEvent(2000, second_event, 43);
+    const std::string summary = CoreTiming::GetScheduledEventsSummary();
+
+    std::vector<u8> buffer(0x1000);
+    u8* ptr = buffer.data();
+    PointerWrap save(&ptr, PointerWrap::MODE_WRITE);
+    CoreTiming::DoState(save);
+    const size_t size = ptr - buffer.data();
+
+    // Event types registered in another order still match by name
+    CoreTiming::ClearPendingEvents();
+    CoreTiming::UnregisterAllEvents();
+    second_event = CoreTiming::RegisterEvent("second", [](u64, int) {});
+    CoreTiming::RegisterEvent("first", [](u64, int) {});
+    CoreTiming::ScheduleEvent(5000, second_event, 44);
+
+    ptr = buffer.data();
+    PointerWrap load(&ptr, PointerWrap::MODE_READ);
+    CoreTiming::DoState(load);
+    REQUIRE(load.error == PointerWrap::ERROR_NONE);
+    REQUIRE(static_cast<size_t>(ptr - buffer.data()) == size);
+    REQUIRE(CoreTiming::GetScheduledEventsSummary() == summary);
+    REQUIRE(CoreTiming::UnscheduleEvent(second_event, 43) == 2000);
+
+    CoreTiming::Shutdown();
+}
+
+// Hidden by default, run with `tests [benchmark]`
+TEST_CASE("Checkpoint throughput", "[.][benchmark]") {
+    const std::string path = FileUtil::GetTempDir() + "/checkpoint_benchmark.bin";
+    // As much memory as an application using all of the Old 3DS FCRAM and VRAM
+    const std::vector<u8> memory = MakeMemory(134 * 1024 * 1024);
+    std::vector<u8> read_memory(memory.size());
+
+    using Clock = std::chrono::steady_clock;
+    auto milliseconds = [](Clock::duration duration) {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    };
+
+    auto start = Clock::now();
+    {
+        StateWriter writer(path, Header{});
+        writer.BeginSection("Memory", 1, memory.size());
+        writer.Write(memory.data(), memory.size());
+        REQUIRE(writer.Finish());
+    }
+    const double save_ms = milliseconds(Clock::now() - start);
+
+    start = Clock::now();
+    {
+        StateReader reader(path);
+        REQUIRE(reader.BeginSection("Memory", 1) == static_cast<s64>(memory.size()));
+        REQUIRE(reader.Read(read_memory.data(), read_memory.size()));
+        REQUIRE(reader.Finish());
+    }
+    const double load_ms = milliseconds(Clock::now() - start);
+    REQUIRE(read_memory == memory);
+
+    std::printf("Saved %zu MiB in %.1f ms, loaded in %.1f ms, file of %.1f MiB\n",
+                memory.size() >> 20, save_ms, load_ms,
+                FileUtil::GetSize(path) / (1024.0 * 1024.0));
+    FileUtil::Delete(path);
+}
+
+} // namespace Checkpoint
+} // namespace Core
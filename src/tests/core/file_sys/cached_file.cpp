@@ -0,0 +1,327 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <catch.hpp>
+#include "common/file_util.h"
+#include "core/file_sys/cached_file.h"
+#include "core/file_sys/disk_archive.h"
+
+namespace FileSys {
+
+namespace {
+
+/// File held in memory, counting the accesses made to it
+class MemoryFile final : public FileBackend {
+public:
+    explicit MemoryFile(std::vector<u8>& data) : data(data) {}
+
+    ResultVal<size_t> Read(u64 offset, size_t length, u8* buffer) const override {
+        ++reads;
+        if (offset >= data.size())
+            return MakeResult<size_t>(0);
+        length = std::min<size_t>(length, data.size() - offset);
+        std::memcpy(buffer, data.data() + offset, length);
+        return MakeResult<size_t>(length);
+    }
+
+    ResultVal<size_t> Write(u64 offset, size_t length, bool flush,
+                            const u8* buffer) const override {
+        ++writes;
+        if (offset + length > data.size())
+            data.resize(offset + length);
+        std::memcpy(data.data() + offset, buffer, length);
+        return MakeResult<size_t>(length);
+    }
+
+    u64 GetSize() const override {
+        return data.size();
+    }
+
+    bool SetSize(u64 size) const override {
+        data.resize(size);
+        return true;
+    }
+
+    bool Close() const override {
+        return true;
+    }
+
+    void Flush() const override {}
+
+    std::vector<u8>& data;
+    mutable int reads = 0;
+    mutable int writes = 0;
+};
+
+std::vector<u8> MakePattern(size_t size) {
+    std::vector<u8> data(size);
+    for (size_t i = 0; i < size; ++i) {
+        data[i] = static_cast<u8>(i * 7 + (i >> 8));
+    }
+    return data;
+}
+
+/// File adding a fixed latency to each access to another file, like a slow storage device would
+class SlowFile final : public FileBackend {
+public:
+    SlowFile(std::unique_ptr<FileBackend> file, std::chrono::microseconds latency)
+        : file(std::move(file)), latency(latency) {}
+
+    ResultVal<size_t> Read(u64 offset, size_t length, u8* buffer) const override {
+        std::this_thread::sleep_for(latency);
+        return file->Read(offset, length, buffer);
+    }
+
+    ResultVal<size_t> ReadScatter(u64 offset,
+                                  const std::vector<Memory::HostSpan>& spans) const override {
+        std::this_thread::sleep_for(latency);
+        return file->ReadScatter(offset, spans);
+    }
+
+    ResultVal<size_t> Write(u64 offset, size_t length, bool flush,
+                            const u8* buffer) const override {
+        std::this_thread::sleep_for(latency);
+        return file->Write(offset, length, flush, buffer);
+    }
+
+    u64 GetSize() const override {
+        return file->GetSize();
+    }
+
+    bool SetSize(u64 size) const override {
+        return file->SetSize(size);
+    }
+
+    bool Close() const override {
+        return file->Close();
+    }
+
+    void Flush() const override {
+        file->Flush();
+    }
+
+private:
+    std::unique_ptr<FileBackend> file;
+    std::chrono::microseconds latency;
+};
+
+} // Anonymous namespace
+
+TEST_CASE("CachedFile serves repeated reads from the cache", "[core][file_sys]") {
+    std::vector<u8> data = MakePattern(0x2800);
+    auto backend = std::make_unique<MemoryFile>(data);
+    MemoryFile& memory_file = *backend;
+
+    FileCacheConfig config;
+    config.block_size = 0x1000;
+    config.read_ahead_blocks = 0;
+    auto stats = std::make_shared<FileCacheStats>();
+    CachedFile file(std::move(backend), config, stats);
+
+    std::vector<u8> result(0x1800);
+    REQUIRE(*file.Read(0x800, result.size(), result.data()) == result.size());
+    REQUIRE(std::equal(result.begin(), result.end(), data.begin() + 0x800));
+    REQUIRE(memory_file.reads == 2);
+
+    // Reads stop at the end of the file
+    REQUIRE(*file.Read(0x2000, result.size(), result.data()) == 0x800);
+    REQUIRE(std::equal(result.begin(), result.begin() + 0x800, data.begin() + 0x2000));
+    REQUIRE(*file.Read(0x1000, 0x10, result.data()) == 0x10);
+    REQUIRE(memory_file.reads == 3);
+
+    REQUIRE(stats->misses == 3);
+    REQUIRE(stats->hits == 1);
+}
+
+TEST_CASE("CachedFile writes back data when flushed or evicted", "[core][file_sys]") {
+    std::vector<u8> data = MakePattern(0x2800);
+    const std::vector<u8> original = data;
+    auto backend = std::make_unique<MemoryFile>(data);
+
+    FileCacheConfig config;
+    config.block_size = 0x1000;
+    config.capacity = 2;
+    config.read_ahead_blocks = 0;
+    config.write_back = true;
+    auto stats = std::make_shared<FileCacheStats>();
+    CachedFile file(std::move(backend), config, stats);
+
+    const std::vector<u8> written(0x100, 0xAB);
+
+    SECTION("writes are kept until flushed") {
+        REQUIRE(*file.Write(0x2780, written.size(), false, written.data()) == written.size());
+        REQUIRE(data == original);
+        REQUIRE(file.GetSize() == 0x2880);
+
+        std::vector<u8> result(written.size());
+        REQUIRE(*file.Read(0x2780, result.size(), result.data()) == result.size());
+        REQUIRE(result == written);
+
+        file.Flush();
+        REQUIRE(data.size() == 0x2880);
+        REQUIRE(std::equal(written.begin(), written.end(), data.begin() + 0x2780));
+        REQUIRE(std::equal(original.begin(), original.begin() + 0x2780, data.begin()));
+    }
+
+    SECTION("evicted blocks are written back") {
+        REQUIRE(*file.Write(0x10, written.size(), false, written.data()) == written.size());
+        REQUIRE(data == original);
+
+        std::vector<u8> result(0x10);
+        file.Read(0x1000, result.size(), result.data());
+        file.Read(0x2000, result.size(), result.data());
+        REQUIRE(stats->written_back_blocks == 1);
+        REQUIRE(std::equal(written.begin(), written.end(), data.begin() + 0x10));
+    }
+
+    SECTION("writes past the end of the file leave zeros in between") {
+        REQUIRE(*file.Write(0x3000, written.size(), true, written.data()) == written.size());
+        REQUIRE(data.size() == 0x3100);
+
+        std::vector<u8> result(0x800);
+        REQUIRE(*file.Read(0x2800, result.size(), result.data()) == result.size());
+        REQUIRE(std::all_of(result.begin(), result.end(), [](u8 value) { return value == 0; }));
+    }
+}
+
+TEST_CASE("CachedFile doesn't read blocks which are entirely overwritten", "[core][file_sys]") {
+    std::vector<u8> data = MakePattern(0x2800);
+    auto backend = std::make_unique<MemoryFile>(data);
+    MemoryFile& memory_file = *backend;
+
+    FileCacheConfig config;
+    config.block_size = 0x1000;
+    config.read_ahead_blocks = 0;
+    config.write_back = true;
+    CachedFile file(std::move(backend), config, std::make_shared<FileCacheStats>());
+
+    // The whole block, and the valid part of the last block
+    const std::vector<u8> written(0x1000, 0xCD);
+    REQUIRE(*file.Write(0x1000, written.size(), false, written.data()) == written.size());
+    REQUIRE(*file.Write(0x2000, 0x800, false, written.data()) == 0x800);
+    REQUIRE(memory_file.reads == 0);
+
+    // A partial write needs the rest of the block
+    REQUIRE(*file.Write(0x10, 0x10, false, written.data()) == 0x10);
+    REQUIRE(memory_file.reads == 1);
+
+    std::vector<u8> result(0x1800);
+    REQUIRE(*file.Read(0x1000, result.size(), result.data()) == result.size());
+    REQUIRE(std::all_of(result.begin(), result.end(), [](u8 value) { return value == 0xCD; }));
+}
+
+TEST_CASE("CachedFile handles to the same file share their cache", "[core][file_sys]") {
+    std::vector<u8> data = MakePattern(0x2800);
+    const std::vector<u8> original = data;
+
+    FileCacheConfig config;
+    config.block_size = 0x1000;
+    config.read_ahead_blocks = 0;
+    config.write_back = true;
+    auto stats = std::make_shared<FileCacheStats>();
+    const std::string key = "shared_cached_file";
+
+    auto reader_backend = std::make_unique<MemoryFile>(data);
+    MemoryFile& reader_file = *reader_backend;
+    auto reader =
+        std::make_unique<CachedFile>(std::move(reader_backend), false, key, config, stats);
+    std::vector<u8> result(0x100);
+    REQUIRE(*reader->Read(0x1000, result.size(), result.data()) == result.size());
+    REQUIRE(reader_file.reads == 1);
+
+    // A read-only handle can't write
+    REQUIRE(reader->Write(0, result.size(), false, result.data()).Failed());
+
+    auto writer_backend = std::make_unique<MemoryFile>(data);
+    MemoryFile& writer_file = *writer_backend;
+    auto writer =
+        std::make_unique<CachedFile>(std::move(writer_backend), true, key, config, stats);
+    const std::vector<u8> written(0x100, 0xEF);
+    REQUIRE(*writer->Write(0x1000, written.size(), false, written.data()) == written.size());
+    REQUIRE(*writer->Write(0x2800, written.size(), false, written.data()) == written.size());
+
+    // The other handle sees the data before it's written back
+    REQUIRE(data == original);
+    REQUIRE(reader->GetSize() == 0x2900);
+    REQUIRE(*reader->Read(0x1000, result.size(), result.data()) == result.size());
+    REQUIRE(result == written);
+
+    // Blocks are then read through the writable handle
+    const int writer_reads = writer_file.reads;
+    REQUIRE(*reader->Read(0, result.size(), result.data()) == result.size());
+    REQUIRE(reader_file.reads == 1);
+    REQUIRE(writer_file.reads == writer_reads + 1);
+
+    // The dirty blocks are written back when the writable handle goes away
+    writer.reset();
+    REQUIRE(data.size() == 0x2900);
+    REQUIRE(std::equal(written.begin(), written.end(), data.begin() + 0x1000));
+    REQUIRE(*reader->Read(0x2800, result.size(), result.data()) == result.size());
+    REQUIRE(result == written);
+}
+
+// Hidden by default, run with `tests [benchmark]`
+TEST_CASE("CachedFile asset streaming throughput", "[.][benchmark]") {
+    const std::string path = FileUtil::GetTempDir() + "/cached_file_benchmark.bin";
+    constexpr size_t file_size = 4 * 1024 * 1024;
+    {
+        std::vector<u8> contents = MakePattern(file_size);
+        FileUtil::IOFile(path, "wb").WriteBytes(contents.data(), contents.size());
+    }
+
+    Mode mode{};
+    mode.read_flag.Assign(1);
+
+    // Streams the whole file with reads of a given size, with some work done on the data between
+    // the reads, as a game decoding its assets would
+    auto measure = [&](const FileBackend& file, size_t read_size) {
+        std::vector<u8> buffer(read_size);
+        u32 checksum = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t offset = 0; offset + read_size <= file_size; offset += read_size) {
+            file.Read(offset, read_size, buffer.data());
+            for (u8 value : buffer) {
+                checksum = checksum * 31 + value;
+            }
+        }
+        auto duration = std::chrono::steady_clock::now() - start;
+        REQUIRE(checksum != 0);
+        return file_size / std::chrono::duration<double, std::micro>(duration).count();
+    };
+
+    for (auto latency : {std::chrono::microseconds(0), std::chrono::microseconds(200)}) {
+        for (size_t read_size : {0x200, 0x1000, 0x10000}) {
+            auto open_file = [&] {
+                return std::make_unique<SlowFile>(
+                    std::make_unique<DiskFile>(FileUtil::IOFile(path, "rb"), mode), latency);
+            };
+
+            double uncached = measure(*open_file(), read_size);
+
+            FileCacheConfig no_read_ahead;
+            no_read_ahead.read_ahead_blocks = 0;
+            auto stats = std::make_shared<FileCacheStats>();
+            double cached = measure(CachedFile(open_file(), no_read_ahead, stats), read_size);
+
+            stats = std::make_shared<FileCacheStats>();
+            double read_ahead = measure(CachedFile(open_file(), {}, stats), read_size);
+
+            std::printf("%3lld us latency, %6zu byte reads: uncached %.0f MB/s, cached %.0f MB/s, "
+                        "read-ahead %.0f MB/s (hit rate %.1f%%)\n",
+                        static_cast<long long>(latency.count()), read_size, uncached, cached,
+                        read_ahead, stats->GetHitRate() * 100.0);
+        }
+    }
+    FileUtil::Delete(path);
+}
+
+} // namespace FileSys
@@ -0,0 +1,139 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+#include <catch.hpp>
+#include "common/file_util.h"
+#include "core/file_sys/disk_archive.h"
+#include "core/hle/kernel/memory.h"
+#include "core/hle/kernel/process.h"
+#include "core/memory.h"
+
+namespace FileSys {
+
+TEST_CASE("DiskFile::ReadScatter reads into guest memory spans", "[core][file_sys]") {
+    constexpr VAddr first_block_vaddr = 0x08000000;
+    constexpr size_t block_size = 2 * Memory::PAGE_SIZE;
+    constexpr VAddr second_block_vaddr = first_block_vaddr + block_size;
+
+    const std::string path = FileUtil::GetTempDir() + "/disk_file_read_scatter.bin";
+    constexpr size_t file_size = 0x3000;
+    std::vector<u8> contents(file_size);
+    for (size_t i = 0; i < contents.size(); ++i) {
+        contents[i] = static_cast<u8>(i * 13 + (i >> 8));
+    }
+    REQUIRE(FileUtil::IOFile(path, "wb").WriteBytes(contents.data(), contents.size()) ==
+            file_size);
+
+    // Two blocks adjacent in guest memory, backed by separate host allocations
+    auto process = Kernel::Process::Create(Kernel::CodeSet::Create("", 0));
+    auto first_block = std::make_shared<std::vector<u8>>(block_size);
+    auto second_block = std::make_shared<std::vector<u8>>(block_size);
+    process->vm_manager.MapMemoryBlock(first_block_vaddr, first_block, 0, block_size,
+                                       Kernel::MemoryState::Private);
+    process->vm_manager.MapMemoryBlock(second_block_vaddr, second_block, 0, block_size,
+                                       Kernel::MemoryState::Private);
+    Kernel::g_current_process = process;
+
+    Mode mode;
+    mode.hex = 0;
+    mode.read_flag.Assign(1);
+    {
+        DiskFile file(FileUtil::IOFile(path, "rb"), mode);
+        std::vector<Memory::HostSpan> spans;
+
+        SECTION("across pages and blocks") {
+            // Starts in the middle of a page of the first block and ends in the second block
+            const VAddr vaddr = first_block_vaddr + 0x234;
+            const size_t size = block_size + 0x800;
+            REQUIRE(Memory::GetWritableHostSpans(vaddr, size, spans));
+            REQUIRE(spans.size() == 2);
+            REQUIRE(*file.ReadScatter(0x100, spans) == size);
+
+            std::vector<u8> result(size);
+            Memory::ReadBlock(vaddr, result.data(), size);
+            REQUIRE(std::equal(result.begin(), result.end(), contents.begin() + 0x100));
+        }
+
+        SECTION("stops at the end of the file") {
+            std::fill(second_block->begin(), second_block->end(), 0);
+            const VAddr vaddr = second_block_vaddr - 0x100;
+            REQUIRE(Memory::GetWritableHostSpans(vaddr, 0x1000, spans));
+            REQUIRE(spans.size() == 2);
+            const u64 offset = file_size - 0x180;
+            REQUIRE(*file.ReadScatter(offset, spans) == 0x180);
+
+            std::vector<u8> result(0x180);
+            Memory::ReadBlock(vaddr, result.data(), result.size());
+            REQUIRE(std::equal(result.begin(), result.end(), contents.begin() + offset));
+            // The rest of the spans is left untouched
+            REQUIRE((*second_block)[0x80] == 0);
+        }
+
+        SECTION("requires the read flag") {
+            Mode write_mode;
+            write_mode.hex = 0;
+            write_mode.write_flag.Assign(1);
+            DiskFile write_only_file(FileUtil::IOFile(path, "r+b"), write_mode);
+            REQUIRE(Memory::GetWritableHostSpans(first_block_vaddr, 0x10, spans));
+            REQUIRE(write_only_file.ReadScatter(0, spans).Failed());
+        }
+    }
+
+    Kernel::g_current_process = nullptr;
+    FileUtil::Delete(path);
+}
+
+TEST_CASE("DiskFile::WriteGather writes from guest memory spans", "[core][file_sys]") {
+    constexpr VAddr first_block_vaddr = 0x08000000;
+    constexpr size_t block_size = 2 * Memory::PAGE_SIZE;
+    constexpr VAddr second_block_vaddr = first_block_vaddr + block_size;
+
+    const std::string path = FileUtil::GetTempDir() + "/disk_file_write_gather.bin";
+    REQUIRE(FileUtil::IOFile(path, "wb").IsOpen());
+
+    // Two blocks adjacent in guest memory, backed by separate host allocations
+    auto process = Kernel::Process::Create(Kernel::CodeSet::Create("", 0));
+    auto first_block = std::make_shared<std::vector<u8>>(block_size);
+    auto second_block = std::make_shared<std::vector<u8>>(block_size);
+    for (size_t i = 0; i < block_size; ++i) {
+        (*first_block)[i] = static_cast<u8>(i * 7);
+        (*second_block)[i] = static_cast<u8>(i * 11 + 1);
+    }
+    process->vm_manager.MapMemoryBlock(first_block_vaddr, first_block, 0, block_size,
+                                       Kernel::MemoryState::Private);
+    process->vm_manager.MapMemoryBlock(second_block_vaddr, second_block, 0, block_size,
+                                       Kernel::MemoryState::Private);
+    Kernel::g_current_process = process;
+
+    Mode mode;
+    mode.hex = 0;
+    mode.read_flag.Assign(1);
+    mode.write_flag.Assign(1);
+    {
+        DiskFile file(FileUtil::IOFile(path, "r+b"), mode);
+        std::vector<Memory::HostSpan> spans;
+
+        // Starts in the middle of a page of the first block and ends in the second block
+        const VAddr vaddr = first_block_vaddr + 0x234;
+        const size_t size = block_size + 0x800;
+        REQUIRE(Memory::GetReadableHostSpans(vaddr, size, spans));
+        REQUIRE(spans.size() == 2);
+        REQUIRE(*file.WriteGather(0x100, spans, true) == size);
+
+        std::vector<u8> expected(size);
+        Memory::ReadBlock(vaddr, expected.data(), size);
+        std::vector<u8> result(size);
+        REQUIRE(*file.Read(0x100, size, result.data()) == size);
+        REQUIRE(result == expected);
+    }
+
+    Kernel::g_current_process = nullptr;
+    FileUtil::Delete(path);
+}
+
+} // namespace FileSys
@@ -0,0 +1,143 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+#include <catch.hpp>
+#include "common/file_util.h"
+#include "core/file_sys/ivfc_archive.h"
+#include "core/memory.h"
+
+namespace FileSys {
+
+namespace {
+
+constexpr u64 romfs_offset = 0x1000;
+
+/// Creates a file with a RomFS-like data section filled with a known pattern
+std::shared_ptr<FileUtil::IOFile> CreateRomFS(const std::string& path, size_t data_size) {
+    std::vector<u8> contents(romfs_offset + data_size);
+    for (size_t i = 0; i < contents.size(); ++i) {
+        contents[i] = static_cast<u8>(i * 7 + (i >> 8));
+    }
+    FileUtil::IOFile(path, "wb").WriteBytes(contents.data(), contents.size());
+    return std::make_shared<FileUtil::IOFile>(path, "rb");
+}
+
+/// Splits a buffer in spans of the size of a page, as they would be in discontiguous guest memory
+std::vector<Memory::HostSpan> SplitInPages(std::vector<u8>& buffer) {
+    std::vector<Memory::HostSpan> spans;
+    for (size_t offset = 0; offset < buffer.size(); offset += Memory::PAGE_SIZE) {
+        const size_t size = std::min<size_t>(Memory::PAGE_SIZE, buffer.size() - offset);
+        spans.push_back({buffer.data() + offset, size});
+    }
+    return spans;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("IVFCFile::ReadScatter matches Read", "[core][file_sys]") {
+    const std::string path = FileUtil::GetTempDir() + "/ivfc_read_scatter.bin";
+    constexpr size_t data_size = 0x5432;
+    {
+        IVFCFile file(CreateRomFS(path, data_size), romfs_offset, data_size);
+
+        SECTION("reads across spans") {
+            std::vector<u8> expected(0x3100);
+            REQUIRE(*file.Read(0x123, expected.size(), expected.data()) == expected.size());
+
+            std::vector<u8> result(expected.size());
+            REQUIRE(*file.ReadScatter(0x123, SplitInPages(result)) == expected.size());
+            REQUIRE(result == expected);
+        }
+
+        SECTION("stops at the end of the data") {
+            std::vector<u8> expected(0x2000);
+            const size_t expected_size = data_size - 0x4000;
+            REQUIRE(*file.Read(0x4000, expected.size(), expected.data()) == expected_size);
+
+            std::vector<u8> result(expected.size());
+            REQUIRE(*file.ReadScatter(0x4000, SplitInPages(result)) == expected_size);
+            REQUIRE(std::memcmp(result.data(), expected.data(), expected_size) == 0);
+        }
+    }
+    FileUtil::Delete(path);
+}
+
+TEST_CASE("IVFCFile reads from the RomFS mapping match reads from the file", "[core][file_sys]") {
+    const std::string path = FileUtil::GetTempDir() + "/ivfc_mapping.bin";
+    constexpr size_t data_size = 0x5432;
+    {
+        auto romfs_file = CreateRomFS(path, data_size);
+        auto mapping = MapRomFS(romfs_file, romfs_offset, data_size);
+        REQUIRE(mapping != nullptr);
+
+        IVFCFile mapped_file(romfs_file, mapping, romfs_offset, data_size);
+        IVFCFile unmapped_file(romfs_file, nullptr, romfs_offset, data_size);
+
+        // Sequential reads, reads going backwards and reads past the end of the data
+        for (u64 offset : {0x0, 0x800, 0x1000, 0x123, 0x5000, 0x6000}) {
+            std::vector<u8> expected(0x800);
+            std::vector<u8> result(expected.size());
+            const size_t expected_size = *unmapped_file.Read(offset, 0x800, expected.data());
+            REQUIRE(*mapped_file.Read(offset, 0x800, result.data()) == expected_size);
+            REQUIRE(result == expected);
+
+            std::fill(result.begin(), result.end(), 0);
+            REQUIRE(*mapped_file.ReadScatter(offset, SplitInPages(result)) == expected_size);
+            REQUIRE(result == expected);
+        }
+    }
+    FileUtil::Delete(path);
+}
+
+// Hidden by default, run with `tests [benchmark]`
+TEST_CASE("IVFCFile read throughput", "[.][benchmark]") {
+    const std::string path = FileUtil::GetTempDir() + "/ivfc_read_benchmark.bin";
+    constexpr size_t data_size = 16 * 1024 * 1024;
+    {
+        auto romfs_file = CreateRomFS(path, data_size);
+        IVFCFile unmapped_file(romfs_file, nullptr, romfs_offset, data_size);
+        IVFCFile mapped_file(romfs_file, MapRomFS(romfs_file, romfs_offset, data_size),
+                             romfs_offset, data_size);
+        std::vector<u8> guest_memory(data_size);
+
+        for (size_t read_size : {0x200, 0x1000, 0x10000, 0x100000}) {
+            auto measure = [&](auto&& read) {
+                auto start = std::chrono::steady_clock::now();
+                for (size_t offset = 0; offset + read_size <= data_size; offset += read_size) {
+                    read(offset);
+                }
+                auto duration = std::chrono::steady_clock::now() - start;
+                return data_size / std::chrono::duration<double, std::micro>(duration).count();
+            };
+
+            // The previous path: read into a temporary buffer, then copy it to the guest memory
+            double buffered = measure([&](size_t offset) {
+                std::vector<u8> data(read_size);
+                unmapped_file.Read(offset, data.size(), data.data());
+                std::memcpy(guest_memory.data() + offset, data.data(), data.size());
+            });
+            double direct = measure([&](size_t offset) {
+                std::vector<Memory::HostSpan> spans{{guest_memory.data() + offset, read_size}};
+                unmapped_file.ReadScatter(offset, spans);
+            });
+            double mapped = measure([&](size_t offset) {
+                std::vector<Memory::HostSpan> spans{{guest_memory.data() + offset, read_size}};
+                mapped_file.ReadScatter(offset, spans);
+            });
+
+            std::printf("%7zu byte reads: buffered %.0f MB/s, direct %.0f MB/s, mapped %.0f MB/s\n",
+                        read_size, buffered, direct, mapped);
+        }
+    }
+    FileUtil::Delete(path);
+}
+
+} // namespace FileSys
@@ -0,0 +1,207 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <catch.hpp>
+#include "core/file_sys/lzss.h"
+
+namespace FileSys {
+
+namespace {
+
+/// The byte-at-a-time decompressor the optimised one replaced, used as the reference
+bool ReferenceDecompress(const u8* compressed, u32 compressed_size, u8* decompressed,
+                         u32 decompressed_size) {
+    const u8* footer = compressed + compressed_size - 8;
+    u32 buffer_top_and_bottom;
+    std::memcpy(&buffer_top_and_bottom, footer, sizeof(u32));
+    u32 out = decompressed_size;
+    u32 index = compressed_size - ((buffer_top_and_bottom >> 24) & 0xFF);
+    u32 stop_index = compressed_size - (buffer_top_and_bottom & 0xFFFFFF);
+
+    std::memset(decompressed, 0, decompressed_size);
+    std::memcpy(decompressed, compressed, compressed_size);
+
+    while (index > stop_index) {
+        u8 control = compressed[--index];
+
+        for (unsigned i = 0; i < 8; i++) {
+            if (index <= stop_index || out == 0)
+                break;
+
+            if (control & 0x80) {
+                if (index < 2)
+                    return false;
+                index -= 2;
+
+                u32 segment_offset = compressed[index] | (compressed[index + 1] << 8);
+                u32 segment_size = ((segment_offset >> 12) & 15) + 3;
+                segment_offset &= 0x0FFF;
+                segment_offset += 2;
+
+                if (out < segment_size)
+                    return false;
+
+                for (unsigned j = 0; j < segment_size; j++) {
+                    if (out + segment_offset >= decompressed_size)
+                        return false;
+
+                    u8 data = decompressed[out + segment_offset];
+                    decompressed[--out] = data;
+                }
+            } else {
+                if (out < 1)
+                    return false;
+                decompressed[--out] = compressed[--index];
+            }
+            control <<= 1;
+        }
+    }
+    return true;
+}
+
+/**
+ * Builds a valid compressed .code made of an uncompressed part followed by a compressed part,
+ * with random literals and back-references.
+ * @param plain_size Size of the uncompressed part
+ * @param data_size Size of the data the compressed part decompresses to
+ * @param literal_chance Probability of each token being a literal rather than a back-reference
+ */
+std::vector<u8> MakeCompressed(std::mt19937& rng, u32 plain_size, u32 data_size,
+                               double literal_chance) {
+    struct Token {
+        bool is_reference;
+        u16 value; ///< Literal byte, or encoded back-reference
+    };
+
+    std::bernoulli_distribution is_literal(literal_chance);
+    std::bernoulli_distribution is_near(0.5);
+    std::uniform_int_distribution<u32> byte(0, 255);
+
+    // Tokens in decompression order, that is from the end of the data to its beginning
+    std::vector<Token> tokens;
+    u32 written = 0;
+    while (written < data_size) {
+        const u32 remaining = data_size - written;
+        // The distance to the copied bytes is at least 3, so that much must be written before
+        if (written < 3 || remaining < 3 || is_literal(rng)) {
+            tokens.push_back({false, static_cast<u16>(byte(rng))});
+            written += 1;
+            continue;
+        }
+
+        // Mix overlapping copies, which repeat a short pattern, with copies from further away
+        const u32 max_offset = std::min<u32>(is_near(rng) ? 8 : 0x1001, written - 1);
+        const u32 offset = std::uniform_int_distribution<u32>(2, max_offset)(rng);
+        const u32 size = std::uniform_int_distribution<u32>(3, std::min<u32>(18, remaining))(rng);
+        tokens.push_back({true, static_cast<u16>(((size - 3) << 12) | (offset - 2))});
+        written += size;
+    }
+
+    // Lay the tokens out backwards, behind a control byte for each group of 8
+    std::vector<u8> stream;
+    for (size_t group = 0; group < tokens.size(); group += 8) {
+        u8 control = 0;
+        std::vector<u8> group_bytes;
+        for (size_t i = group; i < std::min(group + 8, tokens.size()); ++i) {
+            control |= (tokens[i].is_reference ? 0x80 : 0) >> (i - group);
+            if (tokens[i].is_reference) {
+                group_bytes.push_back(static_cast<u8>(tokens[i].value >> 8));
+                group_bytes.push_back(static_cast<u8>(tokens[i].value));
+            } else {
+                group_bytes.push_back(static_cast<u8>(tokens[i].value));
+            }
+        }
+        stream.push_back(control);
+        stream.insert(stream.end(), group_bytes.begin(), group_bytes.end());
+    }
+
+    std::vector<u8> compressed(plain_size);
+    for (u8& value : compressed) {
+        value = static_cast<u8>(byte(rng));
+    }
+    compressed.insert(compressed.end(), stream.rbegin(), stream.rend());
+
+    // Footer: the sizes of the compressed part and of the footer, then the size difference
+    const u32 compressed_part_size = static_cast<u32>(stream.size()) + 8;
+    const u32 compressed_size = plain_size + compressed_part_size;
+    const u32 top_and_bottom = (8u << 24) | compressed_part_size;
+    const u32 additional_size = plain_size + data_size - compressed_size;
+    compressed.resize(compressed_size);
+    std::memcpy(&compressed[compressed_size - 8], &top_and_bottom, sizeof(u32));
+    std::memcpy(&compressed[compressed_size - 4], &additional_size, sizeof(u32));
+    return compressed;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("LZSS_Decompress matches the reference decompressor", "[core][file_sys]") {
+    std::mt19937 rng(1234);
+    for (double literal_chance : {0.05, 0.3, 0.6}) {
+        std::vector<u8> compressed = MakeCompressed(rng, 0x1000, 0x20000, literal_chance);
+        const u32 compressed_size = static_cast<u32>(compressed.size());
+        const u32 size = LZSS_GetDecompressedSize(compressed.data(), compressed_size);
+        REQUIRE(size == 0x21000);
+
+        std::vector<u8> expected(size);
+        REQUIRE(ReferenceDecompress(compressed.data(), compressed_size, expected.data(), size));
+
+        std::vector<u8> result(size);
+        REQUIRE(LZSS_Decompress(compressed.data(), compressed_size, result.data(), size));
+        REQUIRE(result == expected);
+    }
+}
+
+TEST_CASE("LZSS_Decompress rejects references out of bounds", "[core][file_sys]") {
+    std::mt19937 rng(1234);
+    std::vector<u8> compressed = MakeCompressed(rng, 0x100, 0x1000, 0.3);
+    const u32 compressed_size = static_cast<u32>(compressed.size());
+    const u32 size = LZSS_GetDecompressedSize(compressed.data(), compressed_size);
+
+    // Make the first token a back-reference to data past the end of the buffer
+    u8* control = &compressed[compressed_size - 9];
+    *control |= 0x80;
+    compressed[compressed_size - 10] = 0xFF;
+    compressed[compressed_size - 11] = 0xFF;
+
+    std::vector<u8> result(size);
+    REQUIRE_FALSE(LZSS_Decompress(compressed.data(), compressed_size, result.data(), size));
+    REQUIRE_FALSE(ReferenceDecompress(compressed.data(), compressed_size, result.data(), size));
+}
+
+// Hidden by default, run with `tests [benchmark]`
+TEST_CASE("LZSS_Decompress throughput", "[.][benchmark]") {
+    std::mt19937 rng(1234);
+    for (double literal_chance : {0.1, 0.3, 0.6}) {
+        std::vector<u8> compressed = MakeCompressed(rng, 0x1000, 16 * 1024 * 1024, literal_chance);
+        const u32 compressed_size = static_cast<u32>(compressed.size());
+        const u32 size = LZSS_GetDecompressedSize(compressed.data(), compressed_size);
+        std::vector<u8> result(size);
+
+        // Best of a few runs, to leave out the noise
+        auto measure = [&](auto&& decompress) {
+            double best = 0.0;
+            for (int run = 0; run < 5; ++run) {
+                auto start = std::chrono::steady_clock::now();
+                decompress(compressed.data(), compressed_size, result.data(), size);
+                auto duration = std::chrono::steady_clock::now() - start;
+                double ms = std::chrono::duration<double, std::milli>(duration).count();
+                best = run == 0 ? ms : std::min(best, ms);
+            }
+            return best;
+        };
+
+        double reference = measure(ReferenceDecompress);
+        double optimised = measure(LZSS_Decompress);
+        std::printf("%2.0f%% literals, 16 MiB .code: byte-at-a-time %.1f ms, optimised %.1f ms\n",
+                    literal_chance * 100, reference, optimised);
+    }
+}
+
+} // namespace FileSys
@@ -0,0 +1,65 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <catch.hpp>
+#include "core/frame_profiler.h"
+
+namespace Core {
+
+using namespace std::chrono_literals;
+
+TEST_CASE("FrameProfiler counts time towards the innermost component", "[core]") {
+    FrameProfiler profiler;
+    using Component = FrameProfiler::Component;
+    auto time_of = [&profiler](size_t frame, Component component) {
+        return profiler.GetFrames()[frame].components[static_cast<size_t>(component)];
+    };
+
+    {
+        // Nothing is recorded before the profiler is started
+        FrameProfiler::Scope scope(profiler, Component::CPU);
+        profiler.EndFrame();
+    }
+    REQUIRE(profiler.GetFrames().empty());
+
+    profiler.Start();
+    {
+        FrameProfiler::Scope cpu_scope(profiler, Component::CPU);
+        std::this_thread::sleep_for(2ms);
+        {
+            FrameProfiler::Scope hle_scope(profiler, Component::HLE);
+            std::this_thread::sleep_for(10ms);
+        }
+        // A frame ending while a component runs splits its time between the frames
+        FrameProfiler::Scope gpu_scope(profiler, Component::GPU);
+        std::this_thread::sleep_for(1ms);
+        profiler.EndFrame();
+        std::this_thread::sleep_for(1ms);
+    }
+    profiler.EndFrame();
+    profiler.Stop();
+
+    const auto& frames = profiler.GetFrames();
+    REQUIRE(frames.size() == 2);
+    REQUIRE(time_of(0, Component::HLE) >= 10ms);
+    REQUIRE(time_of(0, Component::CPU) >= 2ms);
+    REQUIRE(time_of(0, Component::CPU) < 8ms);
+    REQUIRE(time_of(0, Component::GPU) >= 1ms);
+    REQUIRE(time_of(0, Component::DSP) == FrameProfiler::Clock::duration::zero());
+    REQUIRE(frames[0].total >= time_of(0, Component::CPU) + time_of(0, Component::HLE) +
+                                   time_of(0, Component::GPU));
+    REQUIRE(time_of(1, Component::GPU) >= 1ms);
+    REQUIRE(time_of(1, Component::HLE) == FrameProfiler::Clock::duration::zero());
+
+    const std::string json = profiler.ToJSON({});
+    REQUIRE(json.find("\"frames\": 2,") != std::string::npos);
+    for (const char* key : {"\"total\"", "\"cpu\"", "\"gpu\"", "\"dsp\"", "\"hle\"", "\"other\""}) {
+        REQUIRE(json.find(key) != std::string::npos);
+    }
+}
+
+} // namespace Core
@@ -0,0 +1,192 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+#include <catch.hpp>
+#include "core/core_timing.h"
+#include "core/hle/kernel/address_arbiter.h"
+#include "core/hle/kernel/errors.h"
+#include "core/hle/kernel/thread.h"
+#include "core/hle/result.h"
+#include "core/memory.h"
+#include "tests/core/hle/kernel/kernel_test_common.h"
+
+namespace Kernel {
+
+using KernelTests::TestEnvironment;
+
+constexpr u32 SVC_EXIT_THREAD = 0x09;
+constexpr u32 SVC_CREATE_ADDRESS_ARBITER = 0x21;
+constexpr u32 SVC_ARBITRATE_ADDRESS = 0x22;
+
+/// Address of the counter the threads arbitrate on, which makes them wait as long as it's 0
+constexpr VAddr COUNTER_ADDRESS = TestEnvironment::DATA_VADDR + 0x100;
+
+static Handle CreateArbiter(TestEnvironment& env) {
+    REQUIRE(env.CallSVC(SVC_CREATE_ADDRESS_ARBITER, {}) == RESULT_SUCCESS.raw);
+    return env.GetReg(1);
+}
+
+/// Makes the running threads wait on an address, until the signalling thread runs
+static void WaitUntilSignaller(TestEnvironment& env, Handle arbiter, const Thread* signaller,
+                               VAddr address, u64 nanoseconds = -1) {
+    const auto type = nanoseconds == static_cast<u64>(-1)
+                          ? ArbitrationType::WaitIfLessThan
+                          : ArbitrationType::WaitIfLessThanWithTimeout;
+    while (GetCurrentThread() != signaller) {
+        env.CallSVC(SVC_ARBITRATE_ADDRESS,
+                    {arbiter, address, static_cast<u32>(type), 1, static_cast<u32>(nanoseconds),
+                     static_cast<u32>(nanoseconds >> 32)});
+    }
+}
+
+/**
+ * Signals threads waiting on an address from the signalling thread, and exits the threads resumed
+ * in the order they run
+ * @returns the threads resumed
+ */
+static std::vector<Thread*> Signal(TestEnvironment& env, Handle arbiter, const Thread* signaller,
+                                   VAddr address, s32 count) {
+    REQUIRE(GetCurrentThread() == signaller);
+    env.CallSVC(SVC_ARBITRATE_ADDRESS, {arbiter, address,
+                                        static_cast<u32>(ArbitrationType::Signal),
+                                        static_cast<u32>(count), 0, 0});
+    std::vector<Thread*> resumed;
+    while (GetCurrentThread() != signaller) {
+        resumed.push_back(GetCurrentThread());
+        env.CallSVC(SVC_EXIT_THREAD, {});
+    }
+    return resumed;
+}
+
+TEST_CASE("ArbitrateAddress resumes threads by priority, then newest first", "[core][kernel]") {
+    TestEnvironment env;
+    Memory::Write32(COUNTER_ADDRESS, 0);
+    SharedPtr<Thread> signaller = env.CreateThread(THREADPRIO_LOWEST);
+    std::vector<SharedPtr<Thread>> waiters;
+    for (u32 priority : {0x30, 0x20, 0x30, 0x28, 0x20}) {
+        waiters.push_back(env.CreateThread(priority));
+    }
+    env.Reschedule();
+    const Handle arbiter = CreateArbiter(env);
+    WaitUntilSignaller(env, arbiter, signaller.get(), COUNTER_ADDRESS);
+    for (const auto& waiter : waiters) {
+        REQUIRE(waiter->status == THREADSTATUS_WAIT_ARB);
+    }
+
+    // Threads waiting on another address are left alone
+    REQUIRE(Signal(env, arbiter, signaller.get(), COUNTER_ADDRESS + 4, 1).empty());
+
+    const std::vector<Thread*> expected_order{waiters[4].get(), waiters[1].get(),
+                                              waiters[3].get(), waiters[2].get(),
+                                              waiters[0].get()};
+    for (Thread* expected : expected_order) {
+        const std::vector<Thread*> resumed =
+            Signal(env, arbiter, signaller.get(), COUNTER_ADDRESS, 1);
+        REQUIRE(resumed.size() == 1);
+        REQUIRE(resumed[0] == expected);
+    }
+    REQUIRE(Signal(env, arbiter, signaller.get(), COUNTER_ADDRESS, 1).empty());
+}
+
+TEST_CASE("ArbitrateAddress resumes all threads in the order they were created",
+          "[core][kernel]") {
+    TestEnvironment env;
+    Memory::Write32(COUNTER_ADDRESS, 0);
+    SharedPtr<Thread> signaller = env.CreateThread(THREADPRIO_LOWEST);
+    std::vector<SharedPtr<Thread>> waiters;
+    for (int i = 0; i < 4; ++i) {
+        waiters.push_back(env.CreateThread(0x30));
+    }
+    env.Reschedule();
+    const Handle arbiter = CreateArbiter(env);
+    WaitUntilSignaller(env, arbiter, signaller.get(), COUNTER_ADDRESS);
+
+    const std::vector<Thread*> resumed =
+        Signal(env, arbiter, signaller.get(), COUNTER_ADDRESS, -1);
+    REQUIRE(resumed.size() == 4);
+    for (size_t i = 0; i < resumed.size(); ++i) {
+        REQUIRE(resumed[i] == waiters[i].get());
+    }
+}
+
+TEST_CASE("ArbitrateAddress follows the priority changes of waiting threads", "[core][kernel]") {
+    TestEnvironment env;
+    Memory::Write32(COUNTER_ADDRESS, 0);
+    SharedPtr<Thread> signaller = env.CreateThread(THREADPRIO_LOWEST);
+    SharedPtr<Thread> high = env.CreateThread(0x20);
+    SharedPtr<Thread> low = env.CreateThread(0x30);
+    env.Reschedule();
+    const Handle arbiter = CreateArbiter(env);
+    WaitUntilSignaller(env, arbiter, signaller.get(), COUNTER_ADDRESS);
+
+    low->SetPriority(0x10);
+    std::vector<Thread*> resumed = Signal(env, arbiter, signaller.get(), COUNTER_ADDRESS, 1);
+    REQUIRE(resumed.size() == 1);
+    REQUIRE(resumed[0] == low.get());
+    resumed = Signal(env, arbiter, signaller.get(), COUNTER_ADDRESS, 1);
+    REQUIRE(resumed.size() == 1);
+    REQUIRE(resumed[0] == high.get());
+}
+
+TEST_CASE("ArbitrateAddress forgets the threads whose wait timed out", "[core][kernel]") {
+    TestEnvironment env;
+    Memory::Write32(COUNTER_ADDRESS, 0);
+    SharedPtr<Thread> signaller = env.CreateThread(THREADPRIO_LOWEST);
+    SharedPtr<Thread> waiter = env.CreateThread(0x30);
+    env.Reschedule();
+    const Handle arbiter = CreateArbiter(env);
+    WaitUntilSignaller(env, arbiter, signaller.get(), COUNTER_ADDRESS, 1000);
+    REQUIRE(waiter->status == THREADSTATUS_WAIT_ARB);
+
+    CoreTiming::AddTicks(usToCycles(10));
+    CoreTiming::Advance();
+    REQUIRE(waiter->status == THREADSTATUS_READY);
+    REQUIRE(env.Reschedule() == waiter.get());
+    REQUIRE(env.GetReg(0) == RESULT_TIMEOUT.raw);
+    env.CallSVC(SVC_EXIT_THREAD, {});
+
+    REQUIRE(Signal(env, arbiter, signaller.get(), COUNTER_ADDRESS, -1).empty());
+}
+
+// Hidden by default, run with `tests [benchmark]`
+TEST_CASE("ArbitrateAddress with many waiting threads", "[.][benchmark]") {
+    constexpr u32 num_addresses = 16;
+    for (u32 num_threads : {16, 64, 256}) {
+        TestEnvironment env;
+        SharedPtr<Thread> signaller = env.CreateThread(THREADPRIO_LOWEST);
+        std::vector<SharedPtr<Thread>> waiters;
+        for (u32 i = 0; i < num_threads; ++i) {
+            waiters.push_back(env.CreateThread(0x20 + i % 8));
+        }
+        env.Reschedule();
+        const Handle arbiter = CreateArbiter(env);
+
+        // Spreads the threads over several addresses, each one waiting again once resumed
+        const auto begin = std::chrono::steady_clock::now();
+        u32 signals = 0;
+        for (int round = 0; round < 100; ++round) {
+            for (u32 i = 0; GetCurrentThread() != signaller.get(); ++i) {
+                const VAddr address = COUNTER_ADDRESS + 4 * (i % num_addresses);
+                env.CallSVC(SVC_ARBITRATE_ADDRESS,
+                            {arbiter, address,
+                             static_cast<u32>(ArbitrationType::WaitIfLessThan), 1, 0, 0});
+            }
+            for (u32 i = 0; i < num_addresses; ++i) {
+                env.CallSVC(SVC_ARBITRATE_ADDRESS,
+                            {arbiter, COUNTER_ADDRESS + 4 * i,
+                             static_cast<u32>(ArbitrationType::Signal), 1, 0, 0});
+                ++signals;
+            }
+        }
+        const std::chrono::duration<double, std::nano> duration =
+            std::chrono::steady_clock::now() - begin;
+        std::printf("ArbitrateAddress with %3u threads: %.0f ns per signal and wait\n",
+                    num_threads, duration.count() / signals);
+    }
+}
+
+} // namespace Kernel
@@ -2,6 +2,9 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <cstring>
+#include <memory>
+#include <vector>
 #include <catch.hpp>
 #include "core/hle/ipc.h"
 #include "core/hle/kernel/client_port.h"
@@ -11,6 +14,7 @@
 #include "core/hle/kernel/hle_ipc.h"
 #include "core/hle/kernel/process.h"
 #include "core/hle/kernel/server_session.h"
+#include "core/memory.h"
 
 namespace Kernel {
 
@@ -116,6 +120,44 @@ TEST_CASE("HLERequestContext::PopulateFromIncomingCommandBuffer", "[core][kernel
         REQUIRE(context.CommandBuffer()[2] == process->process_id);
     }
 
+    SECTION("translates mapped buffer descriptors") {
+        auto buffer = std::make_shared<std::vector<u8>>(Memory::PAGE_SIZE);
+        VAddr target_address = 0x10000000;
+        auto result = process->vm_manager.MapMemoryBlock(target_address, buffer, 0, buffer->size(),
+                                                         MemoryState::Private);
+        REQUIRE(result.Code() == RESULT_SUCCESS);
+
+        const u32_le input[]{
+            IPC::MakeHeader(0, 0, 2), IPC::MappedBufferDesc(buffer->size(), IPC::RW),
+            target_address,
+        };
+
+        context.PopulateFromIncomingCommandBuffer(input, *process, handle_table);
+
+        REQUIRE(context.CommandBuffer()[2] == target_address);
+        const MappedBuffer& mapped_buffer = context.GetMappedBuffer(1);
+        REQUIRE(mapped_buffer.GetSize() == buffer->size());
+        REQUIRE(mapped_buffer.GetPermissions() == IPC::RW);
+
+        // The buffer is accessed in place in the guest memory
+        const u32 value = 0xCAFEBABE;
+        mapped_buffer.Write(&value, 8, sizeof(value));
+        REQUIRE(std::memcmp(buffer->data() + 8, &value, sizeof(value)) == 0);
+        u32 read_value = 0;
+        mapped_buffer.Read(&read_value, 8, sizeof(read_value));
+        REQUIRE(read_value == value);
+
+        // Ranges running past the end of the buffer, which come from the guest, are clamped
+        const u64 large_value = 0x0123456789ABCDEF;
+        REQUIRE(mapped_buffer.Write(&large_value, buffer->size() - 4, sizeof(large_value)) == 4);
+        REQUIRE(std::memcmp(buffer->data() + buffer->size() - 4, &large_value, 4) == 0);
+        u64 large_read_value = 0;
+        REQUIRE(mapped_buffer.Read(&large_read_value, buffer->size() + 4, 8) == 0);
+        REQUIRE(large_read_value == 0);
+
+        REQUIRE(process->vm_manager.UnmapRange(target_address, buffer->size()) == RESULT_SUCCESS);
+    }
+
     SECTION("translates mixed params") {
         auto a = MakeObject();
         const u32_le input[]{
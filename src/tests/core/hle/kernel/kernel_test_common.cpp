@@ -0,0 +1,62 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "core/arm/dyncom/arm_dyncom.h"
+#include "core/core.h"
+#include "core/core_timing.h"
+#include "core/hle/kernel/process.h"
+#include "core/hle/kernel/thread.h"
+#include "core/hle/svc.h"
+#include "core/memory.h"
+#include "tests/core/hle/kernel/kernel_test_common.h"
+
+namespace KernelTests {
+
+TestEnvironment::TestEnvironment() : data(std::make_shared<std::vector<u8>>(DATA_SIZE)) {
+    CoreTiming::Init();
+    Core::System::GetInstance().SetCPU(std::make_unique<ARM_DynCom>(USER32MODE));
+    Kernel::Init(0);
+
+    process = Kernel::Process::Create(Kernel::CodeSet::Create("test", 0));
+    process->vm_manager
+        .MapMemoryBlock(DATA_VADDR, data, 0, DATA_SIZE, Kernel::MemoryState::Private)
+        .Unwrap();
+    Kernel::g_current_process = process;
+    Memory::SetCurrentPageTable(&process->vm_manager.page_table);
+}
+
+TestEnvironment::~TestEnvironment() {
+    Kernel::Shutdown();
+    Core::System::GetInstance().SetCPU(nullptr);
+    CoreTiming::Shutdown();
+}
+
+Kernel::SharedPtr<Kernel::Thread> TestEnvironment::CreateThread(u32 priority) {
+    return Kernel::Thread::Create("test", DATA_VADDR, priority, 0, THREADPROCESSORID_0,
+                                  DATA_VADDR + DATA_SIZE, process)
+        .Unwrap();
+}
+
+Kernel::Thread* TestEnvironment::Reschedule() {
+    Kernel::Reschedule();
+    return Kernel::GetCurrentThread();
+}
+
+u32 TestEnvironment::CallSVC(u32 immediate, std::initializer_list<u32> args) {
+    int index = 0;
+    for (u32 arg : args) {
+        Core::CPU().SetReg(index++, arg);
+    }
+    SVC::CallSVC(immediate);
+    const u32 result = Core::CPU().GetReg(0);
+    // As after any SVC in the emulation loop, the thread is switched out if it has to wait
+    Kernel::Reschedule();
+    return result;
+}
+
+u32 TestEnvironment::GetReg(int index) const {
+    return Core::CPU().GetReg(index);
+}
+
+} // namespace KernelTests
@@ -0,0 +1,57 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <initializer_list>
+#include <memory>
+#include <vector>
+#include "common/common_types.h"
+#include "core/hle/kernel/kernel.h"
+
+namespace Kernel {
+class Process;
+class Thread;
+} // namespace Kernel
+
+namespace KernelTests {
+
+/**
+ * Runs the kernel on its own, for tests making SVCs on behalf of the threads of a test process.
+ * No guest code is executed: the threads are switched with Reschedule, and the SVCs are called
+ * with their arguments in the registers of the CPU, as if the running thread had made them.
+ */
+class TestEnvironment final {
+public:
+    /// Address of the memory the test can freely read and write
+    static constexpr VAddr DATA_VADDR = 0x08000000;
+    static constexpr u32 DATA_SIZE = 0x10000;
+
+    TestEnvironment();
+    ~TestEnvironment();
+
+    /// Creates a thread of the test process, ready to run
+    Kernel::SharedPtr<Kernel::Thread> CreateThread(u32 priority);
+
+    /// Switches to the next thread to run, and returns it
+    Kernel::Thread* Reschedule();
+
+    /**
+     * Makes an SVC from the running thread, then reschedules as the emulation loop does. If the
+     * thread waits, the results it gets on waking up are in the registers once it runs again.
+     * @param immediate Number of the SVC
+     * @param args Arguments of the SVC, in registers r0 and up
+     * @returns the result of the SVC, in r0
+     */
+    u32 CallSVC(u32 immediate, std::initializer_list<u32> args);
+
+    /// Returns a register of the CPU, such as an output of the last SVC
+    u32 GetReg(int index) const;
+
+private:
+    Kernel::SharedPtr<Kernel::Process> process;
+    std::shared_ptr<std::vector<u8>> data;
+};
+
+} // namespace KernelTests
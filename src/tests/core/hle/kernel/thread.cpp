@@ -0,0 +1,100 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <vector>
+#include <catch.hpp>
+#include "common/chunk_file.h"
+#include "core/arm/arm_interface.h"
+#include "core/core.h"
+#include "core/hle/kernel/errors.h"
+#include "core/hle/kernel/event.h"
+#include "core/hle/kernel/handle_table.h"
+#include "core/hle/kernel/thread.h"
+#include "core/hle/result.h"
+#include "tests/core/hle/kernel/kernel_test_common.h"
+
+namespace Kernel {
+
+using KernelTests::TestEnvironment;
+
+constexpr u32 SVC_WAIT_SYNCHRONIZATION_1 = 0x24;
+
+static std::vector<u8> SaveThreadState() {
+    u8* ptr = nullptr;
+    PointerWrap measure(&ptr, PointerWrap::MODE_MEASURE);
+    DoThreadState(measure);
+    std::vector<u8> buffer(reinterpret_cast<size_t>(ptr));
+
+    ptr = buffer.data();
+    PointerWrap p(&ptr, PointerWrap::MODE_WRITE);
+    DoThreadState(p);
+    return buffer;
+}
+
+TEST_CASE("SaveThreadContexts saves the registers kept loaded in the CPU", "[core][kernel]") {
+    TestEnvironment env;
+    SharedPtr<Event> event = Event::Create(ResetType::OneShot);
+    const Handle handle = g_handle_table.Create(event).Unwrap();
+    SharedPtr<Thread> thread = env.CreateThread(0x30);
+    REQUIRE(env.Reschedule() == thread.get());
+
+    Core::CPU().SetReg(4, 0x12345678);
+    Core::CPU().SetVFPReg(3, 0x3F800000);
+    Kernel::SaveThreadContexts();
+    REQUIRE(thread->context.cpu_registers[4] == 0x12345678);
+    REQUIRE(thread->context.fpu_registers[3] == 0x3F800000);
+
+    // The VFP registers of a thread going idle stay in the CPU, and only reach its context once
+    // they are saved
+    Core::CPU().SetVFPReg(3, 0x40000000);
+    REQUIRE(env.CallSVC(SVC_WAIT_SYNCHRONIZATION_1, {handle, 0, 0xFFFFFFFF, 0xFFFFFFFF}) ==
+            RESULT_TIMEOUT.raw);
+    REQUIRE(GetCurrentThread() == nullptr);
+    Kernel::SaveThreadContexts();
+    REQUIRE(thread->context.fpu_registers[3] == 0x40000000);
+
+    event->Signal();
+    REQUIRE(env.Reschedule() == thread.get());
+    REQUIRE(Core::CPU().GetVFPReg(3) == 0x40000000);
+}
+
+TEST_CASE("DoThreadState only restores the threads in the state they were saved in",
+          "[core][kernel]") {
+    TestEnvironment env;
+    SharedPtr<Event> event = Event::Create(ResetType::OneShot);
+    const Handle handle = g_handle_table.Create(event).Unwrap();
+    SharedPtr<Thread> waiter = env.CreateThread(0x20);
+    SharedPtr<Thread> thread = env.CreateThread(0x30);
+    REQUIRE(env.Reschedule() == waiter.get());
+    env.CallSVC(SVC_WAIT_SYNCHRONIZATION_1, {handle, 0, 0xFFFFFFFF, 0xFFFFFFFF});
+    REQUIRE(GetCurrentThread() == thread.get());
+
+    Core::CPU().SetReg(4, 0x12345678);
+    std::vector<u8> buffer = SaveThreadState();
+    Core::CPU().SetReg(4, 0);
+
+    u8* ptr = buffer.data();
+    PointerWrap check(&ptr, PointerWrap::MODE_READ);
+    REQUIRE(IsThreadStateRestorable(check));
+    ptr = buffer.data();
+    PointerWrap load(&ptr, PointerWrap::MODE_READ);
+    DoThreadState(load);
+    REQUIRE(load.error != PointerWrap::ERROR_FAILURE);
+    REQUIRE(ptr == buffer.data() + buffer.size());
+    REQUIRE(Core::CPU().GetReg(4) == 0x12345678);
+
+    // Once the waiting thread is resumed, the threads are no longer in the saved state
+    event->Signal();
+    Core::CPU().SetReg(4, 0);
+    ptr = buffer.data();
+    PointerWrap check_resumed(&ptr, PointerWrap::MODE_READ);
+    REQUIRE_FALSE(IsThreadStateRestorable(check_resumed));
+    ptr = buffer.data();
+    PointerWrap load_resumed(&ptr, PointerWrap::MODE_READ);
+    DoThreadState(load_resumed);
+    REQUIRE(load_resumed.error == PointerWrap::ERROR_FAILURE);
+    REQUIRE(Core::CPU().GetReg(4) == 0);
+}
+
+} // namespace Kernel
@@ -0,0 +1,174 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+#include <catch.hpp>
+#include "core/hle/kernel/errors.h"
+#include "core/hle/kernel/event.h"
+#include "core/hle/kernel/handle_table.h"
+#include "core/hle/kernel/thread.h"
+#include "core/hle/result.h"
+#include "core/memory.h"
+#include "tests/core/hle/kernel/kernel_test_common.h"
+
+namespace Kernel {
+
+using KernelTests::TestEnvironment;
+
+constexpr u32 SVC_WAIT_SYNCHRONIZATION_1 = 0x24;
+constexpr u32 SVC_WAIT_SYNCHRONIZATION_N = 0x25;
+constexpr u32 SVC_REPLY_AND_RECEIVE = 0x4F;
+
+/// Creates events and writes their handles to the data memory, returning the handles' address
+static VAddr CreateEvents(std::vector<SharedPtr<Event>>& events, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        events.push_back(Event::Create(ResetType::OneShot));
+        const Handle handle = g_handle_table.Create(events.back()).Unwrap();
+        Memory::Write32(TestEnvironment::DATA_VADDR + static_cast<VAddr>(i * 4), handle);
+    }
+    return TestEnvironment::DATA_VADDR;
+}
+
+/// Makes a WaitSynchronizationN SVC waiting for any of the handles, without a timeout
+static u32 WaitForAny(TestEnvironment& env, VAddr handles, u32 count) {
+    return env.CallSVC(SVC_WAIT_SYNCHRONIZATION_N, {0xFFFFFFFF, handles, count, 0, 0xFFFFFFFF});
+}
+
+TEST_CASE("WaitSynchronizationN reuses the storage of the wait list", "[core][kernel]") {
+    TestEnvironment env;
+    std::vector<SharedPtr<Event>> events;
+    const VAddr handles = CreateEvents(events, 4);
+    SharedPtr<Thread> thread = env.CreateThread(0x30);
+    REQUIRE(env.Reschedule() == thread.get());
+
+    REQUIRE(WaitForAny(env, handles, 4) == RESULT_TIMEOUT.raw);
+    REQUIRE(thread->status == THREADSTATUS_WAIT_SYNCH_ANY);
+    REQUIRE(thread->wait_objects.size() == 4);
+    const SharedPtr<WaitObject>* storage = thread->wait_objects.data();
+
+    events[2]->Signal();
+    REQUIRE(thread->status == THREADSTATUS_READY);
+    REQUIRE(thread->wait_objects.empty());
+    REQUIRE(env.Reschedule() == thread.get());
+    REQUIRE(env.GetReg(0) == RESULT_SUCCESS.raw);
+    REQUIRE(env.GetReg(1) == 2);
+
+    // Waiting again, even on fewer objects, doesn't allocate
+    REQUIRE(WaitForAny(env, handles, 3) == RESULT_TIMEOUT.raw);
+    REQUIRE(thread->wait_objects.data() == storage);
+    events[0]->Signal();
+    REQUIRE(env.Reschedule() == thread.get());
+    REQUIRE(env.GetReg(1) == 0);
+    REQUIRE(thread->wait_objects.data() == storage);
+}
+
+TEST_CASE("WaitSynchronizationN leaves the wait list empty when not waiting", "[core][kernel]") {
+    TestEnvironment env;
+    std::vector<SharedPtr<Event>> events;
+    const VAddr handles = CreateEvents(events, 3);
+    SharedPtr<Thread> thread = env.CreateThread(0x30);
+    REQUIRE(env.Reschedule() == thread.get());
+
+    // An object is ready
+    events[1]->Signal();
+    REQUIRE(WaitForAny(env, handles, 3) == RESULT_SUCCESS.raw);
+    REQUIRE(env.GetReg(1) == 1);
+    REQUIRE(thread->status == THREADSTATUS_RUNNING);
+    REQUIRE(thread->wait_objects.empty());
+
+    // No timeout
+    REQUIRE(env.CallSVC(SVC_WAIT_SYNCHRONIZATION_N, {0, handles, 3, 0, 0}) == RESULT_TIMEOUT.raw);
+    REQUIRE(thread->wait_objects.empty());
+
+    // An invalid handle
+    Memory::Write32(handles + 8, 0xDEADBEEF);
+    REQUIRE(WaitForAny(env, handles, 3) == ERR_INVALID_HANDLE.raw);
+    REQUIRE(thread->status == THREADSTATUS_RUNNING);
+    REQUIRE(thread->wait_objects.empty());
+}
+
+TEST_CASE("WaitSynchronization1 reuses the storage of the wait list", "[core][kernel]") {
+    TestEnvironment env;
+    std::vector<SharedPtr<Event>> events;
+    const VAddr handles = CreateEvents(events, 2);
+    SharedPtr<Thread> thread = env.CreateThread(0x30);
+    REQUIRE(env.Reschedule() == thread.get());
+
+    // Gives the wait list some storage
+    REQUIRE(WaitForAny(env, handles, 2) == RESULT_TIMEOUT.raw);
+    const SharedPtr<WaitObject>* storage = thread->wait_objects.data();
+    events[0]->Signal();
+    REQUIRE(env.Reschedule() == thread.get());
+
+    const Handle handle = Memory::Read32(handles + 4);
+    REQUIRE(env.CallSVC(SVC_WAIT_SYNCHRONIZATION_1, {handle, 0, 0xFFFFFFFF, 0xFFFFFFFF}) ==
+            RESULT_TIMEOUT.raw);
+    REQUIRE(thread->status == THREADSTATUS_WAIT_SYNCH_ANY);
+    REQUIRE(thread->wait_objects.size() == 1);
+    REQUIRE(thread->wait_objects.data() == storage);
+
+    events[1]->Signal();
+    REQUIRE(env.Reschedule() == thread.get());
+    REQUIRE(env.GetReg(0) == RESULT_SUCCESS.raw);
+    REQUIRE(thread->wait_objects.empty());
+}
+
+TEST_CASE("ReplyAndReceive reuses the storage of the wait list", "[core][kernel]") {
+    TestEnvironment env;
+    std::vector<SharedPtr<Event>> events;
+    const VAddr handles = CreateEvents(events, 3);
+    SharedPtr<Thread> thread = env.CreateThread(0x30);
+    REQUIRE(env.Reschedule() == thread.get());
+
+    // Without a reply target, this only waits for a request on any of the objects
+    REQUIRE(env.CallSVC(SVC_REPLY_AND_RECEIVE, {0, handles, 3, 0}) == RESULT_SUCCESS.raw);
+    REQUIRE(thread->status == THREADSTATUS_WAIT_SYNCH_ANY);
+    REQUIRE(thread->wait_objects.size() == 3);
+    const SharedPtr<WaitObject>* storage = thread->wait_objects.data();
+
+    events[1]->Signal();
+    REQUIRE(env.Reschedule() == thread.get());
+    REQUIRE(env.GetReg(1) == 1);
+    REQUIRE(thread->wait_objects.empty());
+
+    REQUIRE(env.CallSVC(SVC_REPLY_AND_RECEIVE, {0, handles, 3, 0}) == RESULT_SUCCESS.raw);
+    REQUIRE(thread->wait_objects.data() == storage);
+    events[2]->Signal();
+    REQUIRE(env.Reschedule() == thread.get());
+    REQUIRE(env.GetReg(1) == 2);
+
+    // An object is ready
+    events[0]->Signal();
+    REQUIRE(env.CallSVC(SVC_REPLY_AND_RECEIVE, {0, handles, 3, 0}) == RESULT_SUCCESS.raw);
+    REQUIRE(env.GetReg(1) == 0);
+    REQUIRE(thread->status == THREADSTATUS_RUNNING);
+    REQUIRE(thread->wait_objects.empty());
+}
+
+// Hidden by default, run with `tests [benchmark]`
+TEST_CASE("WaitSynchronizationN throughput", "[.][benchmark]") {
+    TestEnvironment env;
+    std::vector<SharedPtr<Event>> events;
+    const VAddr handles = CreateEvents(events, 16);
+    SharedPtr<Thread> thread = env.CreateThread(0x30);
+    REQUIRE(env.Reschedule() == thread.get());
+
+    constexpr int iterations = 100000;
+    for (u32 count : {1, 4, 16}) {
+        const auto begin = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            WaitForAny(env, handles, count);
+            events[i % count]->Signal();
+            env.Reschedule();
+        }
+        const std::chrono::duration<double, std::nano> duration =
+            std::chrono::steady_clock::now() - begin;
+        std::printf("WaitSynchronizationN on %2u events: %.0f ns per wait\n", count,
+                    duration.count() / iterations);
+    }
+}
+
+} // namespace Kernel
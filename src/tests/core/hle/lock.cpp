@@ -0,0 +1,43 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <future>
+#include <thread>
+#include <catch.hpp>
+#include "core/hle/lock.h"
+
+namespace HLE {
+
+TEST_CASE("HLE::LockGuard accounts the time waited for and held", "[core][hle]") {
+    static LockSite holder_site("Test holder");
+    static LockSite waiter_site("Test waiter");
+
+    std::promise<void> locked;
+    std::thread holder([&locked] {
+        LockGuard lock(holder_site);
+        locked.set_value();
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    });
+    locked.get_future().wait();
+    {
+        LockGuard lock(waiter_site);
+        // Recursive acquisitions on the same thread never wait
+        LockGuard nested_lock(waiter_site);
+    }
+    holder.join();
+
+    REQUIRE(holder_site.acquisitions == 1);
+    REQUIRE(holder_site.contentions == 0);
+    REQUIRE(holder_site.hold_ns >= 10000000);
+    REQUIRE(waiter_site.acquisitions == 2);
+    REQUIRE(waiter_site.contentions == 1);
+    REQUIRE(waiter_site.wait_ns >= 10000000);
+
+    LogLockStats();
+    REQUIRE(holder_site.acquisitions == 0);
+    REQUIRE(waiter_site.wait_ns == 0);
+}
+
+} // namespace HLE
@@ -0,0 +1,144 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+#include <catch.hpp>
+#include "common/file_util.h"
+#include "common/string_util.h"
+#include "core/hle/service/am/title_index.h"
+
+namespace Service {
+namespace AM {
+
+namespace {
+
+/// Title/ folder in the temporary directory, removed at the end of the test
+struct TitleFolder {
+    TitleFolder() {
+        FileUtil::DeleteDirRecursively(root);
+    }
+    ~TitleFolder() {
+        FileUtil::DeleteDirRecursively(root);
+    }
+
+    std::string GetContentPath(u64 tid) const {
+        return Common::StringFromFormat("%s%08x/%08x/content/00000000.app", title_path.c_str(),
+                                        static_cast<u32>(tid >> 32),
+                                        static_cast<u32>(tid & 0xFFFFFFFF));
+    }
+
+    /// Installs a title, whose content is valid if it begins with 'N'
+    void Install(u64 tid, const std::string& contents) const {
+        const std::string path = GetContentPath(tid);
+        REQUIRE(FileUtil::CreateFullPath(path));
+        REQUIRE(FileUtil::WriteStringToFile(false, contents, path.c_str()) == contents.size());
+    }
+
+    const std::string root = FileUtil::GetTempDir() + "/title_index_test/";
+    const std::string title_path = root + "title/";
+    const std::string cache_path = root + "cache/title_index.bin";
+};
+
+} // Anonymous namespace
+
+TEST_CASE("TitleIndex only checks the titles changed since the last scan", "[core][am]") {
+    TitleFolder folder;
+    std::atomic<int> checks{0};
+    auto check = [&folder, &checks](u64 tid, std::string& content_path) {
+        ++checks;
+        content_path = folder.GetContentPath(tid);
+        std::string contents;
+        return FileUtil::ReadFileToString(false, content_path.c_str(), contents) &&
+               !contents.empty() && contents[0] == 'N';
+    };
+
+    folder.Install(0x0004000000030000, "NCCH");
+    folder.Install(0x0004000000010000, "NCCH");
+    folder.Install(0x0004000E00010000, "NCCH update");
+    folder.Install(0x0004000000020000, "broken");
+
+    const std::vector<u64> expected{0x0004000000010000, 0x0004000000030000, 0x0004000E00010000};
+    REQUIRE(TitleIndex(folder.title_path, folder.cache_path).Scan(check, 4) == expected);
+    REQUIRE(checks == 4);
+
+    // Nothing changed, so the results come from the saved index
+    TitleIndex index(folder.title_path, folder.cache_path);
+    REQUIRE(index.Scan(check, 4) == expected);
+    REQUIRE(checks == 4);
+    REQUIRE(index.GetLastStats().cached == 4);
+
+    // A rewritten content, a new title and a removed one
+    folder.Install(0x0004000000020000, "NCCH fixed");
+    folder.Install(0x0004000000040000, "NCCH");
+    FileUtil::DeleteDirRecursively(folder.title_path + "00040000/00030000/");
+    const std::vector<u64> updated{0x0004000000010000, 0x0004000000020000, 0x0004000000040000,
+                                   0x0004000E00010000};
+    REQUIRE(index.Scan(check, 4) == updated);
+    REQUIRE(checks == 6);
+    REQUIRE(index.GetLastStats().checked == 2);
+
+    // A damaged index is scanned again from scratch
+    FileUtil::WriteStringToFile(false, "TIDX", folder.cache_path.c_str());
+    REQUIRE(index.Scan(check, 1) == updated);
+    REQUIRE(checks == 10);
+
+    // Folders that aren't title IDs are ignored
+    REQUIRE(FileUtil::CreateFullPath(folder.title_path + "notatid/00000000/"));
+    REQUIRE(index.Scan(check, 4) == updated);
+    REQUIRE(checks == 10);
+}
+
+// Hidden by default, run with `tests [benchmark]`
+TEST_CASE("TitleIndex scan time", "[.][benchmark]") {
+    // Like opening an NCCH: its header, then its extended header and its ExeFS header
+    auto check = [](u64 tid, std::string& content_path) {
+        content_path = Common::StringFromFormat(
+            "%s/title_index_benchmark/title/%08x/%08x/content/00000000.app",
+            FileUtil::GetTempDir().c_str(), static_cast<u32>(tid >> 32),
+            static_cast<u32>(tid & 0xFFFFFFFF));
+        FileUtil::IOFile file(content_path, "rb");
+        std::vector<u8> header(0x200);
+        for (u64 offset : {0x0, 0x200, 0xA00}) {
+            if (!file.Seek(offset, SEEK_SET) || file.ReadBytes(header.data(), 0x200) != 0x200)
+                return false;
+        }
+        return header[0] == 'N';
+    };
+    const unsigned num_workers = std::max(std::thread::hardware_concurrency(), 1u);
+
+    for (u32 count : {0, 100, 1000}) {
+        const std::string root = FileUtil::GetTempDir() + "/title_index_benchmark/";
+        FileUtil::DeleteDirRecursively(root);
+        FileUtil::CreateFullPath(root + "title/");
+        const std::string contents(0x4000, 'N');
+        for (u32 i = 0; i < count; ++i) {
+            const std::string path = Common::StringFromFormat(
+                "%stitle/00040000/%08x/content/00000000.app", root.c_str(), i << 8);
+            FileUtil::CreateFullPath(path);
+            FileUtil::WriteStringToFile(false, contents, path.c_str());
+        }
+
+        TitleIndex index(root + "title/", root + "title_index.bin");
+        REQUIRE(index.Scan(check, 1).size() == count);
+        const double one_worker_ms = index.GetLastStats().duration_ms;
+        FileUtil::Delete(root + "title_index.bin");
+        REQUIRE(index.Scan(check, num_workers).size() == count);
+        const double workers_ms = index.GetLastStats().duration_ms;
+        REQUIRE(index.Scan(check, num_workers).size() == count);
+        const double cached_ms = index.GetLastStats().duration_ms;
+
+        std::printf("%4u titles: %.1f ms with 1 worker, %.1f ms with %u workers, %.1f ms from the "
+                    "index\n",
+                    count, one_worker_ms, workers_ms, num_workers, cached_ms);
+        FileUtil::DeleteDirRecursively(root);
+    }
+}
+
+} // namespace AM
+} // namespace Service
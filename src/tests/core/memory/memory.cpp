@@ -2,6 +2,8 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <memory>
+#include <vector>
 #include <catch.hpp>
 #include "core/hle/kernel/memory.h"
 #include "core/hle/kernel/process.h"
@@ -54,3 +56,123 @@ TEST_CASE("Memory::IsValidVirtualAddress", "[core][memory]") {
         CHECK(Memory::IsValidVirtualAddress(*process, Memory::CONFIG_MEMORY_VADDR) == false);
     }
 }
+
+TEST_CASE("Memory::GetWritableHostSpans", "[core][memory]") {
+    constexpr VAddr first_block_vaddr = 0x08000000;
+    constexpr size_t block_size = 4 * Memory::PAGE_SIZE;
+    constexpr VAddr second_block_vaddr = first_block_vaddr + block_size;
+
+    // Two blocks adjacent in guest memory, backed by separate host allocations
+    auto process = Kernel::Process::Create(Kernel::CodeSet::Create("", 0));
+    auto first_block = std::make_shared<std::vector<u8>>(block_size);
+    auto second_block = std::make_shared<std::vector<u8>>(block_size);
+    process->vm_manager.MapMemoryBlock(first_block_vaddr, first_block, 0, block_size,
+                                       Kernel::MemoryState::Private);
+    process->vm_manager.MapMemoryBlock(second_block_vaddr, second_block, 0, block_size,
+                                       Kernel::MemoryState::Private);
+    Kernel::g_current_process = process;
+
+    std::vector<Memory::HostSpan> spans;
+
+    SECTION("pages contiguous in host memory are merged") {
+        REQUIRE(Memory::GetWritableHostSpans(first_block_vaddr + 0x123, 2 * Memory::PAGE_SIZE,
+                                             spans));
+        REQUIRE(spans.size() == 1);
+        CHECK(spans[0].pointer == first_block->data() + 0x123);
+        CHECK(spans[0].size == 2 * Memory::PAGE_SIZE);
+    }
+
+    SECTION("a range across blocks is split at the end of the first block") {
+        REQUIRE(Memory::GetWritableHostSpans(second_block_vaddr - 0x10, 0x1020, spans));
+        REQUIRE(spans.size() == 2);
+        CHECK(spans[0].pointer == first_block->data() + block_size - 0x10);
+        CHECK(spans[0].size == 0x10);
+        CHECK(spans[1].pointer == second_block->data());
+        CHECK(spans[1].size == 0x1010);
+    }
+
+    SECTION("a range ending exactly at a page boundary") {
+        REQUIRE(Memory::GetWritableHostSpans(first_block_vaddr + Memory::PAGE_SIZE - 4, 4, spans));
+        REQUIRE(spans.size() == 1);
+        CHECK(spans[0].pointer == first_block->data() + Memory::PAGE_SIZE - 4);
+        CHECK(spans[0].size == 4);
+    }
+
+    SECTION("an empty range has no spans") {
+        REQUIRE(Memory::GetWritableHostSpans(first_block_vaddr, 0, spans));
+        CHECK(spans.empty());
+    }
+
+    SECTION("a range running into unmapped memory fails") {
+        CHECK_FALSE(Memory::GetWritableHostSpans(second_block_vaddr + block_size - 8, 16, spans));
+        CHECK_FALSE(Memory::GetWritableHostSpans(first_block_vaddr - 8, 16, spans));
+    }
+
+    Kernel::g_current_process = nullptr;
+}
+
+TEST_CASE("Memory write tracking", "[core][memory]") {
+    constexpr VAddr block_vaddr = 0x08000000;
+    constexpr size_t block_size = 4 * Memory::PAGE_SIZE;
+
+    auto process = Kernel::Process::Create(Kernel::CodeSet::Create("", 0));
+    auto block = std::make_shared<std::vector<u8>>(block_size);
+    process->vm_manager.MapMemoryBlock(block_vaddr, block, 0, block_size,
+                                       Kernel::MemoryState::Private);
+    Kernel::g_current_process = process;
+    Memory::SetCurrentPageTable(&process->vm_manager.page_table);
+
+    // Pages reported, and their first byte when reported
+    std::vector<u8*> written_pages;
+    std::vector<u8> previous_values;
+    Memory::StartWriteTracking([&](u8* pointer, size_t size) {
+        CHECK(size == Memory::PAGE_SIZE);
+        written_pages.push_back(pointer);
+        previous_values.push_back(*pointer);
+    });
+
+    SECTION("the first write to each page is reported before it happens") {
+        (*block)[Memory::PAGE_SIZE] = 7;
+        Memory::Write8(block_vaddr + Memory::PAGE_SIZE, 1);
+        Memory::Write8(block_vaddr + Memory::PAGE_SIZE + 1, 2);
+        REQUIRE(written_pages == std::vector<u8*>{block->data() + Memory::PAGE_SIZE});
+        CHECK(previous_values[0] == 7);
+        CHECK(Memory::Read8(block_vaddr + Memory::PAGE_SIZE + 1) == 2);
+
+        // Reads don't untrack the pages
+        (*block)[2 * Memory::PAGE_SIZE] = 3;
+        CHECK(Memory::Read8(block_vaddr + 2 * Memory::PAGE_SIZE) == 3);
+        CHECK(written_pages.size() == 1);
+
+        const std::vector<u8> data(Memory::PAGE_SIZE, 5);
+        Memory::WriteBlock(block_vaddr + Memory::PAGE_SIZE + 0x800, data.data(), data.size());
+        REQUIRE(written_pages.size() == 2);
+        CHECK(written_pages[1] == block->data() + 2 * Memory::PAGE_SIZE);
+        CHECK(previous_values[1] == 3);
+    }
+
+    SECTION("the pages written to are reported again once re-armed") {
+        Memory::Write32(block_vaddr, 1);
+        Memory::RearmWriteTracking();
+        Memory::Write32(block_vaddr, 2);
+        Memory::Write32(block_vaddr, 3);
+        REQUIRE(written_pages.size() == 2);
+        CHECK(written_pages[1] == block->data());
+        CHECK(previous_values[1] == 1);
+    }
+
+    SECTION("nothing is reported once stopped") {
+        Memory::NotifyHostWrite(block->data(), Memory::PAGE_SIZE);
+        REQUIRE(written_pages.size() == 1);
+        Memory::StopWriteTracking();
+        Memory::NotifyHostWrite(block->data(), Memory::PAGE_SIZE);
+        Memory::Write32(block_vaddr + Memory::PAGE_SIZE, 1);
+        CHECK(written_pages.size() == 1);
+        CHECK(Memory::GetPointer(block_vaddr + Memory::PAGE_SIZE) ==
+              block->data() + Memory::PAGE_SIZE);
+    }
+
+    Memory::StopWriteTracking();
+    Memory::SetCurrentPageTable(nullptr);
+    Kernel::g_current_process = nullptr;
+}
@@ -0,0 +1,109 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <numeric>
+#include <thread>
+#include <catch.hpp>
+#include "core/perf_stats.h"
+#include "core/settings.h"
+
+namespace Core {
+
+using namespace std::chrono_literals;
+
+/// Runs a system frame taking the given walltime, as seen by the frame skipper
+static void RunFrame(PerfStats& perf_stats, FrameSkipper& frame_skipper,
+                     std::chrono::milliseconds duration) {
+    perf_stats.BeginSystemFrame();
+    std::this_thread::sleep_for(duration);
+    perf_stats.EndSystemFrame();
+    frame_skipper.EndFrame(perf_stats);
+}
+
+TEST_CASE("FrameSkipper renders all frames when emulation is fast", "[core]") {
+    Settings::values.use_frame_skip = true;
+    Settings::values.frame_skip_threshold = 95;
+    PerfStats perf_stats;
+    FrameSkipper frame_skipper;
+
+    for (int i = 0; i < 4; ++i) {
+        RunFrame(perf_stats, frame_skipper, 2ms);
+        REQUIRE(!frame_skipper.IsSkippingFrame());
+    }
+    REQUIRE(perf_stats.GetAndResetStats(0).skipped_frames == 0);
+
+    Settings::values.use_frame_skip = false;
+}
+
+TEST_CASE("FrameSkipper skips frames when emulation is slow", "[core]") {
+    Settings::values.use_frame_skip = true;
+    Settings::values.frame_skip_threshold = 95;
+    PerfStats perf_stats;
+    FrameSkipper frame_skipper;
+
+    // Rendering takes longer than a frame (16.7 ms), but less than two, so one frame out of two
+    // is skipped
+    RunFrame(perf_stats, frame_skipper, 25ms);
+    REQUIRE(frame_skipper.IsSkippingFrame());
+    RunFrame(perf_stats, frame_skipper, 1ms);
+    REQUIRE(!frame_skipper.IsSkippingFrame());
+    RunFrame(perf_stats, frame_skipper, 25ms);
+    REQUIRE(frame_skipper.IsSkippingFrame());
+    RunFrame(perf_stats, frame_skipper, 1ms);
+    REQUIRE(!frame_skipper.IsSkippingFrame());
+
+    // Only the draws to the color buffers copied to the screen are skipped
+    frame_skipper.AddPresentedColorBuffer(0x18000000);
+    RunFrame(perf_stats, frame_skipper, 25ms);
+    REQUIRE(frame_skipper.IsSkippingDraw(0x18000000));
+    REQUIRE(!frame_skipper.IsSkippingDraw(0x18100000));
+    RunFrame(perf_stats, frame_skipper, 1ms);
+    REQUIRE(!frame_skipper.IsSkippingDraw(0x18000000));
+
+    const PerfStats::Results results = perf_stats.GetAndResetStats(6 * 16'667);
+    REQUIRE(results.skipped_frames == 3);
+    REQUIRE(results.frame_skip_speed_gain > 0.0);
+
+    // Nothing is skipped anymore once disabled
+    Settings::values.use_frame_skip = false;
+    RunFrame(perf_stats, frame_skipper, 25ms);
+    REQUIRE(!frame_skipper.IsSkippingFrame());
+}
+
+TEST_CASE("PerfStats sorts frame pacing errors into a histogram", "[core]") {
+    PerfStats perf_stats;
+    perf_stats.AddFramePacingError(10us);
+    perf_stats.AddFramePacingError(50us);
+    perf_stats.AddFramePacingError(51us);
+    perf_stats.AddFramePacingError(20ms);
+
+    const PerfStats::Results results = perf_stats.GetAndResetStats(0);
+    REQUIRE(results.pacing_error_histogram[0] == 2);
+    REQUIRE(results.pacing_error_histogram[1] == 1);
+    REQUIRE(results.pacing_error_histogram.back() == 1);
+    REQUIRE(results.pacing_error_max == Approx(0.02));
+    REQUIRE(perf_stats.GetAndResetStats(0).pacing_error_histogram[0] == 0);
+}
+
+TEST_CASE("FrameLimiter waits until the emulated time catches up", "[core]") {
+    Settings::values.toggle_framelimit = true;
+    for (auto pacing : {Settings::FramePacing::Sleep, Settings::FramePacing::Precise}) {
+        Settings::values.frame_pacing = pacing;
+        PerfStats perf_stats;
+        FrameLimiter frame_limiter;
+        frame_limiter.DoFrameLimiting(0, perf_stats);
+
+        const auto begin = FrameLimiter::Clock::now();
+        frame_limiter.DoFrameLimiting(10'000, perf_stats);
+        REQUIRE(FrameLimiter::Clock::now() - begin >= 9ms);
+
+        const PerfStats::Results results = perf_stats.GetAndResetStats(0);
+        REQUIRE(std::accumulate(results.pacing_error_histogram.begin(),
+                                results.pacing_error_histogram.end(), 0u) == 1);
+    }
+    Settings::values.toggle_framelimit = false;
+}
+
+} // namespace Core
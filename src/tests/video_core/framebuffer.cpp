@@ -0,0 +1,165 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <catch.hpp>
+#include "common/color.h"
+#include "core/memory.h"
+#include "video_core/regs_framebuffer.h"
+#include "video_core/swrasterizer/framebuffer.h"
+#include "video_core/utils.h"
+
+using Pica::FramebufferRegs;
+using Pica::Rasterizer::FramebufferView;
+
+namespace {
+
+constexpr u32 width = 240;
+constexpr u32 height = 400;
+
+std::unique_ptr<FramebufferRegs::FramebufferConfig> MakeConfig(
+    FramebufferRegs::ColorFormat color_format, FramebufferRegs::DepthFormat depth_format) {
+    auto config = std::make_unique<FramebufferRegs::FramebufferConfig>();
+    std::memset(config.get(), 0, sizeof(*config));
+    config->color_format.Assign(color_format);
+    config->depth_format.Assign(depth_format);
+    config->width.Assign(width);
+    config->height.Assign(height - 1);
+    config->color_buffer_address.Assign(Memory::VRAM_PADDR / 8);
+    config->depth_buffer_address.Assign((Memory::VRAM_PADDR + width * height * 4) / 8);
+    return config;
+}
+
+/// Returns the location of a pixel as addressed by the rasterizer, computed from scratch
+u8* ReferencePixel(PAddr addr, int x, int y, u32 bytes_per_pixel) {
+    y = height - 1 - y;
+    return Memory::GetPhysicalPointer(addr) +
+           VideoCore::GetMortonOffset(x, y, bytes_per_pixel) +
+           (y & ~7) * width * bytes_per_pixel;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("Pica::Rasterizer::FramebufferView addresses tiled color buffers", "[video_core]") {
+    using ColorFormat = FramebufferRegs::ColorFormat;
+    std::mt19937 rng(0xfb);
+
+    for (auto format : {ColorFormat::RGBA8, ColorFormat::RGB8, ColorFormat::RGB5A1,
+                        ColorFormat::RGB565, ColorFormat::RGBA4}) {
+        auto config = MakeConfig(format, FramebufferRegs::DepthFormat::D24S8);
+        const FramebufferView view(*config);
+        const u32 bytes_per_pixel = FramebufferRegs::BytesPerColorPixel(format);
+
+        for (int i = 0; i < 1024; ++i) {
+            const int x = rng() % width;
+            const int y = rng() % height;
+            const Math::Vec4<u8> color = Math::MakeVec<u8>(rng(), rng(), rng(), rng());
+            view.DrawPixel(x, y, color);
+
+            u8 expected[4] = {};
+            Math::Vec4<u8> decoded;
+            switch (format) {
+            case ColorFormat::RGBA8:
+                Color::EncodeRGBA8(color, expected);
+                decoded = Color::DecodeRGBA8(expected);
+                break;
+            case ColorFormat::RGB8:
+                Color::EncodeRGB8(color, expected);
+                decoded = Color::DecodeRGB8(expected);
+                break;
+            case ColorFormat::RGB5A1:
+                Color::EncodeRGB5A1(color, expected);
+                decoded = Color::DecodeRGB5A1(expected);
+                break;
+            case ColorFormat::RGB565:
+                Color::EncodeRGB565(color, expected);
+                decoded = Color::DecodeRGB565(expected);
+                break;
+            case ColorFormat::RGBA4:
+                Color::EncodeRGBA4(color, expected);
+                decoded = Color::DecodeRGBA4(expected);
+                break;
+            }
+            u8* pixel = ReferencePixel(config->GetColorBufferPhysicalAddress(), x, y,
+                                       bytes_per_pixel);
+            REQUIRE(std::memcmp(pixel, expected, bytes_per_pixel) == 0);
+
+            const Math::Vec4<u8> result = view.GetPixel(x, y);
+            REQUIRE((result.r() == decoded.r() && result.g() == decoded.g() &&
+                     result.b() == decoded.b() && result.a() == decoded.a()));
+        }
+    }
+}
+
+TEST_CASE("Pica::Rasterizer::FramebufferView addresses tiled depth buffers", "[video_core]") {
+    using DepthFormat = FramebufferRegs::DepthFormat;
+    std::mt19937 rng(0xfb);
+
+    for (auto format : {DepthFormat::D16, DepthFormat::D24, DepthFormat::D24S8}) {
+        auto config = MakeConfig(FramebufferRegs::ColorFormat::RGBA8, format);
+        const FramebufferView view(*config);
+        const u32 bytes_per_pixel = FramebufferRegs::BytesPerDepthPixel(format);
+        const u32 depth_mask = format == DepthFormat::D16 ? 0xFFFF : 0xFFFFFF;
+
+        for (int i = 0; i < 1024; ++i) {
+            const int x = rng() % width;
+            const int y = rng() % height;
+            const u32 depth = rng() & depth_mask;
+            const u8 stencil = rng() & 0xFF;
+            u8* pixel = ReferencePixel(config->GetDepthBufferPhysicalAddress(), x, y,
+                                       bytes_per_pixel);
+
+            view.SetDepth(x, y, depth);
+            view.SetStencil(x, y, stencil);
+            REQUIRE(view.GetDepth(x, y) == depth);
+            if (format == DepthFormat::D16) {
+                REQUIRE(Color::DecodeD16(pixel) == depth);
+            } else {
+                REQUIRE(Color::DecodeD24(pixel) == depth);
+            }
+
+            if (format == DepthFormat::D24S8) {
+                REQUIRE(view.GetStencil(x, y) == stencil);
+                REQUIRE(pixel[3] == stencil);
+            }
+        }
+    }
+}
+
+// Hidden by default, run with `tests [benchmark]`
+TEST_CASE("Pica::Rasterizer::FramebufferView fill rate", "[.][benchmark]") {
+    auto config = MakeConfig(FramebufferRegs::ColorFormat::RGBA8,
+                             FramebufferRegs::DepthFormat::D24S8);
+    const Math::Vec4<u8> color = {0x20, 0x40, 0x60, 0x80};
+    constexpr int passes = 16;
+
+    auto fill = [&](auto&& get_view) {
+        auto start = std::chrono::steady_clock::now();
+        for (int pass = 0; pass < passes; ++pass) {
+            for (u32 y = 0; y < height; ++y) {
+                for (u32 x = 0; x < width; ++x) {
+                    const FramebufferView& view = get_view();
+                    u32 depth = view.GetDepth(x, y);
+                    view.SetDepth(x, y, depth + 1);
+                    view.DrawPixel(x, y, color);
+                }
+            }
+        }
+        auto duration = std::chrono::steady_clock::now() - start;
+        return passes * width * height /
+               std::chrono::duration<double, std::micro>(duration).count();
+    };
+
+    // Resolving the view for every fragment matches the cost of the previous per-fragment lookups
+    double per_fragment = fill([&] { return FramebufferView(*config); });
+    const FramebufferView view(*config);
+    double per_draw = fill([&]() -> const FramebufferView& { return view; });
+
+    std::printf("per-fragment setup %.1f Mpixel/s, per-draw setup %.1f Mpixel/s\n", per_fragment,
+                per_draw);
+}
@@ -0,0 +1,153 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <tuple>
+#include <catch.hpp>
+#include "video_core/pica_state.h"
+#include "video_core/regs_lighting.h"
+#include "video_core/swrasterizer/lighting.h"
+
+using Pica::LightingRegs;
+
+namespace {
+
+struct Fragment {
+    Math::Quaternion<float> normquat;
+    Math::Vec3<float> view;
+    Math::Vec4<u8> texture_color[4];
+};
+
+/// Generates a random, but valid, lighting configuration with 1 to 8 lights
+void RandomizeLighting(std::mt19937& rng, LightingRegs& regs, Pica::State::Lighting& state) {
+    std::array<u32, sizeof(LightingRegs) / sizeof(u32)> raw;
+    for (auto& word : raw) {
+        word = rng();
+    }
+    std::memcpy(&regs, raw.data(), sizeof(regs));
+
+    for (auto& lut : state.luts) {
+        for (auto& entry : lut) {
+            entry.raw = rng();
+        }
+    }
+
+    static const LightingRegs::LightingConfig configs[] = {
+        LightingRegs::LightingConfig::Config0, LightingRegs::LightingConfig::Config1,
+        LightingRegs::LightingConfig::Config2, LightingRegs::LightingConfig::Config3,
+        LightingRegs::LightingConfig::Config4, LightingRegs::LightingConfig::Config5,
+        LightingRegs::LightingConfig::Config6, LightingRegs::LightingConfig::Config7,
+    };
+    static const LightingRegs::LightingScale scales[] = {
+        LightingRegs::LightingScale::Scale1,   LightingRegs::LightingScale::Scale2,
+        LightingRegs::LightingScale::Scale4,   LightingRegs::LightingScale::Scale8,
+        LightingRegs::LightingScale::Scale1_4, LightingRegs::LightingScale::Scale1_2,
+    };
+    auto random_input = [&] { return static_cast<LightingRegs::LightingLutInput>(rng() % 6); };
+    auto random_scale = [&] { return scales[rng() % 6]; };
+
+    regs.config0.config.Assign(configs[rng() % 8]);
+    regs.config0.bump_mode.Assign(static_cast<LightingRegs::LightingBumpMode>(rng() % 3));
+    regs.config0.bump_selector.Assign(rng() % 3);
+
+    regs.lut_input.d0.Assign(random_input());
+    regs.lut_input.d1.Assign(random_input());
+    regs.lut_input.sp.Assign(random_input());
+    regs.lut_input.fr.Assign(random_input());
+    regs.lut_input.rb.Assign(random_input());
+    regs.lut_input.rg.Assign(random_input());
+    regs.lut_input.rr.Assign(random_input());
+
+    regs.lut_scale.d0.Assign(random_scale());
+    regs.lut_scale.d1.Assign(random_scale());
+    regs.lut_scale.sp.Assign(random_scale());
+    regs.lut_scale.fr.Assign(random_scale());
+    regs.lut_scale.rb.Assign(random_scale());
+    regs.lut_scale.rg.Assign(random_scale());
+    regs.lut_scale.rr.Assign(random_scale());
+}
+
+Fragment RandomFragment(std::mt19937& rng) {
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    Fragment fragment;
+    fragment.normquat =
+        Math::Quaternion<float>{{dist(rng), dist(rng), dist(rng)}, dist(rng)}.Normalized();
+    fragment.view = Math::MakeVec(dist(rng), dist(rng), dist(rng)) * 10.0f;
+    for (auto& color : fragment.texture_color) {
+        color = Math::MakeVec<u8>(rng() & 0xFF, rng() & 0xFF, rng() & 0xFF, rng() & 0xFF);
+    }
+    return fragment;
+}
+
+bool operator==(const Math::Vec4<u8>& a, const Math::Vec4<u8>& b) {
+    return a.x == b.x && a.y == b.y && a.z == b.z && a.w == b.w;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("Pica::SetupLighting matches the generic lighting path", "[video_core]") {
+    std::mt19937 rng(0x3d5);
+    auto regs = std::make_unique<LightingRegs>();
+    auto state = std::make_unique<Pica::State::Lighting>();
+    auto setup = std::make_unique<Pica::LightingSetup>();
+
+    for (int config = 0; config < 64; ++config) {
+        RandomizeLighting(rng, *regs, *state);
+        Pica::SetupLighting(*setup, *regs, *state);
+
+        for (int i = 0; i < 64; ++i) {
+            Fragment fragment = RandomFragment(rng);
+            auto expected = Pica::ComputeFragmentsColors(
+                *regs, *state, fragment.normquat, fragment.view, fragment.texture_color);
+            auto result = Pica::ComputeFragmentsColors(*setup, fragment.normquat, fragment.view,
+                                                       fragment.texture_color);
+            REQUIRE(std::get<0>(result) == std::get<0>(expected));
+            REQUIRE(std::get<1>(result) == std::get<1>(expected));
+        }
+    }
+}
+
+// Hidden by default, run with `tests [benchmark]`
+TEST_CASE("Pica::ComputeFragmentsColors per-fragment cost", "[.][benchmark]") {
+    constexpr int fragments = 1 << 18;
+
+    std::mt19937 rng(0x3d5);
+    auto regs = std::make_unique<LightingRegs>();
+    auto state = std::make_unique<Pica::State::Lighting>();
+    auto setup = std::make_unique<Pica::LightingSetup>();
+
+    for (unsigned num_lights : {1, 4, 8}) {
+        RandomizeLighting(rng, *regs, *state);
+        regs->max_light_index.Assign(num_lights - 1);
+        Pica::SetupLighting(*setup, *regs, *state);
+        Fragment fragment = RandomFragment(rng);
+
+        unsigned checksum = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < fragments; ++i) {
+            auto colors = Pica::ComputeFragmentsColors(*regs, *state, fragment.normquat,
+                                                       fragment.view, fragment.texture_color);
+            checksum += std::get<0>(colors).r();
+        }
+        auto middle = std::chrono::steady_clock::now();
+        for (int i = 0; i < fragments; ++i) {
+            auto colors = Pica::ComputeFragmentsColors(*setup, fragment.normquat, fragment.view,
+                                                       fragment.texture_color);
+            checksum += std::get<0>(colors).r();
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        auto ns_per_fragment = [&](std::chrono::steady_clock::duration duration) {
+            return std::chrono::duration<double, std::nano>(duration).count() / fragments;
+        };
+        std::printf("%u light(s): generic %6.1f ns/fragment, baked %6.1f ns/fragment (%u)\n",
+                    num_lights, ns_per_fragment(middle - start), ns_per_fragment(end - middle),
+                    checksum);
+    }
+}
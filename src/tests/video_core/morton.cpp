@@ -0,0 +1,117 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+#include <catch.hpp>
+#include "common/common_types.h"
+#include "video_core/utils.h"
+
+namespace {
+
+constexpr u32 WIDTH = 128;
+constexpr u32 HEIGHT = 64;
+
+/// Reference per-pixel implementation of the Morton to bottom-up linear copy
+std::vector<u8> ReferenceMortonToLinear(const std::vector<u8>& morton_data, u32 bytes_per_pixel,
+                                        u32 linear_bytes_per_pixel) {
+    std::vector<u8> linear_data(WIDTH * HEIGHT * linear_bytes_per_pixel);
+    for (u32 y = 0; y < HEIGHT; ++y) {
+        for (u32 x = 0; x < WIDTH; ++x) {
+            const u32 coarse_y = y & ~7;
+            u32 morton_offset = VideoCore::GetMortonOffset(x, y, bytes_per_pixel) +
+                                coarse_y * WIDTH * bytes_per_pixel;
+            u32 linear_offset = (x + (HEIGHT - 1 - y) * WIDTH) * linear_bytes_per_pixel;
+            std::copy_n(&morton_data[morton_offset], bytes_per_pixel, &linear_data[linear_offset]);
+        }
+    }
+    return linear_data;
+}
+
+std::vector<u8> MakeTestImage(u32 bytes_per_pixel) {
+    std::vector<u8> data(WIDTH * HEIGHT * bytes_per_pixel);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<u8>(i * 7 + (i >> 8));
+    }
+    return data;
+}
+
+template <size_t bytes_per_pixel, size_t linear_bytes_per_pixel>
+void CheckRoundTrip() {
+    std::vector<u8> morton_data = MakeTestImage(bytes_per_pixel);
+    std::vector<u8> linear_data(WIDTH * HEIGHT * linear_bytes_per_pixel);
+
+    VideoCore::MortonCopyImage<bytes_per_pixel, linear_bytes_per_pixel, true>(
+        WIDTH, HEIGHT, morton_data.data(), linear_data.data());
+    REQUIRE(linear_data ==
+            ReferenceMortonToLinear(morton_data, bytes_per_pixel, linear_bytes_per_pixel));
+
+    std::vector<u8> round_trip(morton_data.size());
+    VideoCore::MortonCopyImage<bytes_per_pixel, linear_bytes_per_pixel, false>(
+        WIDTH, HEIGHT, round_trip.data(), linear_data.data());
+    REQUIRE(round_trip == morton_data);
+}
+
+template <size_t bytes_per_pixel, size_t linear_bytes_per_pixel>
+void BenchmarkFormat(const char* name) {
+    constexpr u32 width = 1024;
+    constexpr u32 height = 1024;
+    constexpr int iterations = 32;
+
+    std::vector<u8> morton_data(width * height * bytes_per_pixel);
+    std::vector<u8> linear_data(width * height * linear_bytes_per_pixel);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        VideoCore::MortonCopyImage<bytes_per_pixel, linear_bytes_per_pixel, true>(
+            width, height, morton_data.data(), linear_data.data());
+    }
+    auto middle = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        VideoCore::MortonCopyImage<bytes_per_pixel, linear_bytes_per_pixel, false>(
+            width, height, morton_data.data(), linear_data.data());
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    auto megabytes_per_second = [&](std::chrono::steady_clock::duration duration) {
+        double seconds = std::chrono::duration<double>(duration).count();
+        return morton_data.size() * iterations / seconds / (1024.0 * 1024.0);
+    };
+    std::printf("%-8s unswizzle %8.1f MB/s, swizzle %8.1f MB/s\n", name,
+                megabytes_per_second(middle - start), megabytes_per_second(end - middle));
+}
+
+} // Anonymous namespace
+
+TEST_CASE("VideoCore::MortonCopyImage", "[video_core]") {
+    SECTION("8-bit") {
+        CheckRoundTrip<1, 1>();
+    }
+    SECTION("16-bit") {
+        CheckRoundTrip<2, 2>();
+    }
+    SECTION("24-bit") {
+        CheckRoundTrip<3, 3>();
+    }
+    SECTION("24-bit padded to 32-bit") {
+        CheckRoundTrip<3, 4>();
+    }
+    SECTION("32-bit") {
+        CheckRoundTrip<4, 4>();
+    }
+}
+
+// Hidden by default, run with `tests [benchmark]`
+TEST_CASE("VideoCore::MortonCopyImage throughput", "[.][benchmark]") {
+    BenchmarkFormat<4, 4>("RGBA8");
+    BenchmarkFormat<3, 3>("RGB8");
+    BenchmarkFormat<2, 2>("RGB5A1");
+    BenchmarkFormat<2, 2>("RGB565");
+    BenchmarkFormat<2, 2>("RGBA4");
+    BenchmarkFormat<2, 2>("D16");
+    BenchmarkFormat<3, 4>("D24");
+    BenchmarkFormat<4, 4>("D24S8");
+}
@@ -9,6 +9,7 @@
 #include "common/assert.h"
 #include "common/logging/log.h"
 #include "common/microprofile.h"
+#include "common/perf_counters.h"
 #include "common/vector_math.h"
 #include "core/hle/service/gsp_gpu.h"
 #include "core/hw/gpu.h"
@@ -171,6 +172,7 @@ static void LoadDefaultVertexAttributes(u32 register_value) {
                 immediate_attribute_id += 1;
             } else {
                 MICROPROFILE_SCOPE(GPU_Drawing);
+                PERF_COUNTERS_SCOPE(GPU_Drawing);
                 immediate_attribute_id = 0;
 
                 auto* shader_engine = Shader::GetEngine();
@@ -210,6 +212,7 @@ static void LoadDefaultVertexAttributes(u32 register_value) {
 
 static void Draw(u32 command_id) {
     MICROPROFILE_SCOPE(GPU_Drawing);
+    PERF_COUNTERS_SCOPE(GPU_Drawing);
     auto& regs = g_state.regs;
 
 #if PICA_LOG_TEV
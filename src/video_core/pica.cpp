@@ -3,9 +3,11 @@
 // Refer to the license.txt file included.
 
 #include <cstring>
+#include "common/chunk_file.h"
 #include "video_core/geometry_pipeline.h"
 #include "video_core/pica.h"
 #include "video_core/pica_state.h"
+#include "video_core/rasterizer_interface.h"
 #include "video_core/renderer_base.h"
 #include "video_core/video_core.h"
 
@@ -21,6 +23,19 @@ void Shutdown() {
     Shader::Shutdown();
 }
 
+void DoState(PointerWrap& p) {
+    g_state.DoState(p);
+
+    if (p.GetMode() == PointerWrap::MODE_READ && VideoCore::g_renderer) {
+        // Let the rasterizer pick up the restored registers, as if they had just been written
+        for (u32 id = 0; id < Regs::NUM_REGS; ++id) {
+            VideoCore::g_renderer->Rasterizer()->NotifyPicaRegisterChanged(id);
+        }
+        // Writing the registers only marks the tables they select, while all of them were restored
+        VideoCore::g_renderer->Rasterizer()->InvalidateLookupTables();
+    }
+}
+
 template <typename T>
 void Zero(T& o) {
     memset(&o, 0, sizeof(o));
@@ -51,4 +66,33 @@ void State::Reset() {
     Zero(immediate);
     primitive_assembler.Reconfigure(PipelineRegs::TriangleTopology::List);
 }
+
+void State::DoState(PointerWrap& p) {
+    auto s = p.Section("Pica", 1);
+    if (!s)
+        return;
+
+    p.DoVoid(&regs, sizeof(regs));
+    for (Shader::ShaderSetup* setup : {&vs, &gs}) {
+        p.DoVoid(&setup->uniforms, sizeof(setup->uniforms));
+        p.Do(setup->program_code);
+        p.Do(setup->swizzle_data);
+        p.Do(setup->engine_data.entry_point);
+    }
+    p.DoVoid(&input_default_attributes, sizeof(input_default_attributes));
+    p.DoVoid(&proctex, sizeof(proctex));
+    p.DoVoid(&lighting, sizeof(lighting));
+    p.DoVoid(&fog, sizeof(fog));
+    p.DoVoid(&immediate.input_vertex, sizeof(immediate.input_vertex));
+    p.Do(immediate.current_attribute);
+    p.Do(immediate.reset_geometry_pipeline);
+
+    if (p.GetMode() == PointerWrap::MODE_READ) {
+        // Compiled shaders are looked up again by the next draw
+        vs.engine_data.cached_shader = nullptr;
+        gs.engine_data.cached_shader = nullptr;
+        Zero(cmd_list);
+        primitive_assembler.Reconfigure(regs.pipeline.triangle_topology);
+    }
+}
 }
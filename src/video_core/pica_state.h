@@ -13,6 +13,8 @@
 #include "video_core/regs.h"
 #include "video_core/shader/shader.h"
 
+class PointerWrap;
+
 namespace Pica {
 
 /// Struct used to describe current Pica state
@@ -20,6 +22,9 @@ struct State {
     State();
     void Reset();
 
+    /// Serializes the state, for checkpoints. Draws in progress are dropped when it is restored.
+    void DoState(PointerWrap& p);
+
     /// Pica registers
     Regs regs;
 
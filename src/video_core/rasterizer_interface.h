@@ -32,6 +32,9 @@ public:
     /// Notify rasterizer that the specified PICA register has been changed
     virtual void NotifyPicaRegisterChanged(u32 id) = 0;
 
+    /// Notify rasterizer that the lookup tables written through the PICA registers were all replaced
+    virtual void InvalidateLookupTables() {}
+
     /// Notify rasterizer that all caches should be flushed to 3DS memory
     virtual void FlushAll() = 0;
 
@@ -0,0 +1,43 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "common/logging/log.h"
+#include "core/core.h"
+#include "core/frontend/emu_window.h"
+#include "core/tracer/recorder.h"
+#include "video_core/debug_utils/debug_utils.h"
+#include "video_core/renderer_null/renderer_null.h"
+#include "video_core/video_core.h"
+
+void RendererNull::SwapBuffers() {
+    Core::System::GetInstance().perf_stats.EndSystemFrame();
+    Core::System::GetInstance().frame_skipper.EndFrame(Core::System::GetInstance().perf_stats);
+
+    render_window->PollEvents();
+
+    Core::System::GetInstance().perf_stats.BeginSystemFrame();
+
+    RefreshRasterizerSetting();
+
+    if (Pica::g_debug_context && Pica::g_debug_context->recorder) {
+        Pica::g_debug_context->recorder->FrameFinished();
+    }
+}
+
+void RendererNull::SetWindow(EmuWindow* window) {
+    render_window = window;
+}
+
+bool RendererNull::Init() {
+    if (VideoCore::g_hw_renderer_enabled) {
+        LOG_ERROR(Render, "The null renderer can't use the hardware rasterizer");
+        return false;
+    }
+
+    RefreshRasterizerSetting();
+
+    return true;
+}
+
+void RendererNull::ShutDown() {}
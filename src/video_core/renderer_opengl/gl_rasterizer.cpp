@@ -13,6 +13,7 @@
 #include "common/math_util.h"
 #include "common/microprofile.h"
 #include "common/vector_math.h"
+#include "core/core.h"
 #include "core/hw/gpu.h"
 #include "video_core/pica_state.h"
 #include "video_core/regs_framebuffer.h"
@@ -51,16 +52,7 @@ RasterizerOpenGL::RasterizerOpenGL() : shader_dirty(true) {
     glBindBufferBase(GL_UNIFORM_BUFFER, 0, uniform_buffer.handle);
 
     uniform_block_data.dirty = true;
-
-    uniform_block_data.lut_dirty.fill(true);
-
-    uniform_block_data.fog_lut_dirty = true;
-
-    uniform_block_data.proctex_noise_lut_dirty = true;
-    uniform_block_data.proctex_color_map_dirty = true;
-    uniform_block_data.proctex_alpha_map_dirty = true;
-    uniform_block_data.proctex_lut_dirty = true;
-    uniform_block_data.proctex_diff_lut_dirty = true;
+    InvalidateLookupTables();
 
     // Set vertex attributes
     glVertexAttribPointer(GLShader::ATTRIBUTE_POSITION, 4, GL_FLOAT, GL_FALSE,
@@ -221,9 +213,14 @@ void RasterizerOpenGL::AddTriangle(const Pica::Shader::OutputVertex& v0,
 void RasterizerOpenGL::DrawTriangles() {
     if (vertex_batch.empty())
         return;
+    const auto& regs = Pica::g_state.regs;
+    if (Core::System::GetInstance().frame_skipper.IsSkippingDraw(
+            regs.framebuffer.framebuffer.GetColorBufferPhysicalAddress())) {
+        vertex_batch.clear();
+        return;
+    }
 
     MICROPROFILE_SCOPE(OpenGL_Drawing);
-    const auto& regs = Pica::g_state.regs;
 
     // Sync and bind the framebuffer surfaces
     CachedSurface* color_surface;
@@ -232,6 +229,15 @@ void RasterizerOpenGL::DrawTriangles() {
     std::tie(color_surface, depth_surface, rect) =
         res_cache.GetFramebufferSurfaces(regs.framebuffer.framebuffer);
 
+    // Once rendering moves on to another color buffer, the previous one is typically about to be
+    // consumed by a display transfer. If it was read back before, start reading it back again
+    // before the CPU asks for it. Render targets never read back don't cost a readback.
+    if (color_surface != nullptr && color_surface->addr != last_color_buffer_addr) {
+        res_cache.BeginRegionDownload(last_color_buffer_addr, last_color_buffer_size);
+        last_color_buffer_addr = color_surface->addr;
+        last_color_buffer_size = color_surface->size;
+    }
+
     state.draw.draw_framebuffer = framebuffer.handle;
     state.Apply();
 
@@ -388,11 +394,11 @@ void RasterizerOpenGL::DrawTriangles() {
     // Mark framebuffer surfaces as dirty
     // TODO: Restrict invalidation area to the viewport
     if (color_surface != nullptr) {
-        color_surface->dirty = true;
+        color_surface->MarkDirty();
         res_cache.FlushRegion(color_surface->addr, color_surface->size, color_surface, true);
     }
     if (depth_surface != nullptr) {
-        depth_surface->dirty = true;
+        depth_surface->MarkDirty();
         res_cache.FlushRegion(depth_surface->addr, depth_surface->size, depth_surface, true);
     }
 
@@ -884,6 +890,18 @@ void RasterizerOpenGL::NotifyPicaRegisterChanged(u32 id) {
     }
 }
 
+void RasterizerOpenGL::InvalidateLookupTables() {
+    uniform_block_data.lut_dirty.fill(true);
+
+    uniform_block_data.fog_lut_dirty = true;
+
+    uniform_block_data.proctex_noise_lut_dirty = true;
+    uniform_block_data.proctex_color_map_dirty = true;
+    uniform_block_data.proctex_alpha_map_dirty = true;
+    uniform_block_data.proctex_lut_dirty = true;
+    uniform_block_data.proctex_diff_lut_dirty = true;
+}
+
 void RasterizerOpenGL::FlushAll() {
     MICROPROFILE_SCOPE(OpenGL_CacheManagement);
     res_cache.FlushAll();
@@ -961,7 +979,7 @@ bool RasterizerOpenGL::AccelerateDisplayTransfer(const GPU::Regs::DisplayTransfe
 
     u32 dst_size = dst_params.width * dst_params.height *
                    CachedSurface::GetFormatBpp(dst_params.pixel_format) / 8;
-    dst_surface->dirty = true;
+    dst_surface->MarkDirty();
     res_cache.FlushRegion(config.GetPhysicalOutputAddress(), dst_size, dst_surface, true);
     return true;
 }
@@ -1110,7 +1128,7 @@ bool RasterizerOpenGL::AccelerateFill(const GPU::Regs::MemoryFillConfig& config)
     // TODO: Return scissor test to previous value when scissor test is implemented
     cur_state.Apply();
 
-    dst_surface->dirty = true;
+    dst_surface->MarkDirty();
     res_cache.FlushRegion(dst_surface->addr, dst_surface->size, dst_surface, true);
     return true;
 }
@@ -41,6 +41,7 @@ public:
                      const Pica::Shader::OutputVertex& v2) override;
     void DrawTriangles() override;
     void NotifyPicaRegisterChanged(u32 id) override;
+    void InvalidateLookupTables() override;
     void FlushAll() override;
     void FlushRegion(PAddr addr, u32 size) override;
     void FlushAndInvalidateRegion(PAddr addr, u32 size) override;
@@ -262,6 +263,10 @@ private:
 
     RasterizerCacheOpenGL res_cache;
 
+    /// Region of the color buffer targeted by the previous draw
+    PAddr last_color_buffer_addr = 0;
+    u32 last_color_buffer_size = 0;
+
     std::vector<HardwareVertex> vertex_batch;
 
     std::unordered_map<GLShader::PicaShaderConfig, std::unique_ptr<PicaShader>> shader_cache;
@@ -6,15 +6,18 @@
 #include <atomic>
 #include <cstring>
 #include <iterator>
+#include <tuple>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 #include <glad/glad.h>
+#include "common/alignment.h"
 #include "common/bit_field.h"
 #include "common/logging/log.h"
 #include "common/math_util.h"
 #include "common/microprofile.h"
 #include "common/vector_math.h"
+#include "core/core.h"
 #include "core/frontend/emu_window.h"
 #include "core/memory.h"
 #include "core/settings.h"
@@ -49,58 +52,72 @@ static const std::array<FormatTuple, 4> depth_format_tuples = {{
 RasterizerCacheOpenGL::RasterizerCacheOpenGL() {
     transfer_framebuffers[0].Create();
     transfer_framebuffers[1].Create();
+
+    upload_buffer.Create();
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, upload_buffer.handle);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, UPLOAD_BUFFER_SIZE, nullptr, GL_STREAM_DRAW);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
 }
 
 RasterizerCacheOpenGL::~RasterizerCacheOpenGL() {
     FlushAll();
 }
 
+template <bool morton_to_gl>
+static void MortonCopyPixelsImpl(u32 bytes_per_pixel, u32 gl_bytes_per_pixel, u32 width,
+                                 u32 height, u8* morton_data, u8* gl_data) {
+    using VideoCore::MortonCopyImage;
+
+    switch (bytes_per_pixel * 8 + gl_bytes_per_pixel) {
+    case 1 * 8 + 1:
+        return MortonCopyImage<1, 1, morton_to_gl>(width, height, morton_data, gl_data);
+    case 2 * 8 + 2:
+        return MortonCopyImage<2, 2, morton_to_gl>(width, height, morton_data, gl_data);
+    case 3 * 8 + 3:
+        return MortonCopyImage<3, 3, morton_to_gl>(width, height, morton_data, gl_data);
+    case 3 * 8 + 4:
+        return MortonCopyImage<3, 4, morton_to_gl>(width, height, morton_data, gl_data);
+    case 4 * 8 + 4:
+        return MortonCopyImage<4, 4, morton_to_gl>(width, height, morton_data, gl_data);
+    default:
+        UNREACHABLE_MSG("Unsupported pixel sizes %u -> %u", bytes_per_pixel, gl_bytes_per_pixel);
+    }
+}
+
 static void MortonCopyPixels(CachedSurface::PixelFormat pixel_format, u32 width, u32 height,
                              u32 bytes_per_pixel, u32 gl_bytes_per_pixel, u8* morton_data,
                              u8* gl_data, bool morton_to_gl) {
     using PixelFormat = CachedSurface::PixelFormat;
 
-    u8* data_ptrs[2];
-    u32 depth_stencil_shifts[2] = {24, 8};
-
-    if (morton_to_gl) {
-        std::swap(depth_stencil_shifts[0], depth_stencil_shifts[1]);
-    }
-
     if (pixel_format == PixelFormat::D24S8) {
-        for (unsigned y = 0; y < height; ++y) {
-            for (unsigned x = 0; x < width; ++x) {
-                const u32 coarse_y = y & ~7;
-                u32 morton_offset = VideoCore::GetMortonOffset(x, y, bytes_per_pixel) +
-                                    coarse_y * width * bytes_per_pixel;
-                u32 gl_pixel_index = (x + (height - 1 - y) * width) * gl_bytes_per_pixel;
-
-                data_ptrs[morton_to_gl] = morton_data + morton_offset;
-                data_ptrs[!morton_to_gl] = &gl_data[gl_pixel_index];
-
-                // Swap depth and stencil value ordering since 3DS does not match OpenGL
-                u32 depth_stencil;
-                memcpy(&depth_stencil, data_ptrs[1], sizeof(u32));
-                depth_stencil = (depth_stencil << depth_stencil_shifts[0]) |
-                                (depth_stencil >> depth_stencil_shifts[1]);
-
-                memcpy(data_ptrs[0], &depth_stencil, sizeof(u32));
+        // Swap depth and stencil value ordering since 3DS does not match OpenGL
+        const u32 shift = morton_to_gl ? 8 : 24;
+        u8* tile = morton_data;
+        for (u32 y = 0; y < height; y += 8) {
+            for (u32 x = 0; x < width; x += 8, tile += 8 * 8 * sizeof(u32)) {
+                for (u32 fine_y = 0; fine_y < 8; ++fine_y) {
+                    u8* gl_line = gl_data + (height - 1 - (y + fine_y)) * width * sizeof(u32);
+                    for (u32 fine_x = 0; fine_x < 8; ++fine_x) {
+                        u8* morton_pixel =
+                            tile + VideoCore::MortonInterleave(fine_x, fine_y) * sizeof(u32);
+                        u8* gl_pixel = gl_line + (x + fine_x) * sizeof(u32);
+
+                        u32 depth_stencil;
+                        std::memcpy(&depth_stencil, morton_to_gl ? morton_pixel : gl_pixel,
+                                    sizeof(u32));
+                        depth_stencil = (depth_stencil << shift) | (depth_stencil >> (32 - shift));
+                        std::memcpy(morton_to_gl ? gl_pixel : morton_pixel, &depth_stencil,
+                                    sizeof(u32));
+                    }
+                }
             }
         }
+    } else if (morton_to_gl) {
+        MortonCopyPixelsImpl<true>(bytes_per_pixel, gl_bytes_per_pixel, width, height,
+                                   morton_data, gl_data);
     } else {
-        for (unsigned y = 0; y < height; ++y) {
-            for (unsigned x = 0; x < width; ++x) {
-                const u32 coarse_y = y & ~7;
-                u32 morton_offset = VideoCore::GetMortonOffset(x, y, bytes_per_pixel) +
-                                    coarse_y * width * bytes_per_pixel;
-                u32 gl_pixel_index = (x + (height - 1 - y) * width) * gl_bytes_per_pixel;
-
-                data_ptrs[morton_to_gl] = morton_data + morton_offset;
-                data_ptrs[!morton_to_gl] = &gl_data[gl_pixel_index];
-
-                memcpy(data_ptrs[0], data_ptrs[1], bytes_per_pixel);
-            }
-        }
+        MortonCopyPixelsImpl<false>(bytes_per_pixel, gl_bytes_per_pixel, width, height,
+                                    morton_data, gl_data);
     }
 }
 
@@ -224,6 +241,33 @@ static void AllocateSurfaceTexture(GLuint texture, CachedSurface::PixelFormat pi
     cur_state.Apply();
 }
 
+std::pair<u8*, GLintptr> RasterizerCacheOpenGL::MapUploadBuffer(GLsizeiptr size) {
+    ASSERT(size <= UPLOAD_BUFFER_SIZE);
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, upload_buffer.handle);
+
+    GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+    if (upload_buffer_pos + size > UPLOAD_BUFFER_SIZE) {
+        // Wrap around by orphaning the old storage; uploads still reading from it are unaffected
+        access |= GL_MAP_INVALIDATE_BUFFER_BIT;
+        upload_buffer_pos = 0;
+    } else {
+        access |= GL_MAP_INVALIDATE_RANGE_BIT;
+    }
+
+    GLintptr offset = upload_buffer_pos;
+    u8* data = static_cast<u8*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, offset, size, access));
+
+    // Keep the next upload suitably aligned for any pixel type
+    upload_buffer_pos = Common::AlignUp(static_cast<size_t>(offset + size), 256);
+
+    return {data, offset};
+}
+
+void RasterizerCacheOpenGL::UnmapUploadBuffer() {
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+}
+
 MICROPROFILE_DEFINE(OpenGL_SurfaceUpload, "OpenGL", "Surface Upload", MP_RGB(128, 64, 192));
 CachedSurface* RasterizerCacheOpenGL::GetSurface(const CachedSurface& params, bool match_res_scale,
                                                  bool load_if_create) {
@@ -329,16 +373,28 @@ CachedSurface* RasterizerCacheOpenGL::GetSurface(const CachedSurface& params, bo
             glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
         } else {
             SurfaceType type = CachedSurface::GetFormatType(new_surface->pixel_format);
-            if (type != SurfaceType::Depth && type != SurfaceType::DepthStencil) {
-                FormatTuple tuple;
-                if ((size_t)params.pixel_format < fb_format_tuples.size()) {
-                    tuple = fb_format_tuples[(unsigned int)params.pixel_format];
-                } else {
-                    // Texture
-                    tuple = {GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE};
-                }
+            if (type == SurfaceType::Color) {
+                // Internal OpenGL color formats are consistent so no conversion is necessary
+                const FormatTuple& tuple = fb_format_tuples[(unsigned int)params.pixel_format];
+                u32 bytes_per_pixel = CachedSurface::GetFormatBpp(params.pixel_format) / 8;
+
+                u8* upload_data;
+                GLintptr upload_offset;
+                std::tie(upload_data, upload_offset) =
+                    MapUploadBuffer(params.width * params.height * bytes_per_pixel);
 
-                std::vector<Math::Vec4<u8>> tex_buffer(params.width * params.height);
+                MortonCopyPixels(params.pixel_format, params.width, params.height, bytes_per_pixel,
+                                 bytes_per_pixel, texture_src_data, upload_data, true);
+
+                UnmapUploadBuffer();
+                glTexImage2D(GL_TEXTURE_2D, 0, tuple.internal_format, params.width, params.height,
+                             0, tuple.format, tuple.type, reinterpret_cast<void*>(upload_offset));
+                glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            } else if (type == SurfaceType::Texture) {
+                u8* upload_data;
+                GLintptr upload_offset;
+                std::tie(upload_data, upload_offset) =
+                    MapUploadBuffer(params.width * params.height * sizeof(Math::Vec4<u8>));
 
                 Pica::Texture::TextureInfo tex_info;
                 tex_info.width = params.width;
@@ -347,15 +403,29 @@ CachedSurface* RasterizerCacheOpenGL::GetSurface(const CachedSurface& params, bo
                 tex_info.SetDefaultStride();
                 tex_info.physical_address = params.addr;
 
-                for (unsigned y = 0; y < params.height; ++y) {
-                    for (unsigned x = 0; x < params.width; ++x) {
-                        tex_buffer[x + params.width * y] = Pica::Texture::LookupTexture(
-                            texture_src_data, x, params.height - 1 - y, tex_info);
+                // Decode one tile at a time so that the tile address is only computed once
+                const size_t tile_size = Pica::Texture::CalculateTileSize(tex_info.format);
+                for (unsigned y = 0; y < params.height; y += 8) {
+                    const u8* tile = texture_src_data + (y / 8) * tex_info.stride;
+                    for (unsigned x = 0; x < params.width; x += 8, tile += tile_size) {
+                        for (unsigned fine_y = 0; fine_y < 8; ++fine_y) {
+                            // OpenGL expects the lowest line first
+                            unsigned gl_y = params.height - 1 - (y + fine_y);
+                            for (unsigned fine_x = 0; fine_x < 8; ++fine_x) {
+                                Math::Vec4<u8> texel = Pica::Texture::LookupTexelInTile(
+                                    tile, fine_x, fine_y, tex_info, false);
+                                std::memcpy(upload_data +
+                                                (x + fine_x + params.width * gl_y) * sizeof(texel),
+                                            &texel, sizeof(texel));
+                            }
+                        }
                     }
                 }
 
-                glTexImage2D(GL_TEXTURE_2D, 0, tuple.internal_format, params.width, params.height,
-                             0, GL_RGBA, GL_UNSIGNED_BYTE, tex_buffer.data());
+                UnmapUploadBuffer();
+                glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, params.width, params.height, 0, GL_RGBA,
+                             GL_UNSIGNED_BYTE, reinterpret_cast<void*>(upload_offset));
+                glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
             } else {
                 // Depth/Stencil formats need special treatment since they aren't sampleable using
                 // LookupTexture and can't use RGBA format
@@ -370,18 +440,24 @@ CachedSurface* RasterizerCacheOpenGL::GetSurface(const CachedSurface& params, bo
 
                 u32 gl_bytes_per_pixel = use_4bpp ? 4 : bytes_per_pixel;
 
-                std::vector<u8> temp_fb_depth_buffer(params.width * params.height *
-                                                     gl_bytes_per_pixel);
-
-                u8* temp_fb_depth_buffer_ptr =
-                    use_4bpp ? temp_fb_depth_buffer.data() + 1 : temp_fb_depth_buffer.data();
+                u8* upload_data;
+                GLintptr upload_offset;
+                std::tie(upload_data, upload_offset) =
+                    MapUploadBuffer(params.width * params.height * gl_bytes_per_pixel);
+                if (use_4bpp) {
+                    // Only the upper 3 bytes of each texel are copied, and the buffer is mapped
+                    // with its previous contents invalidated, so the low byte must be zeroed
+                    std::memset(upload_data, 0, params.width * params.height * gl_bytes_per_pixel);
+                }
 
                 MortonCopyPixels(params.pixel_format, params.width, params.height, bytes_per_pixel,
-                                 gl_bytes_per_pixel, texture_src_data, temp_fb_depth_buffer_ptr,
-                                 true);
+                                 gl_bytes_per_pixel, texture_src_data,
+                                 use_4bpp ? upload_data + 1 : upload_data, true);
 
+                UnmapUploadBuffer();
                 glTexImage2D(GL_TEXTURE_2D, 0, tuple.internal_format, params.width, params.height,
-                             0, tuple.format, tuple.type, temp_fb_depth_buffer.data());
+                             0, tuple.format, tuple.type, reinterpret_cast<void*>(upload_offset));
+                glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
             }
         }
 
@@ -660,22 +736,43 @@ CachedSurface* RasterizerCacheOpenGL::TryGetFillSurface(const GPU::Regs::MemoryF
     return nullptr;
 }
 
-MICROPROFILE_DEFINE(OpenGL_SurfaceDownload, "OpenGL", "Surface Download", MP_RGB(128, 192, 64));
-void RasterizerCacheOpenGL::FlushSurface(CachedSurface* surface) {
+/// Returns the format tuple used to read back a surface and the size of each pixel as returned by
+/// OpenGL
+static std::pair<const FormatTuple&, u32> GetDownloadFormat(CachedSurface::PixelFormat format) {
     using PixelFormat = CachedSurface::PixelFormat;
     using SurfaceType = CachedSurface::SurfaceType;
 
-    if (!surface->dirty) {
-        return;
+    SurfaceType type = CachedSurface::GetFormatType(format);
+    u32 bytes_per_pixel = CachedSurface::GetFormatBpp(format) / 8;
+
+    if (type != SurfaceType::Depth && type != SurfaceType::DepthStencil) {
+        // TODO: Ensure this will always be a color format, not a depth or other format
+        ASSERT((size_t)format < fb_format_tuples.size());
+        return {fb_format_tuples[(unsigned int)format], bytes_per_pixel};
     }
 
-    MICROPROFILE_SCOPE(OpenGL_SurfaceDownload);
+    // Depth/Stencil formats need special treatment since they aren't sampleable using
+    // LookupTexture and can't use RGBA format
+    size_t tuple_idx = (size_t)format - 14;
+    ASSERT(tuple_idx < depth_format_tuples.size());
 
-    u8* dst_buffer = Memory::GetPhysicalPointer(surface->addr);
-    if (dst_buffer == nullptr) {
+    // OpenGL needs 4 bpp alignment for D24 since using GL_UNSIGNED_INT as type
+    bool use_4bpp = (format == PixelFormat::D24);
+    return {depth_format_tuples[tuple_idx], use_4bpp ? 4 : bytes_per_pixel};
+}
+
+MICROPROFILE_DEFINE(OpenGL_SurfaceDownload, "OpenGL", "Surface Download", MP_RGB(128, 192, 64));
+void RasterizerCacheOpenGL::BeginSurfaceDownload(CachedSurface* surface) {
+    if (!surface->dirty || surface->download_pending) {
+        return;
+    }
+
+    if (Memory::GetPhysicalPointer(surface->addr) == nullptr) {
         return;
     }
 
+    MICROPROFILE_SCOPE(OpenGL_SurfaceDownload);
+
     OpenGLState cur_state = OpenGLState::GetCurState();
     GLuint old_tex = cur_state.texture_units[0].texture_2d;
 
@@ -701,61 +798,128 @@ void RasterizerCacheOpenGL::FlushSurface(CachedSurface* surface) {
     cur_state.Apply();
     glActiveTexture(GL_TEXTURE0);
 
-    if (!surface->is_tiled) {
-        // TODO: Ensure this will always be a color format, not a depth or other format
-        ASSERT((size_t)surface->pixel_format < fb_format_tuples.size());
-        const FormatTuple& tuple = fb_format_tuples[(unsigned int)surface->pixel_format];
+    const auto download_format = GetDownloadFormat(surface->pixel_format);
+    const FormatTuple& tuple = download_format.first;
+    u32 gl_bytes_per_pixel = download_format.second;
 
-        glPixelStorei(GL_PACK_ROW_LENGTH, (GLint)surface->pixel_stride);
-        glGetTexImage(GL_TEXTURE_2D, 0, tuple.format, tuple.type, dst_buffer);
-        glPixelStorei(GL_PACK_ROW_LENGTH, 0);
-    } else {
-        SurfaceType type = CachedSurface::GetFormatType(surface->pixel_format);
-        if (type != SurfaceType::Depth && type != SurfaceType::DepthStencil) {
-            ASSERT((size_t)surface->pixel_format < fb_format_tuples.size());
-            const FormatTuple& tuple = fb_format_tuples[(unsigned int)surface->pixel_format];
+    // Linear surfaces are read back with the stride of the emulated image, so that each line can
+    // later be copied to its final location
+    u32 row_length = surface->is_tiled || surface->pixel_stride == 0 ? surface->width
+                                                                      : surface->pixel_stride;
 
-            u32 bytes_per_pixel = CachedSurface::GetFormatBpp(surface->pixel_format) / 8;
+    surface->download_buffer.Create();
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, surface->download_buffer.handle);
+    glBufferData(GL_PIXEL_PACK_BUFFER, row_length * surface->height * gl_bytes_per_pixel, nullptr,
+                 GL_STREAM_READ);
 
-            std::vector<u8> temp_gl_buffer(surface->width * surface->height * bytes_per_pixel);
+    glPixelStorei(GL_PACK_ROW_LENGTH, (GLint)row_length);
+    glGetTexImage(GL_TEXTURE_2D, 0, tuple.format, tuple.type, nullptr);
+    glPixelStorei(GL_PACK_ROW_LENGTH, 0);
 
-            glGetTexImage(GL_TEXTURE_2D, 0, tuple.format, tuple.type, temp_gl_buffer.data());
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
 
-            // Directly copy pixels. Internal OpenGL color formats are consistent so no conversion
-            // is necessary.
-            MortonCopyPixels(surface->pixel_format, surface->width, surface->height,
-                             bytes_per_pixel, bytes_per_pixel, dst_buffer, temp_gl_buffer.data(),
-                             false);
-        } else {
-            // Depth/Stencil formats need special treatment since they aren't sampleable using
-            // LookupTexture and can't use RGBA format
-            size_t tuple_idx = (size_t)surface->pixel_format - 14;
-            ASSERT(tuple_idx < depth_format_tuples.size());
-            const FormatTuple& tuple = depth_format_tuples[tuple_idx];
+    surface->download_fence.Release();
+    surface->download_fence.Create();
+    surface->download_pending = true;
 
-            u32 bytes_per_pixel = CachedSurface::GetFormatBpp(surface->pixel_format) / 8;
+    cur_state.texture_units[0].texture_2d = old_tex;
+    cur_state.Apply();
+}
 
-            // OpenGL needs 4 bpp alignment for D24 since using GL_UNSIGNED_INT as type
-            bool use_4bpp = (surface->pixel_format == PixelFormat::D24);
+void RasterizerCacheOpenGL::BeginRegionDownload(PAddr addr, u32 size) {
+    if (size == 0) {
+        return;
+    }
 
-            u32 gl_bytes_per_pixel = use_4bpp ? 4 : bytes_per_pixel;
+    auto surface_interval = boost::icl::interval<PAddr>::right_open(addr, addr + size);
+    auto cache_upper_bound = surface_cache.upper_bound(surface_interval);
+    for (auto it = surface_cache.lower_bound(surface_interval); it != cache_upper_bound; ++it) {
+        for (auto& surface : it->second) {
+            if (surface->downloaded_before) {
+                BeginSurfaceDownload(surface.get());
+            }
+        }
+    }
+}
 
-            std::vector<u8> temp_gl_buffer(surface->width * surface->height * gl_bytes_per_pixel);
+MICROPROFILE_DEFINE(OpenGL_SurfaceDownloadStall, "OpenGL", "Surface Download Stall",
+                    MP_RGB(192, 64, 64));
+void RasterizerCacheOpenGL::FlushSurface(CachedSurface* surface) {
+    using PixelFormat = CachedSurface::PixelFormat;
 
-            glGetTexImage(GL_TEXTURE_2D, 0, tuple.format, tuple.type, temp_gl_buffer.data());
+    if (!surface->dirty) {
+        return;
+    }
 
-            u8* temp_gl_buffer_ptr = use_4bpp ? temp_gl_buffer.data() + 1 : temp_gl_buffer.data();
+    u8* dst_buffer = Memory::GetPhysicalPointer(surface->addr);
+    if (dst_buffer == nullptr) {
+        return;
+    }
+    Memory::NotifyHostWrite(dst_buffer, surface->size);
+
+    const bool started_early = surface->download_pending;
+    if (!started_early) {
+        BeginSurfaceDownload(surface);
+    }
+
+    MICROPROFILE_SCOPE(OpenGL_SurfaceDownload);
+
+    // Wait for the readback to land in the pack buffer, accounting the time spent blocked
+    {
+        MICROPROFILE_SCOPE(OpenGL_SurfaceDownloadStall);
+        const auto stall_begin = Core::PerfStats::Clock::now();
+
+        GLenum wait_result;
+        do {
+            wait_result = glClientWaitSync(surface->download_fence.handle,
+                                           GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+        } while (wait_result == GL_TIMEOUT_EXPIRED);
+        ASSERT(wait_result != GL_WAIT_FAILED);
+
+        Core::System::GetInstance().perf_stats.AddSurfaceDownload(
+            started_early, Core::PerfStats::Clock::now() - stall_begin);
+    }
 
-            MortonCopyPixels(surface->pixel_format, surface->width, surface->height,
-                             bytes_per_pixel, gl_bytes_per_pixel, dst_buffer, temp_gl_buffer_ptr,
-                             false);
+    const u32 gl_bytes_per_pixel = GetDownloadFormat(surface->pixel_format).second;
+    const u32 bytes_per_pixel = CachedSurface::GetFormatBpp(surface->pixel_format) / 8;
+    const u32 row_length = surface->is_tiled || surface->pixel_stride == 0 ? surface->width
+                                                                            : surface->pixel_stride;
+    const u32 buffer_size = row_length * surface->height * gl_bytes_per_pixel;
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, surface->download_buffer.handle);
+    u8* gl_buffer =
+        static_cast<u8*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, buffer_size, GL_MAP_READ_BIT));
+
+    // Internal OpenGL color formats are consistent so no conversion is necessary. D24 is read as
+    // 32-bit values, of which only the upper three bytes are kept.
+    u8* gl_buffer_ptr = (surface->pixel_format == PixelFormat::D24) ? gl_buffer + 1 : gl_buffer;
+
+    if (!surface->is_tiled) {
+        // Only copy the visible part of each line, leaving the padding up to the stride untouched
+        for (u32 y = 0; y < surface->height; ++y) {
+            u8* dst_line = dst_buffer + y * row_length * bytes_per_pixel;
+            const u8* gl_line = gl_buffer_ptr + y * row_length * gl_bytes_per_pixel;
+            if (gl_bytes_per_pixel == bytes_per_pixel) {
+                std::memcpy(dst_line, gl_line, surface->width * bytes_per_pixel);
+                continue;
+            }
+            for (u32 x = 0; x < surface->width; ++x) {
+                std::memcpy(dst_line + x * bytes_per_pixel, gl_line + x * gl_bytes_per_pixel,
+                            bytes_per_pixel);
+            }
         }
+    } else {
+        MortonCopyPixels(surface->pixel_format, surface->width, surface->height, bytes_per_pixel,
+                         gl_bytes_per_pixel, dst_buffer, gl_buffer_ptr, false);
     }
 
-    surface->dirty = false;
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
 
-    cur_state.texture_units[0].texture_2d = old_tex;
-    cur_state.Apply();
+    surface->download_fence.Release();
+    surface->download_pending = false;
+    surface->downloaded_before = true;
+    surface->dirty = false;
 }
 
 void RasterizerCacheOpenGL::FlushRegion(PAddr addr, u32 size, const CachedSurface* skip_surface,
@@ -8,6 +8,7 @@
 #include <memory>
 #include <set>
 #include <tuple>
+#include <utility>
 #ifdef __GNUC__
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-local-typedefs"
@@ -162,6 +163,12 @@ struct CachedSurface {
         return SurfaceType::Invalid;
     }
 
+    /// Marks the surface as modified on the GPU, discarding any readback that is still in flight
+    void MarkDirty() {
+        dirty = true;
+        download_pending = false;
+    }
+
     u32 GetScaledWidth() const {
         return (u32)(width * res_scale_width);
     }
@@ -187,6 +194,16 @@ struct CachedSurface {
     bool is_tiled;
     PixelFormat pixel_format;
     bool dirty;
+
+    /// Pixel pack buffer receiving an asynchronous readback of the texture
+    OGLBuffer download_buffer;
+    /// Fence signalled once the readback into download_buffer has completed
+    OGLSync download_fence;
+    /// True if download_buffer holds (or will hold) the current contents of the texture
+    bool download_pending = false;
+    /// True if the surface was written back to memory before. Such surfaces are likely to be read
+    /// back again, so their readbacks are worth starting ahead of time.
+    bool downloaded_before = false;
 };
 
 class RasterizerCacheOpenGL : NonCopyable {
@@ -223,6 +240,14 @@ public:
     /// Attempt to get a surface that exactly matches the fill region and format
     CachedSurface* TryGetFillSurface(const GPU::Regs::MemoryFillConfig& config);
 
+    /// Start reading the surface back from the GPU without waiting for the result. The data is
+    /// written to memory by the next FlushSurface call on the surface.
+    void BeginSurfaceDownload(CachedSurface* surface);
+
+    /// Start asynchronous readbacks of the dirty surfaces overlapping the region that were written
+    /// back to memory before, as those are likely to be read back again
+    void BeginRegionDownload(PAddr addr, u32 size);
+
     /// Write the surface back to memory
     void FlushSurface(CachedSurface* surface);
 
@@ -234,6 +259,23 @@ public:
     void FlushAll();
 
 private:
+    /// Size of the ring buffer used to stream texture data to the GPU
+    static constexpr GLsizeiptr UPLOAD_BUFFER_SIZE = 16 * 1024 * 1024;
+
+    /**
+     * Maps a region of the upload ring buffer for writing. The buffer is left bound to
+     * GL_PIXEL_UNPACK_BUFFER so the returned offset can be passed as pixel data pointer.
+     * @param size Size of the region in bytes
+     * @returns Pointer to the mapped region and its offset within the buffer
+     */
+    std::pair<u8*, GLintptr> MapUploadBuffer(GLsizeiptr size);
+
+    /// Unmaps the region mapped by MapUploadBuffer, making it available to OpenGL
+    void UnmapUploadBuffer();
+
     SurfaceCache surface_cache;
+
+    OGLBuffer upload_buffer;
+    GLintptr upload_buffer_pos = 0;
     OGLFramebuffer transfer_framebuffers[2];
 };
@@ -140,12 +140,18 @@ void RendererOpenGL::SwapBuffers() {
     DrawScreens();
 
     Core::System::GetInstance().perf_stats.EndSystemFrame();
+    Core::System::GetInstance().frame_skipper.EndFrame(Core::System::GetInstance().perf_stats);
 
     // Swap buffers
     render_window->PollEvents();
     render_window->SwapBuffers();
 
-    Core::System::GetInstance().frame_limiter.DoFrameLimiting(CoreTiming::GetGlobalTimeUs());
+    if (Settings::values.use_vsync) {
+        Core::System::GetInstance().frame_limiter.AddVSyncTimestamp(
+            Core::FrameLimiter::Clock::now());
+    }
+    Core::System::GetInstance().frame_limiter.DoFrameLimiting(
+        CoreTiming::GetGlobalTimeUs(), Core::System::GetInstance().perf_stats);
     Core::System::GetInstance().perf_stats.BeginSystemFrame();
 
     prev_state.Apply();
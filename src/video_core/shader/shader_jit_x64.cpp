@@ -4,6 +4,7 @@
 
 #include "common/hash.h"
 #include "common/microprofile.h"
+#include "common/perf_counters.h"
 #include "video_core/shader/shader.h"
 #include "video_core/shader/shader_jit_x64.h"
 #include "video_core/shader/shader_jit_x64_compiler.h"
@@ -39,6 +40,7 @@ void JitX64Engine::Run(const ShaderSetup& setup, UnitState& state) const {
     ASSERT(setup.engine_data.cached_shader != nullptr);
 
     MICROPROFILE_SCOPE(GPU_Shader);
+    PERF_COUNTERS_SCOPE(GPU_Shader);
 
     const JitShader* shader = static_cast<const JitShader*>(setup.engine_data.cached_shader);
     shader->Run(setup, state, setup.engine_data.entry_point);
@@ -20,203 +20,240 @@
 namespace Pica {
 namespace Rasterizer {
 
-void DrawPixel(int x, int y, const Math::Vec4<u8>& color) {
-    const auto& framebuffer = g_state.regs.framebuffer.framebuffer;
-    const PAddr addr = framebuffer.GetColorBufferPhysicalAddress();
-
-    // Similarly to textures, the render framebuffer is laid out from bottom to top, too.
-    // NOTE: The framebuffer height register contains the actual FB height minus one.
-    y = framebuffer.height - y;
-
-    const u32 coarse_y = y & ~7;
-    u32 bytes_per_pixel =
-        GPU::Regs::BytesPerPixel(GPU::Regs::PixelFormat(framebuffer.color_format.Value()));
-    u32 dst_offset = VideoCore::GetMortonOffset(x, y, bytes_per_pixel) +
-                     coarse_y * framebuffer.width * bytes_per_pixel;
-    u8* dst_pixel = Memory::GetPhysicalPointer(addr) + dst_offset;
+template <FramebufferRegs::ColorFormat format>
+static Math::Vec4<u8> DecodeColor(const u8* bytes) {
+    switch (format) {
+    case FramebufferRegs::ColorFormat::RGBA8:
+        return Color::DecodeRGBA8(bytes);
+    case FramebufferRegs::ColorFormat::RGB8:
+        return Color::DecodeRGB8(bytes);
+    case FramebufferRegs::ColorFormat::RGB5A1:
+        return Color::DecodeRGB5A1(bytes);
+    case FramebufferRegs::ColorFormat::RGB565:
+        return Color::DecodeRGB565(bytes);
+    case FramebufferRegs::ColorFormat::RGBA4:
+        return Color::DecodeRGBA4(bytes);
+    }
+    return {0, 0, 0, 0};
+}
 
-    switch (framebuffer.color_format) {
+template <FramebufferRegs::ColorFormat format>
+static void EncodeColor(const Math::Vec4<u8>& color, u8* bytes) {
+    switch (format) {
     case FramebufferRegs::ColorFormat::RGBA8:
-        Color::EncodeRGBA8(color, dst_pixel);
+        Color::EncodeRGBA8(color, bytes);
         break;
-
     case FramebufferRegs::ColorFormat::RGB8:
-        Color::EncodeRGB8(color, dst_pixel);
+        Color::EncodeRGB8(color, bytes);
         break;
-
     case FramebufferRegs::ColorFormat::RGB5A1:
-        Color::EncodeRGB5A1(color, dst_pixel);
+        Color::EncodeRGB5A1(color, bytes);
         break;
-
     case FramebufferRegs::ColorFormat::RGB565:
-        Color::EncodeRGB565(color, dst_pixel);
+        Color::EncodeRGB565(color, bytes);
         break;
-
     case FramebufferRegs::ColorFormat::RGBA4:
-        Color::EncodeRGBA4(color, dst_pixel);
+        Color::EncodeRGBA4(color, bytes);
         break;
-
-    default:
-        LOG_CRITICAL(Render_Software, "Unknown framebuffer color format %x",
-                     framebuffer.color_format.Value());
-        UNIMPLEMENTED();
     }
 }
 
-const Math::Vec4<u8> GetPixel(int x, int y) {
-    const auto& framebuffer = g_state.regs.framebuffer.framebuffer;
-    const PAddr addr = framebuffer.GetColorBufferPhysicalAddress();
+template <FramebufferRegs::DepthFormat format>
+static u32 DecodeDepth(const u8* bytes) {
+    switch (format) {
+    case FramebufferRegs::DepthFormat::D16:
+        return Color::DecodeD16(bytes);
+    case FramebufferRegs::DepthFormat::D24:
+        return Color::DecodeD24(bytes);
+    case FramebufferRegs::DepthFormat::D24S8:
+        return Color::DecodeD24S8(bytes).x;
+    }
+    return 0;
+}
 
-    y = framebuffer.height - y;
+template <FramebufferRegs::DepthFormat format>
+static void EncodeDepth(u32 value, u8* bytes) {
+    switch (format) {
+    case FramebufferRegs::DepthFormat::D16:
+        Color::EncodeD16(value, bytes);
+        break;
+    case FramebufferRegs::DepthFormat::D24:
+        Color::EncodeD24(value, bytes);
+        break;
+    case FramebufferRegs::DepthFormat::D24S8:
+        Color::EncodeD24X8(value, bytes);
+        break;
+    }
+}
 
-    const u32 coarse_y = y & ~7;
-    u32 bytes_per_pixel =
-        GPU::Regs::BytesPerPixel(GPU::Regs::PixelFormat(framebuffer.color_format.Value()));
-    u32 src_offset = VideoCore::GetMortonOffset(x, y, bytes_per_pixel) +
-                     coarse_y * framebuffer.width * bytes_per_pixel;
-    u8* src_pixel = Memory::GetPhysicalPointer(addr) + src_offset;
+// Used for unknown formats, which are only reported once the buffer is actually accessed
 
-    switch (framebuffer.color_format) {
-    case FramebufferRegs::ColorFormat::RGBA8:
-        return Color::DecodeRGBA8(src_pixel);
+static Math::Vec4<u8> DecodeUnknownColor(const u8* bytes) {
+    LOG_CRITICAL(Render_Software, "Unknown framebuffer color format %x",
+                 g_state.regs.framebuffer.framebuffer.color_format.Value());
+    UNIMPLEMENTED();
+    return {0, 0, 0, 0};
+}
 
-    case FramebufferRegs::ColorFormat::RGB8:
-        return Color::DecodeRGB8(src_pixel);
+static void EncodeUnknownColor(const Math::Vec4<u8>& color, u8* bytes) {
+    DecodeUnknownColor(bytes);
+}
 
-    case FramebufferRegs::ColorFormat::RGB5A1:
-        return Color::DecodeRGB5A1(src_pixel);
+static u32 DecodeUnknownDepth(const u8* bytes) {
+    LOG_CRITICAL(HW_GPU, "Unimplemented depth format %u",
+                 g_state.regs.framebuffer.framebuffer.depth_format.Value());
+    UNIMPLEMENTED();
+    return 0;
+}
 
-    case FramebufferRegs::ColorFormat::RGB565:
-        return Color::DecodeRGB565(src_pixel);
+static void EncodeUnknownDepth(u32 value, u8* bytes) {
+    DecodeUnknownDepth(bytes);
+}
 
-    case FramebufferRegs::ColorFormat::RGBA4:
-        return Color::DecodeRGBA4(src_pixel);
+// Used for buffers which aren't bound or mapped, which are likewise only reported once accessed
 
-    default:
-        LOG_CRITICAL(Render_Software, "Unknown framebuffer color format %x",
-                     framebuffer.color_format.Value());
-        UNIMPLEMENTED();
-    }
+static void ReportUnboundBuffer(const char* name) {
+    LOG_CRITICAL(Render_Software, "Accessed the %s buffer, which isn't bound", name);
+    UNIMPLEMENTED();
+}
 
+static Math::Vec4<u8> DecodeUnboundColor(const u8* bytes) {
+    ReportUnboundBuffer("color");
     return {0, 0, 0, 0};
 }
 
-u32 GetDepth(int x, int y) {
-    const auto& framebuffer = g_state.regs.framebuffer.framebuffer;
-    const PAddr addr = framebuffer.GetDepthBufferPhysicalAddress();
-    u8* depth_buffer = Memory::GetPhysicalPointer(addr);
-
-    y = framebuffer.height - y;
-
-    const u32 coarse_y = y & ~7;
-    u32 bytes_per_pixel = FramebufferRegs::BytesPerDepthPixel(framebuffer.depth_format);
-    u32 stride = framebuffer.width * bytes_per_pixel;
-
-    u32 src_offset = VideoCore::GetMortonOffset(x, y, bytes_per_pixel) + coarse_y * stride;
-    u8* src_pixel = depth_buffer + src_offset;
+static void EncodeUnboundColor(const Math::Vec4<u8>& color, u8* bytes) {
+    ReportUnboundBuffer("color");
+}
 
-    switch (framebuffer.depth_format) {
-    case FramebufferRegs::DepthFormat::D16:
-        return Color::DecodeD16(src_pixel);
-    case FramebufferRegs::DepthFormat::D24:
-        return Color::DecodeD24(src_pixel);
-    case FramebufferRegs::DepthFormat::D24S8:
-        return Color::DecodeD24S8(src_pixel).x;
-    default:
-        LOG_CRITICAL(HW_GPU, "Unimplemented depth format %u", framebuffer.depth_format);
-        UNIMPLEMENTED();
-        return 0;
-    }
+static u32 DecodeUnboundDepth(const u8* bytes) {
+    ReportUnboundBuffer("depth");
+    return 0;
 }
 
-u8 GetStencil(int x, int y) {
-    const auto& framebuffer = g_state.regs.framebuffer.framebuffer;
-    const PAddr addr = framebuffer.GetDepthBufferPhysicalAddress();
-    u8* depth_buffer = Memory::GetPhysicalPointer(addr);
+static void EncodeUnboundDepth(u32 value, u8* bytes) {
+    ReportUnboundBuffer("depth");
+}
 
-    y = framebuffer.height - y;
+static u8* GetBufferPointer(PAddr addr) {
+    // Buffers which aren't bound get the accessors above instead of those of their format
+    return addr != 0 ? Memory::GetPhysicalPointer(addr) : nullptr;
+}
 
-    const u32 coarse_y = y & ~7;
-    u32 bytes_per_pixel = Pica::FramebufferRegs::BytesPerDepthPixel(framebuffer.depth_format);
-    u32 stride = framebuffer.width * bytes_per_pixel;
+template <FramebufferRegs::ColorFormat format>
+void FramebufferView::SetColorFormat() {
+    color_bytes_per_pixel = FramebufferRegs::BytesPerColorPixel(format);
+    decode_color = DecodeColor<format>;
+    encode_color = EncodeColor<format>;
+}
 
-    u32 src_offset = VideoCore::GetMortonOffset(x, y, bytes_per_pixel) + coarse_y * stride;
-    u8* src_pixel = depth_buffer + src_offset;
+template <FramebufferRegs::DepthFormat format>
+void FramebufferView::SetDepthFormat() {
+    depth_bytes_per_pixel = FramebufferRegs::BytesPerDepthPixel(format);
+    decode_depth = DecodeDepth<format>;
+    encode_depth = EncodeDepth<format>;
+}
 
-    switch (framebuffer.depth_format) {
-    case FramebufferRegs::DepthFormat::D24S8:
-        return Color::DecodeD24S8(src_pixel).y;
+FramebufferView::FramebufferView(const FramebufferRegs::FramebufferConfig& framebuffer)
+    : height(framebuffer.height), depth_format(framebuffer.depth_format) {
+    using ColorFormat = FramebufferRegs::ColorFormat;
+    using DepthFormat = FramebufferRegs::DepthFormat;
 
+    switch (framebuffer.color_format) {
+    case ColorFormat::RGBA8:
+        SetColorFormat<ColorFormat::RGBA8>();
+        break;
+    case ColorFormat::RGB8:
+        SetColorFormat<ColorFormat::RGB8>();
+        break;
+    case ColorFormat::RGB5A1:
+        SetColorFormat<ColorFormat::RGB5A1>();
+        break;
+    case ColorFormat::RGB565:
+        SetColorFormat<ColorFormat::RGB565>();
+        break;
+    case ColorFormat::RGBA4:
+        SetColorFormat<ColorFormat::RGBA4>();
+        break;
     default:
-        LOG_WARNING(
-            HW_GPU,
-            "GetStencil called for function which doesn't have a stencil component (format %u)",
-            framebuffer.depth_format);
-        return 0;
+        color_bytes_per_pixel = 0;
+        decode_color = DecodeUnknownColor;
+        encode_color = EncodeUnknownColor;
+        break;
+    }
+    color_buffer = GetBufferPointer(framebuffer.GetColorBufferPhysicalAddress());
+    color_stride = framebuffer.width * color_bytes_per_pixel;
+    if (color_buffer == nullptr) {
+        decode_color = DecodeUnboundColor;
+        encode_color = EncodeUnboundColor;
     }
-}
-
-void SetDepth(int x, int y, u32 value) {
-    const auto& framebuffer = g_state.regs.framebuffer.framebuffer;
-    const PAddr addr = framebuffer.GetDepthBufferPhysicalAddress();
-    u8* depth_buffer = Memory::GetPhysicalPointer(addr);
-
-    y = framebuffer.height - y;
-
-    const u32 coarse_y = y & ~7;
-    u32 bytes_per_pixel = FramebufferRegs::BytesPerDepthPixel(framebuffer.depth_format);
-    u32 stride = framebuffer.width * bytes_per_pixel;
-
-    u32 dst_offset = VideoCore::GetMortonOffset(x, y, bytes_per_pixel) + coarse_y * stride;
-    u8* dst_pixel = depth_buffer + dst_offset;
 
-    switch (framebuffer.depth_format) {
-    case FramebufferRegs::DepthFormat::D16:
-        Color::EncodeD16(value, dst_pixel);
+    switch (depth_format) {
+    case DepthFormat::D16:
+        SetDepthFormat<DepthFormat::D16>();
         break;
-
-    case FramebufferRegs::DepthFormat::D24:
-        Color::EncodeD24(value, dst_pixel);
+    case DepthFormat::D24:
+        SetDepthFormat<DepthFormat::D24>();
         break;
-
-    case FramebufferRegs::DepthFormat::D24S8:
-        Color::EncodeD24X8(value, dst_pixel);
+    case DepthFormat::D24S8:
+        SetDepthFormat<DepthFormat::D24S8>();
         break;
-
     default:
-        LOG_CRITICAL(HW_GPU, "Unimplemented depth format %u", framebuffer.depth_format);
-        UNIMPLEMENTED();
+        depth_bytes_per_pixel = 0;
+        decode_depth = DecodeUnknownDepth;
+        encode_depth = EncodeUnknownDepth;
         break;
     }
-}
-
-void SetStencil(int x, int y, u8 value) {
-    const auto& framebuffer = g_state.regs.framebuffer.framebuffer;
-    const PAddr addr = framebuffer.GetDepthBufferPhysicalAddress();
-    u8* depth_buffer = Memory::GetPhysicalPointer(addr);
+    depth_buffer = GetBufferPointer(framebuffer.GetDepthBufferPhysicalAddress());
+    depth_stride = framebuffer.width * depth_bytes_per_pixel;
+    if (depth_buffer == nullptr) {
+        decode_depth = DecodeUnboundDepth;
+        encode_depth = EncodeUnboundDepth;
+    }
 
-    y = framebuffer.height - y;
+    // The buffers are drawn to straight in the emulated memory. The height register holds the
+    // height minus one.
+    if (color_buffer != nullptr) {
+        Memory::NotifyHostWrite(color_buffer, color_stride * (height + 1));
+    }
+    if (depth_buffer != nullptr) {
+        Memory::NotifyHostWrite(depth_buffer, depth_stride * (height + 1));
+    }
+}
 
-    const u32 coarse_y = y & ~7;
-    u32 bytes_per_pixel = Pica::FramebufferRegs::BytesPerDepthPixel(framebuffer.depth_format);
-    u32 stride = framebuffer.width * bytes_per_pixel;
+u8 FramebufferView::GetStencil(int x, int y) const {
+    if (depth_format != FramebufferRegs::DepthFormat::D24S8) {
+        LOG_WARNING(
+            HW_GPU,
+            "GetStencil called for function which doesn't have a stencil component (format %u)",
+            depth_format);
+        return 0;
+    }
+    if (depth_buffer == nullptr) {
+        DecodeUnboundDepth(nullptr);
+        return 0;
+    }
 
-    u32 dst_offset = VideoCore::GetMortonOffset(x, y, bytes_per_pixel) + coarse_y * stride;
-    u8* dst_pixel = depth_buffer + dst_offset;
+    return Color::DecodeD24S8(GetDepthPixel(x, y)).y;
+}
 
-    switch (framebuffer.depth_format) {
-    case Pica::FramebufferRegs::DepthFormat::D16:
-    case Pica::FramebufferRegs::DepthFormat::D24:
+void FramebufferView::SetStencil(int x, int y, u8 value) const {
+    switch (depth_format) {
+    case FramebufferRegs::DepthFormat::D16:
+    case FramebufferRegs::DepthFormat::D24:
         // Nothing to do
         break;
 
-    case Pica::FramebufferRegs::DepthFormat::D24S8:
-        Color::EncodeX24S8(value, dst_pixel);
+    case FramebufferRegs::DepthFormat::D24S8:
+        if (depth_buffer == nullptr) {
+            EncodeUnboundDepth(value, nullptr);
+            break;
+        }
+        Color::EncodeX24S8(value, GetDepthPixel(x, y));
         break;
 
     default:
-        LOG_CRITICAL(HW_GPU, "Unimplemented depth format %u", framebuffer.depth_format);
-        UNIMPLEMENTED();
+        DecodeUnknownDepth(nullptr);
         break;
     }
 }
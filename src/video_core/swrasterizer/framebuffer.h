@@ -7,16 +7,88 @@
 #include "common/common_types.h"
 #include "common/vector_math.h"
 #include "video_core/regs_framebuffer.h"
+#include "video_core/utils.h"
 
 namespace Pica {
 namespace Rasterizer {
 
-void DrawPixel(int x, int y, const Math::Vec4<u8>& color);
-const Math::Vec4<u8> GetPixel(int x, int y);
-u32 GetDepth(int x, int y);
-u8 GetStencil(int x, int y);
-void SetDepth(int x, int y, u32 value);
-void SetStencil(int x, int y, u8 value);
+/**
+ * Accessor for the color and depth buffers bound to the rasterizer. Buffer pointers, strides and
+ * formats are resolved once on construction, so per-fragment accesses only compute the offset of
+ * the pixel within its 8x8 tile and call the encoder or decoder of the bound format.
+ * The view must be recreated whenever the framebuffer registers change.
+ */
+class FramebufferView {
+public:
+    explicit FramebufferView(const FramebufferRegs::FramebufferConfig& framebuffer);
+
+    void DrawPixel(int x, int y, const Math::Vec4<u8>& color) const {
+        encode_color(color, GetColorPixel(x, y));
+    }
+
+    Math::Vec4<u8> GetPixel(int x, int y) const {
+        return decode_color(GetColorPixel(x, y));
+    }
+
+    u32 GetDepth(int x, int y) const {
+        return decode_depth(GetDepthPixel(x, y));
+    }
+
+    u8 GetStencil(int x, int y) const;
+
+    void SetDepth(int x, int y, u32 value) const {
+        encode_depth(value, GetDepthPixel(x, y));
+    }
+
+    void SetStencil(int x, int y, u8 value) const;
+
+private:
+    using DecodeColorFunc = Math::Vec4<u8> (*)(const u8* bytes);
+    using EncodeColorFunc = void (*)(const Math::Vec4<u8>& color, u8* bytes);
+    using DecodeDepthFunc = u32 (*)(const u8* bytes);
+    using EncodeDepthFunc = void (*)(u32 value, u8* bytes);
+
+    template <FramebufferRegs::ColorFormat format>
+    void SetColorFormat();
+
+    template <FramebufferRegs::DepthFormat format>
+    void SetDepthFormat();
+
+    /// Computes the offset of a pixel from the start of a tiled buffer
+    u32 GetOffset(int x, int y, u32 bytes_per_pixel, u32 stride) const {
+        // Similarly to textures, the render framebuffer is laid out from bottom to top, too.
+        // NOTE: The framebuffer height register contains the actual FB height minus one.
+        y = height - y;
+        return (y & ~7) * stride +
+               ((x & ~7) * 8 + VideoCore::MortonInterleave(x, y)) * bytes_per_pixel;
+    }
+
+    u8* GetColorPixel(int x, int y) const {
+        return color_buffer + GetOffset(x, y, color_bytes_per_pixel, color_stride);
+    }
+
+    u8* GetDepthPixel(int x, int y) const {
+        return depth_buffer + GetOffset(x, y, depth_bytes_per_pixel, depth_stride);
+    }
+
+    int height;
+
+    u8* color_buffer;
+    u32 color_bytes_per_pixel;
+    /// Bytes per row of pixels, i.e. an eighth of the size of a row of tiles
+    u32 color_stride;
+    DecodeColorFunc decode_color;
+    EncodeColorFunc encode_color;
+
+    u8* depth_buffer;
+    u32 depth_bytes_per_pixel;
+    /// Bytes per row of pixels, i.e. an eighth of the size of a row of tiles
+    u32 depth_stride;
+    FramebufferRegs::DepthFormat depth_format;
+    DecodeDepthFunc decode_depth;
+    EncodeDepthFunc encode_depth;
+};
+
 u8 PerformStencilAction(FramebufferRegs::StencilAction action, u8 old_stencil, u8 ref);
 
 Math::Vec4<u8> EvaluateBlendEquation(const Math::Vec4<u8>& src, const Math::Vec4<u8>& srcfactor,
@@ -305,4 +305,297 @@ std::tuple<Math::Vec4<u8>, Math::Vec4<u8>> ComputeFragmentsColors(
     return std::make_tuple(diffuse, specular);
 }
 
+static void ConvertLut(LightingSetup& setup, const Pica::State::Lighting& lighting_state,
+                       unsigned lut_index) {
+    ASSERT_MSG(lut_index < lighting_state.luts.size(), "Out of range lut");
+
+    for (unsigned i = 0; i < 256; ++i) {
+        const auto& entry = lighting_state.luts[lut_index][i];
+        setup.luts[lut_index][i] = {entry.ToFloat(), entry.DiffToFloat()};
+    }
+}
+
+static LightingSetup::LutLookup SetupLutLookup(LightingSetup& setup,
+                                               const Pica::State::Lighting& lighting_state,
+                                               bool enabled, LightingRegs::LightingLutInput input,
+                                               bool abs, float scale,
+                                               LightingRegs::LightingSampler sampler) {
+    LightingSetup::LutLookup lookup{};
+    lookup.enabled = enabled;
+    if (enabled) {
+        lookup.input = input;
+        lookup.abs = abs;
+        lookup.scale = scale;
+        lookup.lut = static_cast<unsigned>(sampler);
+        ConvertLut(setup, lighting_state, lookup.lut);
+    }
+    return lookup;
+}
+
+void SetupLighting(LightingSetup& setup, const Pica::LightingRegs& lighting,
+                   const Pica::State::Lighting& lighting_state) {
+    using Sampler = LightingRegs::LightingSampler;
+    const auto config = lighting.config0.config.Value();
+
+    setup.bump_mode = lighting.config0.bump_mode;
+    setup.bump_selector = lighting.config0.bump_selector;
+    setup.bump_renorm = !lighting.config0.disable_bump_renorm;
+    setup.clamp_highlights = lighting.config0.clamp_highlights != 0;
+    setup.cp_input_supported = (config == LightingRegs::LightingConfig::Config7);
+
+    auto setup_lookup = [&](bool disabled, LightingRegs::LightingLutInput input, bool abs_disabled,
+                            LightingRegs::LightingScale scale, Sampler sampler) {
+        bool enabled = !disabled && LightingRegs::IsLightingSamplerSupported(config, sampler);
+        return SetupLutLookup(setup, lighting_state, enabled, input, !abs_disabled,
+                              lighting.lut_scale.GetScale(scale), sampler);
+    };
+
+    setup.d0 = setup_lookup(lighting.config1.disable_lut_d0, lighting.lut_input.d0,
+                            lighting.abs_lut_input.disable_d0, lighting.lut_scale.d0,
+                            Sampler::Distribution0);
+    setup.d1 = setup_lookup(lighting.config1.disable_lut_d1, lighting.lut_input.d1,
+                            lighting.abs_lut_input.disable_d1, lighting.lut_scale.d1,
+                            Sampler::Distribution1);
+    setup.rr = setup_lookup(lighting.config1.disable_lut_rr, lighting.lut_input.rr,
+                            lighting.abs_lut_input.disable_rr, lighting.lut_scale.rr,
+                            Sampler::ReflectRed);
+    setup.rg = setup_lookup(lighting.config1.disable_lut_rg, lighting.lut_input.rg,
+                            lighting.abs_lut_input.disable_rg, lighting.lut_scale.rg,
+                            Sampler::ReflectGreen);
+    setup.rb = setup_lookup(lighting.config1.disable_lut_rb, lighting.lut_input.rb,
+                            lighting.abs_lut_input.disable_rb, lighting.lut_scale.rb,
+                            Sampler::ReflectBlue);
+    setup.fr = setup_lookup(lighting.config1.disable_lut_fr, lighting.lut_input.fr,
+                            lighting.abs_lut_input.disable_fr, lighting.lut_scale.fr,
+                            Sampler::Fresnel);
+
+    const auto fresnel_selector = lighting.config0.fresnel_selector.Value();
+    setup.fresnel_primary_alpha =
+        fresnel_selector == LightingRegs::LightingFresnelSelector::PrimaryAlpha ||
+        fresnel_selector == LightingRegs::LightingFresnelSelector::Both;
+    setup.fresnel_secondary_alpha =
+        fresnel_selector == LightingRegs::LightingFresnelSelector::SecondaryAlpha ||
+        fresnel_selector == LightingRegs::LightingFresnelSelector::Both;
+
+    setup.global_ambient = lighting.global_ambient.ToVec3f();
+
+    setup.num_lights = lighting.max_light_index + 1;
+    for (unsigned light_index = 0; light_index < setup.num_lights; ++light_index) {
+        unsigned num = lighting.light_enable.GetNum(light_index);
+        const auto& light_config = lighting.light[num];
+        auto& light = setup.lights[light_index];
+
+        light.position = {float16::FromRaw(light_config.x).ToFloat32(),
+                          float16::FromRaw(light_config.y).ToFloat32(),
+                          float16::FromRaw(light_config.z).ToFloat32()};
+        light.directional = light_config.config.directional != 0;
+        light.two_sided_diffuse = light_config.config.two_sided_diffuse != 0;
+        light.geometric_factor_0 = light_config.config.geometric_factor_0 != 0;
+        light.geometric_factor_1 = light_config.config.geometric_factor_1 != 0;
+
+        light.dist_atten_enabled = !lighting.IsDistAttenDisabled(num);
+        if (light.dist_atten_enabled) {
+            light.dist_atten_scale =
+                Pica::float20::FromRaw(light_config.dist_atten_scale).ToFloat32();
+            light.dist_atten_bias =
+                Pica::float20::FromRaw(light_config.dist_atten_bias).ToFloat32();
+            light.dist_atten_lut = static_cast<unsigned>(Sampler::DistanceAttenuation) + num;
+            ConvertLut(setup, lighting_state, light.dist_atten_lut);
+        }
+
+        light.spot_atten = SetupLutLookup(
+            setup, lighting_state,
+            !lighting.IsSpotAttenDisabled(num) &&
+                LightingRegs::IsLightingSamplerSupported(config, Sampler::SpotlightAttenuation),
+            lighting.lut_input.sp, lighting.abs_lut_input.disable_sp == 0,
+            lighting.lut_scale.GetScale(lighting.lut_scale.sp),
+            LightingRegs::SpotlightAttenuationSampler(num));
+        Math::Vec3<s32> spot_dir{light_config.spot_x.Value(), light_config.spot_y.Value(),
+                                 light_config.spot_z.Value()};
+        light.spot_direction = spot_dir.Cast<float>() / 2047.0f;
+
+        light.specular_0 = light_config.specular_0.ToVec3f();
+        light.specular_1 = light_config.specular_1.ToVec3f();
+        light.diffuse = light_config.diffuse.ToVec3f();
+        light.ambient = light_config.ambient.ToVec3f();
+    }
+}
+
+std::tuple<Math::Vec4<u8>, Math::Vec4<u8>> ComputeFragmentsColors(
+    const LightingSetup& setup, const Math::Quaternion<float>& normquat,
+    const Math::Vec3<float>& view, const Math::Vec4<u8> (&texture_color)[4]) {
+
+    Math::Vec3<float> surface_normal = Math::MakeVec(0.0f, 0.0f, 1.0f);
+    Math::Vec3<float> surface_tangent = Math::MakeVec(1.0f, 0.0f, 0.0f);
+
+    if (setup.bump_mode != LightingRegs::LightingBumpMode::None) {
+        Math::Vec3<float> perturbation =
+            texture_color[setup.bump_selector].xyz().Cast<float>() / 127.5f -
+            Math::MakeVec(1.0f, 1.0f, 1.0f);
+        if (setup.bump_mode == LightingRegs::LightingBumpMode::NormalMap) {
+            if (setup.bump_renorm) {
+                const float z_square = 1 - perturbation.xy().Length2();
+                perturbation.z = std::sqrt(std::max(z_square, 0.0f));
+            }
+            surface_normal = perturbation;
+        } else if (setup.bump_mode == LightingRegs::LightingBumpMode::TangentMap) {
+            surface_tangent = perturbation;
+        }
+    }
+
+    // Use the normalized the quaternion when performing the rotation
+    auto normal = Math::QuaternionRotate(normquat, surface_normal);
+    auto tangent = Math::QuaternionRotate(normquat, surface_tangent);
+
+    Math::Vec3<float> norm_view = view.Normalized();
+
+    Math::Vec4<float> diffuse_sum = {0.0f, 0.0f, 0.0f, 1.0f};
+    Math::Vec4<float> specular_sum = {0.0f, 0.0f, 0.0f, 1.0f};
+
+    for (unsigned light_index = 0; light_index < setup.num_lights; ++light_index) {
+        const auto& light = setup.lights[light_index];
+
+        Math::Vec3<float> light_vector = light.directional ? light.position : light.position + view;
+        light_vector.Normalize();
+
+        Math::Vec3<float> half_vector = norm_view + light_vector;
+        Math::Vec3<float> norm_half_vector = half_vector.Normalized();
+
+        float dist_atten = 1.0f;
+        if (light.dist_atten_enabled) {
+            auto distance = (-view - light.position).Length();
+            float sample_loc = MathUtil::Clamp(
+                light.dist_atten_scale * distance + light.dist_atten_bias, 0.0f, 1.0f);
+
+            u8 lutindex =
+                static_cast<u8>(MathUtil::Clamp(std::floor(sample_loc * 256.0f), 0.0f, 255.0f));
+            float delta = sample_loc * 256 - lutindex;
+            const auto& entry = setup.luts[light.dist_atten_lut][lutindex];
+            dist_atten = entry.x + entry.y * delta;
+        }
+
+        auto GetLutValue = [&](const LightingSetup::LutLookup& lookup) {
+            float result = 0.0f;
+
+            switch (lookup.input) {
+            case LightingRegs::LightingLutInput::NH:
+                result = Math::Dot(normal, norm_half_vector);
+                break;
+            case LightingRegs::LightingLutInput::VH:
+                result = Math::Dot(norm_view, norm_half_vector);
+                break;
+            case LightingRegs::LightingLutInput::NV:
+                result = Math::Dot(normal, norm_view);
+                break;
+            case LightingRegs::LightingLutInput::LN:
+                result = Math::Dot(light_vector, normal);
+                break;
+            case LightingRegs::LightingLutInput::SP:
+                result = Math::Dot(light_vector, light.spot_direction);
+                break;
+            case LightingRegs::LightingLutInput::CP:
+                if (setup.cp_input_supported) {
+                    const Math::Vec3<float> half_vector_proj =
+                        norm_half_vector - normal * Math::Dot(normal, norm_half_vector);
+                    result = Math::Dot(half_vector_proj, tangent);
+                }
+                break;
+            default:
+                LOG_CRITICAL(HW_GPU, "Unknown lighting LUT input %u\n",
+                             static_cast<u32>(lookup.input));
+                UNIMPLEMENTED();
+            }
+
+            u8 index;
+            float delta;
+
+            if (lookup.abs) {
+                if (light.two_sided_diffuse)
+                    result = std::abs(result);
+                else
+                    result = std::max(result, 0.0f);
+
+                float flr = std::floor(result * 256.0f);
+                index = static_cast<u8>(MathUtil::Clamp(flr, 0.0f, 255.0f));
+                delta = result * 256 - index;
+            } else {
+                float flr = std::floor(result * 128.0f);
+                s8 signed_index = static_cast<s8>(MathUtil::Clamp(flr, -128.0f, 127.0f));
+                delta = result * 128.0f - signed_index;
+                index = static_cast<u8>(signed_index);
+            }
+
+            const auto& entry = setup.luts[lookup.lut][index];
+            return lookup.scale * (entry.x + entry.y * delta);
+        };
+
+        float spot_atten = light.spot_atten.enabled ? GetLutValue(light.spot_atten) : 1.0f;
+
+        float d0_lut_value = setup.d0.enabled ? GetLutValue(setup.d0) : 1.0f;
+        Math::Vec3<float> specular_0 = d0_lut_value * light.specular_0;
+
+        Math::Vec3<float> refl_value;
+        refl_value.x = setup.rr.enabled ? GetLutValue(setup.rr) : 1.0f;
+        refl_value.y = setup.rg.enabled ? GetLutValue(setup.rg) : refl_value.x;
+        refl_value.z = setup.rb.enabled ? GetLutValue(setup.rb) : refl_value.x;
+
+        float d1_lut_value = setup.d1.enabled ? GetLutValue(setup.d1) : 1.0f;
+        Math::Vec3<float> specular_1 = d1_lut_value * refl_value * light.specular_1;
+
+        // Note: only the last entry in the light slots applies the Fresnel factor
+        if (light_index == setup.num_lights - 1 && setup.fr.enabled) {
+            float lut_value = GetLutValue(setup.fr);
+            if (setup.fresnel_primary_alpha) {
+                diffuse_sum.a() = lut_value;
+            }
+            if (setup.fresnel_secondary_alpha) {
+                specular_sum.a() = lut_value;
+            }
+        }
+
+        auto dot_product = Math::Dot(light_vector, normal);
+
+        float clamp_highlights = 1.0f;
+        if (setup.clamp_highlights && dot_product <= 0.0f) {
+            clamp_highlights = 0.0f;
+        }
+
+        if (light.two_sided_diffuse)
+            dot_product = std::abs(dot_product);
+        else
+            dot_product = std::max(dot_product, 0.0f);
+
+        if (light.geometric_factor_0 || light.geometric_factor_1) {
+            float geo_factor = half_vector.Length2();
+            geo_factor = geo_factor == 0.0f ? 0.0f : std::min(dot_product / geo_factor, 1.0f);
+            if (light.geometric_factor_0) {
+                specular_0 *= geo_factor;
+            }
+            if (light.geometric_factor_1) {
+                specular_1 *= geo_factor;
+            }
+        }
+
+        auto diffuse = light.diffuse * dot_product + light.ambient;
+        diffuse_sum += Math::MakeVec(diffuse * dist_atten * spot_atten, 0.0f);
+
+        specular_sum += Math::MakeVec(
+            (specular_0 + specular_1) * clamp_highlights * dist_atten * spot_atten, 0.0f);
+    }
+
+    diffuse_sum += Math::MakeVec(setup.global_ambient, 0.0f);
+
+    auto diffuse = Math::MakeVec<float>(MathUtil::Clamp(diffuse_sum.x, 0.0f, 1.0f) * 255,
+                                        MathUtil::Clamp(diffuse_sum.y, 0.0f, 1.0f) * 255,
+                                        MathUtil::Clamp(diffuse_sum.z, 0.0f, 1.0f) * 255,
+                                        MathUtil::Clamp(diffuse_sum.w, 0.0f, 1.0f) * 255)
+                       .Cast<u8>();
+    auto specular = Math::MakeVec<float>(MathUtil::Clamp(specular_sum.x, 0.0f, 1.0f) * 255,
+                                         MathUtil::Clamp(specular_sum.y, 0.0f, 1.0f) * 255,
+                                         MathUtil::Clamp(specular_sum.z, 0.0f, 1.0f) * 255,
+                                         MathUtil::Clamp(specular_sum.w, 0.0f, 1.0f) * 255)
+                        .Cast<u8>();
+    return std::make_tuple(diffuse, specular);
+}
+
 } // namespace Pica
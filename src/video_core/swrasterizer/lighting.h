@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <array>
 #include <tuple>
 #include "common/quaternion.h"
 #include "common/vector_math.h"
@@ -11,9 +12,83 @@
 
 namespace Pica {
 
+/**
+ * Lighting configuration decoded from the PICA registers and lookup tables, so that it does not
+ * need to be re-evaluated for every fragment of a draw.
+ */
+struct LightingSetup {
+    /// A LUT lookup performed by the lighting equation
+    struct LutLookup {
+        bool enabled;
+        LightingRegs::LightingLutInput input;
+        bool abs;
+        float scale;
+        /// Index of the LUT in LightingSetup::luts
+        unsigned lut;
+    };
+
+    struct Light {
+        Math::Vec3<float> position;
+        bool directional;
+        bool two_sided_diffuse;
+        bool geometric_factor_0;
+        bool geometric_factor_1;
+
+        bool dist_atten_enabled;
+        float dist_atten_scale;
+        float dist_atten_bias;
+        /// Index of the distance attenuation LUT in LightingSetup::luts
+        unsigned dist_atten_lut;
+
+        LutLookup spot_atten;
+        Math::Vec3<float> spot_direction;
+
+        Math::Vec3<float> specular_0;
+        Math::Vec3<float> specular_1;
+        Math::Vec3<float> diffuse;
+        Math::Vec3<float> ambient;
+    };
+
+    LightingRegs::LightingBumpMode bump_mode;
+    unsigned bump_selector;
+    bool bump_renorm;
+    bool clamp_highlights;
+    /// True if the CP LUT input has to be computed rather than being 0
+    bool cp_input_supported;
+
+    LutLookup d0;
+    LutLookup d1;
+    LutLookup rr;
+    LutLookup rg;
+    LutLookup rb;
+    LutLookup fr;
+    bool fresnel_primary_alpha;
+    bool fresnel_secondary_alpha;
+
+    Math::Vec3<float> global_ambient;
+
+    unsigned num_lights;
+    std::array<Light, 8> lights;
+
+    /// LUT entries converted to (value, difference) pairs
+    std::array<std::array<Math::Vec2<float>, 256>, LightingRegs::NumLightingSampler> luts;
+};
+
+/// Decodes the lighting configuration for use with the LightingSetup overload of
+/// ComputeFragmentsColors. Only the lookup tables referenced by the configuration are converted.
+void SetupLighting(LightingSetup& setup, const Pica::LightingRegs& lighting,
+                   const Pica::State::Lighting& lighting_state);
+
+/// Computes the primary and secondary fragment colors directly from the PICA lighting state.
 std::tuple<Math::Vec4<u8>, Math::Vec4<u8>> ComputeFragmentsColors(
     const Pica::LightingRegs& lighting, const Pica::State::Lighting& lighting_state,
     const Math::Quaternion<float>& normquat, const Math::Vec3<float>& view,
     const Math::Vec4<u8> (&texture_color)[4]);
 
+/// Computes the primary and secondary fragment colors using a configuration set up with
+/// SetupLighting. Produces the same results as the generic implementation.
+std::tuple<Math::Vec4<u8>, Math::Vec4<u8>> ComputeFragmentsColors(
+    const LightingSetup& setup, const Math::Quaternion<float>& normquat,
+    const Math::Vec3<float>& view, const Math::Vec4<u8> (&texture_color)[4]);
+
 } // namespace Pica
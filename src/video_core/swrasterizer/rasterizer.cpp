@@ -5,7 +5,10 @@
 #include <algorithm>
 #include <array>
 #include <cmath>
+#include <iterator>
+#include <memory>
 #include <tuple>
+#include <unordered_map>
 #include "common/assert.h"
 #include "common/bit_field.h"
 #include "common/color.h"
@@ -13,6 +16,7 @@
 #include "common/logging/log.h"
 #include "common/math_util.h"
 #include "common/microprofile.h"
+#include "common/perf_counters.h"
 #include "common/quaternion.h"
 #include "common/vector_math.h"
 #include "core/hw/gpu.h"
@@ -31,6 +35,7 @@
 #include "video_core/swrasterizer/texturing.h"
 #include "video_core/texture/texture_decode.h"
 #include "video_core/utils.h"
+#include "video_core/video_core.h"
 
 namespace Pica {
 namespace Rasterizer {
@@ -116,6 +121,206 @@ static std::tuple<float24, float24, PAddr> ConvertCubeCoord(float24 u, float24 v
     return std::make_tuple(x / z * half + half, y / z * half + half, addr);
 }
 
+/// Lighting configuration decoded for the current draw, rebuilt when the lighting state changes
+static LightingSetup lighting_setup;
+static bool lighting_setup_dirty = true;
+
+void NotifyLightingChanged() {
+    lighting_setup_dirty = true;
+}
+
+/// Compiled texture combiner programs, keyed by the registers they were built from
+static std::unordered_map<TevProgram::Config, std::unique_ptr<TevProgram>> tev_program_cache;
+static const TevProgram* current_tev_program = nullptr;
+
+void NotifyTexturingChanged() {
+    current_tev_program = nullptr;
+}
+
+static const TevProgram& GetTevProgram(const Regs& regs) {
+    if (current_tev_program == nullptr) {
+        const TevProgram::Config config(regs.texturing, regs.framebuffer);
+        auto iter = tev_program_cache.find(config);
+        if (iter == tev_program_cache.end()) {
+            auto program = std::make_unique<TevProgram>(regs.texturing, regs.framebuffer);
+            iter = tev_program_cache.emplace(config, std::move(program)).first;
+        }
+        current_tev_program = iter->second.get();
+    }
+    return *current_tev_program;
+}
+
+/**
+ * Runs the texture environment on a fragment and applies the alpha test to its output. This is the
+ * generic path, which evaluates the combiner configuration straight from the registers.
+ * @returns false if the fragment was discarded by the alpha test
+ */
+static bool CombineFragment(const Regs& regs,
+                            const std::array<TexturingRegs::TevStageConfig, 6>& tev_stages,
+                            const Math::Vec4<u8>& primary_color,
+                            const Math::Vec4<u8>& primary_fragment_color,
+                            const Math::Vec4<u8>& secondary_fragment_color,
+                            const Math::Vec4<u8> (&texture_color)[4],
+                            Math::Vec4<u8>& combiner_output) {
+    // Texture environment - consists of 6 stages of color and alpha combining.
+    //
+    // Color combiners take three input color values from some source (e.g. interpolated
+    // vertex color, texture color, previous stage, etc), perform some very simple
+    // operations on each of them (e.g. inversion) and then calculate the output color
+    // with some basic arithmetic. Alpha combiners can be configured separately but work
+    // analogously.
+    Math::Vec4<u8> combiner_buffer = {0, 0, 0, 0};
+    Math::Vec4<u8> next_combiner_buffer =
+        Math::MakeVec(regs.texturing.tev_combiner_buffer_color.r.Value(),
+                      regs.texturing.tev_combiner_buffer_color.g.Value(),
+                      regs.texturing.tev_combiner_buffer_color.b.Value(),
+                      regs.texturing.tev_combiner_buffer_color.a.Value())
+            .Cast<u8>();
+    for (unsigned tev_stage_index = 0; tev_stage_index < tev_stages.size();
+         ++tev_stage_index) {
+        const auto& tev_stage = tev_stages[tev_stage_index];
+        using Source = TexturingRegs::TevStageConfig::Source;
+
+        auto GetSource = [&](Source source) -> Math::Vec4<u8> {
+            switch (source) {
+            case Source::PrimaryColor:
+                return primary_color;
+
+            case Source::PrimaryFragmentColor:
+                return primary_fragment_color;
+
+            case Source::SecondaryFragmentColor:
+                return secondary_fragment_color;
+
+            case Source::Texture0:
+                return texture_color[0];
+
+            case Source::Texture1:
+                return texture_color[1];
+
+            case Source::Texture2:
+                return texture_color[2];
+
+            case Source::Texture3:
+                return texture_color[3];
+
+            case Source::PreviousBuffer:
+                return combiner_buffer;
+
+            case Source::Constant:
+                return Math::MakeVec(tev_stage.const_r.Value(), tev_stage.const_g.Value(),
+                                     tev_stage.const_b.Value(), tev_stage.const_a.Value())
+                    .Cast<u8>();
+
+            case Source::Previous:
+                return combiner_output;
+
+            default:
+                LOG_ERROR(HW_GPU, "Unknown color combiner source %d", (int)source);
+                UNIMPLEMENTED();
+                return {0, 0, 0, 0};
+            }
+        };
+
+        // color combiner
+        // NOTE: Not sure if the alpha combiner might use the color output of the previous
+        //       stage as input. Hence, we currently don't directly write the result to
+        //       combiner_output.rgb(), but instead store it in a temporary variable until
+        //       alpha combining has been done.
+        Math::Vec3<u8> color_result[3] = {
+            GetColorModifier(tev_stage.color_modifier1, GetSource(tev_stage.color_source1)),
+            GetColorModifier(tev_stage.color_modifier2, GetSource(tev_stage.color_source2)),
+            GetColorModifier(tev_stage.color_modifier3, GetSource(tev_stage.color_source3)),
+        };
+        auto color_output = ColorCombine(tev_stage.color_op, color_result);
+
+        u8 alpha_output;
+        if (tev_stage.color_op == TexturingRegs::TevStageConfig::Operation::Dot3_RGBA) {
+            // result of Dot3_RGBA operation is also placed to the alpha component
+            alpha_output = color_output.x;
+        } else {
+            // alpha combiner
+            std::array<u8, 3> alpha_result = {{
+                GetAlphaModifier(tev_stage.alpha_modifier1,
+                                 GetSource(tev_stage.alpha_source1)),
+                GetAlphaModifier(tev_stage.alpha_modifier2,
+                                 GetSource(tev_stage.alpha_source2)),
+                GetAlphaModifier(tev_stage.alpha_modifier3,
+                                 GetSource(tev_stage.alpha_source3)),
+            }};
+            alpha_output = AlphaCombine(tev_stage.alpha_op, alpha_result);
+        }
+
+        combiner_output[0] =
+            std::min((unsigned)255, color_output.r() * tev_stage.GetColorMultiplier());
+        combiner_output[1] =
+            std::min((unsigned)255, color_output.g() * tev_stage.GetColorMultiplier());
+        combiner_output[2] =
+            std::min((unsigned)255, color_output.b() * tev_stage.GetColorMultiplier());
+        combiner_output[3] =
+            std::min((unsigned)255, alpha_output * tev_stage.GetAlphaMultiplier());
+
+        combiner_buffer = next_combiner_buffer;
+
+        if (regs.texturing.tev_combiner_buffer_input.TevStageUpdatesCombinerBufferColor(
+                tev_stage_index)) {
+            next_combiner_buffer.r() = combiner_output.r();
+            next_combiner_buffer.g() = combiner_output.g();
+            next_combiner_buffer.b() = combiner_output.b();
+        }
+
+        if (regs.texturing.tev_combiner_buffer_input.TevStageUpdatesCombinerBufferAlpha(
+                tev_stage_index)) {
+            next_combiner_buffer.a() = combiner_output.a();
+        }
+    }
+
+    const auto& output_merger = regs.framebuffer.output_merger;
+    // TODO: Does alpha testing happen before or after stencil?
+    if (output_merger.alpha_test.enable) {
+        bool pass = false;
+
+        switch (output_merger.alpha_test.func) {
+        case FramebufferRegs::CompareFunc::Never:
+            pass = false;
+            break;
+
+        case FramebufferRegs::CompareFunc::Always:
+            pass = true;
+            break;
+
+        case FramebufferRegs::CompareFunc::Equal:
+            pass = combiner_output.a() == output_merger.alpha_test.ref;
+            break;
+
+        case FramebufferRegs::CompareFunc::NotEqual:
+            pass = combiner_output.a() != output_merger.alpha_test.ref;
+            break;
+
+        case FramebufferRegs::CompareFunc::LessThan:
+            pass = combiner_output.a() < output_merger.alpha_test.ref;
+            break;
+
+        case FramebufferRegs::CompareFunc::LessThanOrEqual:
+            pass = combiner_output.a() <= output_merger.alpha_test.ref;
+            break;
+
+        case FramebufferRegs::CompareFunc::GreaterThan:
+            pass = combiner_output.a() > output_merger.alpha_test.ref;
+            break;
+
+        case FramebufferRegs::CompareFunc::GreaterThanOrEqual:
+            pass = combiner_output.a() >= output_merger.alpha_test.ref;
+            break;
+        }
+
+        if (!pass)
+            return false;
+    }
+
+    return true;
+}
+
 MICROPROFILE_DEFINE(GPU_Rasterization, "GPU", "Rasterization", MP_RGB(50, 50, 240));
 
 /**
@@ -126,6 +331,7 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
                                     bool reversed = false) {
     const auto& regs = g_state.regs;
     MICROPROFILE_SCOPE(GPU_Rasterization);
+    PERF_COUNTERS_SCOPE(GPU_Rasterization);
 
     // vertex positions in rasterizer coordinates
     static auto FloatToFix = [](float24 flt) {
@@ -159,6 +365,11 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
             return;
     }
 
+    if (!regs.lighting.disable && lighting_setup_dirty) {
+        SetupLighting(lighting_setup, regs.lighting, g_state.lighting);
+        lighting_setup_dirty = false;
+    }
+
     u16 min_x = std::min({vtxpos[0].x, vtxpos[1].x, vtxpos[2].x});
     u16 min_y = std::min({vtxpos[0].y, vtxpos[1].y, vtxpos[2].y});
     u16 max_x = std::max({vtxpos[0].x, vtxpos[1].x, vtxpos[2].x});
@@ -214,10 +425,18 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
     auto textures = regs.texturing.GetTextures();
     auto tev_stages = regs.texturing.GetTevStages();
 
+    const TevProgram* tev_program = nullptr;
+    TevProgram::Inputs tev_inputs;
+    if (VideoCore::g_compiled_tev_enabled) {
+        tev_program = &GetTevProgram(regs);
+        tev_program->SetupInputs(tev_inputs);
+    }
+
     bool stencil_action_enable =
         g_state.regs.framebuffer.output_merger.stencil_test.enable &&
         g_state.regs.framebuffer.framebuffer.depth_format == FramebufferRegs::DepthFormat::D24S8;
     const auto stencil_test = g_state.regs.framebuffer.output_merger.stencil_test;
+    const FramebufferView framebuffer_view(regs.framebuffer.framebuffer);
 
     // Enter rasterization loop, starting at the center of the topleft bounding box corner.
     // TODO: Not sure if looping through x first might be faster
@@ -406,22 +625,6 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
                                            g_state.regs.texturing, g_state.proctex);
             }
 
-            // Texture environment - consists of 6 stages of color and alpha combining.
-            //
-            // Color combiners take three input color values from some source (e.g. interpolated
-            // vertex color, texture color, previous stage, etc), perform some very simple
-            // operations on each of them (e.g. inversion) and then calculate the output color
-            // with some basic arithmetic. Alpha combiners can be configured separately but work
-            // analogously.
-            Math::Vec4<u8> combiner_output;
-            Math::Vec4<u8> combiner_buffer = {0, 0, 0, 0};
-            Math::Vec4<u8> next_combiner_buffer =
-                Math::MakeVec(regs.texturing.tev_combiner_buffer_color.r.Value(),
-                              regs.texturing.tev_combiner_buffer_color.g.Value(),
-                              regs.texturing.tev_combiner_buffer_color.b.Value(),
-                              regs.texturing.tev_combiner_buffer_color.a.Value())
-                    .Cast<u8>();
-
             Math::Vec4<u8> primary_fragment_color = {0, 0, 0, 0};
             Math::Vec4<u8> secondary_fragment_color = {0, 0, 0, 0};
 
@@ -438,151 +641,26 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
                     GetInterpolatedAttribute(v0.view.y, v1.view.y, v2.view.y).ToFloat32(),
                     GetInterpolatedAttribute(v0.view.z, v1.view.z, v2.view.z).ToFloat32(),
                 };
-                std::tie(primary_fragment_color, secondary_fragment_color) = ComputeFragmentsColors(
-                    g_state.regs.lighting, g_state.lighting, normquat, view, texture_color);
+                std::tie(primary_fragment_color, secondary_fragment_color) =
+                    ComputeFragmentsColors(lighting_setup, normquat, view, texture_color);
             }
 
-            for (unsigned tev_stage_index = 0; tev_stage_index < tev_stages.size();
-                 ++tev_stage_index) {
-                const auto& tev_stage = tev_stages[tev_stage_index];
-                using Source = TexturingRegs::TevStageConfig::Source;
-
-                auto GetSource = [&](Source source) -> Math::Vec4<u8> {
-                    switch (source) {
-                    case Source::PrimaryColor:
-                        return primary_color;
-
-                    case Source::PrimaryFragmentColor:
-                        return primary_fragment_color;
-
-                    case Source::SecondaryFragmentColor:
-                        return secondary_fragment_color;
-
-                    case Source::Texture0:
-                        return texture_color[0];
-
-                    case Source::Texture1:
-                        return texture_color[1];
-
-                    case Source::Texture2:
-                        return texture_color[2];
-
-                    case Source::Texture3:
-                        return texture_color[3];
-
-                    case Source::PreviousBuffer:
-                        return combiner_buffer;
-
-                    case Source::Constant:
-                        return Math::MakeVec(tev_stage.const_r.Value(), tev_stage.const_g.Value(),
-                                             tev_stage.const_b.Value(), tev_stage.const_a.Value())
-                            .Cast<u8>();
-
-                    case Source::Previous:
-                        return combiner_output;
-
-                    default:
-                        LOG_ERROR(HW_GPU, "Unknown color combiner source %d", (int)source);
-                        UNIMPLEMENTED();
-                        return {0, 0, 0, 0};
-                    }
-                };
-
-                // color combiner
-                // NOTE: Not sure if the alpha combiner might use the color output of the previous
-                //       stage as input. Hence, we currently don't directly write the result to
-                //       combiner_output.rgb(), but instead store it in a temporary variable until
-                //       alpha combining has been done.
-                Math::Vec3<u8> color_result[3] = {
-                    GetColorModifier(tev_stage.color_modifier1, GetSource(tev_stage.color_source1)),
-                    GetColorModifier(tev_stage.color_modifier2, GetSource(tev_stage.color_source2)),
-                    GetColorModifier(tev_stage.color_modifier3, GetSource(tev_stage.color_source3)),
-                };
-                auto color_output = ColorCombine(tev_stage.color_op, color_result);
-
-                u8 alpha_output;
-                if (tev_stage.color_op == TexturingRegs::TevStageConfig::Operation::Dot3_RGBA) {
-                    // result of Dot3_RGBA operation is also placed to the alpha component
-                    alpha_output = color_output.x;
-                } else {
-                    // alpha combiner
-                    std::array<u8, 3> alpha_result = {{
-                        GetAlphaModifier(tev_stage.alpha_modifier1,
-                                         GetSource(tev_stage.alpha_source1)),
-                        GetAlphaModifier(tev_stage.alpha_modifier2,
-                                         GetSource(tev_stage.alpha_source2)),
-                        GetAlphaModifier(tev_stage.alpha_modifier3,
-                                         GetSource(tev_stage.alpha_source3)),
-                    }};
-                    alpha_output = AlphaCombine(tev_stage.alpha_op, alpha_result);
-                }
-
-                combiner_output[0] =
-                    std::min((unsigned)255, color_output.r() * tev_stage.GetColorMultiplier());
-                combiner_output[1] =
-                    std::min((unsigned)255, color_output.g() * tev_stage.GetColorMultiplier());
-                combiner_output[2] =
-                    std::min((unsigned)255, color_output.b() * tev_stage.GetColorMultiplier());
-                combiner_output[3] =
-                    std::min((unsigned)255, alpha_output * tev_stage.GetAlphaMultiplier());
-
-                combiner_buffer = next_combiner_buffer;
-
-                if (regs.texturing.tev_combiner_buffer_input.TevStageUpdatesCombinerBufferColor(
-                        tev_stage_index)) {
-                    next_combiner_buffer.r() = combiner_output.r();
-                    next_combiner_buffer.g() = combiner_output.g();
-                    next_combiner_buffer.b() = combiner_output.b();
-                }
-
-                if (regs.texturing.tev_combiner_buffer_input.TevStageUpdatesCombinerBufferAlpha(
-                        tev_stage_index)) {
-                    next_combiner_buffer.a() = combiner_output.a();
-                }
+            Math::Vec4<u8> combiner_output;
+            if (tev_program != nullptr) {
+                tev_inputs[TevProgram::PrimaryColor] = primary_color;
+                tev_inputs[TevProgram::PrimaryFragmentColor] = primary_fragment_color;
+                tev_inputs[TevProgram::SecondaryFragmentColor] = secondary_fragment_color;
+                std::copy(std::begin(texture_color), std::end(texture_color),
+                          tev_inputs.begin() + TevProgram::Texture0);
+                if (!tev_program->Run(tev_inputs, combiner_output))
+                    continue;
+            } else if (!CombineFragment(regs, tev_stages, primary_color, primary_fragment_color,
+                                        secondary_fragment_color, texture_color,
+                                        combiner_output)) {
+                continue;
             }
 
             const auto& output_merger = regs.framebuffer.output_merger;
-            // TODO: Does alpha testing happen before or after stencil?
-            if (output_merger.alpha_test.enable) {
-                bool pass = false;
-
-                switch (output_merger.alpha_test.func) {
-                case FramebufferRegs::CompareFunc::Never:
-                    pass = false;
-                    break;
-
-                case FramebufferRegs::CompareFunc::Always:
-                    pass = true;
-                    break;
-
-                case FramebufferRegs::CompareFunc::Equal:
-                    pass = combiner_output.a() == output_merger.alpha_test.ref;
-                    break;
-
-                case FramebufferRegs::CompareFunc::NotEqual:
-                    pass = combiner_output.a() != output_merger.alpha_test.ref;
-                    break;
-
-                case FramebufferRegs::CompareFunc::LessThan:
-                    pass = combiner_output.a() < output_merger.alpha_test.ref;
-                    break;
-
-                case FramebufferRegs::CompareFunc::LessThanOrEqual:
-                    pass = combiner_output.a() <= output_merger.alpha_test.ref;
-                    break;
-
-                case FramebufferRegs::CompareFunc::GreaterThan:
-                    pass = combiner_output.a() > output_merger.alpha_test.ref;
-                    break;
-
-                case FramebufferRegs::CompareFunc::GreaterThanOrEqual:
-                    pass = combiner_output.a() >= output_merger.alpha_test.ref;
-                    break;
-                }
-
-                if (!pass)
-                    continue;
-            }
 
             // Apply fog combiner
             // Not fully accurate. We'd have to know what data type is used to
@@ -618,17 +696,18 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
 
             u8 old_stencil = 0;
 
-            auto UpdateStencil = [stencil_test, x, y,
-                                  &old_stencil](Pica::FramebufferRegs::StencilAction action) {
+            auto UpdateStencil = [stencil_test, x, y, &old_stencil,
+                                  &framebuffer_view](Pica::FramebufferRegs::StencilAction action) {
                 u8 new_stencil =
                     PerformStencilAction(action, old_stencil, stencil_test.reference_value);
                 if (g_state.regs.framebuffer.framebuffer.allow_depth_stencil_write != 0)
-                    SetStencil(x >> 4, y >> 4, (new_stencil & stencil_test.write_mask) |
-                                                   (old_stencil & ~stencil_test.write_mask));
+                    framebuffer_view.SetStencil(x >> 4, y >> 4,
+                                                (new_stencil & stencil_test.write_mask) |
+                                                    (old_stencil & ~stencil_test.write_mask));
             };
 
             if (stencil_action_enable) {
-                old_stencil = GetStencil(x >> 4, y >> 4);
+                old_stencil = framebuffer_view.GetStencil(x >> 4, y >> 4);
                 u8 dest = old_stencil & stencil_test.input_mask;
                 u8 ref = stencil_test.reference_value & stencil_test.input_mask;
 
@@ -679,7 +758,7 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
             u32 z = (u32)(depth * ((1 << num_bits) - 1));
 
             if (output_merger.depth_test_enable) {
-                u32 ref_z = GetDepth(x >> 4, y >> 4);
+                u32 ref_z = framebuffer_view.GetDepth(x >> 4, y >> 4);
 
                 bool pass = false;
 
@@ -727,14 +806,14 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
             if (regs.framebuffer.framebuffer.allow_depth_stencil_write != 0 &&
                 output_merger.depth_write_enable) {
 
-                SetDepth(x >> 4, y >> 4, z);
+                framebuffer_view.SetDepth(x >> 4, y >> 4, z);
             }
 
             // The stencil depth_pass action is executed even if depth testing is disabled
             if (stencil_action_enable)
                 UpdateStencil(stencil_test.action_depth_pass);
 
-            auto dest = GetPixel(x >> 4, y >> 4);
+            auto dest = framebuffer_view.GetPixel(x >> 4, y >> 4);
             Math::Vec4<u8> blend_output = combiner_output;
 
             if (output_merger.alphablend_enable) {
@@ -840,7 +919,7 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
             };
 
             if (regs.framebuffer.framebuffer.allow_color_write != 0)
-                DrawPixel(x >> 4, y >> 4, result);
+                framebuffer_view.DrawPixel(x >> 4, y >> 4, result);
         }
     }
 }
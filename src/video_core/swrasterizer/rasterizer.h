@@ -42,5 +42,11 @@ struct Vertex : Shader::OutputVertex {
 
 void ProcessTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2);
 
+/// Notifies the rasterizer that the lighting registers or lookup tables may have changed
+void NotifyLightingChanged();
+
+/// Notifies the rasterizer that the texture combiner or alpha test registers may have changed
+void NotifyTexturingChanged();
+
 } // namespace Rasterizer
 } // namespace Pica
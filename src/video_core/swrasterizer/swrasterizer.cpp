@@ -2,15 +2,45 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include "core/core.h"
+#include "video_core/pica_state.h"
+#include "video_core/regs.h"
 #include "video_core/swrasterizer/clipper.h"
+#include "video_core/swrasterizer/rasterizer.h"
 #include "video_core/swrasterizer/swrasterizer.h"
 
 namespace VideoCore {
 
+SWRasterizer::SWRasterizer() {
+    // The PICA state may have been changed while another rasterizer was active
+    Pica::Rasterizer::NotifyLightingChanged();
+    Pica::Rasterizer::NotifyTexturingChanged();
+}
+
 void SWRasterizer::AddTriangle(const Pica::Shader::OutputVertex& v0,
                                const Pica::Shader::OutputVertex& v1,
                                const Pica::Shader::OutputVertex& v2) {
+    // Triangles are drawn as they come, so this is where skipped frames are dropped. The pixels are
+    // written straight to emulated memory, which is why only draws to the screen are skipped.
+    const auto& framebuffer = Pica::g_state.regs.framebuffer.framebuffer;
+    if (Core::System::GetInstance().frame_skipper.IsSkippingDraw(
+            framebuffer.GetColorBufferPhysicalAddress()))
+        return;
     Pica::Clipper::ProcessTriangle(v0, v1, v2);
 }
 
+void SWRasterizer::NotifyPicaRegisterChanged(u32 id) {
+    // This also covers writes to the lighting LUT data registers
+    if (id >= PICA_REG_INDEX(lighting) &&
+        id < PICA_REG_INDEX(lighting) + sizeof(Pica::LightingRegs) / sizeof(u32)) {
+        Pica::Rasterizer::NotifyLightingChanged();
+    }
+
+    if ((id >= PICA_REG_INDEX(texturing) &&
+         id < PICA_REG_INDEX(texturing) + sizeof(Pica::TexturingRegs) / sizeof(u32)) ||
+        id == PICA_REG_INDEX(framebuffer.output_merger.alpha_test)) {
+        Pica::Rasterizer::NotifyTexturingChanged();
+    }
+}
+
 } // namespace VideoCore
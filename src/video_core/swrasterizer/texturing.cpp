@@ -3,11 +3,14 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <cstring>
+#include <utility>
 
 #include "common/assert.h"
 #include "common/common_types.h"
 #include "common/math_util.h"
 #include "common/vector_math.h"
+#include "video_core/regs_framebuffer.h"
 #include "video_core/regs_texturing.h"
 #include "video_core/swrasterizer/texturing.h"
 
@@ -240,5 +243,291 @@ u8 AlphaCombine(TevStageConfig::Operation op, const std::array<u8, 3>& input) {
     }
 };
 
+// Wrappers specialising the generic combiner functions on their configuration value. Since these
+// live in the same translation unit, the dispatch is resolved at compile time.
+
+template <TevStageConfig::ColorModifier factor>
+static Math::Vec3<u8> ColorModifierFn(const Math::Vec4<u8>& values) {
+    return GetColorModifier(factor, values);
+}
+
+template <TevStageConfig::AlphaModifier factor>
+static u8 AlphaModifierFn(const Math::Vec4<u8>& values) {
+    return GetAlphaModifier(factor, values);
+}
+
+template <TevStageConfig::Operation op>
+static Math::Vec3<u8> ColorCombineFn(const Math::Vec3<u8> input[3]) {
+    return ColorCombine(op, input);
+}
+
+template <TevStageConfig::Operation op>
+static u8 AlphaCombineFn(const std::array<u8, 3>& input) {
+    return AlphaCombine(op, input);
+}
+
+template <FramebufferRegs::CompareFunc func>
+static bool AlphaTestFn(u8 alpha, u8 ref) {
+    using CompareFunc = FramebufferRegs::CompareFunc;
+    switch (func) {
+    case CompareFunc::Never:
+        return false;
+    case CompareFunc::Always:
+        return true;
+    case CompareFunc::Equal:
+        return alpha == ref;
+    case CompareFunc::NotEqual:
+        return alpha != ref;
+    case CompareFunc::LessThan:
+        return alpha < ref;
+    case CompareFunc::LessThanOrEqual:
+        return alpha <= ref;
+    case CompareFunc::GreaterThan:
+        return alpha > ref;
+    case CompareFunc::GreaterThanOrEqual:
+        return alpha >= ref;
+    }
+    return false;
+}
+
+/// Builds a table of function pointers, indexed by the raw value of the template argument enum
+template <typename Enum, typename Func, template <Enum> class Wrapper, size_t... values>
+static constexpr std::array<Func, sizeof...(values)> MakeFunctionTable(
+    std::index_sequence<values...>) {
+    return {{Wrapper<static_cast<Enum>(values)>::value...}};
+}
+
+#define FUNCTION_TABLE_WRAPPER(name, Enum, function)                                               \
+    template <Enum value_>                                                                         \
+    struct name {                                                                                  \
+        static constexpr auto value = &function<value_>;                                           \
+    }
+
+FUNCTION_TABLE_WRAPPER(ColorModifierEntry, TevStageConfig::ColorModifier, ColorModifierFn);
+FUNCTION_TABLE_WRAPPER(AlphaModifierEntry, TevStageConfig::AlphaModifier, AlphaModifierFn);
+FUNCTION_TABLE_WRAPPER(ColorCombineEntry, TevStageConfig::Operation, ColorCombineFn);
+FUNCTION_TABLE_WRAPPER(AlphaCombineEntry, TevStageConfig::Operation, AlphaCombineFn);
+FUNCTION_TABLE_WRAPPER(AlphaTestEntry, FramebufferRegs::CompareFunc, AlphaTestFn);
+
+#undef FUNCTION_TABLE_WRAPPER
+
+/// Returns the number of operands read by a combiner operation
+static unsigned GetNumOperands(TevStageConfig::Operation op) {
+    using Operation = TevStageConfig::Operation;
+    switch (op) {
+    case Operation::Replace:
+        return 1;
+    case Operation::Modulate:
+    case Operation::Add:
+    case Operation::AddSigned:
+    case Operation::Subtract:
+    case Operation::Dot3_RGB:
+    case Operation::Dot3_RGBA:
+        return 2;
+    case Operation::Lerp:
+    case Operation::MultiplyThenAdd:
+    case Operation::AddThenMultiply:
+        return 3;
+    default:
+        return 0;
+    }
+}
+
+static u8 GetInputSlot(TevStageConfig::Source source, unsigned stage_index) {
+    using Source = TevStageConfig::Source;
+    switch (source) {
+    case Source::PrimaryColor:
+        return TevProgram::PrimaryColor;
+    case Source::PrimaryFragmentColor:
+        return TevProgram::PrimaryFragmentColor;
+    case Source::SecondaryFragmentColor:
+        return TevProgram::SecondaryFragmentColor;
+    case Source::Texture0:
+        return TevProgram::Texture0;
+    case Source::Texture1:
+        return TevProgram::Texture1;
+    case Source::Texture2:
+        return TevProgram::Texture2;
+    case Source::Texture3:
+        return TevProgram::Texture3;
+    case Source::PreviousBuffer:
+        return TevProgram::PreviousBuffer;
+    case Source::Constant:
+        return static_cast<u8>(TevProgram::Constant0 + stage_index);
+    case Source::Previous:
+        return TevProgram::Previous;
+    default:
+        LOG_ERROR(HW_GPU, "Unknown color combiner source %d", (int)source);
+        return TevProgram::Zero;
+    }
+}
+
+TevProgram::TevProgram(const TexturingRegs& texturing, const FramebufferRegs& framebuffer) {
+    using Operation = TevStageConfig::Operation;
+    using Source = TevStageConfig::Source;
+
+    static constexpr auto color_modifiers =
+        MakeFunctionTable<TevStageConfig::ColorModifier, ColorModifierFunc, ColorModifierEntry>(
+            std::make_index_sequence<16>());
+    static constexpr auto alpha_modifiers =
+        MakeFunctionTable<TevStageConfig::AlphaModifier, AlphaModifierFunc, AlphaModifierEntry>(
+            std::make_index_sequence<8>());
+    static constexpr auto color_combiners =
+        MakeFunctionTable<Operation, ColorCombineFunc, ColorCombineEntry>(
+            std::make_index_sequence<16>());
+    static constexpr auto alpha_combiners =
+        MakeFunctionTable<Operation, AlphaCombineFunc, AlphaCombineEntry>(
+            std::make_index_sequence<16>());
+    static constexpr auto alpha_tests =
+        MakeFunctionTable<FramebufferRegs::CompareFunc, AlphaTestFunc, AlphaTestEntry>(
+            std::make_index_sequence<8>());
+
+    const auto tev_stages = texturing.GetTevStages();
+    bool previous_stage_skipped = false;
+    for (unsigned stage_index = 0; stage_index < tev_stages.size(); ++stage_index) {
+        const auto& tev_stage = tev_stages[stage_index];
+
+        constants[stage_index] = Math::MakeVec(tev_stage.const_r.Value(), tev_stage.const_g.Value(),
+                                               tev_stage.const_b.Value(), tev_stage.const_a.Value())
+                                     .Cast<u8>();
+
+        Stage stage;
+        stage.update_buffer_color =
+            texturing.tev_combiner_buffer_input.TevStageUpdatesCombinerBufferColor(stage_index);
+        stage.update_buffer_alpha =
+            texturing.tev_combiner_buffer_input.TevStageUpdatesCombinerBufferAlpha(stage_index);
+        stage.color_multiplier = tev_stage.GetColorMultiplier();
+        stage.alpha_multiplier = tev_stage.GetAlphaMultiplier();
+
+        // Stages which pass on the previous output unmodified don't need to be run at all
+        bool is_passthrough =
+            tev_stage.color_op == Operation::Replace && tev_stage.alpha_op == Operation::Replace &&
+            tev_stage.color_source1 == Source::Previous &&
+            tev_stage.alpha_source1 == Source::Previous &&
+            tev_stage.color_modifier1 == TevStageConfig::ColorModifier::SourceColor &&
+            tev_stage.alpha_modifier1 == TevStageConfig::AlphaModifier::SourceAlpha &&
+            stage.color_multiplier == 1 && stage.alpha_multiplier == 1 &&
+            !stage.update_buffer_color && !stage.update_buffer_alpha;
+        if (is_passthrough) {
+            previous_stage_skipped = true;
+            continue;
+        }
+        stage.previous_stage_skipped = previous_stage_skipped;
+        previous_stage_skipped = false;
+
+        const std::array<Source, 3> color_sources = {
+            {tev_stage.color_source1, tev_stage.color_source2, tev_stage.color_source3}};
+        const std::array<Source, 3> alpha_sources = {
+            {tev_stage.alpha_source1, tev_stage.alpha_source2, tev_stage.alpha_source3}};
+        const std::array<TevStageConfig::ColorModifier, 3> color_modifier_values = {
+            {tev_stage.color_modifier1, tev_stage.color_modifier2, tev_stage.color_modifier3}};
+        const std::array<TevStageConfig::AlphaModifier, 3> alpha_modifier_values = {
+            {tev_stage.alpha_modifier1, tev_stage.alpha_modifier2, tev_stage.alpha_modifier3}};
+
+        stage.num_color_operands = GetNumOperands(tev_stage.color_op);
+        stage.color_combine = color_combiners[static_cast<size_t>(tev_stage.color_op.Value())];
+        stage.dot3_rgba = tev_stage.color_op == Operation::Dot3_RGBA;
+        stage.num_alpha_operands = stage.dot3_rgba ? 0 : GetNumOperands(tev_stage.alpha_op);
+        stage.alpha_combine = alpha_combiners[static_cast<size_t>(tev_stage.alpha_op.Value())];
+
+        for (unsigned i = 0; i < 3; ++i) {
+            stage.color_inputs[i] = GetInputSlot(color_sources[i], stage_index);
+            stage.color_modifiers[i] =
+                color_modifiers[static_cast<size_t>(color_modifier_values[i])];
+            stage.alpha_inputs[i] = GetInputSlot(alpha_sources[i], stage_index);
+            stage.alpha_modifiers[i] =
+                alpha_modifiers[static_cast<size_t>(alpha_modifier_values[i])];
+        }
+
+        stages[num_stages++] = stage;
+    }
+
+    initial_buffer = Math::MakeVec(texturing.tev_combiner_buffer_color.r.Value(),
+                                   texturing.tev_combiner_buffer_color.g.Value(),
+                                   texturing.tev_combiner_buffer_color.b.Value(),
+                                   texturing.tev_combiner_buffer_color.a.Value())
+                         .Cast<u8>();
+
+    const auto& alpha_test_config = framebuffer.output_merger.alpha_test;
+    if (alpha_test_config.enable) {
+        alpha_test = alpha_tests[static_cast<size_t>(alpha_test_config.func.Value())];
+        alpha_test_ref = static_cast<u8>(alpha_test_config.ref);
+    }
+}
+
+TevProgram::Config::Config(const TexturingRegs& texturing, const FramebufferRegs& framebuffer) {
+    // Padding is zeroed as well, as configs are compared and hashed bytewise
+    std::memset(this, 0, sizeof(Config));
+
+    const auto tev_stages = texturing.GetTevStages();
+    for (size_t i = 0; i < tev_stages.size(); ++i) {
+        std::memcpy(&this->tev_stages[i * sizeof(TevStageConfig)], &tev_stages[i],
+                    sizeof(TevStageConfig));
+    }
+    buffer_update_mask = texturing.tev_combiner_buffer_input.update_mask_rgb |
+                         (texturing.tev_combiner_buffer_input.update_mask_a << 4);
+    buffer_color = texturing.tev_combiner_buffer_color.raw;
+    std::memcpy(&alpha_test, &framebuffer.output_merger.alpha_test, sizeof(u32));
+}
+
+void TevProgram::SetupInputs(Inputs& inputs) const {
+    inputs[Zero] = {0, 0, 0, 0};
+    std::copy(constants.begin(), constants.end(), inputs.begin() + Constant0);
+}
+
+bool TevProgram::Run(Inputs& inputs, Math::Vec4<u8>& output) const {
+    Math::Vec4<u8> next_buffer = initial_buffer;
+    inputs[PreviousBuffer] = {0, 0, 0, 0};
+    inputs[Previous] = {0, 0, 0, 0};
+
+    for (unsigned stage_index = 0; stage_index < num_stages; ++stage_index) {
+        const Stage& stage = stages[stage_index];
+
+        if (stage.previous_stage_skipped) {
+            // The buffer moves on by one stage even for stages that were skipped
+            inputs[PreviousBuffer] = next_buffer;
+        }
+
+        Math::Vec3<u8> color_result[3];
+        for (unsigned i = 0; i < stage.num_color_operands; ++i) {
+            color_result[i] = stage.color_modifiers[i](inputs[stage.color_inputs[i]]);
+        }
+        Math::Vec3<u8> color_output = stage.color_combine(color_result);
+
+        u8 alpha_output;
+        if (stage.dot3_rgba) {
+            // result of Dot3_RGBA operation is also placed to the alpha component
+            alpha_output = color_output.x;
+        } else {
+            std::array<u8, 3> alpha_result;
+            for (unsigned i = 0; i < stage.num_alpha_operands; ++i) {
+                alpha_result[i] = stage.alpha_modifiers[i](inputs[stage.alpha_inputs[i]]);
+            }
+            alpha_output = stage.alpha_combine(alpha_result);
+        }
+
+        Math::Vec4<u8>& previous = inputs[Previous];
+        previous.r() = std::min(255u, color_output.r() * stage.color_multiplier);
+        previous.g() = std::min(255u, color_output.g() * stage.color_multiplier);
+        previous.b() = std::min(255u, color_output.b() * stage.color_multiplier);
+        previous.a() = std::min(255u, alpha_output * stage.alpha_multiplier);
+
+        inputs[PreviousBuffer] = next_buffer;
+
+        if (stage.update_buffer_color) {
+            next_buffer.r() = previous.r();
+            next_buffer.g() = previous.g();
+            next_buffer.b() = previous.b();
+        }
+
+        if (stage.update_buffer_alpha) {
+            next_buffer.a() = previous.a();
+        }
+    }
+
+    output = inputs[Previous];
+    return alpha_test == nullptr || alpha_test(output.a(), alpha_test_ref);
+}
+
 } // namespace Rasterizer
 } // namespace Pica
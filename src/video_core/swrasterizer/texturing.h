@@ -4,8 +4,13 @@
 
 #pragma once
 
+#include <array>
+#include <cstring>
+#include <functional>
 #include "common/common_types.h"
+#include "common/hash.h"
 #include "common/vector_math.h"
+#include "video_core/regs_framebuffer.h"
 #include "video_core/regs_texturing.h"
 
 namespace Pica {
@@ -24,5 +29,114 @@ Math::Vec3<u8> ColorCombine(TexturingRegs::TevStageConfig::Operation op,
 
 u8 AlphaCombine(TexturingRegs::TevStageConfig::Operation op, const std::array<u8, 3>& input);
 
+/**
+ * Texture combiner and alpha test configuration, translated into input indices and functions
+ * specialised on the register values. This lets fragments be combined without dispatching on the
+ * configuration for every operand, and drops stages that just pass on the previous output.
+ */
+class TevProgram {
+public:
+    /// Slots of the per-fragment input array
+    enum InputSlot : unsigned {
+        PrimaryColor = 0,
+        PrimaryFragmentColor = 1,
+        SecondaryFragmentColor = 2,
+        Texture0 = 3,
+        Texture1 = 4,
+        Texture2 = 5,
+        Texture3 = 6,
+        PreviousBuffer = 7,
+        Previous = 8,
+        /// Used for invalid sources
+        Zero = 9,
+        /// Constant color of the first stage, followed by those of the other stages
+        Constant0 = 10,
+
+        NumInputSlots = Constant0 + 6,
+    };
+    using Inputs = std::array<Math::Vec4<u8>, NumInputSlots>;
+
+    TevProgram(const TexturingRegs& texturing, const FramebufferRegs& framebuffer);
+
+    /// Register state a program is compiled from, which identifies the program in caches
+    struct Config {
+        Config(const TexturingRegs& texturing, const FramebufferRegs& framebuffer);
+
+        bool operator==(const Config& other) const {
+            return std::memcmp(this, &other, sizeof(Config)) == 0;
+        }
+
+        bool operator!=(const Config& other) const {
+            return !(*this == other);
+        }
+
+        /// Raw values of the registers of the six combiner stages
+        std::array<u8, sizeof(TexturingRegs::TevStageConfig) * 6> tev_stages;
+        u32 buffer_update_mask;
+        u32 buffer_color;
+        u32 alpha_test;
+    };
+
+    /// Fills in the slots of the input array that are constant for the whole draw
+    void SetupInputs(Inputs& inputs) const;
+
+    /**
+     * Combines a fragment and applies the alpha test to the result.
+     * @param inputs Inputs set up with SetupInputs, with the slots up to Texture3 filled in for the
+     *               current fragment
+     * @param output Receives the combiner output
+     * @returns false if the fragment was discarded by the alpha test
+     */
+    bool Run(Inputs& inputs, Math::Vec4<u8>& output) const;
+
+private:
+    using ColorModifierFunc = Math::Vec3<u8> (*)(const Math::Vec4<u8>& values);
+    using AlphaModifierFunc = u8 (*)(const Math::Vec4<u8>& values);
+    using ColorCombineFunc = Math::Vec3<u8> (*)(const Math::Vec3<u8> input[3]);
+    using AlphaCombineFunc = u8 (*)(const std::array<u8, 3>& input);
+    using AlphaTestFunc = bool (*)(u8 alpha, u8 ref);
+
+    struct Stage {
+        unsigned num_color_operands;
+        std::array<u8, 3> color_inputs;
+        std::array<ColorModifierFunc, 3> color_modifiers;
+        ColorCombineFunc color_combine;
+        unsigned color_multiplier;
+
+        /// The alpha combiner is skipped if the alpha output is taken from a Dot3_RGBA result
+        bool dot3_rgba;
+        unsigned num_alpha_operands;
+        std::array<u8, 3> alpha_inputs;
+        std::array<AlphaModifierFunc, 3> alpha_modifiers;
+        AlphaCombineFunc alpha_combine;
+        unsigned alpha_multiplier;
+
+        bool update_buffer_color;
+        bool update_buffer_alpha;
+
+        /// Whether the stage before this one was dropped, so the previous buffer must be updated
+        bool previous_stage_skipped;
+    };
+
+    std::array<Stage, 6> stages;
+    unsigned num_stages = 0;
+
+    std::array<Math::Vec4<u8>, 6> constants;
+    Math::Vec4<u8> initial_buffer;
+
+    /// Null if alpha testing is disabled
+    AlphaTestFunc alpha_test = nullptr;
+    u8 alpha_test_ref;
+};
+
 } // namespace Rasterizer
 } // namespace Pica
+
+namespace std {
+template <>
+struct hash<Pica::Rasterizer::TevProgram::Config> {
+    size_t operator()(const Pica::Rasterizer::TevProgram::Config& k) const {
+        return Common::ComputeHash64(&k, sizeof(Pica::Rasterizer::TevProgram::Config));
+    }
+};
+} // namespace std
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <cstddef>
+#include <cstring>
 #include "common/common_types.h"
 
 namespace VideoCore {
@@ -49,4 +51,72 @@ static inline u32 GetMortonOffset(u32 x, u32 y, u32 bytes_per_pixel) {
     return (i + offset) * bytes_per_pixel;
 }
 
+/**
+ * Copies a single 8x8 tile between Morton order and a linear image.
+ *
+ * Texels are moved in pairs, since horizontally adjacent texels at even x coordinates are also
+ * adjacent in Morton order. All sizes are compile-time constants, which lets the compiler turn each
+ * copy into plain (vector) loads and stores instead of per-texel offset computations.
+ *
+ * @tparam bytes_per_pixel Size of a texel in the Morton-ordered tile
+ * @tparam linear_bytes_per_pixel Size of a texel in the linear image. Must be at least
+ *                                bytes_per_pixel; only the first bytes_per_pixel bytes are copied.
+ * @tparam morton_to_linear Copy direction
+ * @param tile_buffer Pointer to the beginning of the Morton-ordered tile
+ * @param linear_buffer Pointer to the first texel of the linear line matching row 0 of the tile
+ * @param linear_stride Offset in bytes between consecutive linear lines. May be negative for
+ *                      images stored bottom-up.
+ */
+template <size_t bytes_per_pixel, size_t linear_bytes_per_pixel, bool morton_to_linear>
+inline void MortonCopyTile(u8* tile_buffer, u8* linear_buffer, ptrdiff_t linear_stride) {
+    static_assert(linear_bytes_per_pixel >= bytes_per_pixel, "Linear texels too small");
+
+    for (u32 y = 0; y < 8; ++y) {
+        u8* line = linear_buffer + y * linear_stride;
+        for (u32 x = 0; x < 8; x += 2) {
+            u8* tile_pixels = tile_buffer + MortonInterleave(x, y) * bytes_per_pixel;
+            u8* linear_pixels = line + x * linear_bytes_per_pixel;
+
+            if (bytes_per_pixel == linear_bytes_per_pixel) {
+                if (morton_to_linear) {
+                    std::memcpy(linear_pixels, tile_pixels, 2 * bytes_per_pixel);
+                } else {
+                    std::memcpy(tile_pixels, linear_pixels, 2 * bytes_per_pixel);
+                }
+            } else {
+                for (u32 i = 0; i < 2; ++i) {
+                    u8* linear_pixel = linear_pixels + i * linear_bytes_per_pixel;
+                    u8* tile_pixel = tile_pixels + i * bytes_per_pixel;
+                    if (morton_to_linear) {
+                        std::memcpy(linear_pixel, tile_pixel, bytes_per_pixel);
+                    } else {
+                        std::memcpy(tile_pixel, linear_pixel, bytes_per_pixel);
+                    }
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Copies a tiled image of the given size between Morton order and a linear, bottom-up image (as
+ * used by OpenGL), one tile at a time.
+ * @param width, height Dimensions of the image in texels. Must be multiples of 8.
+ */
+template <size_t bytes_per_pixel, size_t linear_bytes_per_pixel, bool morton_to_linear>
+inline void MortonCopyImage(u32 width, u32 height, u8* morton_data, u8* linear_data) {
+    const ptrdiff_t linear_stride = static_cast<ptrdiff_t>(width * linear_bytes_per_pixel);
+    u8* tile_buffer = morton_data;
+
+    for (u32 y = 0; y < height; y += 8) {
+        // Row 0 of each tile is the lowest line, which is stored last in a bottom-up image
+        u8* linear_line = linear_data + (height - 1 - y) * linear_stride;
+        for (u32 x = 0; x < width; x += 8) {
+            MortonCopyTile<bytes_per_pixel, linear_bytes_per_pixel, morton_to_linear>(
+                tile_buffer, linear_line + x * linear_bytes_per_pixel, -linear_stride);
+            tile_buffer += 8 * 8 * bytes_per_pixel;
+        }
+    }
+}
+
 } // namespace
@@ -20,8 +20,10 @@ extern EmuWindow* g_emu_window;                  ///< Emu window
 
 // TODO: Wrap these in a user settings struct along with any other graphics settings (often set from
 // qt ui)
+extern std::atomic<bool> g_null_renderer_enabled;
 extern std::atomic<bool> g_hw_renderer_enabled;
 extern std::atomic<bool> g_shader_jit_enabled;
+extern std::atomic<bool> g_compiled_tev_enabled;
 extern std::atomic<bool> g_toggle_framelimit_enabled;
 
 /// Start the video core